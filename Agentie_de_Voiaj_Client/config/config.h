@@ -1,5 +1,6 @@
 #pragma once
 #include <QString>
+#include <QStringList>
 
 namespace Config
 {
@@ -21,9 +22,18 @@ namespace Config
     {
         const QString DEFAULT_HOST = "127.0.0.1";
         constexpr int DEFAULT_PORT = 8080;
+        const QString LOCAL_SERVER_NAME = "";          // Set to the server's local socket name to skip TCP on the same host
         constexpr int CONNECTION_TIMEOUT_MS = 300000;  // 5 minutes
         constexpr int REQUEST_TIMEOUT_MS = 60000;     // 60 seconds
         constexpr int MAX_RETRIES = 3;
+        constexpr int LISTING_PAGE_SIZE = 50;          // Offers/reservations asked for per page
+
+        // Columns the offer and reservation cards show; the rest of an offer comes with GET_OFFER_DETAILS
+        const QStringList OFFER_CARD_FIELDS = { "Offer_ID", "Name", "Destination_Name", "Price_per_Person",
+                                                "Duration_Days", "Departure_Date", "Return_Date",
+                                                "Total_Seats", "Reserved_Seats", "Status" };
+        const QStringList RESERVATION_CARD_FIELDS = { "Reservation_ID", "Offer_ID", "Offer_Name", "Destination_Name",
+                                                      "Number_of_Persons", "Total_Price", "Reservation_Date", "Status" };
     }
 
     // UI Configuration
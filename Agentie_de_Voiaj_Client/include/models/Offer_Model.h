@@ -54,6 +54,8 @@ public:
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
     // Public methods
     void refresh_offers();
@@ -88,7 +90,7 @@ signals:
     void cancellation_failed(const QString& error_message);
 
 private slots:
-    void on_offers_received(const QJsonArray& offers);
+    void on_offers_received(const QJsonArray& offers, const QString& next_page);
     void on_booking_success(const QString& message);
     void on_booking_failed(const QString& error_message);
     void on_cancellation_success(const QString& message);
@@ -104,6 +106,10 @@ private:
     void save_cached_offers();
 
     QVector<Offer> m_offers;
+    QString m_next_page;          // Server token for the page after the last one received
+    QJsonObject m_search_params;  // Last search, repeated with "after" for its next pages
+    bool m_is_search = false;
+    bool m_fetching_more = false; // The awaited page is appended instead of replacing the list
     bool m_is_loading = false;
     QString m_last_error;
     QSettings* m_settings = nullptr;
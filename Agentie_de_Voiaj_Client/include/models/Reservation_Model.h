@@ -56,6 +56,8 @@ public:
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
     // Public methods
     void refresh_reservations();
@@ -89,7 +91,7 @@ signals:
     void status_updated(int reservation_id, const QString& new_status);
 
 private slots:
-    void on_reservations_received(const QJsonArray& reservations);
+    void on_reservations_received(const QJsonArray& reservations, const QString& next_page);
     void on_cancellation_success(const QString& message);
     void on_cancellation_failed(const QString& error_message);
     void on_network_error(const QString& error_message);
@@ -103,6 +105,8 @@ private:
     void load_cached_reservations();
 
     QVector<Reservation> m_reservations;
+    QString m_next_page;          // Server token for the older reservations after the last one received
+    bool m_fetching_more = false; // The awaited page is appended instead of replacing the list
     bool m_is_loading = false;
     QString m_last_error;
     QSettings* m_settings = nullptr;
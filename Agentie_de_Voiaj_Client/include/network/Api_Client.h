@@ -1,6 +1,7 @@
 #pragma once
 #include <QObject>
 #include <QTcpSocket>
+#include <QLocalSocket>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -21,6 +22,7 @@ public:
         Get_Destinations,
         Get_Offers,
         Search_Offers,
+        Get_Offer_Details,
         Book_Offer,
         Get_User_Reservations,
         Cancel_Reservation,
@@ -35,12 +37,14 @@ public:
         QJsonObject data;
         int status_code = 0;
         QString error_details;
+        QString next_page; // Paged listings: pass back as "after" for the next page, empty on the last one
     };
 
     static Api_Client& instance();
     static void shutdown();
 
     void set_server_url(const QString& host, int port);
+    void set_local_server(const QString& name); // same-host server socket instead of TCP, empty = TCP
     void set_auth_token(const QString& token);
     void set_timeout(int timeout_ms);
 
@@ -53,12 +57,13 @@ public:
     void logout();
 
     void get_destinations();
-    void get_offers();
-    void search_offers(const QJsonObject& search_params);
+    void get_offers(const QString& after = QString());
+    void search_offers(const QJsonObject& search_params, const QString& after = QString());
+    void get_offer_details(int offer_id);
 
     void get_user_info();
     void update_user_info(const QJsonObject& user_data);
-    void get_user_reservations();
+    void get_user_reservations(const QString& after = QString());
 
     void book_offer(int offer_id, int person_count, const QJsonObject& additional_info);
     void cancel_reservation(int reservation_id);
@@ -78,9 +83,10 @@ signals:
     void logged_out();
 
     void destinations_received(const QJsonArray& destinations);
-    void offers_received(const QJsonArray& offers);
+    void offers_received(const QJsonArray& offers, const QString& next_page);
+    void offer_details_received(const QJsonObject& offer);
     void user_info_received(const QJsonObject& user_info);
-    void reservations_received(const QJsonArray& reservations);
+    void reservations_received(const QJsonArray& reservations, const QString& next_page);
 
     void booking_success(const QString& message);
     void booking_failed(const QString& error_message);
@@ -94,6 +100,7 @@ private slots:
     void on_socket_disconnected();
     void on_socket_ready_read();
     void on_socket_error(QAbstractSocket::SocketError error);
+    void on_local_socket_error(QLocalSocket::LocalSocketError error);
     void on_request_timeout();
     void send_keepalive();
     void attempt_reconnection();
@@ -106,6 +113,8 @@ private:
     void disconnect_from_server();
     void send_json_message(const QJsonObject& message);
     void send_request(Request_Type type, const QJsonObject& data);
+    void send_pending_requests();
+    bool retry_in_flight_request(const QString& reason);
     void handle_response(const QJsonObject& response);
     
     Api_Response parse_json_response(const QJsonObject& json_response) const;
@@ -113,6 +122,12 @@ private:
     void process_data_response(Request_Type type, const Api_Response& response);
 
     void handle_socket_error(QAbstractSocket::SocketError error);
+    
+    // The connection in use: m_local_socket when a local server name is set, else m_socket
+    bool is_local_transport() const;
+    QIODevice* get_transport() const;
+    bool is_transport_connected() const;
+    bool is_transport_connecting() const;
     void emit_error(const QString& error_message);
 
     QString request_type_to_string(Request_Type type) const;
@@ -125,6 +140,7 @@ private:
     static Api_Client* s_instance;
 
     std::unique_ptr<QTcpSocket> m_socket;
+    std::unique_ptr<QLocalSocket> m_local_socket;
     std::unique_ptr<QTimer> m_timeout_timer;
     std::unique_ptr<QTimer> m_reconnect_timer;
     std::unique_ptr<QTimer> m_keepalive_timer;
@@ -132,6 +148,7 @@ private:
 
     QString m_server_host;
     int m_server_port;
+    QString m_local_server_name;
     QString m_auth_token;
     int m_timeout_ms;
 
@@ -146,10 +163,19 @@ private:
         QJsonObject data;
     };
     QList<Pending_Request> m_pending_requests;
+    
+    // Last booking/cancellation sent with an idempotency key, resent as-is on timeout or reconnect
+    std::optional<Pending_Request> m_retryable_request;
+    int m_retry_attempts = 0;
+    
+    // RESUME_SESSION sent on reconnect, pending requests wait for its answer
+    bool m_resuming_session = false;
 
     	static constexpr int DEFAULT_TIMEOUT_MS = 15000; // 15 seconds - matches config.h
     static constexpr int DEFAULT_PORT = 8080;
     static constexpr int MAX_BUFFER_SIZE = 1024 * 1024; // 1MB limit
+    static constexpr int REQUEST_IN_PROGRESS_CODE = 409; // matches Config::Idempotency on the server
+    static constexpr int IN_PROGRESS_RETRY_DELAY_MS = 500;
 };
 
 Q_DECLARE_METATYPE(Api_Client::Request_Type)
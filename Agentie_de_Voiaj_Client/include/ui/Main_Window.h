@@ -82,6 +82,7 @@ private:
     void refresh_destinations_display();
     void refresh_offers_display();
     void refresh_reservations_display();
+    void fetch_more_near_end(QScrollArea* scroll_area, QAbstractItemModel* model);
     
     // Profile management helpers
     void load_profile_data();
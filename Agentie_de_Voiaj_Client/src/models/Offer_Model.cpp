@@ -91,12 +91,37 @@ QHash<int, QByteArray> Offer_Model::roleNames() const
     return roles;
 }
 
+bool Offer_Model::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return false;
+    
+    return !m_next_page.isEmpty() && !m_is_loading;
+}
+
+void Offer_Model::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    
+    set_loading(true);
+    m_fetching_more = true;
+    qDebug() << "Offer_Model: Fetching next page of offers...";
+    
+    if (m_is_search)
+        Api_Client::instance().search_offers(m_search_params, m_next_page);
+    else
+        Api_Client::instance().get_offers(m_next_page);
+}
+
 void Offer_Model::refresh_offers()
 {
     if (m_is_loading)
         return;
     
     set_loading(true);
+    m_is_search = false;
+    m_fetching_more = false;
     qDebug() << "Offer_Model: Refreshing offers...";
     
     Api_Client::instance().get_offers();
@@ -118,6 +143,9 @@ void Offer_Model::search_offers(const QString& destination, double min_price, do
     if (max_price > 0.0)
         search_params["max_price"] = max_price;
     
+    m_search_params = search_params;
+    m_is_search = true;
+    m_fetching_more = false;
     Api_Client::instance().search_offers(search_params);
 }
 
@@ -125,6 +153,7 @@ void Offer_Model::clear_offers()
 {
     beginResetModel();
     m_offers.clear();
+    m_next_page.clear();
     endResetModel();
     
     emit offers_cleared();
@@ -235,13 +264,11 @@ void Offer_Model::connect_api_signals()
             this, &Offer_Model::on_network_error);
 }
 
-void Offer_Model::on_offers_received(const QJsonArray& offers)
+void Offer_Model::on_offers_received(const QJsonArray& offers, const QString& next_page)
 {
     qDebug() << "Offer_Model: Received" << offers.size() << "offers";
     
-    beginResetModel();
-    m_offers.clear();
-    
+    QVector<Offer> page;
     for (const auto& value : offers)
     {
         if (value.isObject())
@@ -249,14 +276,31 @@ void Offer_Model::on_offers_received(const QJsonArray& offers)
             Offer offer = offer_from_json(value.toObject());
             if (offer.id > 0)  // Valid offer
             {
-                m_offers.append(offer);
+                page.append(offer);
             }
         }
     }
     
+    m_next_page = next_page;
+    set_loading(false);
+    
+    // A further page goes below the rows already shown, views add only the new ones
+    if (m_fetching_more)
+    {
+        m_fetching_more = false;
+        if (!page.isEmpty())
+        {
+            beginInsertRows(QModelIndex(), m_offers.size(), m_offers.size() + page.size() - 1);
+            m_offers += page;
+            endInsertRows();
+        }
+        return;
+    }
+    
+    beginResetModel();
+    m_offers = page;
     endResetModel();
     
-    set_loading(false);
     emit offers_loaded();
     emit data_refreshed();
     
@@ -293,6 +337,7 @@ void Offer_Model::on_cancellation_failed(const QString& error_message)
 void Offer_Model::on_network_error(const QString& error_message)
 {
     set_loading(false);
+    m_fetching_more = false;
     qWarning() << "Offer_Model: Network error:" << error_message;
     set_error(error_message);
     emit error_occurred(error_message);
@@ -94,12 +94,33 @@ QHash<int, QByteArray> Reservation_Model::roleNames() const
     return roles;
 }
 
+bool Reservation_Model::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return false;
+    
+    return !m_next_page.isEmpty() && !m_is_loading;
+}
+
+void Reservation_Model::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    
+    set_loading(true);
+    m_fetching_more = true;
+    qDebug() << "Reservation_Model: Fetching next page of reservations...";
+    
+    Api_Client::instance().get_user_reservations(m_next_page);
+}
+
 void Reservation_Model::refresh_reservations()
 {
     if (m_is_loading)
         return;
     
     set_loading(true);
+    m_fetching_more = false;
     qDebug() << "Reservation_Model: Refreshing reservations...";
     
     Api_Client::instance().get_user_reservations();
@@ -109,6 +130,7 @@ void Reservation_Model::clear_reservations()
 {
     beginResetModel();
     m_reservations.clear();
+    m_next_page.clear();
     endResetModel();
     
     emit reservations_cleared();
@@ -234,13 +256,11 @@ void Reservation_Model::connect_api_signals()
             this, &Reservation_Model::on_network_error);
 }
 
-void Reservation_Model::on_reservations_received(const QJsonArray& reservations)
+void Reservation_Model::on_reservations_received(const QJsonArray& reservations, const QString& next_page)
 {
     qDebug() << "Reservation_Model: Received" << reservations.size() << "reservations";
     
-    beginResetModel();
-    m_reservations.clear();
-    
+    QVector<Reservation> page;
     for (const auto& value : reservations)
     {
         if (value.isObject())
@@ -248,14 +268,31 @@ void Reservation_Model::on_reservations_received(const QJsonArray& reservations)
             Reservation reservation = reservation_from_json(value.toObject());
             if (reservation.id > 0)  // Valid reservation
             {
-                m_reservations.append(reservation);
+                page.append(reservation);
             }
         }
     }
     
+    m_next_page = next_page;
+    set_loading(false);
+    
+    // Older reservations go below the ones already shown, views add only the new rows
+    if (m_fetching_more)
+    {
+        m_fetching_more = false;
+        if (!page.isEmpty())
+        {
+            beginInsertRows(QModelIndex(), m_reservations.size(), m_reservations.size() + page.size() - 1);
+            m_reservations += page;
+            endInsertRows();
+        }
+        return;
+    }
+    
+    beginResetModel();
+    m_reservations = page;
     endResetModel();
     
-    set_loading(false);
     emit reservations_loaded();
     emit data_refreshed();
     
@@ -282,6 +319,7 @@ void Reservation_Model::on_cancellation_failed(const QString& error_message)
 void Reservation_Model::on_network_error(const QString& error_message)
 {
     set_loading(false);
+    m_fetching_more = false;
     qWarning() << "Reservation_Model: Network error:" << error_message;
     set_error(error_message);
     emit error_occurred(error_message);
@@ -4,8 +4,10 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QMutexLocker>
+#include <QUuid>
 #include <QDebug>
 #include <mutex>
+#include <algorithm>
 
 // Static instance
 Api_Client* Api_Client::s_instance = nullptr;
@@ -13,11 +15,13 @@ Api_Client* Api_Client::s_instance = nullptr;
 Api_Client::Api_Client(QObject* parent)
     : QObject(parent)
     , m_socket(std::make_unique<QTcpSocket>(this))
+    , m_local_socket(std::make_unique<QLocalSocket>(this))
     , m_timeout_timer(std::make_unique<QTimer>(this))
     , m_reconnect_timer(std::make_unique<QTimer>(this))
     , m_keepalive_timer(std::make_unique<QTimer>(this))
     , m_server_host(Config::Server::DEFAULT_HOST)
     , m_server_port(Config::Server::DEFAULT_PORT)
+    , m_local_server_name(Config::Server::LOCAL_SERVER_NAME)
     , m_timeout_ms(DEFAULT_TIMEOUT_MS)
     , m_is_connected(false)
     , m_current_request_type(Request_Type::Login)
@@ -47,6 +51,16 @@ Api_Client::Api_Client(QObject* parent)
             this, &Api_Client::on_socket_ready_read);
     connect(m_socket.get(), QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::errorOccurred),
             this, &Api_Client::on_socket_error);
+    
+    // Same slots for the local socket, only one of the two is ever connected
+    connect(m_local_socket.get(), &QLocalSocket::connected,
+            this, &Api_Client::on_socket_connected);
+    connect(m_local_socket.get(), &QLocalSocket::disconnected,
+            this, &Api_Client::on_socket_disconnected);
+    connect(m_local_socket.get(), &QLocalSocket::readyRead,
+            this, &Api_Client::on_socket_ready_read);
+    connect(m_local_socket.get(), &QLocalSocket::errorOccurred,
+            this, &Api_Client::on_local_socket_error);
 }
 
 Api_Client::~Api_Client()
@@ -83,6 +97,14 @@ void Api_Client::set_server_url(const QString& host, int port)
     qDebug() << "Api_Client server set to:" << host << ":" << port;
 }
 
+void Api_Client::set_local_server(const QString& name)
+{
+    QMutexLocker locker(&m_mutex);
+    m_local_server_name = name;
+    
+    qDebug() << "Api_Client local server set to:" << name;
+}
+
 void Api_Client::set_auth_token(const QString& token)
 {
     QMutexLocker locker(&m_mutex);
@@ -97,16 +119,23 @@ void Api_Client::set_timeout(int timeout_ms)
 
 void Api_Client::connect_to_server()
 {
-    if (m_socket->state() == QAbstractSocket::ConnectedState)
+    if (is_transport_connected())
     {
         return; // Already connected
     }
     
-    if (m_socket->state() == QAbstractSocket::ConnectingState)
+    if (is_transport_connecting())
     {
         return; // Already connecting
     }
     
+    if (is_local_transport())
+    {
+        qDebug() << "Connecting to local server:" << m_local_server_name;
+        m_local_socket->connectToServer(m_local_server_name);
+        return;
+    }
+    
     // Validate server parameters
     if (m_server_host.isEmpty() || m_server_port <= 0 || m_server_port > 65535)
     {
@@ -138,7 +167,11 @@ void Api_Client::disconnect_from_server()
     // Stop keepalive timer
     m_keepalive_timer->stop();
     
-    if (m_socket->state() == QAbstractSocket::ConnectedState)
+    if (is_transport_connected() && is_local_transport())
+    {
+        m_local_socket->disconnectFromServer();
+    }
+    else if (m_socket->state() == QAbstractSocket::ConnectedState)
     {
         qDebug() << "Disconnecting from server (non-blocking)";
         m_socket->disconnectFromHost();
@@ -319,6 +352,16 @@ void Api_Client::register_user(const QJsonObject& user_data)
 void Api_Client::logout()
 {
     QMutexLocker locker(&m_mutex);
+    
+    // Closed on the server too, or the token would still resume a session after the logout
+    if (!m_auth_token.isEmpty() && is_transport_connected())
+    {
+        QJsonObject logout_data;
+        logout_data["type"] = "LOGOUT";
+        logout_data["session_token"] = m_auth_token;
+        send_json_message(logout_data);
+    }
+    
     m_auth_token.clear();
     m_is_connected = false;
     disconnect_from_server();
@@ -334,6 +377,7 @@ void Api_Client::get_destinations()
     
     QJsonObject requestData;
     requestData["type"] = "GET_DESTINATIONS";
+    requestData["accept_encoding"] = "zlib";
     
     qDebug() << "Api_Client: Request data:" << requestData;
     qDebug() << "Api_Client: Calling send_request with Request_Type::Get_Destinations";
@@ -343,22 +387,40 @@ void Api_Client::get_destinations()
     qDebug() << "Api_Client: send_request call completed";
 }
 
-void Api_Client::get_offers()
+void Api_Client::get_offers(const QString& after)
 {
     QJsonObject requestData;
     requestData["type"] = "GET_OFFERS";
+    requestData["accept_encoding"] = "zlib";
+    requestData["limit"] = Config::Server::LISTING_PAGE_SIZE;
+    requestData["fields"] = QJsonArray::fromStringList(Config::Server::OFFER_CARD_FIELDS);
+    if (!after.isEmpty())
+        requestData["after"] = after;
     
     send_request(Request_Type::Get_Offers, requestData);
 }
 
-void Api_Client::search_offers(const QJsonObject& search_params)
+void Api_Client::search_offers(const QJsonObject& search_params, const QString& after)
 {
     QJsonObject requestData = search_params;
     requestData["type"] = "SEARCH_OFFERS";
+    requestData["limit"] = Config::Server::LISTING_PAGE_SIZE;
+    requestData["fields"] = QJsonArray::fromStringList(Config::Server::OFFER_CARD_FIELDS);
+    if (!after.isEmpty())
+        requestData["after"] = after;
     
     send_request(Request_Type::Search_Offers, requestData);
 }
 
+void Api_Client::get_offer_details(int offer_id)
+{
+    QJsonObject requestData;
+    requestData["type"] = "GET_OFFER_DETAILS";
+    requestData["offer_id"] = offer_id;
+    
+    send_request(Request_Type::Get_Offer_Details, requestData);
+}
+
 void Api_Client::get_user_info()
 {
     QJsonObject requestData;
@@ -375,10 +437,14 @@ void Api_Client::update_user_info(const QJsonObject& user_info)
     send_request(Request_Type::Update_User_Info, requestData);
 }
 
-void Api_Client::get_user_reservations()
+void Api_Client::get_user_reservations(const QString& after)
 {
     QJsonObject requestData;
     requestData["type"] = "GET_USER_RESERVATIONS";
+    requestData["limit"] = Config::Server::LISTING_PAGE_SIZE;
+    requestData["fields"] = QJsonArray::fromStringList(Config::Server::RESERVATION_CARD_FIELDS);
+    if (!after.isEmpty())
+        requestData["after"] = after;
     
     send_request(Request_Type::Get_User_Reservations, requestData);
 }
@@ -415,6 +481,8 @@ void Api_Client::book_offer(int offer_id, int person_count, const QJsonObject& a
     requestData["type"] = "BOOK_OFFER";
     requestData["offer_id"] = offer_id;
     requestData["person_count"] = person_count;
+    // Lets the request be resent after a timeout without booking twice
+    requestData["idempotency_key"] = QUuid::createUuid().toString(QUuid::WithoutBraces);
     
     send_request(Request_Type::Book_Offer, requestData);
 }
@@ -442,6 +510,7 @@ void Api_Client::cancel_reservation(int reservation_id)
     QJsonObject requestData;
     requestData["type"] = "CANCEL_RESERVATION";
     requestData["reservation_id"] = reservation_id;
+    requestData["idempotency_key"] = QUuid::createUuid().toString(QUuid::WithoutBraces);
     
     send_request(Request_Type::Cancel_Reservation, requestData);
 }
@@ -449,12 +518,14 @@ void Api_Client::cancel_reservation(int reservation_id)
 bool Api_Client::is_connected() const
 {
     QMutexLocker locker(&m_mutex);
-    return m_is_connected && m_socket->state() == QAbstractSocket::ConnectedState;
+    return m_is_connected && is_transport_connected();
 }
 
 QString Api_Client::get_server_url() const
 {
     QMutexLocker locker(&m_mutex);
+    if (!m_local_server_name.isEmpty())
+        return "local:" + m_local_server_name;
     return QString("%1:%2").arg(m_server_host).arg(m_server_port);
 }
 
@@ -468,6 +539,12 @@ void Api_Client::send_request(Request_Type type, const QJsonObject& data)
 {
     m_current_request_type = type;
     
+    if (data.contains("idempotency_key"))
+    {
+        m_retryable_request = Pending_Request{type, data};
+        m_retry_attempts = 0;
+    }
+    
     if (!is_connected())
     {
         // Store the request for sending after connection is established
@@ -486,7 +563,7 @@ void Api_Client::send_request(Request_Type type, const QJsonObject& data)
 
 void Api_Client::send_json_message(const QJsonObject& message)
 {
-    if (m_socket->state() != QAbstractSocket::ConnectedState)
+    if (!is_transport_connected())
     {
         emit_error("Not connected to server");
         return;
@@ -507,10 +584,10 @@ void Api_Client::send_json_message(const QJsonObject& message)
     
     qDebug() << "Sending JSON message:" << jsonData;
     
-    qint64 bytesWritten = m_socket->write(jsonData);
+    qint64 bytesWritten = get_transport()->write(jsonData);
     if (bytesWritten == -1)
     {
-        emit_error(QString("Failed to write to socket: %1").arg(m_socket->errorString()));
+        emit_error(QString("Failed to write to socket: %1").arg(get_transport()->errorString()));
         return;
     }
     
@@ -520,7 +597,8 @@ void Api_Client::send_json_message(const QJsonObject& message)
         return;
     }
     
-    if (!m_socket->flush())
+    bool flushed = is_local_transport() ? m_local_socket->flush() : m_socket->flush();
+    if (!flushed)
     {
         qWarning() << "Socket flush failed, but data was written";
     }
@@ -540,16 +618,39 @@ void Api_Client::on_socket_connected()
     // Start keepalive timer
     m_keepalive_timer->start();
     
-    QList<Pending_Request> pending_requests;
+    QString session_token;
     {
         QMutexLocker locker(&m_mutex);
         m_is_connected = true;
-        pending_requests = m_pending_requests;
-        m_pending_requests.clear();
+        session_token = m_auth_token;
     }
     
     emit connection_status_changed(true);
     
+    // A new socket is not logged in; the session token from the last login restores that
+    // without sending the password again. Pending requests go out once it is answered.
+    if (!session_token.isEmpty())
+    {
+        QJsonObject resume_data;
+        resume_data["type"] = "RESUME_SESSION";
+        resume_data["session_token"] = session_token;
+        m_resuming_session = true;
+        send_json_message(resume_data);
+        return;
+    }
+    
+    send_pending_requests();
+}
+
+void Api_Client::send_pending_requests()
+{
+    QList<Pending_Request> pending_requests;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending_requests = m_pending_requests;
+        m_pending_requests.clear();
+    }
+    
     // Send all pending requests
     for (const auto& pending : pending_requests)
     {
@@ -569,16 +670,34 @@ void Api_Client::on_socket_disconnected()
         m_receive_buffer.clear();
     }
     
+    m_resuming_session = false;
     m_timeout_timer->stop();
     m_keepalive_timer->stop();
     emit connection_status_changed(false);
     
+    // An unanswered booking/cancellation goes out again, with the same key, once reconnected
+    if (m_retryable_request)
+    {
+        QMutexLocker locker(&m_mutex);
+        const QString key = m_retryable_request->data["idempotency_key"].toString();
+        bool already_queued = std::any_of(m_pending_requests.cbegin(), m_pending_requests.cend(),
+            [&key](const Pending_Request& pending) { return pending.data["idempotency_key"].toString() == key; });
+        if (!already_queued)
+        {
+            m_pending_requests.append(*m_retryable_request);
+        }
+    }
+    
     // Start reconnection attempts only if this wasn't an intentional disconnect
     // Check if there's a socket error (not intentional disconnect)
-    if (m_socket->error() != QAbstractSocket::UnknownSocketError && 
-        m_socket->error() != QAbstractSocket::RemoteHostClosedError) {
+    bool lost = is_local_transport()
+        ? m_local_socket->error() != QLocalSocket::UnknownSocketError &&
+          m_local_socket->error() != QLocalSocket::PeerClosedError
+        : m_socket->error() != QAbstractSocket::UnknownSocketError &&
+          m_socket->error() != QAbstractSocket::RemoteHostClosedError;
+    if (lost) {
         if (!m_reconnect_timer->isActive()) {
-            qDebug() << "Starting reconnection attempts due to error:" << m_socket->errorString();
+            qDebug() << "Starting reconnection attempts due to error:" << get_transport()->errorString();
             // Add delay before first reconnection attempt
             m_reconnect_timer->start(2000);  // Start after 2 seconds
         }
@@ -589,14 +708,14 @@ void Api_Client::attempt_reconnection()
 {
     qDebug() << "Attempting to reconnect to server...";
     
-    if (m_socket->state() == QAbstractSocket::ConnectedState) {
+    if (is_transport_connected()) {
         qDebug() << "Already connected, stopping reconnection attempts";
         m_reconnect_timer->stop();
         return;
     }
     
     	// Don't attempt reconnection if we're already trying to connect
-	if (m_socket->state() == QAbstractSocket::ConnectingState) {
+	if (is_transport_connecting()) {
 		qDebug() << "Connection attempt already in progress";
 		return;
 	}
@@ -632,7 +751,7 @@ void Api_Client::on_socket_ready_read()
 {
     m_timeout_timer->stop();
     
-    QByteArray data = m_socket->readAll();
+    QByteArray data = get_transport()->readAll();
     
     // Check buffer size limit to prevent memory exhaustion
     if (m_receive_buffer.size() + data.size() > MAX_BUFFER_SIZE)
@@ -683,6 +802,19 @@ void Api_Client::on_socket_ready_read()
             continue;
         }
         
+        // Large listings may come zlib-compressed, the reply itself is inside
+        if (doc.isObject() && doc.object().value("encoding").toString() == "zlib")
+        {
+            QByteArray payload = qUncompress(QByteArray::fromBase64(doc.object().value("payload").toString().toLatin1()));
+            doc = QJsonDocument::fromJson(payload, &parseError);
+            if (parseError.error != QJsonParseError::NoError)
+            {
+                qWarning() << "Compressed reply could not be read:" << parseError.errorString();
+                processed_messages++;
+                continue;
+            }
+        }
+        
         if (doc.isObject())
         {
             handle_response(doc.object());
@@ -702,10 +834,39 @@ void Api_Client::on_socket_error(QAbstractSocket::SocketError error)
     handle_socket_error(error);
 }
 
+void Api_Client::on_local_socket_error(QLocalSocket::LocalSocketError error)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_is_connected = false;
+    }
+    
+    emit connection_status_changed(false);
+    
+    if (error == QLocalSocket::ServerNotFoundError || error == QLocalSocket::ConnectionRefusedError)
+        emit_error("Local server not available - Server might be down");
+    else
+        emit_error(m_local_socket->errorString());
+}
+
 void Api_Client::on_request_timeout()
 {
     qWarning() << "Request timeout occurred for:" << request_type_to_string(m_current_request_type);
     
+    // No answer to RESUME_SESSION: send what was waiting anyway, the server answers each
+    if (m_resuming_session)
+    {
+        m_resuming_session = false;
+        send_pending_requests();
+        return;
+    }
+    
+    // Bookings and cancellations carry an idempotency key, so resending them is safe
+    if (retry_in_flight_request("request timeout"))
+    {
+        return;
+    }
+    
     // Don't disconnect completely for request timeout, just emit error
     // The connection might still be valid, just this specific request failed
     emit_error("Request timeout - server did not respond in time");
@@ -717,6 +878,32 @@ void Api_Client::on_request_timeout()
     }
 }
 
+bool Api_Client::retry_in_flight_request(const QString& reason)
+{
+    if (!m_retryable_request || m_retry_attempts >= Config::Server::MAX_RETRIES)
+    {
+        m_retryable_request.reset();
+        return false;
+    }
+    
+    ++m_retry_attempts;
+    qDebug() << "Resending" << request_type_to_string(m_retryable_request->type)
+             << "after" << reason << "- attempt" << m_retry_attempts << "of" << Config::Server::MAX_RETRIES;
+    
+    Pending_Request request = *m_retryable_request;
+    m_current_request_type = request.type;
+    if (is_connected())
+    {
+        send_json_message(request.data);
+    }
+    else
+    {
+        // on_socket_disconnected already queued it for the reconnect
+        connect_to_server();
+    }
+    return true;
+}
+
 void Api_Client::handle_response(const QJsonObject& response)
 {
     Api_Response api_response = parse_json_response(response);
@@ -727,10 +914,41 @@ void Api_Client::handle_response(const QJsonObject& response)
         return; // No further processing needed for keepalive
     }
     
+    if (m_resuming_session)
+    {
+        m_resuming_session = false;
+        if (api_response.success)
+        {
+            qDebug() << "Session resumed after reconnect";
+        }
+        else
+        {
+            // Expired or unknown after all: the next login hands out a new token
+            qWarning() << "Session could not be resumed:" << api_response.message;
+            QMutexLocker locker(&m_mutex);
+            m_auth_token.clear();
+        }
+        send_pending_requests();
+        return;
+    }
+    
     qDebug() << "Response received for:" << request_type_to_string(m_current_request_type);
     qDebug() << "Success:" << api_response.success;
     qDebug() << "Message:" << api_response.message;
     
+    if (m_retryable_request && m_retryable_request->type == m_current_request_type)
+    {
+        // The server is still working on the original, ask again shortly for its result
+        if (!api_response.success && api_response.status_code == REQUEST_IN_PROGRESS_CODE)
+        {
+            QTimer::singleShot(IN_PROGRESS_RETRY_DELAY_MS, this, [this]() {
+                retry_in_flight_request("request still in progress");
+            });
+            return;
+        }
+        m_retryable_request.reset();
+    }
+    
     // Handle authentication responses regardless of success/failure
     if (m_current_request_type == Request_Type::Login || m_current_request_type == Request_Type::Register)
     {
@@ -755,6 +973,7 @@ Api_Client::Api_Response Api_Client::parse_json_response(const QJsonObject& json
     Api_Response response;
     response.success = json_response["success"].toBool();
     response.message = json_response["message"].toString();
+    response.next_page = json_response["next_page"].toString();
     
     const QJsonValue data_value = json_response["data"];
     if(data_value.isArray())
@@ -768,7 +987,8 @@ Api_Client::Api_Response Api_Client::parse_json_response(const QJsonObject& json
         response.data = data_value.toObject();
     }
 
-    response.status_code = 200; // TCP doesn't have HTTP status codes
+    // TCP doesn't have HTTP status codes, failures may carry the server's error_code
+    response.status_code = json_response.contains("error_code") ? json_response["error_code"].toInt() : 200;
     
     return response;
 }
@@ -786,6 +1006,13 @@ void Api_Client::process_authentication_response(const Api_Response& response)
         
         if (m_current_request_type == Request_Type::Login)
         {
+            // Kept for RESUME_SESSION, the server sends it with every successful login
+            if (userData.contains("session_token"))
+            {
+                QMutexLocker locker(&m_mutex);
+                m_auth_token = userData["session_token"].toString();
+            }
+            
             qDebug() << "Api_Client: Emitting login_success signal";
             emit login_success(userData);
         }
@@ -840,7 +1067,11 @@ void Api_Client::process_data_response(Request_Type type, const Api_Response& re
             
         case Request_Type::Get_Offers:
         case Request_Type::Search_Offers:
-            emit offers_received(dataArray);
+            emit offers_received(dataArray, response.next_page);
+            break;
+            
+        case Request_Type::Get_Offer_Details:
+            emit offer_details_received(response.data);
             break;
             
         case Request_Type::Get_User_Info:
@@ -848,7 +1079,7 @@ void Api_Client::process_data_response(Request_Type type, const Api_Response& re
             break;
             
         case Request_Type::Get_User_Reservations:
-            emit reservations_received(dataArray);
+            emit reservations_received(dataArray, response.next_page);
             break;
             
         case Request_Type::Book_Offer:
@@ -896,6 +1127,32 @@ void Api_Client::handle_socket_error(QAbstractSocket::SocketError error)
     emit_error(errorMsg);
 }
 
+bool Api_Client::is_local_transport() const
+{
+    return !m_local_server_name.isEmpty();
+}
+
+QIODevice* Api_Client::get_transport() const
+{
+    if (is_local_transport())
+        return m_local_socket.get();
+    return m_socket.get();
+}
+
+bool Api_Client::is_transport_connected() const
+{
+    if (is_local_transport())
+        return m_local_socket->state() == QLocalSocket::ConnectedState;
+    return m_socket->state() == QAbstractSocket::ConnectedState;
+}
+
+bool Api_Client::is_transport_connecting() const
+{
+    if (is_local_transport())
+        return m_local_socket->state() == QLocalSocket::ConnectingState;
+    return m_socket->state() == QAbstractSocket::ConnectingState;
+}
+
 void Api_Client::emit_error(const QString& error_message)
 {
     {
@@ -935,6 +1192,7 @@ QString Api_Client::request_type_to_string(Request_Type type) const
         case Request_Type::Get_Destinations: return "Get_Destinations";
         case Request_Type::Get_Offers: return "Get_Offers";
         case Request_Type::Search_Offers: return "Search_Offers";
+        case Request_Type::Get_Offer_Details: return "Get_Offer_Details";
         case Request_Type::Book_Offer: return "Book_Offer";
         case Request_Type::Get_User_Reservations: return "Get_User_Reservations";
         case Request_Type::Cancel_Reservation: return "Cancel_Reservation";
@@ -953,6 +1211,7 @@ bool Api_Client::is_authentication_required(Request_Type type) const
         case Request_Type::Get_Destinations:
         case Request_Type::Get_Offers:
         case Request_Type::Search_Offers:
+        case Request_Type::Get_Offer_Details:
             return false;
         default:
             return true;
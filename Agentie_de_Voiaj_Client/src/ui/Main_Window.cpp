@@ -21,6 +21,7 @@
 #include <QTimer>
 #include <QGroupBox>
 #include <QScrollArea>
+#include <QScrollBar>
 
 Main_Window::Main_Window(QWidget* parent)
     : QMainWindow(parent)
@@ -433,6 +434,7 @@ void Main_Window::create_offers_tab()
     scrollArea->setWidget(scrollContent);
     scrollArea->setWidgetResizable(true);
     layout->addWidget(scrollArea);
+    fetch_more_near_end(scrollArea, m_offer_model.get());
     
     // Store references for later use
     m_offers_container = offersContainer;
@@ -538,6 +540,7 @@ void Main_Window::create_reservations_tab()
     scrollArea->setWidgetResizable(true);
     scrollArea->hide(); // Hidden until user is authenticated
     layout->addWidget(scrollArea);
+    fetch_more_near_end(scrollArea, m_reservation_model.get());
     
     // Store references for later use
     m_reservations_auth_widget = authRequiredWidget;
@@ -956,6 +959,12 @@ void Main_Window::setup_connections()
             [this](const QString& error) {
                 QMessageBox::warning(this, "Eroare Oferte", error);
             });
+    connect(m_offer_model.get(), &QAbstractItemModel::rowsInserted,
+            [this](const QModelIndex&, int first, int last) {
+                // A further page: only its cards are added, the ones above stay where they are
+                for (int row = first; row <= last && m_offers_container_layout; ++row)
+                    m_offers_container_layout->addWidget(create_offer_card(row));
+            });
     
     // Reservation model connections
     connect(m_reservation_model.get(), &Reservation_Model::reservations_loaded,
@@ -964,6 +973,11 @@ void Main_Window::setup_connections()
             [this](const QString& error) {
                 QMessageBox::warning(this, "Eroare Rezervări", error);
             });
+    connect(m_reservation_model.get(), &QAbstractItemModel::rowsInserted,
+            [this](const QModelIndex&, int first, int last) {
+                for (int row = first; row <= last && m_reservations_container_layout; ++row)
+                    m_reservations_container_layout->addWidget(create_reservation_card(row));
+            });
     
     // API Client connection status monitoring
     connect(&Api_Client::instance(), &Api_Client::connection_status_changed,
@@ -1005,6 +1019,24 @@ void Main_Window::setup_connections()
                         QString("Eroare de conexiune la server: %1").arg(error));
                 }
             });
+    
+    // Cards only carry the listing columns, "Detalii" fetches the whole offer
+    connect(&Api_Client::instance(), &Api_Client::offer_details_received,
+            [this](const QJsonObject& offer) {
+                QString description = offer["Description"].toString();
+                QString services = offer["Included_Services"].toString();
+                QString text = QString("%1 - %2, %3\n\n")
+                    .arg(offer["Name"].toString(), offer["Destination_Name"].toString(), offer["Country"].toString());
+                text += QString("Plecare: %1\nÎntoarcere: %2\n")
+                    .arg(offer["Departure_Date"].toString(), offer["Return_Date"].toString());
+                text += QString("Cazare: %1\nTransport: %2\n")
+                    .arg(offer["Accommodation_Name"].toString(), offer["Transport_Name"].toString());
+                if (!services.isEmpty())
+                    text += QString("Servicii incluse: %1\n").arg(services);
+                if (!description.isEmpty())
+                    text += "\n" + description;
+                QMessageBox::information(this, "Detalii ofertă", text);
+            });
 }
 
 void Main_Window::on_login_action()
@@ -1416,6 +1448,16 @@ void Main_Window::refresh_reservations_display()
     }
 }
 
+void Main_Window::fetch_more_near_end(QScrollArea* scroll_area, QAbstractItemModel* model)
+{
+    // Lists arrive a page at a time; the next one is asked for when the user scrolls close to the end
+    QScrollBar* scroll_bar = scroll_area->verticalScrollBar();
+    connect(scroll_bar, &QScrollBar::valueChanged, this, [scroll_bar, model](int value) {
+        if (value >= scroll_bar->maximum() - scroll_bar->pageStep() / 2 && model->canFetchMore(QModelIndex()))
+            model->fetchMore(QModelIndex());
+    });
+}
+
 QWidget* Main_Window::create_offer_card(const Offer_Model::Offer& offer)
 {
     // Debug offer data
@@ -1457,7 +1499,13 @@ QWidget* Main_Window::create_offer_card(const Offer_Model::Offer& offer)
     
     // Use safe text with fallbacks
     QString name = offer.name.isEmpty() ? "Ofertă fără nume" : offer.name;
-    QString description = offer.description.isEmpty() ? "Fără descriere disponibilă" : offer.description;
+    // Listing pages leave the description out, the dates stand in for it until "Detalii"
+    QString description = offer.description;
+    if (description.isEmpty() && offer.start_date.isValid())
+        description = QString("%1 - %2").arg(offer.start_date.toString("dd.MM.yyyy"),
+                                             offer.end_date.toString("dd.MM.yyyy"));
+    if (description.isEmpty())
+        description = "Fără descriere disponibilă";
     QString destination = offer.destination.isEmpty() ? "Destinație necunoscută" : offer.destination;
     
     QLabel* titleLabel = new QLabel(QString("%1 - %2").arg(name, destination));
@@ -1497,6 +1545,9 @@ QWidget* Main_Window::create_offer_card(const Offer_Model::Offer& offer)
     actionsLayout->addWidget(bookButton);
     
     QPushButton* detailsButton = new QPushButton("Detalii");
+    connect(detailsButton, &QPushButton::clicked, [offer_id = offer.id]() {
+        Api_Client::instance().get_offer_details(offer_id);
+    });
     actionsLayout->addWidget(detailsButton);
     
     offerLayout->addLayout(actionsLayout);
@@ -8,10 +8,18 @@ namespace Config
 	{
 		constexpr int PORT = 8080;
 		constexpr int MAX_CONNECTIONS = 100;
+		const QString LOCAL_SERVER_NAME = "agentie_de_voiaj"; // Local socket/named pipe for tools on the same host, empty = none
+		constexpr int MAX_LOCAL_CONNECTIONS = 32; // Local connections, not counted against MAX_CONNECTIONS
 		constexpr int BACKLOG_SIZE = 10;
 		constexpr int BUFFER_SIZE = 4096;
 		constexpr int SOCKET_TIMEOUT_MS = 300000; // 5 minutes
+		constexpr int OUTPUT_BUFFER_RETAIN_BYTES = 256 * 1024; // Reply buffer kept per client between requests
+		constexpr int STREAM_CHUNK_BYTES = 64 * 1024; // Streamed listings are handed to the socket in pieces of this size, requests are not read past this much unsent output
 		constexpr bool ENABLE_KEEP_ALIVE = true; // Enable TCP keep-alive
+		constexpr bool ENABLE_TCP_NODELAY = true; // Replies are already coalesced per event loop turn, Nagle only delays them
+		constexpr int SOCKET_SEND_BUFFER_BYTES = 256 * 1024; // Kernel buffers per connection, 0 = system default
+		constexpr int SOCKET_RECEIVE_BUFFER_BYTES = 64 * 1024;
+		constexpr int MAX_PENDING_OUTPUT_BYTES = 4 * 1024 * 1024; // A client this far behind on its replies is disconnected
 	}
 
 	// Database Configuration
@@ -23,6 +31,9 @@ namespace Config
 		constexpr int CONNECTION_TIMEOUT = 30; // seconds
 		constexpr int QUERY_TIMEOUT = 15; // seconds
 		constexpr bool AUTO_COMMIT = true; // Auto-commit transactions
+		constexpr int RECONNECT_INITIAL_DELAY_MS = 500; // First probe after the connection is lost
+		constexpr int RECONNECT_MAX_DELAY_MS = 30000; // Backoff doubles per failed probe up to this
+		constexpr double RECONNECT_JITTER = 0.2; // +/- 20% on every probe delay
 
 		// Connection string template - not used, build_connection_string() used instead
 		const QString CONNECTION_TEMPLATE =
@@ -46,6 +57,112 @@ namespace Config
 		const QString LOG_DIRECTORY = "logs/";
 		const QString CONFIG_DIRECTORY = "config/";
 		const QString SQL_SCRIPTS_DIRECTORY = "sql/";
+		const QString DATA_DIRECTORY = "data/";
+	}
+
+	// Storage Backend Configuration (--backend / --database)
+	namespace Storage
+	{
+		const QString DEFAULT_BACKEND = "sqlserver"; // "sqlite" runs on one embedded file, no SQL Server needed
+		const QString SQLITE_PATH = Application::DATA_DIRECTORY + "agentie_de_voiaj.db";
+		constexpr int SQLITE_BUSY_TIMEOUT_MS = 5000; // Wait for the write lock instead of failing
+		constexpr int SQLITE_CACHE_SIZE_KB = 16384; // Page cache per connection
+		constexpr qint64 SQLITE_MMAP_SIZE = 256LL * 1024 * 1024; // Reads served from the mapped file
+		constexpr int SQLITE_MAX_INSERT_ROWS = 500; // SQLITE_MAX_COMPOUND_SELECT
+	}
+
+	// Booking Engine Configuration
+	namespace Booking
+	{
+		constexpr bool ENABLE_SEAT_INVENTORY = true; // Decide bookings in memory, persist via write-behind
+		const QString JOURNAL_PATH = Application::DATA_DIRECTORY + "booking_journal.jsonl";
+		constexpr int WRITE_BEHIND_FLUSH_INTERVAL_MS = 100;
+		constexpr int WRITE_BEHIND_BATCH_SIZE = 200; // Bookings persisted per flush
+		constexpr int WRITE_BEHIND_RETRY_MAX_DELAY_MS = 30000; // A failing booking is retried with doubling delays up to this, never dropped
+		constexpr int JOURNAL_COMPACT_THRESHOLD = 1000; // Completed entries before the journal is rewritten
+		constexpr int SEAT_RECONCILE_INTERVAL_MS = 60000;
+		constexpr bool ENABLE_GROUP_COMMIT = true; // Batch database bookings/cancellations per transaction
+		constexpr int GROUP_COMMIT_WINDOW_MS = 2; // How long the first request waits for company
+		constexpr int GROUP_COMMIT_MAX_BATCH = 64; // Commit early once this many are queued
+	}
+
+	// Idempotency Keys Configuration (safe client retries of BOOK_OFFER / CANCEL_RESERVATION)
+	namespace Idempotency
+	{
+		constexpr bool ENABLE_IDEMPOTENCY_KEYS = true;
+		constexpr int MAX_KEYS = 100000; // Least recently used keys are forgotten first
+		constexpr qint64 KEY_TTL_MS = 24LL * 60 * 60 * 1000; // A retry after this runs as a new request
+		constexpr int MAX_KEY_LENGTH = 128;
+		constexpr bool PERSIST_KEYS = true; // Keep completed results across restarts
+		const QString JOURNAL_PATH = Application::DATA_DIRECTORY + "idempotency_keys.jsonl";
+		constexpr int IN_PROGRESS_ERROR_CODE = 409; // Duplicate arrived while the original still runs
+		constexpr int KEY_REUSED_ERROR_CODE = 422; // Same key, different request
+	}
+
+	// Resumable Sessions Configuration (AUTH hands out a token, RESUME_SESSION takes it back)
+	namespace Sessions
+	{
+		constexpr bool ENABLE_SESSION_RESUME = true;
+		constexpr int SHARD_COUNT = 16; // Lock stripes of the session table
+		constexpr qint64 SESSION_TTL_MS = 12LL * 60 * 60 * 1000; // From AUTH, then the user logs in again
+		constexpr bool PERSIST_SESSIONS = true; // Reconnects after a server restart skip the login
+		const QString JOURNAL_PATH = Application::DATA_DIRECTORY + "sessions.jsonl";
+		constexpr int SESSION_EXPIRED_ERROR_CODE = 401; // Unknown or expired token, log in again
+	}
+
+	// Bulk Catalog Import Configuration (BULK_IMPORT command and --import)
+	namespace Import
+	{
+		constexpr int ROWS_PER_STATEMENT = 1000; // SQL Server limit for one INSERT ... VALUES
+		constexpr int ROWS_PER_TRANSACTION = 10000; // Rows committed together
+		constexpr int MAX_REPORTED_ERRORS = 20; // Rejected rows listed in the report
+		const QString IMPORT_DIRECTORY = "imports"; // BULK_IMPORT only reads files under it (relative to the working directory)
+	}
+
+	// Synthetic Dataset Configuration (--generate and the demo-mode catalog)
+	namespace Dataset
+	{
+		constexpr quint64 DEFAULT_SEED = 20240901; // Same seed, scale and day give the same rows
+		const QString DEMO_SCALE = "demo"; // Loaded into memory when the server runs in demo mode
+		const QString USER_PASSWORD = "Voiaj2024!"; // Every generated user logs in with it
+	}
+
+	// In-memory Cache Configuration
+	namespace Cache
+	{
+		constexpr bool ENABLE_OFFER_CATALOG = true; // Serve GET_OFFERS/SEARCH_OFFERS from memory
+		constexpr int CATALOG_REFRESH_INTERVAL_MS = 15000; // Incremental refresh via Date_Modified
+		constexpr int CATALOG_FULL_RELOAD_INTERVAL_MS = 600000; // Picks up rows deleted outside the server
+		constexpr bool ENABLE_DESTINATION_INDEX = true; // Trigram index for the destination search filter
+		constexpr double DESTINATION_MIN_SIMILARITY = 0.4; // Trigram Jaccard needed for a typo match
+		constexpr bool ENABLE_CREDENTIAL_CACHE = true; // Repeated logins only read the stored hash back by primary key
+		constexpr int CREDENTIAL_CACHE_SIZE = 10000; // Least recently logged in users are dropped first
+		constexpr qint64 CREDENTIAL_CACHE_TTL_MS = 5LL * 60 * 1000; // Picks up profiles changed outside the server
+		constexpr bool ENABLE_RESPONSE_CACHE = true; // Serialized GET_DESTINATIONS/GET_OFFERS replies, shared by every client
+		constexpr int RESPONSE_CACHE_SIZE = 256; // Distinct parameter sets kept, oldest dropped first
+		constexpr qint64 RESPONSE_CACHE_TTL_MS = 60000; // Picks up rows written outside the server
+		constexpr int RESPONSE_CACHE_MAX_REPLY_BYTES = 4 * 1024 * 1024; // Larger replies are streamed, not kept
+		constexpr int RESPONSE_COMPRESS_MIN_BYTES = 1024; // Smaller replies are sent plain even when zlib is accepted
+	}
+
+	// Booking Statistics Configuration
+	namespace Statistics
+	{
+		constexpr bool ENABLE_BOOKING_STATISTICS = true; // Answer the statistics queries from in-memory aggregates
+		constexpr int SNAPSHOT_INTERVAL_MS = 60000; // Copy to Booking_Statistics_Snapshot when changed
+		constexpr bool ENABLE_REVENUE_ROLLUP = true; // Date-range revenue reports sum Reservation_Daily_Rollup
+		constexpr int ROLLUP_INTERVAL_MS = 60000; // Rolls up ended and changed days
+		constexpr int ROLLUP_DAYS_PER_RUN = 366; // Backfill step, the job repeats at once until caught up
+		constexpr int ROLLUP_STARTUP_REFRESH_DAYS = 7; // Re-rolled on startup, changes while down are not tracked
+	}
+
+	// Query Diagnostics Configuration (GET_QUERY_STATS admin command)
+	namespace Diagnostics
+	{
+		constexpr bool ENABLE_QUERY_STATS = true; // Time every statement, grouped by normalized query shape
+		constexpr int SLOW_QUERY_THRESHOLD_MS = 250; // Logged in full with its bind values
+		constexpr int MAX_QUERY_SHAPES = 512; // Further shapes are counted under "(other)"
+		constexpr int DEFAULT_TOP_QUERIES = 20; // Shapes returned by GET_QUERY_STATS
 	}
 
 	// JSON Message Configuration
@@ -56,6 +173,14 @@ namespace Config
 		constexpr bool VALIDATE_SCHEMA = true; // Validate JSON against schema
 	}
 
+	// Listing pagination (GET_OFFERS, SEARCH_OFFERS, GET_USER_RESERVATIONS)
+	namespace Paging
+	{
+		constexpr int DEFAULT_PAGE_SIZE = 50; // Rows per page when the request sets no limit
+		constexpr int MAX_PAGE_SIZE = 500; // Larger limits are cut down to this
+		constexpr int MAX_PAGE_BYTES = JSON::MAX_JSON_SIZE - 4096; // A page ends early past this, room left for the envelope
+	}
+
 	// Security Configuration
 	namespace Security
 	{
@@ -81,6 +206,7 @@ namespace Config
 	{
 		const QString DB_CONNECTION_FAILED = "Failed to connect to database";
 		const QString DB_QUERY_FAILED = "Database query failed";
+		const QString DB_UNAVAILABLE = "Database temporarily unavailable, please try again shortly";
 		const QString INVALID_JSON = "Invalid JSON format";
 		const QString AUTHENTICATION_FAILED = "Authentication failed";
 		const QString USER_NOT_FOUND = "User not found";
@@ -89,6 +215,10 @@ namespace Config
 		const QString INVALID_REQUEST = "Invalid request format";
 		const QString SERVER_ERROR = "Internal server error";
 		const QString SOCKET_COMM_ERROR = "Socket communication error";
+		const QString REQUEST_IN_PROGRESS = "Request with this idempotency key is still being processed";
+		const QString IDEMPOTENCY_KEY_REUSED = "Idempotency key was already used for a different request";
+		const QString INVALID_IDEMPOTENCY_KEY = "Invalid idempotency key";
+		const QString SESSION_EXPIRED = "Session expired, please log in again";
 	}
 
 	// Success Messages
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QDate>
+#include <QtCore/QVariant>
+#include <QtCore/QMutex>
+
+namespace Database
+{
+	/**
+	 * Booking and user aggregates behind the statistics queries, kept up to date
+	 * from the write paths (booking, cancellation, status change, registration)
+	 * instead of being recounted from Reservations and Users on every read.
+	 * rebuild() loads them from grouped SQL rows; the getters return rows with
+	 * the same columns as the SQL statistics queries.
+	 *
+	 * Reservations and registrations are counted per day, so the "this month" and
+	 * "this week" figures include the whole first day of the window where the SQL
+	 * compared against the current time. Event methods are ignored until loaded.
+	 */
+	class Booking_Statistics
+	{
+	private:
+		struct Destination_Totals
+		{
+			QString name;
+			QString country;
+			qint64 active_bookings = 0; // every status except cancelled
+		};
+
+		QHash<int, Destination_Totals> destinations;
+		QHash<int, int> destination_by_offer;
+		QHash<int, qint64> active_bookings_by_offer;
+		QHash<QString, qint64> bookings_by_status;
+		QMap<QDate, qint64> bookings_by_day;      // Reservation_Date, every status
+		QMap<QDate, qint64> registrations_by_day; // Users.Date_Created
+		qint64 total_users = 0;
+
+		// Confirmed and paid reservations, the ones the revenue report counts
+		qint64 revenue_bookings = 0;
+		qreal revenue_total = 0.0;
+		qint64 revenue_persons = 0;
+
+		quint64 version = 0; // bumped by every change, lets snapshots skip idle periods
+		bool loaded = false;
+		mutable QMutex mutex;
+
+	public:
+		// Loading
+		void rebuild(const QList<QHash<QString, QVariant>>& reservation_groups,
+			const QList<QHash<QString, QVariant>>& registration_days,
+			const QList<QHash<QString, QVariant>>& destination_rows,
+			const QList<QHash<QString, QVariant>>& offer_rows);
+		void clear();
+		bool is_loaded() const;
+		quint64 get_version() const;
+
+		// Events from the write paths
+		void record_booking(int offer_id, int person_count, qreal total_price,
+			const QDate& day, const QString& status = "pending");
+		void record_booking_removed(int offer_id, int person_count, qreal total_price,
+			const QDate& day, const QString& status = "pending");
+		void record_status_change(int offer_id, int person_count, qreal total_price,
+			const QString& old_status, const QString& new_status);
+		void record_registration(const QDate& day);
+		void record_user_removed(const QDate& day);
+
+		// Catalog changes
+		bool knows_offer(int offer_id) const;
+		void set_offer_destination(int offer_id, int destination_id);
+		void set_destination(int destination_id, const QString& name, const QString& country);
+		void remove_destination(int destination_id);
+
+		// Reads
+		QList<QHash<QString, QVariant>> get_popular_destinations(int limit) const;
+		QHash<QString, QVariant> get_booking_statistics(const QDate& today) const;
+		QHash<QString, QVariant> get_user_statistics(const QDate& today) const;
+		QHash<QString, QVariant> get_revenue_report() const;
+
+		// Consistency
+		QList<QPair<QString, qreal>> get_snapshot(const QDate& today) const;
+		QStringList compare(const Booking_Statistics& recount, const QDate& today) const;
+
+	private:
+		void apply_locked(int offer_id, qint64 bookings, qint64 persons, qreal revenue,
+			const QString& status, const QDate& day, int sign);
+		qint64 count_since_locked(const QMap<QDate, qint64>& by_day, const QDate& first_day) const;
+		QList<QPair<QString, qreal>> get_snapshot_locked(const QDate& today) const;
+
+		static bool is_revenue_status(const QString& status);
+	};
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QFile>
+#include <QtCore/QElapsedTimer>
+#include <memory>
+
+#include "database/Database_Manager.h"
+
+namespace Database
+{
+	enum class Import_Entity
+	{
+		DESTINATIONS,
+		ACCOMMODATIONS,
+		OFFERS
+	};
+
+	enum class Import_Format
+	{
+		CSV,        // header row with column names, RFC 4180 quoting
+		JSON_LINES  // one JSON object per line
+	};
+
+	struct Import_Stats
+	{
+		qint64 rows_read = 0;
+		qint64 rows_imported = 0;
+		qint64 rows_rejected = 0;
+		int transactions = 0;
+		qint64 elapsed_ms = 0;
+		qreal rows_per_second = 0.0;
+		QStringList errors; // first Config::Import::MAX_REPORTED_ERRORS rejections
+
+		QString to_string() const;
+	};
+
+	/**
+	 * Streams destinations, accommodations or offers from a CSV or JSON Lines
+	 * file into the database. Rows are validated and escaped here, then sent
+	 * Config::Import::ROWS_PER_TRANSACTION at a time through
+	 * Database_Manager::bulk_insert (multi-row INSERTs in one transaction).
+	 * A chunk the database refuses is retried row by row so one bad row only
+	 * rejects itself. In-memory caches are refreshed once, by finish().
+	 *
+	 * Field names are the table's column names (case-insensitive) or the
+	 * snake_case names used by the protocol, e.g. "price_per_person".
+	 * Use run() for a blocking import, or open() + import_next_chunk() +
+	 * finish() to interleave with an event loop.
+	 */
+	class Bulk_Importer
+	{
+	private:
+		enum class Column_Kind
+		{
+			TEXT,
+			INTEGER,
+			DECIMAL,
+			DATE
+		};
+
+		struct Column
+		{
+			QString name;     // table column
+			QString alias;    // protocol field name
+			Column_Kind kind;
+			bool required;
+			QString default_sql; // used when the field is missing, empty = NULL
+		};
+
+		std::shared_ptr<Database_Manager> db_manager;
+		Import_Entity entity = Import_Entity::OFFERS;
+		Import_Format format = Import_Format::CSV;
+		QList<Column> columns;
+
+		QFile input;
+		QStringList csv_header;
+		qint64 line_number = 0;
+		bool at_end = false;
+
+		Import_Stats stats;
+		QElapsedTimer clock;
+
+	public:
+		explicit Bulk_Importer(std::shared_ptr<Database_Manager> db_manager);
+
+		bool open(Import_Entity entity, const QString& path, Import_Format format, QString& error);
+		bool import_next_chunk();
+		Import_Stats finish();
+		Import_Stats run(Import_Entity entity, const QString& path, Import_Format format);
+
+		const Import_Stats& get_stats() const;
+		Import_Entity get_entity() const;
+
+		static bool parse_entity(const QString& name, Import_Entity& entity);
+		static Import_Format detect_format(const QString& path);
+		static bool resolve_import_path(const QString& requested, QString& path, QString& error); // inside IMPORT_DIRECTORY
+		static QString get_table_name(Import_Entity entity);
+
+	private:
+		bool read_record(QHash<QString, QString>& record);
+		bool read_csv_fields(QStringList& fields);
+		bool build_values(const QHash<QString, QString>& record, QString& values_sql, QString& error);
+		void insert_chunk(const QStringList& value_rows, const QList<qint64>& lines);
+		void reject(qint64 line, const QString& error);
+
+		static QList<Column> get_columns(Import_Entity entity);
+	};
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+#include <QtCore/QThread>
+#include <QtCore/QElapsedTimer>
+#include <memory>
+
+#include "database/Database_Manager.h"
+
+namespace Database
+{
+	enum class Circuit_State
+	{
+		CLOSED,    // connected, statements go to the database
+		OPEN,      // link lost, statements fail fast while the next probe is scheduled
+		HALF_OPEN  // a probe or the reconnect after it is running
+	};
+
+	struct Connection_Supervisor_Stats
+	{
+		Circuit_State state = Circuit_State::CLOSED;
+		quint64 outages = 0;
+		quint64 probes = 0;
+		int attempt = 0;          // failed probes in the current outage
+		qint64 outage_ms = 0;     // length of the current outage, 0 while closed
+		QString last_error;
+
+		static QString get_state_name(Circuit_State state);
+	};
+
+	/**
+	 * Opens a throwaway connection on the supervisor's worker thread to find out
+	 * whether the database answers again. Connection Timeout and a dead server
+	 * cost this thread, never the event loop. The probe connection is created
+	 * and removed inside probe(), as QSqlDatabase requires.
+	 */
+	class Connection_Probe : public QObject
+	{
+		Q_OBJECT
+
+	public slots:
+		void probe(const QString& driver, const QString& database_name, const QString& connect_options);
+
+	signals:
+		void finished(bool reachable, const QString& error);
+	};
+
+	/**
+	 * Circuit breaker around the Database_Manager connection. When a statement
+	 * fails with a connection error the manager closes its connection, later
+	 * statements fail fast with ErrorMessages::DB_UNAVAILABLE and the
+	 * supervisor opens the circuit. Probes then run in the background with
+	 * exponential backoff and jitter (Config::Database::RECONNECT_*). After a
+	 * probe succeeds, the real connection is reopened on the owning thread,
+	 * which is quick now that the server answers, and the circuit closes.
+	 *
+	 * Offer listings, seat decisions and write-behind bookings keep being served
+	 * from memory while the circuit is open; everything else gets the error.
+	 * Lives in the thread that owns the database connection.
+	 */
+	class Connection_Supervisor : public QObject
+	{
+		Q_OBJECT
+
+	private:
+		std::shared_ptr<Database_Manager> db_manager;
+		QTimer* probe_timer;
+		QThread probe_thread;
+		Connection_Probe* probe;
+
+		Connection_Supervisor_Stats stats;
+		QElapsedTimer outage_clock;
+
+	public:
+		explicit Connection_Supervisor(std::shared_ptr<Database_Manager> db_manager, QObject* parent = nullptr);
+		~Connection_Supervisor();
+
+		Circuit_State get_state() const;
+		Connection_Supervisor_Stats get_stats() const;
+
+	signals:
+		void connection_lost(const QString& error);
+		void connection_restored(qint64 outage_ms);
+		void probe_requested(const QString& driver, const QString& database_name, const QString& connect_options);
+
+	public slots:
+		void report_connection_lost(const QString& error);
+
+	private slots:
+		void start_probe();
+		void on_probe_finished(bool reachable, const QString& error);
+
+	private:
+		void schedule_probe();
+		int get_backoff_delay_ms() const;
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+#include <QtCore/QMutex>
+#include <list>
+
+namespace Database
+{
+	struct User_Credentials
+	{
+		int user_id = 0;
+		QString password_salt;
+		QString password_hash;
+		QHash<QString, QVariant> profile; // the row authenticate_user() answers with
+	};
+
+	/**
+	 * Credentials of recently authenticated users keyed by the username they
+	 * logged in with, so a repeated login skips the profile lookup and is
+	 * verified here. Database_Manager invalidates a user on update_user,
+	 * change_password and delete_user, and checks the stored hash by User_ID
+	 * before accepting a match, so a password changed outside the server stops
+	 * working at once. A profile changed outside is picked up after ttl_ms.
+	 * Bounded to max_entries, least recently used first out. Unknown usernames
+	 * are never stored.
+	 */
+	class Credential_Cache
+	{
+	private:
+		struct Entry
+		{
+			QString username;
+			User_Credentials credentials;
+			qint64 expires_at_ms = 0;
+		};
+
+		std::list<Entry> entries; // most recently used first
+		QHash<QString, std::list<Entry>::iterator> index;
+		int max_entries;
+		qint64 ttl_ms;
+		mutable QMutex mutex;
+
+	public:
+		Credential_Cache(int max_entries, qint64 ttl_ms);
+
+		bool find(const QString& username, User_Credentials& credentials);
+		void store(const QString& username, const User_Credentials& credentials);
+		void invalidate_user(int user_id);
+		void clear();
+		int size() const;
+	};
+}
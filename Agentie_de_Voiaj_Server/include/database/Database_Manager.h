@@ -1,11 +1,14 @@
 #pragma once
 
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QList>
 #include <QtCore/QHash>
 #include <QtCore/QMutex>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QThread>
 #include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QVariant>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
@@ -13,6 +16,7 @@
 #include <QtSql/QSqlRecord>
 #include <memory>
 #include <functional>
+#include <atomic>
 
 // Utils header
 #include "utils/utils.h"
@@ -20,6 +24,27 @@
 // Data structures - included from separate header files
 #include "models/All_Data_Structures.h"
 
+// In-memory offer catalog and destination search index
+#include "database/Offer_Catalog.h"
+#include "database/Destination_Index.h"
+
+// Seat inventory with write-behind persistence for bookings
+#include "database/Seat_Inventory.h"
+#include "database/Write_Behind_Queue.h"
+
+// Booking and user aggregates behind the statistics queries
+#include "database/Booking_Statistics.h"
+#include "database/Revenue_Rollup.h"
+
+// SQL engine behind the connection (SQL Server or embedded SQLite)
+#include "database/Sql_Dialect.h"
+
+// Per-statement timing grouped by query shape
+#include "database/Query_Stats.h"
+
+// Login credentials of recently authenticated users
+#include "database/Credential_Cache.h"
+
 namespace Database
 {
 	enum class Result_Type
@@ -55,10 +80,67 @@ namespace Database
 		}
 	};
 
+	// Called once per row of a streamed SELECT; false stops reading
+	using Row_Handler = std::function<bool(const QSqlQuery& row)>;
+
+	// Listings whose columns a client can choose, see Database_Manager::get_listing_fields()
+	enum class Listing
+	{
+		DESTINATIONS,
+		OFFERS,
+		RESERVATIONS
+	};
+
+	/**
+	 * A page of a keyset-paginated listing: the first limit rows that sort
+	 * after (after_key, after_id) in the listing's order. after_key is the sort
+	 * column of the last row already sent (a QDate or a QDateTime, null when
+	 * that row had none) and after_id its id, which breaks ties.
+	 *
+	 * fields, when set, narrows the columns read and returned to those named;
+	 * they must come from get_listing_fields() of the listing.
+	 */
+	struct Listing_Request
+	{
+		int limit = 0;      // 0 = every row
+		QVariant after_key;
+		int after_id = 0;   // 0 = first page
+		QStringList fields; // empty = every column
+
+		bool has_after() const
+		{
+			return after_id > 0;
+		}
+	};
+
+	/**
+	 * One booking or cancellation applied together with others by apply_batch().
+	 * Bookings with a token come from the write-behind queue and carry the price
+	 * and time decided in memory; direct bookings are priced from the offer.
+	 */
+	struct Batch_Operation
+	{
+		enum class Kind
+		{
+			BOOK,
+			CANCEL
+		};
+
+		Kind kind = Kind::BOOK;
+		int user_id = 0;
+		int offer_id = 0;
+		int person_count = 0;
+		int reservation_id = 0;   // CANCEL only
+		qreal total_price = -1.0; // < 0 = Price_per_Person * person_count
+		QDateTime created_at;     // invalid = GETDATE()
+		QString token;            // write-behind token, empty for direct bookings
+	};
+
 	class Database_Manager
 	{
 	private:
 		QSqlDatabase db;
+		std::unique_ptr<Sql_Dialect> dialect; // Driver, connection and non-portable SQL of the backend
 
 		QString server;
 		QString database;
@@ -68,15 +150,29 @@ namespace Database
 
 		bool is_connected;
 		bool is_demo_mode; // When true, returns mock data instead of real DB operations
+		QList<QHash<QString, QVariant>> demo_destinations; // Generated rows served in demo mode
 		QMutex db_mutex;
 
-		static constexpr int MAX_RETRIES_ATTEMPTS = 3;
-		static constexpr int RETRY_DELAY_MS = 1000;
+		std::unique_ptr<Offer_Catalog> offer_catalog; // Serves offer listings/searches when loaded
+		std::unique_ptr<Destination_Index> destination_index; // Resolves destination search text to ids
+		std::unique_ptr<Seat_Inventory> seat_inventory; // Booking decisions for active offers
+		std::unique_ptr<Write_Behind_Queue> write_behind_queue; // Accepted bookings not yet in SQL
+		QReadWriteLock seat_sync_lock; // Shared by seat changes, exclusive while reconciling
+		std::unique_ptr<Booking_Statistics> booking_statistics; // Statistics reads when loaded
+		quint64 snapshot_version = 0; // booking_statistics version last written to the snapshot table
+		std::unique_ptr<Revenue_Rollup> revenue_rollup; // Day buckets for date-range revenue reports
+		QHash<QString, bool> procedure_availability; // OBJECT_ID lookups, cleared on connect
+		std::unique_ptr<Query_Stats> query_stats; // Latency per query shape, read by GET_QUERY_STATS
+		std::unique_ptr<Credential_Cache> credential_cache; // Salt, hash and profile of recent logins
+		std::atomic<quint64> listing_versions[3]{}; // one per Listing, bumped by writes to a table it reads
+		std::function<void(const QString&)> connection_lost_handler; // Connection_Supervisor, called with db_mutex held
+		std::function<void(int)> credentials_revoked_handler; // Session_Store, called after a password change or a user deletion
 
 	public:
 		Database_Manager();
 		explicit Database_Manager(const QString& server, const QString& database, 
-			const QString& username, const QString& password);
+			const QString& username, const QString& password,
+			Storage_Backend backend = Storage_Backend::SQL_SERVER);
 		~Database_Manager();
 
 		// Connection methods
@@ -87,11 +183,14 @@ namespace Database
 		bool is_connection_alive() const;
 		bool database_exists() const;
 		bool reconnect();
+		void set_connection_lost_handler(std::function<void(const QString&)> handler);
+		void set_credentials_revoked_handler(std::function<void(int)> handler);
 
 		// Configuration
 		void set_configuration_params(const QString& server, const QString& database,
 			const QString& username, const QString& password);
 		QString get_connection_string() const;
+		const Sql_Dialect& get_dialect() const;
 
 		// Core query methods
 		Query_Result execute_query(const QString& query);
@@ -99,6 +198,7 @@ namespace Database
 		Query_Result execute_insert(const QString& query);
 		Query_Result execute_update(const QString& query);
 		Query_Result execute_delete(const QString& query);
+		Query_Result stream_select(const QString& query, const Row_Handler& handle_row); // affected_rows = rows read
 
 		// Advanced features
 		Query_Result execute_prepared(const QString& query, const QHash<QString, QVariant>& params);
@@ -111,6 +211,13 @@ namespace Database
 
 		// Stored procedures
 		Query_Result execute_stored_procedure(const QString& procedure_name, const QStringList& params);
+		Query_Result execute_batch(const QString& query);
+		Query_Result call_procedure(const QString& procedure_name, const QVariantList& inputs,
+			const QList<QPair<QString, QVariant>>& outputs);
+		bool is_procedure_available(const QString& procedure_name);
+
+		// Bulk loading (value_rows are escaped "(...)" tuples in column order, one transaction)
+		Query_Result bulk_insert(const QString& table, const QStringList& columns, const QStringList& value_rows);
 		
 		// Schema operations
 		bool table_exists(const QString& table_name);
@@ -121,6 +228,8 @@ namespace Database
 		Query_Result authenticate_user(const QString& username, const QString& password);
 		Query_Result register_user(const User_Data& user_data);
 		Query_Result get_user_by_id(int user_id);
+		bool is_user_admin(int user_id); // Users.Is_Admin, set by the operator (--grant-admin)
+		Query_Result set_user_admin(const QString& username, bool is_admin);
 		Query_Result get_user_by_username(const QString& username);
 		Query_Result update_user(const User_Data& user);
 		Query_Result delete_user(int user_id);
@@ -129,6 +238,7 @@ namespace Database
 
 		// Destination management
 		Query_Result get_all_destinations();
+		Query_Result get_all_destinations(const Listing_Request& request, const Row_Handler& handle_row);
 		Query_Result get_destination_by_id(int destination_id);
 		Query_Result add_destination(const Destination_Data& destination);
 		Query_Result update_destination(const Destination_Data& destination);
@@ -158,18 +268,44 @@ namespace Database
 		// Offer management
 		Query_Result get_all_offers();
 		Query_Result get_available_offers();
+		Query_Result get_available_offers(const Listing_Request& request);
+		Query_Result get_available_offers(const Listing_Request& request, const Row_Handler& handle_row); // always from SQL, not the catalog
 		Query_Result get_offer_by_id(int offer_id);
 		Query_Result search_offers(const QString& destination = "", 
 			qreal min_price = 0, qreal max_price = 0,
 			const QString& start_date = "", 
-			const QString& end_date = "");
+			const QString& end_date = "",
+			const Listing_Request& request = Listing_Request());
 		Query_Result add_offer(const Offer_Data& offer);
 		Query_Result update_offer(const Offer_Data& offer);
 		Query_Result delete_offer(int offer_id);
 
+		// Offer catalog (in-memory read model for GET_OFFERS / SEARCH_OFFERS)
+		bool load_offer_catalog();
+		bool refresh_offer_catalog();
+		bool is_offer_catalog_ready() const;
+		bool serves_offers_from_catalog() const; // loaded from SQL, or holding the demo dataset
+
+		// Destination index (trigram lookup for the SEARCH_OFFERS destination filter)
+		bool load_destination_index();
+		bool is_destination_index_ready() const;
+
+		// Seat inventory and write-behind queue (in-memory booking decisions)
+		bool load_seat_inventory();
+		int reconcile_seat_inventory();
+		int flush_write_behind(int max_count = -1);
+		int get_pending_write_count() const;
+		int get_rejected_write_count() const; // dead letters in the booking journal
+		int requeue_rejected_bookings(); // -1 = journal unavailable
+		bool is_seat_inventory_ready() const;
+
 		// Reservation management
-		Query_Result book_offer(int user_id, int offer_id, int person_count = 1);
+		Query_Result book_offer(int user_id, int offer_id, int person_count = 1,
+			const QList<Reservation_Person_Data>& persons = {});
+		bool reserve_in_memory(int user_id, int offer_id, int person_count, Query_Result& result);
+		bool apply_batch(const QList<Batch_Operation>& operations, QList<Query_Result>& results); // false = every operation failed alike
 		Query_Result get_user_reservations(int user_id);
+		Query_Result get_user_reservations(int user_id, const Listing_Request& request, const Row_Handler& handle_row);
 		Query_Result get_offer_reservations(int offer_id);
 		Query_Result get_reservation_by_id(int reservation_id);
 		Query_Result cancel_reservation(int reservation_id);
@@ -187,6 +323,24 @@ namespace Database
 		Query_Result get_user_statistics();
 		Query_Result get_booking_statistics();
 
+		// Booking statistics (incrementally maintained, rebuilt from the database on startup)
+		bool load_booking_statistics();
+		bool is_booking_statistics_ready() const;
+		bool snapshot_booking_statistics();
+		Query_Result check_booking_statistics(bool repair = false);
+
+		// Revenue rollup (Reservation_Daily_Rollup, kept current by refresh_revenue_rollup)
+		bool load_revenue_rollup();
+		int refresh_revenue_rollup(int max_days = -1);
+		bool is_revenue_rollup_ready() const;
+		Query_Result get_revenue_by_period(const QString& start_date, const QString& end_date, Revenue_Period period);
+
+		// Query statistics (first row is the total over every statement, then the top shapes by time)
+		Query_Result get_query_statistics(int top_count, bool reset = false);
+
+		// Data version of a listing (changes whenever a write reached a table it reads, cached responses compare it)
+		quint64 get_data_version(Listing listing) const;
+
 		// Utilities
 		QString escape_string(const QString& input);
 		QString format_date_for_sql(const QString& date);
@@ -198,12 +352,16 @@ namespace Database
 		void enable_demo_mode();
 		bool is_running_in_demo_mode() const;
 		Query_Result create_mock_response(const QString& operation);
+		void load_demo_dataset(const QList<QHash<QString, QVariant>>& destinations,
+			const QList<QHash<QString, QVariant>>& offers);
 
 		// Static utilities
 		static QString hash_password(const QString& password, const QString& salt);
+		static bool verify_password(const QString& password, const QString& salt, const QString& expected_hash);
 		static QString generate_salt();
 		static bool validate_email(const QString& email);
 		static bool validate_cnp(const QString& cnp);
+		static QStringList get_listing_fields(Listing listing); // in select order
 
 	private:
 		// Private helpers
@@ -212,9 +370,35 @@ namespace Database
 		QString build_connection_string() const;
 		Query_Result process_select_result(QSqlQuery& query);
 		Query_Result process_execution_result(QSqlQuery& query);
+		void mark_data_changed(const QString& statement = QString()); // empty = any table may have changed
+		void notify_credentials_revoked(int user_id);
 		bool handle_sql_error(const QSqlError& error);
 		QString get_sql_error(const QSqlError& error);
-		bool retry_operation(std::function<bool()> operation, int max_attempts = MAX_RETRIES_ATTEMPTS);
+		Query_Result make_error_result(const QString& operation, const QSqlError& error);
+		void record_query_timing(const QString& query, const QString& bind_values,
+			const QElapsedTimer& timer, qint64 wait_ns, const Query_Result& result);
+		QString get_offer_catalog_sql() const;
+		static const QList<QPair<QString, QString>>& get_listing_columns(Listing listing); // field, select expression
+		static const QStringList& get_listing_tables(Listing listing); // tables its rows are read from
+		static QString get_select_list(Listing listing, const QStringList& fields);
+		QString get_available_offers_sql(const Listing_Request& request = Listing_Request()) const;
+		QString get_user_reservations_sql(int user_id, const Listing_Request& request = Listing_Request()) const;
+		QString get_keyset_condition(const Listing_Request& request, const QString& key_column,
+			const QString& id_column, bool descending) const;
+		bool resolve_destination_ids(const QString& text, QSet<int>& destination_ids) const;
+		QString get_batch_booking_sql(const QList<Batch_Operation>& bookings);
+		QString get_batch_cancel_sql(const QList<Batch_Operation>& cancellations);
+		bool apply_batch_transaction(const QList<Batch_Operation>& operations, QList<Query_Result>& results); // all or nothing
+		bool apply_batch_with_statements(const QList<Batch_Operation>& bookings, const QList<Batch_Operation>& cancellations,
+			QList<QHash<QString, QVariant>>& booking_rows, QList<QHash<QString, QVariant>>& cancellation_rows,
+			Query_Result& error);
+		Query_Result book_offer_with_procedure(int user_id, int offer_id, int person_count,
+			const QList<Reservation_Person_Data>& persons);
+		Query_Result book_offer_with_statements(int user_id, int offer_id, int person_count,
+			const QList<Reservation_Person_Data>& persons);
+		bool recount_booking_statistics(Booking_Statistics& statistics);
+		void record_statistics_booking(int offer_id, int person_count, qreal total_price, const QDate& day);
+		Query_Result run_revenue_report(const QDateTime& start, const QDateTime& end_exclusive, Revenue_Period period);
 		
 		// Table creation SQL
 		QString get_create_users_table_sql();
@@ -225,6 +409,9 @@ namespace Database
 		QString get_create_offers_table_sql();
 		QString get_create_reservations_table_sql();
 		QString get_create_reservation_persons_table_sql();
-		QString get_create_indexes_sql();
+		QString get_create_write_behind_table_sql();
+		QString get_create_statistics_snapshot_table_sql();
+		QStringList get_create_revenue_rollup_tables_sql();
+		QStringList get_create_indexes_sql();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+#include <QtCore/QDate>
+#include <memory>
+
+#include "database/Database_Manager.h"
+
+namespace Database
+{
+	struct Dataset_Scale
+	{
+		int destinations = 0;
+		int accommodations = 0;
+		int offers = 0;
+		int users = 0;
+		qint64 reservations = 0; // target, the generated count lands close to it
+
+		// "demo", "small", "medium", "large", or a number of offers the rest is scaled to
+		static bool parse(const QString& text, Dataset_Scale& scale);
+		QString to_string() const;
+	};
+
+	struct Generated_Offer
+	{
+		QHash<QString, QVariant> offer;
+		QList<QHash<QString, QVariant>> reservations; // non-cancelled ones add up to Reserved_Seats
+	};
+
+	/**
+	 * Synthetic destinations, accommodations, offers, users and reservations
+	 * for load and performance testing. Every row is derived from the seed and
+	 * its own index only, so the same seed, scale and anchor date always give
+	 * the same data, and any row can be produced again without the others:
+	 * nothing is kept in memory while a large dataset is written.
+	 *
+	 * Rows use the table column names. Foreign keys are filled in from the id
+	 * lists set with set_ids(), by default the ids a fresh database would hand
+	 * out (1..n). Offers also carry the joined columns of the offer catalog
+	 * (Destination_Name, Country, Accommodation_Name, Transport_Name).
+	 *
+	 * load_into() bulk-inserts everything into a real database, generate_demo_*
+	 * feed the demo-mode backend.
+	 */
+	class Dataset_Generator
+	{
+	public:
+		enum class Table
+		{
+			TRANSPORT_TYPES,
+			ACCOMMODATION_TYPES,
+			DESTINATIONS,
+			ACCOMMODATIONS,
+			OFFERS,
+			USERS
+		};
+
+	private:
+		quint64 seed;
+		Dataset_Scale scale;
+		QDate anchor_date; // departures are spread around it
+		QHash<int, QList<int>> ids; // by Table, index -> id
+
+	public:
+		Dataset_Generator(quint64 seed, const Dataset_Scale& scale, const QDate& anchor_date = QDate::currentDate());
+
+		const Dataset_Scale& get_scale() const;
+		void set_ids(Table table, const QList<int>& table_ids);
+
+		int get_transport_type_count() const;
+		int get_accommodation_type_count() const;
+		QHash<QString, QVariant> transport_type(int index) const;
+		QHash<QString, QVariant> accommodation_type(int index) const;
+		QHash<QString, QVariant> destination(int index) const;
+		QHash<QString, QVariant> accommodation(int index) const;
+		Generated_Offer offer(int index) const;
+		QHash<QString, QVariant> user(int index) const;
+
+		QList<QHash<QString, QVariant>> generate_demo_destinations() const;
+		QList<QHash<QString, QVariant>> generate_demo_offers() const;
+
+		Query_Result load_into(std::shared_ptr<Database_Manager> db_manager);
+
+	private:
+		QHash<QString, QVariant> get_row(Table table, int index) const;
+		int get_id(Table table, int index) const;
+		int get_destination_of_accommodation(int accommodation_index) const;
+		quint64 row_seed(Table table, int index) const;
+
+		Query_Result insert_table(std::shared_ptr<Database_Manager> db_manager, Table table, int count);
+		Query_Result insert_reservations(std::shared_ptr<Database_Manager> db_manager, qint64& inserted);
+		Query_Result read_new_ids(std::shared_ptr<Database_Manager> db_manager, Table table, int after_id, int expected);
+		static QString to_values_sql(Database_Manager& db_manager, const QHash<QString, QVariant>& row, const QStringList& columns);
+
+		static QString get_table_name(Table table);
+		static QString get_id_column(Table table);
+		static QStringList get_insert_columns(Table table);
+	};
+}
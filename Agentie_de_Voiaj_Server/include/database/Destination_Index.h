@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QVariant>
+#include <QtCore/QReadWriteLock>
+
+namespace Database
+{
+	/**
+	 * Trigram index over destination Name and Country.
+	 * Text is normalized before indexing (diacritics stripped, case folded,
+	 * punctuation collapsed), so "Brașov", "Brasov" and "BRAŞOV" all match.
+	 * Lookups resolve a search string to candidate Destination_IDs:
+	 *   - find_substring: every trigram of the query must be present, then
+	 *     the candidates are verified with a plain contains()
+	 *   - find_similar: trigram Jaccard similarity per word, for typos
+	 */
+	class Destination_Index
+	{
+	private:
+		struct Entry
+		{
+			QString name;                           // normalized
+			QString country;                        // normalized
+			QVector<QSet<quint64>> token_trigrams;  // whole fields and each word
+			QSet<quint64> all_trigrams;
+		};
+
+		QHash<int, Entry> entries;
+		QHash<quint64, QSet<int>> postings; // trigram -> destination ids
+		bool built = false;
+		mutable QReadWriteLock lock;
+
+	public:
+		Destination_Index() = default;
+
+		// Maintenance
+		void build(const QList<QHash<QString, QVariant>>& rows);
+		void upsert(int destination_id, const QString& name, const QString& country);
+		void remove(int destination_id);
+		void clear();
+		bool is_built() const;
+		int size() const;
+
+		// Lookups
+		QSet<int> find_substring(const QString& text) const;
+		QSet<int> find_similar(const QString& text, qreal min_similarity) const;
+		QSet<int> lookup(const QString& text, qreal min_similarity) const;
+
+		// Normalization helpers
+		static QString normalize(const QString& text);
+		static QSet<quint64> trigrams(const QString& normalized, bool padded = true);
+
+	private:
+		void upsert_locked(int destination_id, const QString& name, const QString& country);
+		void remove_locked(int destination_id);
+		QSet<int> find_substring_locked(const QString& normalized) const;
+		QSet<int> find_similar_locked(const QString& normalized, qreal min_similarity) const;
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <functional>
+#include <memory>
+
+#include "database/Database_Manager.h"
+
+namespace Database
+{
+	struct Group_Commit_Stats
+	{
+		quint64 batches = 0;
+		quint64 operations = 0;
+		int max_batch_size = 0;
+		qreal average_batch_size = 0.0;
+		qreal average_wait_ms = 0.0;           // first arrival in a batch to its commit
+		QVector<quint64> batch_size_histogram; // bucket i counts sizes in [2^i, 2^(i+1))
+
+		static QString get_bucket_label(int bucket);
+	};
+
+	/**
+	 * Collects BOOK_OFFER / CANCEL_RESERVATION requests that need the database
+	 * and applies them together: the first request opens a short window
+	 * (Config::Booking::GROUP_COMMIT_WINDOW_MS), everything that arrives before
+	 * it closes, up to GROUP_COMMIT_MAX_BATCH, goes through one
+	 * Database_Manager::apply_batch() transaction. Each request still gets its
+	 * own result through its callback; a batch the database refuses as a whole
+	 * is applied again one operation per transaction, so only the request at
+	 * fault fails. Lives in the thread that owns the database connection.
+	 */
+	class Group_Commit : public QObject
+	{
+		Q_OBJECT
+
+	private:
+		struct Queued_Operation
+		{
+			Batch_Operation operation;
+			std::function<void(const Query_Result&)> on_complete;
+		};
+
+		std::shared_ptr<Database_Manager> db_manager;
+		QList<Queued_Operation> queue;
+		QTimer* window_timer;
+		QElapsedTimer window_clock;
+
+		Group_Commit_Stats stats;
+		qint64 total_wait_us = 0;
+		mutable QMutex mutex;
+
+	public:
+		explicit Group_Commit(std::shared_ptr<Database_Manager> db_manager, QObject* parent = nullptr);
+
+		void submit(const Batch_Operation& operation, std::function<void(const Query_Result&)> on_complete);
+		int get_queued_count() const;
+		Group_Commit_Stats get_stats() const;
+
+	public slots:
+		void flush();
+
+	private:
+		void record_batch(int batch_size, qint64 wait_us);
+	};
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
+#include <QtCore/QDate>
+#include <QtCore/QDateTime>
+#include <QtCore/QVariant>
+#include <QtCore/QReadWriteLock>
+#include <atomic>
+
+namespace Database
+{
+	/**
+	 * One offer as kept in the catalog. The typed fields are the ones the
+	 * secondary indexes are built on, row holds the columns exactly as the
+	 * SQL listing queries return them so responses look the same either way.
+	 */
+	struct Catalog_Offer
+	{
+		int offer_id = 0;
+		int destination_id = 0;
+		qreal price_per_person = 0.0;
+		QDate departure_date;
+		QDate return_date;
+		int total_seats = 0;
+		int reserved_seats = 0;
+		QDateTime date_modified;
+		QHash<QString, QVariant> row;
+		bool in_use = false; // false for slots freed by removed offers
+
+		int get_available_seats() const
+		{
+			return total_seats - reserved_seats;
+		}
+	};
+
+	struct Offer_Search_Criteria
+	{
+		bool filter_destinations = false; // when true only destination_ids match
+		QSet<int> destination_ids;
+		qreal min_price = 0.0;            // 0 = no lower bound
+		qreal max_price = 0.0;            // 0 = no upper bound
+		QDate start_date;                 // Departure_Date >= start_date
+		QDate end_date;                   // Return_Date <= end_date
+		int min_available_seats = 1;
+		bool only_future_departures = false;
+		QDate after_departure;            // keyset page: only offers sorting after
+		int after_offer_id = 0;           // (after_departure, after_offer_id), 0 = from the start
+		int limit = 0;                    // 0 = every match
+		QStringList fields;               // columns of each returned row, empty = all
+	};
+
+	/**
+	 * In-memory catalog of active offers answering GET_OFFERS and SEARCH_OFFERS.
+	 * Offers live in a flat array of slots; secondary indexes hold slot numbers:
+	 *   - destination id -> slots
+	 *   - slots sorted by price, by departure date and by return date
+	 *   - available seats -> slots (ordered, updated in place on booking)
+	 * A search picks the most selective index and checks the other predicates
+	 * on that candidate list only.
+	 */
+	class Offer_Catalog
+	{
+	private:
+		QVector<Catalog_Offer> offers;
+		QHash<int, int> slot_by_offer_id;
+		QVector<int> free_slots;
+
+		QHash<int, QVector<int>> slots_by_destination;
+		QHash<int, QPair<QString, QString>> destination_names; // id -> (name, country), lower-cased
+		QVector<int> slots_by_price;
+		QVector<int> slots_by_departure;
+		QVector<int> slots_by_return;
+		QMap<int, QSet<int>> slots_by_available_seats;
+
+		QDateTime watermark; // highest Date_Modified seen, for incremental refresh
+		bool loaded = false;
+		std::atomic<quint64> version{ 0 }; // bumped by every change, cached responses compare it
+		mutable QReadWriteLock lock;
+
+	public:
+		Offer_Catalog() = default;
+
+		// Loading and refresh (rows come from the SQL offer listing query)
+		void load(const QList<QHash<QString, QVariant>>& rows);
+		void apply_changes(const QList<QHash<QString, QVariant>>& rows);
+		void clear();
+		bool is_loaded() const;
+		QDateTime get_watermark() const;
+		int size() const;
+		quint64 get_version() const;
+
+		// In-place updates from the write paths
+		void remove_offer(int offer_id);
+		bool adjust_reserved_seats(int offer_id, int delta);
+		void update_destination(int destination_id, const QString& name, const QString& country);
+
+		// Queries
+		QList<QHash<QString, QVariant>> get_available_offers() const;
+		QList<QHash<QString, QVariant>> search(const Offer_Search_Criteria& criteria) const;
+		bool get_offer(int offer_id, QHash<QString, QVariant>& row) const;
+		QSet<int> match_destinations(const QString& text) const;
+
+	private:
+		void upsert_locked(const QHash<QString, QVariant>& row);
+		void remove_locked(int offer_id);
+		void index_slot(int slot, bool keep_sorted);
+		void unindex_slot(int slot);
+		void rebuild_sorted_indexes();
+		bool matches(const Catalog_Offer& offer, const Offer_Search_Criteria& criteria, const QDate& today) const;
+		QVector<int> candidate_slots(const Offer_Search_Criteria& criteria) const;
+
+		static Catalog_Offer offer_from_row(const QHash<QString, QVariant>& row);
+		static bool is_catalog_status(const QHash<QString, QVariant>& row);
+	};
+}
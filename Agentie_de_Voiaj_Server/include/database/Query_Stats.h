@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+#include <QtCore/QMutex>
+#include <array>
+
+namespace Database
+{
+	/**
+	 * Timing of every statement Database_Manager runs, grouped by query shape:
+	 * the SQL with its literals replaced by '?' and value lists folded, so the
+	 * same method called with different ids lands in one entry. Each shape keeps
+	 * call and error counts, rows, time spent waiting for the connection and a
+	 * latency histogram the percentiles are estimated from.
+	 *
+	 * Shapes beyond max_shapes are counted under one "(other)" entry so a query
+	 * built with unbounded text cannot grow the table without limit.
+	 */
+	class Query_Stats
+	{
+	public:
+		// Upper bounds in microseconds, the last bucket takes everything slower
+		static constexpr std::array<qint64, 13> BUCKET_BOUNDS_US = {
+			100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+		};
+		static constexpr int BUCKET_COUNT = static_cast<int>(BUCKET_BOUNDS_US.size()) + 1;
+
+	private:
+		struct Shape_Totals
+		{
+			qint64 calls = 0;
+			qint64 errors = 0;
+			qint64 rows = 0;
+			qint64 total_us = 0;
+			qint64 max_us = 0;
+			qint64 wait_us = 0;
+			std::array<qint64, BUCKET_COUNT> histogram = {};
+		};
+
+		QHash<QString, Shape_Totals> shapes;
+		Shape_Totals totals;
+		int max_shapes;
+		mutable QMutex mutex;
+
+	public:
+		explicit Query_Stats(int max_shapes);
+
+		void record(const QString& query, qint64 wait_us, qint64 run_us, int rows, bool succeeded);
+		void reset();
+
+		// Rows ordered by total time: Query_Shape, Calls, Errors, Rows, Total_Ms, Avg_Ms,
+		// P50_Ms, P95_Ms, P99_Ms, Max_Ms, Avg_Wait_Ms
+		QList<QHash<QString, QVariant>> get_top(int count) const;
+		QHash<QString, QVariant> get_totals() const; // same columns over every statement, plus Shapes
+
+		static QString normalize(const QString& query);
+
+	private:
+		static void add(Shape_Totals& target, qint64 wait_us, qint64 run_us, int rows, bool succeeded);
+		static QHash<QString, QVariant> to_row(const Shape_Totals& source);
+		static double percentile_ms(const Shape_Totals& source, double fraction);
+	};
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QDate>
+#include <QtCore/QDateTime>
+#include <QtCore/QMutex>
+
+#include "database/Sql_Dialect.h"
+
+namespace Database
+{
+	enum class Revenue_Period
+	{
+		NONE,  // one row for the whole range
+		DAY,
+		MONTH,
+		YEAR
+	};
+
+	/**
+	 * Per-day revenue rollup behind the date-range revenue reports. Every day up
+	 * to complete_through has its reservations summed per destination and status
+	 * in Reservation_Daily_Rollup, so a report reads one row per day bucket and
+	 * only scans Reservations for what the rollup does not cover yet: the partial
+	 * current day, partial days at the range edges and days marked dirty by a
+	 * status change since they were rolled up.
+	 *
+	 * This class holds the rollup state and builds the SQL; Database_Manager runs
+	 * it (refresh_revenue_rollup from a timer, get_revenue_report on demand).
+	 * Destination_ID is the offer's destination when the day was rolled up.
+	 */
+	class Revenue_Rollup
+	{
+	private:
+		QDate complete_through;            // invalid until loaded
+		QHash<QDate, quint64> dirty_days;  // day -> mark sequence, see clear_dirty_days()
+		quint64 mark_sequence = 0;
+		bool loaded = false;
+		mutable QMutex mutex;
+
+	public:
+		// State
+		void set_complete_through(const QDate& day);
+		QDate get_complete_through() const;
+		bool is_loaded() const;
+		void clear();
+
+		// Dirty days (reservations of a past day changed status)
+		void mark_dirty(const QDate& day);
+		QHash<QDate, quint64> get_dirty_days(int max_count) const;
+		void clear_dirty_days(const QHash<QDate, quint64>& rolled_up);
+
+		// SQL
+		QString get_report_sql(const Sql_Dialect& dialect, const QDateTime& start, const QDateTime& end_exclusive,
+			Revenue_Period period) const;
+		static QStringList get_rollup_range_statements(const Sql_Dialect& dialect, const QDate& first_day, const QDate& last_day);
+		static QStringList get_rollup_days_statements(const Sql_Dialect& dialect, const QList<QDate>& days);
+
+		// Report bounds: "yyyy-MM-dd" covers the whole day, ISO date-times are taken as is
+		static bool parse_start_bound(const QString& text, QDateTime& bound);
+		static bool parse_end_bound(const QString& text, QDateTime& bound_exclusive);
+		static bool parse_period(const QString& text, Revenue_Period& period);
+
+	private:
+		static QString get_rollup_insert_sql(const Sql_Dialect& dialect, const QString& reservation_filter);
+	};
+}
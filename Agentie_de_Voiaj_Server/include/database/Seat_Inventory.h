@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+#include <QtCore/QReadWriteLock>
+#include <atomic>
+#include <memory>
+
+namespace Database
+{
+	enum class Reserve_Status
+	{
+		RESERVED,
+		NOT_ENOUGH_SEATS,
+		UNKNOWN_OFFER
+	};
+
+	/**
+	 * Per-offer seat counters for active offers, the authority for booking
+	 * decisions while the write-behind queue persists them. try_reserve is a
+	 * compare-and-swap on Reserved_Seats that never lets it pass Total_Seats,
+	 * so concurrent bookings for the same offer cannot oversell.
+	 * reconcile() realigns the counters with the database; the caller must
+	 * keep bookings out while it runs and pass the seats still queued.
+	 */
+	class Seat_Inventory
+	{
+	private:
+		struct Offer_Seats
+		{
+			std::atomic<int> total_seats{ 0 };
+			std::atomic<int> reserved_seats{ 0 };
+			std::atomic<qreal> price_per_person{ 0.0 };
+		};
+
+		QHash<int, std::shared_ptr<Offer_Seats>> offers;
+		bool loaded = false;
+		mutable QReadWriteLock lock; // guards the map, not the counters
+
+	public:
+		Seat_Inventory() = default;
+
+		// Loading (rows carry Offer_ID, Total_Seats, Reserved_Seats, Price_per_Person)
+		void load(const QList<QHash<QString, QVariant>>& rows);
+		int reconcile(const QList<QHash<QString, QVariant>>& rows, const QHash<int, int>& pending_seats);
+		void clear();
+		bool is_loaded() const;
+		int size() const;
+
+		// Booking decisions
+		Reserve_Status try_reserve(int offer_id, int seats, qreal& price_per_person);
+		void release(int offer_id, int seats);
+		void add_reserved(int offer_id, int seats);
+		bool contains(int offer_id) const;
+		int get_available_seats(int offer_id) const;
+
+		// Offer maintenance
+		void set_offer(int offer_id, int total_seats, int reserved_seats, qreal price_per_person);
+		void update_offer(int offer_id, int total_seats, qreal price_per_person);
+		void remove_offer(int offer_id);
+
+	private:
+		std::shared_ptr<Offer_Seats> find(int offer_id) const;
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QDate>
+#include <QtCore/QDateTime>
+#include <QtSql/QSqlError>
+#include <memory>
+
+namespace Database
+{
+	enum class Storage_Backend
+	{
+		SQL_SERVER, // QODBC, the production database
+		SQLITE      // QSQLITE, one embedded file for single-node and test deployments
+	};
+
+	enum class Date_Part
+	{
+		DAY,
+		WEEK,
+		MONTH
+	};
+
+	/**
+	 * Everything Database_Manager needs to know about the SQL engine behind the
+	 * connection: how to open it, the SQL fragments that differ between engines
+	 * and what the engine can run in one round trip. Queries are still written
+	 * inline by Database_Manager and only ask the dialect for the parts that are
+	 * not portable (current time, row limits, identity columns, DDL guards).
+	 *
+	 * Where an engine lacks a feature altogether (stored procedures, multi
+	 * statement batches with table variables) the capability getters return
+	 * false and Database_Manager takes its statement-by-statement path.
+	 */
+	class Sql_Dialect
+	{
+	public:
+		virtual ~Sql_Dialect() = default;
+
+		static std::unique_ptr<Sql_Dialect> create(Storage_Backend backend);
+		static bool parse_backend(const QString& text, Storage_Backend& backend);
+		static Storage_Backend get_default_backend(); // Config::Storage::DEFAULT_BACKEND
+
+		// Connection
+		virtual Storage_Backend get_backend() const = 0;
+		virtual QString get_driver_name() const = 0;
+		virtual QString get_database_name(const QString& server, const QString& database,
+			const QString& username, const QString& password) const = 0;
+		virtual QString get_connect_options() const = 0;
+		virtual QStringList get_session_statements() const = 0; // run once after every open
+		virtual bool is_embedded() const = 0;                    // database name is a local file path
+		virtual bool is_connection_error(const QSqlError& error) const = 0; // the connection must be reopened
+
+		// Capabilities
+		virtual bool supports_procedures() const = 0;
+		virtual bool supports_batches() const = 0; // several statements and table variables in one exec
+		virtual int get_max_insert_rows() const = 0; // rows in one INSERT ... VALUES
+
+		// Expressions
+		virtual QString now() const = 0;
+		virtual QString now_plus(int amount, Date_Part part) const = 0;
+		virtual QString date_of(const QString& expression) const = 0;
+		virtual QString month_start(const QString& expression) const = 0;
+		virtual QString year_start(const QString& expression) const = 0;
+		virtual QString date_literal(const QDate& day) const = 0;
+		virtual QString datetime_literal(const QDateTime& moment) const = 0;
+
+		// Statements
+		virtual QString top(int count) const = 0;   // after SELECT
+		virtual QString limit(int count) const = 0; // after ORDER BY
+		virtual QString update_lock_hint() const = 0; // after the locked table name
+		virtual QString get_identity_column() const = 0;
+		virtual QString get_insert_returning_id_sql(const QString& insert_sql, const QString& id_column) const = 0;
+		virtual QString get_create_table_sql(const QString& table, const QString& columns) const = 0;
+		virtual QString get_create_index_sql(const QString& index, const QString& table,
+			const QString& columns, const QString& included_columns = QString()) const = 0;
+		virtual QString get_table_exists_sql(const QString& table) const = 0;
+		virtual QString get_table_columns_sql(const QString& table) const = 0; // one COLUMN_NAME per row
+		virtual QString get_set_triggers_sql(const QString& table, bool enabled) const = 0; // empty when there are none
+	};
+
+	class Sql_Server_Dialect : public Sql_Dialect
+	{
+	public:
+		Storage_Backend get_backend() const override;
+		QString get_driver_name() const override;
+		QString get_database_name(const QString& server, const QString& database,
+			const QString& username, const QString& password) const override;
+		QString get_connect_options() const override;
+		QStringList get_session_statements() const override;
+		bool is_embedded() const override;
+		bool is_connection_error(const QSqlError& error) const override;
+
+		bool supports_procedures() const override;
+		bool supports_batches() const override;
+		int get_max_insert_rows() const override;
+
+		QString now() const override;
+		QString now_plus(int amount, Date_Part part) const override;
+		QString date_of(const QString& expression) const override;
+		QString month_start(const QString& expression) const override;
+		QString year_start(const QString& expression) const override;
+		QString date_literal(const QDate& day) const override;
+		QString datetime_literal(const QDateTime& moment) const override;
+
+		QString top(int count) const override;
+		QString limit(int count) const override;
+		QString update_lock_hint() const override;
+		QString get_identity_column() const override;
+		QString get_insert_returning_id_sql(const QString& insert_sql, const QString& id_column) const override;
+		QString get_create_table_sql(const QString& table, const QString& columns) const override;
+		QString get_create_index_sql(const QString& index, const QString& table,
+			const QString& columns, const QString& included_columns = QString()) const override;
+		QString get_table_exists_sql(const QString& table) const override;
+		QString get_table_columns_sql(const QString& table) const override;
+		QString get_set_triggers_sql(const QString& table, bool enabled) const override;
+	};
+
+	/**
+	 * Embedded SQLite through QSQLITE. The file runs in WAL mode so readers do
+	 * not block the writer, with synchronous=NORMAL (durable at checkpoints,
+	 * never corrupt) and a larger page cache and mmap window than the defaults.
+	 * Dates are stored as ISO text in local time, like GETDATE() returns them.
+	 */
+	class Sqlite_Dialect : public Sql_Dialect
+	{
+	public:
+		Storage_Backend get_backend() const override;
+		QString get_driver_name() const override;
+		QString get_database_name(const QString& server, const QString& database,
+			const QString& username, const QString& password) const override;
+		QString get_connect_options() const override;
+		QStringList get_session_statements() const override;
+		bool is_embedded() const override;
+		bool is_connection_error(const QSqlError& error) const override;
+
+		bool supports_procedures() const override;
+		bool supports_batches() const override;
+		int get_max_insert_rows() const override;
+
+		QString now() const override;
+		QString now_plus(int amount, Date_Part part) const override;
+		QString date_of(const QString& expression) const override;
+		QString month_start(const QString& expression) const override;
+		QString year_start(const QString& expression) const override;
+		QString date_literal(const QDate& day) const override;
+		QString datetime_literal(const QDateTime& moment) const override;
+
+		QString top(int count) const override;
+		QString limit(int count) const override;
+		QString update_lock_hint() const override;
+		QString get_identity_column() const override;
+		QString get_insert_returning_id_sql(const QString& insert_sql, const QString& id_column) const override;
+		QString get_create_table_sql(const QString& table, const QString& columns) const override;
+		QString get_create_index_sql(const QString& index, const QString& table,
+			const QString& columns, const QString& included_columns = QString()) const override;
+		QString get_table_exists_sql(const QString& table) const override;
+		QString get_table_columns_sql(const QString& table) const override;
+		QString get_set_triggers_sql(const QString& table, bool enabled) const override;
+	};
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QFile>
+#include <QtCore/QDateTime>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+
+namespace Database
+{
+	/**
+	 * A booking accepted by the seat inventory but not yet written to SQL.
+	 * token identifies it across restarts so a replay never inserts it twice.
+	 */
+	struct Pending_Booking
+	{
+		QString token;
+		int user_id = 0;
+		int offer_id = 0;
+		int person_count = 0;
+		qreal total_price = 0.0;
+		QDateTime created_at;
+		int attempts = 0; // failed flush attempts, in memory only
+		qint64 retry_at_ms = 0; // not flushed again before this, in memory only
+		QString rejection; // why the database refused it, set once it is dead-lettered
+	};
+
+	/**
+	 * Durable FIFO of pending bookings backed by an append-only journal.
+	 * enqueue() returns only after the record is flushed and synced to disk;
+	 * mark_done() appends a completion record. On open() the journal is
+	 * replayed, completed entries dropped and the file compacted, so
+	 * bookings acknowledged before a crash are persisted after restart.
+	 *
+	 * A booking the database refuses for good (a constraint) is never
+	 * forgotten: mark_rejected() moves it to a dead-letter list that stays in
+	 * the journal until requeue_rejected() puts it back in the queue.
+	 * Journal lines are JSON objects: {"op":"book",...}, {"op":"done",...},
+	 * {"op":"rejected","reason":...} and {"op":"requeue",...}; the last state of
+	 * a token wins.
+	 */
+	class Write_Behind_Queue
+	{
+	private:
+		QString journal_path;
+		QFile journal;
+		QList<Pending_Booking> pending;
+		QList<Pending_Booking> rejected; // dead letters, kept for the operator
+		int done_since_compaction = 0;
+		mutable QMutex mutex;
+
+	public:
+		explicit Write_Behind_Queue(const QString& journal_path);
+		~Write_Behind_Queue();
+
+		bool open();
+		void close();
+		bool is_open() const;
+
+		bool enqueue(const Pending_Booking& booking);
+		QList<Pending_Booking> peek(int max_count) const;
+		QList<Pending_Booking> peek_ready(int max_count, qint64 now_ms) const; // skips bookings backing off
+		void mark_done(const QString& token);
+		int mark_failed(const QString& token, qint64 retry_at_ms); // attempts so far
+		bool mark_rejected(const QString& token, const QString& reason);
+		int requeue_rejected();
+
+		int size() const;
+		int get_rejected_count() const;
+		QHash<int, int> get_pending_seats_by_offer() const;
+
+	private:
+		bool append_record(const QJsonObject& record);
+		bool compact_locked();
+
+		static QJsonObject to_record(const Pending_Booking& booking);
+		static Pending_Booking from_record(const QJsonObject& record);
+		static bool sync_to_disk(QFileDevice& file);
+	};
+}
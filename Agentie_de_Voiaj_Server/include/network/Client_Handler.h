@@ -4,10 +4,13 @@
 #include <QtCore/QThread>
 #include <QtCore/QMutex>
 #include <QtCore/QTimer>
+#include <QtCore/QList>
 #include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QLocalSocket>
 #include <memory>
 
 #include "network/Network_Types.h"
+#include "network/Client_Session.h"
 #include "database/Database_Manager.h"
 
 // Forward declarations
@@ -20,67 +23,68 @@ namespace SocketNetwork
 
 namespace SocketNetwork
 {
-	class Client_Handler : public QObject
+	/**
+	 * The Client_Session of a client connected over TCP or the local server.
+	 * Reads request lines from the socket and queues replies per connection,
+	 * flushed to the socket once per event loop turn.
+	 */
+	class Client_Handler : public Client_Session
 	{
 		Q_OBJECT
 
 	private:
-		QTcpSocket* client_socket;
-		Client_Info client_info;
+		QIODevice* client_socket; // the connection, whichever kind it is
+		QTcpSocket* tcp_socket;     // null for a local connection
+		QLocalSocket* local_socket; // null for a TCP connection
 		std::shared_ptr<Database::Database_Manager> db_manager;
 		Protocol_Handler* protocol_handler;
 		Socket_Server* server;
 
 		QThread* handler_thread;
 		bool is_running;
-		QMutex send_mutex;
 
 		QTimer* keep_alive_timer;
-		int messages_received = 0;
-		int messages_sent = 0;
+		QList<QByteArray> pending_output; // Framed replies not yet handed to the socket, in order
+		qsizetype pending_bytes = 0;
+		bool flush_scheduled = false; // flush_pending_output() is queued on the event loop
+		bool reading_paused = false; // requests wait unread until the client takes its replies
+		bool output_stalled = false; // the client stopped reading, its connection is being dropped
+		quint64 deferred_allocations = 0; // made by the deferred request before it waited, recorded with its reply
 
 	public:
-		Client_Handler(QTcpSocket* socket, const Client_Info& info,
+		Client_Handler(QIODevice* socket, const Client_Info& info, // a QTcpSocket or a QLocalSocket
 			std::shared_ptr<Database::Database_Manager> db_manager,
 			Protocol_Handler* protocol_handler, Socket_Server* server);
-		~Client_Handler();
+		~Client_Handler() override;
 
 		void start_handling();
 		void stop_handling();
 		bool is_client_running() const;
 
-		bool send_message(const QString& message);
-		QString receive_message();
-
-		const Client_Info& get_client_info() const;
-		void update_last_activity();
-		bool is_authenticated() const;
-		void set_authenticated(int user_id, const QString& username);
-
-		int get_messages_received() const 
-		{ 
-			return messages_received; 
-		}
-		
-		int get_messages_sent() const 
-		{ 
-			return messages_sent;
-		}
-		qint64 get_idle_time() const;
+		void complete_deferred_response(const Response& response) override;
+		bool send_cached(const QByteArray& reply) override;
+		QByteArray receive_message();
 
 	signals:
-		void messageReceived(const QString& message);
+		void messageReceived(const QByteArray& message);
 		void clientDisconnected();
 
 	private slots:
 		void handle_ready_read();
 		void handle_disconnection();
+		void flush_pending_output();
+		void handle_bytes_written();
 
 	private:
 		void handle_client_loop();
-		bool process_message(const QString& message);
+		bool is_open() const override;
+		bool write_output_locked() override;
+		bool flush_output_locked() override;
+		bool queue_output_locked(const QByteArray& reply);
+		bool flush_pending_locked();
+		void drop_stalled_reader_locked();
+		bool is_output_backed_up();
 		bool is_socket_valid() const;
-		void send_error_response(const QString& error_message);
-		void send_success_response(const QString& data = "", const QString& message = "");
+		qintptr get_gather_descriptor() const; // -1 when gathered writes do not apply
 	};
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QMutex>
+#include <QtCore/QByteArray>
+
+#include "network/Network_Types.h"
+
+// Forward declarations
+
+namespace SocketNetwork
+{
+	class Protocol_Handler;
+	class Response_Stream;
+}
+
+namespace SocketNetwork
+{
+	/**
+	 * One client as Protocol_Handler sees it: who it is, and where its replies
+	 * go. Replies are framed here, in output_buffer under send_mutex, and
+	 * handed to the transport by write_output_locked() (a whole reply, \r\n
+	 * appended) or flush_output_locked() (part of a streamed one).
+	 * Client_Handler sends them over a TCP or local socket, Loopback_Session
+	 * keeps them in memory.
+	 *
+	 * process_request() is the path every request line takes, parse, dispatch
+	 * and reply, so each transport only reads lines and calls it. Deferred
+	 * replies come back through complete_deferred_response().
+	 */
+	class Client_Session : public QObject
+	{
+		Q_OBJECT
+
+		friend class Response_Stream; // writes into output_buffer under send_mutex
+
+	protected:
+		Client_Info client_info;
+		QMutex send_mutex;
+
+		bool awaiting_response = false; // A deferred response is outstanding, later requests wait
+		QByteArray output_buffer; // Every reply is written here, its capacity is reused
+		int messages_received = 0;
+		int messages_sent = 0;
+		QByteArray capture_buffer; // Copy of the reply being written, for the response cache
+		qsizetype capture_limit = -1; // -1 = not capturing
+		int capture_messages_sent = 0; // messages_sent when the capture began
+
+	public:
+		explicit Client_Session(const Client_Info& info, QObject* parent = nullptr);
+		~Client_Session() override = default;
+
+		bool send_message(const QString& message);
+		bool send_response(const Response& response);
+		virtual void complete_deferred_response(const Response& response) = 0;
+
+		// Response cache: copies the next reply as written, or writes a cached one as is
+		void begin_capture(qsizetype max_bytes);
+		bool end_capture(QByteArray& reply); // false unless exactly one whole reply was written
+		virtual bool send_cached(const QByteArray& reply) = 0;
+
+		const Client_Info& get_client_info() const;
+		void update_last_activity();
+		bool is_authenticated() const;
+		void set_authenticated(int user_id, const QString& username);
+		void clear_authentication();
+
+		int get_messages_received() const
+		{
+			return messages_received;
+		}
+
+		int get_messages_sent() const
+		{
+			return messages_sent;
+		}
+		qint64 get_idle_time() const;
+
+	protected:
+		// One request line, trimmed. False when the session should be closed
+		bool process_request(Protocol_Handler* protocol_handler, const QByteArray& message);
+
+		// Transport
+		virtual bool is_open() const = 0;
+		virtual bool write_output_locked() = 0; // output_buffer is a whole reply
+		virtual bool flush_output_locked() = 0; // output_buffer is the next part of a streamed reply
+		void capture_output_locked();
+
+		void send_error_response(const QString& error_message);
+		void send_success_response(const QString& data = "", const QString& message = "");
+	};
+}
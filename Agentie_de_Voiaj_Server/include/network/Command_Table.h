@@ -0,0 +1,131 @@
+#pragma once
+
+#include <QtCore/QChar>
+#include <QtCore/QStringView>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace SocketNetwork
+{
+	// One name a command is sent by, and the position of the command it names
+	struct Command_Name
+	{
+		std::string_view name;
+		int command = -1;
+	};
+
+	namespace Command_Hash
+	{
+		constexpr std::uint32_t FNV_OFFSET_BASIS = 2166136261u;
+		constexpr std::uint32_t FNV_PRIME = 16777619u;
+		constexpr std::uint32_t MAX_SEEDS = 1u << 16;
+
+		constexpr char16_t code_of(char c)
+		{
+			return static_cast<unsigned char>(c);
+		}
+
+		constexpr char16_t code_of(QChar c)
+		{
+			return c.unicode();
+		}
+
+		constexpr char16_t to_upper(char16_t c)
+		{
+			return (c >= u'a' && c <= u'z') ? static_cast<char16_t>(c - (u'a' - u'A')) : c;
+		}
+
+		// FNV-1a over the upper-cased code units, so "get_offers" finds GET_OFFERS
+		template <typename Text>
+		constexpr std::uint32_t hash_name(const Text& text, std::uint32_t seed)
+		{
+			std::uint32_t hash = FNV_OFFSET_BASIS ^ (seed * FNV_PRIME);
+			for (auto c : text)
+			{
+				hash ^= to_upper(code_of(c));
+				hash *= FNV_PRIME;
+			}
+			// The low bits pick the slot but only see the low bits of the input: fold the high ones in
+			return hash ^ (hash >> 16);
+		}
+
+		template <typename Text>
+		constexpr bool same_name(std::string_view name, const Text& text)
+		{
+			if (static_cast<std::size_t>(text.size()) != name.size())
+			{
+				return false;
+			}
+			for (std::size_t i = 0; i < name.size(); ++i)
+			{
+				if (to_upper(code_of(name[i])) != to_upper(code_of(text[i])))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	/**
+	 * Perfect hash of command names, built by the compiler. make_command_table()
+	 * tries hash seeds until every name lands in a slot of its own; valid stays
+	 * false when none does, which the caller turns into a static_assert. A
+	 * lookup is one hash of the received name, a mask and one comparison to
+	 * confirm the hit, however many commands there are, and is case-insensitive
+	 * without building an upper-cased copy.
+	 */
+	template <std::size_t NAME_COUNT, std::size_t SLOT_COUNT>
+	struct Command_Table
+	{
+		static_assert((SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "SLOT_COUNT must be a power of two");
+		static_assert(NAME_COUNT < SLOT_COUNT, "SLOT_COUNT must exceed the number of names");
+
+		std::array<Command_Name, NAME_COUNT> names{};
+		std::array<int, SLOT_COUNT> slots{}; // position in names + 1, 0 = free
+		std::uint32_t seed = 0;
+		bool valid = false;
+
+		// Position of the named command, -1 when no command has that name
+		int find(QStringView name) const
+		{
+			int entry = slots[Command_Hash::hash_name(name, seed) & (SLOT_COUNT - 1)] - 1;
+			if (entry < 0 || !Command_Hash::same_name(names[entry].name, name))
+			{
+				return -1;
+			}
+			return names[entry].command;
+		}
+	};
+
+	template <std::size_t SLOT_COUNT, std::size_t NAME_COUNT>
+	constexpr Command_Table<NAME_COUNT, SLOT_COUNT> make_command_table(const std::array<Command_Name, NAME_COUNT>& names)
+	{
+		for (std::uint32_t seed = 0; seed < Command_Hash::MAX_SEEDS; ++seed)
+		{
+			Command_Table<NAME_COUNT, SLOT_COUNT> table{};
+			table.names = names;
+			table.seed = seed;
+			table.valid = true;
+			for (std::size_t i = 0; i < NAME_COUNT && table.valid; ++i)
+			{
+				std::size_t slot = Command_Hash::hash_name(names[i].name, seed) & (SLOT_COUNT - 1);
+				if (table.slots[slot] != 0)
+				{
+					table.valid = false; // also what a name registered twice ends in
+				}
+				else
+				{
+					table.slots[slot] = static_cast<int>(i) + 1;
+				}
+			}
+			if (table.valid)
+			{
+				return table;
+			}
+		}
+		return Command_Table<NAME_COUNT, SLOT_COUNT>{};
+	}
+}
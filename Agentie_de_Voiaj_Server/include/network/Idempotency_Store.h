@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QHash>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QJsonObject>
+#include <list>
+
+#include "network/Network_Types.h"
+
+namespace SocketNetwork
+{
+	enum class Idempotency_Status
+	{
+		NEW,         // First time: run the request, then complete() or abandon() the key
+		REPLAY,      // Already done: answer with the stored response
+		IN_PROGRESS, // The original is still running (e.g. waiting for its group commit)
+		KEY_REUSED   // Same key, different request
+	};
+
+	/**
+	 * Results of recent mutating requests (BOOK_OFFER, CANCEL_RESERVATION) keyed by
+	 * user and the client's idempotency key, so a retried request is answered from
+	 * here instead of running again. Only successful results are kept: a failed
+	 * request changed nothing and may simply run again. Bounded to max_entries
+	 * (least recently used first out) and each key expires ttl_ms after it was
+	 * completed. With a journal path, completed keys are appended to a JSON lines
+	 * file and reloaded by open().
+	 */
+	class Idempotency_Store
+	{
+	private:
+		struct Entry
+		{
+			QString key;
+			QByteArray fingerprint; // hash of the request, detects a reused key
+			bool completed = false;
+			Response response;
+			qint64 expires_at_ms = 0; // 0 while in progress
+		};
+
+		std::list<Entry> entries; // most recently used first
+		QHash<QString, std::list<Entry>::iterator> index;
+		int max_entries;
+		qint64 ttl_ms;
+
+		QString journal_path;
+		QFile journal;
+		int journal_records = 0;
+		mutable QMutex mutex;
+
+	public:
+		Idempotency_Store(int max_entries, qint64 ttl_ms, const QString& journal_path = QString());
+		~Idempotency_Store();
+
+		bool open();
+
+		Idempotency_Status begin(const QString& key, const QByteArray& fingerprint, Response& stored_response);
+		void complete(const QString& key, const Response& response);
+		void abandon(const QString& key);
+		int size() const;
+
+		static QString make_key(int user_id, const QString& idempotency_key);
+		static QByteArray make_fingerprint(const QString& command, const QJsonObject& request);
+
+	private:
+		void remove_locked(std::list<Entry>::iterator it);
+		void evict_locked();
+		bool append_record_locked(const Entry& entry);
+		bool compact_locked();
+		static QByteArray to_line(const Entry& entry);
+	};
+}
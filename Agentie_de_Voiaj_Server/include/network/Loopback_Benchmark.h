@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <memory>
+
+#include "database/Database_Manager.h"
+
+namespace SocketNetwork
+{
+	struct Benchmark_Stats
+	{
+		int sessions = 0;
+		qint64 requests = 0;
+		qint64 failed_requests = 0; // success false, or no reply before the timeout
+		qint64 reply_bytes = 0;
+		qint64 elapsed_ms = 0;
+		qreal requests_per_second = 0.0;
+		qint64 p50_us = 0; // request written to reply read
+		qint64 p99_us = 0;
+		qint64 max_us = 0;
+		qreal allocations_per_request = 0.0; // 0 unless allocation counting is enabled
+
+		QString to_string() const;
+	};
+
+	/**
+	 * Drives the protocol stack, parse, dispatch, database and serialize,
+	 * through Loopback_Sessions instead of sockets, so handler cost can be
+	 * measured without the kernel's networking in it. Requests are sent round
+	 * robin, one at a time: session s sends line (s + round) of the script,
+	 * waits for its reply, then the next session goes. The same script,
+	 * session count and data give the same sequence of requests every run.
+	 */
+	class Loopback_Benchmark
+	{
+	private:
+		std::shared_ptr<Database::Database_Manager> db_manager;
+
+	public:
+		explicit Loopback_Benchmark(std::shared_ptr<Database::Database_Manager> db_manager);
+
+		Benchmark_Stats run(int session_count, int requests_per_session, const QList<QByteArray>& script);
+
+		// One JSON request per line, blank lines and lines starting with # skipped
+		static bool load_script(const QString& path, QList<QByteArray>& script, QString& error);
+		static QList<QByteArray> get_default_script(); // anonymous listings and searches
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+
+#include "network/Client_Session.h"
+
+namespace SocketNetwork
+{
+	/**
+	 * A Client_Session whose transport is two byte buffers in the same
+	 * process. write() plays the client sending bytes: every complete line
+	 * goes through process_request() at once, on the calling thread, as
+	 * Client_Handler::handle_ready_read() would run it. Replies are framed
+	 * exactly as on a socket and collected for read_reply().
+	 *
+	 * Replies that are deferred (group commit, bulk import) complete from the
+	 * event loop; wait_for_reply() runs it until one is there. Lines written
+	 * meanwhile wait, as they do on a socket.
+	 */
+	class Loopback_Session : public Client_Session
+	{
+		Q_OBJECT
+
+	private:
+		Protocol_Handler* protocol_handler;
+		QByteArray input;    // bytes written by the client, not yet a whole line
+		QByteArray received; // reply bytes not yet read by the client
+		qint64 bytes_received = 0;
+		bool is_closed = false;
+
+	public:
+		Loopback_Session(const Client_Info& info, Protocol_Handler* protocol_handler, QObject* parent = nullptr);
+		~Loopback_Session() override = default;
+
+		// Client side
+		void write(const QByteArray& data);
+		bool can_read_reply() const;
+		QByteArray read_reply(); // next reply line, without \r\n; empty when there is none
+		bool wait_for_reply(int timeout_ms);
+		void close();
+
+		qint64 get_bytes_received() const
+		{
+			return bytes_received;
+		}
+
+		void complete_deferred_response(const Response& response) override;
+		bool send_cached(const QByteArray& reply) override;
+
+	signals:
+		void replyReady();
+
+	protected:
+		bool is_open() const override;
+		bool write_output_locked() override;
+		bool flush_output_locked() override;
+
+	private slots:
+		void process_input();
+	};
+}
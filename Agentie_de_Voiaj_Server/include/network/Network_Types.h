@@ -1,11 +1,12 @@
 #pragma once
 
 #include <QtCore/QString>
+#include <QtCore/QByteArray>
 #include <QtCore/QDateTime>
 #include <QtNetwork/QHostAddress>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
-#include <QtNetwork/QTcpSocket>
+#include <QtCore/QIODevice>
 #include <functional>
 
 #include "config.h"
@@ -18,6 +19,8 @@ namespace SocketNetwork
 		QString ip_address = "127.0.0.1";
 		int port = Config::Server::PORT;
 		int max_clients = Config::Server::MAX_CONNECTIONS;
+		QString local_server_name = Config::Server::LOCAL_SERVER_NAME; // empty = TCP only
+		int max_local_clients = Config::Server::MAX_LOCAL_CONNECTIONS;
 		int receive_timeout_ms = Config::Server::SOCKET_TIMEOUT_MS;
 		int send_timeout_ms = Config::Server::SOCKET_TIMEOUT_MS;
 		int keep_alive_interval_ms = 60000;
@@ -32,20 +35,21 @@ namespace SocketNetwork
 
 	struct Client_Info
 	{
-		QTcpSocket* socket;
+		QIODevice* socket; // QTcpSocket, or QLocalSocket when is_local
 		QString ip_address;
 		int port;
+		bool is_local = false; // came in through the local server
 		QString connection_time;
-		QString last_activity_time;
+		qint64 last_activity_ms = 0;
 		bool is_authenticated = false;
 		int user_id = 0;
 		QString username;
 
-		Client_Info(QTcpSocket* s, const QString& ip, int p)
+		Client_Info(QIODevice* s, const QString& ip, int p)
 			: socket(s), ip_address(ip), port(p)
 		{
 			connection_time = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
-			last_activity_time = connection_time;
+			last_activity_ms = QDateTime::currentMSecsSinceEpoch();
 		}
 	};
 
@@ -59,30 +63,38 @@ namespace SocketNetwork
 		QString start_time;
 		qreal average_response_time_ms;
 		int memory_usage_mb;
+		qreal allocations_per_request = -1.0; // -1 unless built with AGENTIE_COUNT_ALLOCATIONS
 	};
 
+	// The values are also the opcodes a client may send as "op" instead of a command name: never renumber
 	enum class Message_Type
 	{
-		AUTHENTICATION,
-		REGISTRATION,
-		GET_DESTINATIONS,
-		GET_OFFERS,
-		SEARCH_OFFERS,
-		BOOK_OFFER,
-		GET_USER_RESERVATIONS,
-		CANCEL_RESERVATION,
-		GET_USER_INFO,
-		UPDATE_USER_INFO,
-		// Admin message types reserved for future implementation
-		KEEPALIVE,
-		ERR,
-		UNKNOWN
+		UNKNOWN = 0,
+		AUTHENTICATION = 1,
+		REGISTRATION = 2,
+		GET_DESTINATIONS = 3,
+		GET_OFFERS = 4,
+		SEARCH_OFFERS = 5,
+		BOOK_OFFER = 6,
+		GET_USER_RESERVATIONS = 7,
+		CANCEL_RESERVATION = 8,
+		GET_USER_INFO = 9,
+		UPDATE_USER_INFO = 10,
+		RESUME_SESSION = 11,
+		GET_OFFER_DETAILS = 12,
+		LOGOUT = 13,
+		// Admin message types
+		BULK_IMPORT = 32,
+		CHECK_STATISTICS = 33,
+		GET_QUERY_STATS = 34,
+		KEEPALIVE = 48,
+		ERR = 49
 	};
 
 	struct Parsed_Message
 	{
 		Message_Type type;
-		QString raw_message;
+		QByteArray raw_message; // UTF-8 line as received, shared with the read buffer
 		QJsonObject json_data; // Store parsed JSON data
 		bool is_valid = false;
 		QString error_message;
@@ -96,22 +108,24 @@ namespace SocketNetwork
 	{
 		bool success = false;
 		QString message;
-		QString data; // JSON data
+		QByteArray data; // UTF-8 JSON, written into the reply as is
 		int error_code = 0;
+		bool deferred = false; // Sent later by the handler that completes it (group commit)
+		bool streamed = false; // Already written to the client by a Response_Stream
 
-		Response(bool s = false, const QString& msg = "", const QString& d = "")
+		Response(bool s = false, const QString& msg = "", const QByteArray& d = QByteArray())
 			: success(s), message(msg), data(d)
 		{
 		}
 		
-		Response(bool s, const QString& msg, const QString& d, int code)
+		Response(bool s, const QString& msg, const QByteArray& d, int code)
 			: success(s), message(msg), data(d), error_code(code)
 		{
 		}
 	};
 
 	// SocketRAII is no longer needed with Qt's automatic resource management
-	// QTcpSocket handles resource cleanup automatically
+	// QTcpSocket/QLocalSocket handle resource cleanup automatically
 
 	// Forward declarations
 	class Socket_Server;
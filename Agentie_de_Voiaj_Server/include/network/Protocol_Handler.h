@@ -3,15 +3,26 @@
 #include <QtCore/QString>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
+#include <QtCore/QPointer>
 #include <memory>
+#include <optional>
+#include <string_view>
 
 #include "network/Network_Types.h"
 #include "database/Database_Manager.h"
+#include "database/Group_Commit.h"
+#include "database/Bulk_Importer.h"
+#include "network/Idempotency_Store.h"
+#include "network/Session_Store.h"
+#include "network/Response_Cache.h"
 
 // Forward declarations
 namespace SocketNetwork
 {
-	class Client_Handler;
+	class Client_Session;
+	class Response_Stream;
+	struct Command_Registry;
 }
 
 namespace SocketNetwork
@@ -20,45 +31,111 @@ namespace SocketNetwork
 	{
 	private:
 		std::shared_ptr<Database::Database_Manager> db_manager;
+		std::unique_ptr<Database::Group_Commit> group_commit; // null when disabled or in demo mode
+		std::unique_ptr<Idempotency_Store> idempotency_store; // null when idempotency keys are disabled
+		std::shared_ptr<Session_Store> session_store; // null when session resume is disabled; shared with db_manager's revocation hook
+		std::unique_ptr<Response_Cache> response_cache; // null when the response cache is disabled
+		std::shared_ptr<Database::Bulk_Importer> active_import; // one BULK_IMPORT at a time
+		std::unique_ptr<QTimer> import_timer; // drives active_import a chunk per event loop turn
 
 	public:
 		explicit Protocol_Handler(std::shared_ptr<Database::Database_Manager> db_manager);
+		~Protocol_Handler();
 
-		Parsed_Message parse_message(const QString& json_message);
-		Message_Type get_message_type(const QJsonObject& json_obj);
+		const Database::Group_Commit* get_group_commit() const;
+
+		Parsed_Message parse_message(const QByteArray& json_message); // one UTF-8 line
+		Message_Type get_message_type(const QJsonObject& json_obj); // "op", else "type" or "command"
 		QString message_type_to_string(Message_Type type);
 
-		Response process_message(const Parsed_Message& parsed_message, SocketNetwork::Client_Handler* client_handler);
+		Response process_message(const Parsed_Message& parsed_message, SocketNetwork::Client_Session* session);
 		QString create_response(bool success, const QString& message = "",
 			const QJsonValue& data = QJsonValue(), int error_code = 0);
 		// Note: Use Utils::JSON::create_error_response and Utils::JSON::create_success_response
 		// Note: Use Config::ErrorMessages and Config::SuccessMessages constants in implementation
 
-		Response handle_authentication(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_registration(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_get_destinations(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_get_offers(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_search_offers(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_book_offer(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_get_user_reservations(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_cancel_reservation(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_get_user_info(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_update_user_info(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		Response handle_keepalive(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
+		// Reached through dispatch(), which has already checked access and required fields
+		Response handle_authentication(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_registration(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_get_destinations(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_get_offers(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_search_offers(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_get_offer_details(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_book_offer(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_get_user_reservations(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_cancel_reservation(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_get_user_info(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_update_user_info(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_keepalive(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_resume_session(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_logout(const Parsed_Message& message, SocketNetwork::Client_Session* client);
 
 		// Admin functions not implemented for college project scope
-		// Response handle_admin_get_stats(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		// Response handle_admin_get_users(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
-		// Response handle_admin_manage_offers(const Parsed_Message& message, SocketNetwork::Client_Handler* client);
+		// Response handle_admin_get_stats(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		// Response handle_admin_get_users(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		// Response handle_admin_manage_offers(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_admin_bulk_import(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_admin_check_statistics(const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response handle_admin_get_query_stats(const Parsed_Message& message, SocketNetwork::Client_Session* client);
 
 		// bool validate_required_parameters(const Parsed_Message& message,  // Removed - not needed with JSON
 		//	const std::vector<std::string>& required_params,
 		//	std::string& error_message);
-		bool is_user_admin(int user_id);  // Keep for potential future use
+		bool is_user_admin(int user_id);
 		// Note: Use Config::Business and Config::Security constants for validation limits
 
 
 	private:
+		// Group commit: queues the operation and answers the client when its batch commits
+		Response defer_to_group_commit(const Database::Batch_Operation& operation,
+			SocketNetwork::Client_Session* client, const QString& success_message,
+			const QString& idempotency_key = QString());
+
+		// Idempotency keys: a retried mutating request is answered with the stored result
+		using Message_Handler = Response (Protocol_Handler::*)(const Parsed_Message&, SocketNetwork::Client_Session*);
+		Response handle_idempotent(const Parsed_Message& message, SocketNetwork::Client_Session* client,
+			Message_Handler handler);
+		QString get_idempotency_key(const Parsed_Message& message, SocketNetwork::Client_Session* client) const;
+		static void record_idempotent_result(Idempotency_Store* store, const QString& key, const Response& response);
+
+		// Command registry: one entry per message type, listed in Command_Registry in Protocol_Handler.cpp
+		enum class Access
+		{
+			ANYONE,
+			USER,  // authenticated
+			ADMIN  // authenticated and Users.Is_Admin set
+		};
+
+		struct Command
+		{
+			Message_Type type;
+			std::string_view label;    // message_type_to_string(), part of idempotency fingerprints
+			std::string_view names;    // accepted as "type" or "command", space separated
+			Message_Handler handler;   // null = known, not served
+			Access access;
+			bool idempotent;           // retries with the same idempotency_key get the stored reply
+			std::optional<Database::Listing> cached; // read-only, the reply bytes are kept in response_cache while this listing's data version holds
+			std::string_view required; // fields the JSON must contain, space separated
+		};
+
+		friend struct Command_Registry;
+		static const Command* find_command(Message_Type type);
+		Response dispatch(const Command& command, const Parsed_Message& message, SocketNetwork::Client_Session* client);
+		Response dispatch_cached(const Command& command, const Parsed_Message& message, SocketNetwork::Client_Session* client);
+
+		// Bulk import: runs one chunk, answers the admin once the last one is in
+		void continue_bulk_import(QPointer<SocketNetwork::Client_Session> target);
+
+		// Keyset pagination: limit and after of a listing request, next_page of its reply
+		int read_page_request(const Parsed_Message& message, bool datetime_key, Database::Listing_Request& request) const; // -1 = bad token
+		Response finish_page(Response_Stream& stream, const Database::Query_Result& result, const QString& message_text) const;
+		static QString encode_page_token(const QVariant& key, int id);
+		static bool decode_page_token(const QString& token, bool datetime_key, Database::Listing_Request& request);
+
+		// Field projection: the columns a listing request asked for, always with its key columns
+		static QString read_fields(const Parsed_Message& message, Database::Listing listing,
+			const QStringList& key_fields, Database::Listing_Request& request); // error text, empty = valid
+
 		// JSON utilities
 		QJsonArray vector_to_json(const QList<QHash<QString, QVariant>>& data);
 		// Helper for converting query results to JSON
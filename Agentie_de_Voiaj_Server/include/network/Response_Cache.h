@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <list>
+#include <string_view>
+
+namespace SocketNetwork
+{
+	/**
+	 * Serialized replies of read-only listing commands, keyed by command and
+	 * normalized parameters (make_key()) and valid for one data version of
+	 * the listing it was built from, Database_Manager::get_data_version(). Each
+	 * entry keeps its own version, so a write to the offers leaves cached
+	 * destination listings in place. An entry is the reply line exactly
+	 * as written to the socket, plain and zlib-compressed, so serving it is a
+	 * socket write: QByteArray is implicitly shared, every connection sends the
+	 * same bytes without copying them.
+	 *
+	 * A lookup with a newer version than the entry's drops it, a store with an
+	 * older one than the entry's (the data changed while the reply was built)
+	 * is ignored.
+	 * Entries also end after ttl_ms, for rows written outside the server, and
+	 * at midnight, since offer listings hide past departures. Bounded to
+	 * max_entries, least recently used first out.
+	 */
+	class Response_Cache
+	{
+	private:
+		struct Entry
+		{
+			QByteArray key;
+			QByteArray plain;      // reply line, \r\n included
+			QByteArray compressed; // {"encoding":"zlib","payload":...}\r\n, = plain when small
+			quint64 data_version = 0;
+			qint64 expires_at_ms = 0;
+		};
+
+		std::list<Entry> entries; // most recently used first
+		QHash<QByteArray, std::list<Entry>::iterator> index;
+		int max_entries;
+		qint64 ttl_ms;
+		int compress_min_bytes;
+		mutable QMutex mutex;
+
+	public:
+		Response_Cache(int max_entries, qint64 ttl_ms, int compress_min_bytes);
+
+		bool find(const QByteArray& key, quint64 data_version, bool compressed, QByteArray& reply);
+		void store(const QByteArray& key, quint64 data_version, const QByteArray& reply);
+		void clear();
+		int size() const;
+
+		static QByteArray make_key(std::string_view label, const QJsonObject& params);
+		static QByteArray compress_reply(const QByteArray& reply);
+	};
+}
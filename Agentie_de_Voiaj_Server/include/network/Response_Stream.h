@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QVariant>
+#include <QtCore/QMutex>
+#include <QtSql/QSqlQuery>
+
+#include "network/Network_Types.h"
+
+namespace SocketNetwork
+{
+	class Client_Session;
+
+	/**
+	 * Writes a listing reply while its rows are still being read. The opening
+	 * {"data":[ goes out first, each row is serialized into the client's output
+	 * buffer as it arrives and the buffer is handed to the socket every
+	 * Config::Server::STREAM_CHUNK_BYTES, so the reply never exists whole in
+	 * memory. finish() closes the array and writes message and success after
+	 * it: a query failing half way still ends as a well-formed reply, with
+	 * success false.
+	 *
+	 * Row keys are written in the order QJsonObject sorts them, so the bytes
+	 * match the replies built with vector_to_json(). All rows of one stream
+	 * must have the same columns. The client's send mutex is held from
+	 * construction until finish(), no other reply can be interleaved.
+	 *
+	 * With set_page() the stream takes at most max_rows rows and stops before
+	 * the one that would push the reply past max_bytes; is_page_full() then
+	 * tells that rows were left out, and the key and id of the last row
+	 * written are where the next page starts.
+	 *
+	 * With set_fields() only the named columns of each row are written, for
+	 * rows that come whole from the offer catalog or the demo data.
+	 */
+	class Response_Stream
+	{
+	private:
+		struct Column
+		{
+			QString name;
+			int index = 0;  // position in the SELECT list
+			QByteArray key; // "Name":
+		};
+
+		Client_Session* client;
+		QMutexLocker<QMutex> locker;
+		QList<Column> columns; // taken from the first row
+		QStringList fields;    // empty = every column
+		int row_count = 0;
+		bool failed = false; // the client went away, later rows are dropped
+		bool finished = false;
+
+		int max_rows = -1;    // -1 = no page
+		qint64 max_bytes = -1;
+		qint64 bytes_flushed = 0;
+		qsizetype row_start = 0; // where the row being written starts in the output buffer
+		QString key_column;
+		QString id_column;
+		int key_index = -1;   // positions in the SELECT list, -1 when missing
+		int id_index = -1;
+		QVariant last_key;
+		int last_id = 0;
+		bool page_full = false;
+
+	public:
+		explicit Response_Stream(Client_Session* client);
+		~Response_Stream();
+
+		void set_page(int max_rows, qint64 max_bytes, const QString& key_column, const QString& id_column);
+		void set_fields(const QStringList& fields);
+
+		bool append_row(const QSqlQuery& row);
+		bool append_row(const QHash<QString, QVariant>& row);
+		Response finish(bool success, const QString& message, const QString& next_page = QString());
+
+		int get_row_count() const;
+		bool is_page_full() const;
+		QVariant get_last_key() const;
+		int get_last_id() const;
+
+	private:
+		bool begin_row();
+		void set_columns(const QStringList& names);
+		bool end_row(const QVariant& key, const QVariant& id);
+	};
+}
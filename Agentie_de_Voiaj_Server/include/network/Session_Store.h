@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <atomic>
+#include <memory>
+
+namespace SocketNetwork
+{
+	struct Session
+	{
+		int user_id = 0;
+		QString username;
+		QString ip_address;      // where the session was opened by AUTH
+		qint64 created_at_ms = 0;
+		qint64 expires_at_ms = 0;
+	};
+
+	/**
+	 * Sessions opened by AUTH, keyed by the SHA-256 of the token the client got
+	 * back, so RESUME_SESSION restores authentication on a new socket without
+	 * touching the database. The table is split into shards, each behind its own
+	 * mutex, so clients reconnecting together after a restart do not queue on
+	 * one lock. A session ends ttl_ms after it was opened.
+	 *
+	 * With a journal path, sessions are appended to a JSON lines file as they
+	 * open and close and reloaded by open(). Only token hashes are written: the
+	 * file does not let anyone resume a session.
+	 */
+	class Session_Store
+	{
+	private:
+		struct Shard
+		{
+			QHash<QByteArray, Session> sessions;
+			QMutex mutex;
+		};
+
+		std::unique_ptr<Shard[]> shards;
+		int shard_count;
+		qint64 ttl_ms;
+		std::atomic<int> opened_since_purge{ 0 };
+
+		QString journal_path;
+		QFile journal;
+		int journal_records = 0;
+		QMutex journal_mutex; // never taken while a shard mutex is held
+
+	public:
+		Session_Store(int shard_count, qint64 ttl_ms, const QString& journal_path = QString());
+		~Session_Store();
+
+		bool open();
+
+		QString create(int user_id, const QString& username, const QString& ip_address);
+		bool resume(const QString& token, Session& session);
+		bool revoke(const QString& token, int user_id); // only a session of user_id is closed
+		int revoke_user(int user_id); // every session of the user, after a password change or deletion
+		int purge_expired();
+		int size() const;
+
+		static QByteArray hash_token(const QString& token);
+
+	private:
+		Shard& get_shard(const QByteArray& token_hash) const;
+		void append_record(const QByteArray& token_hash, const Session* session); // null = closed
+		bool compact();
+		static QByteArray to_line(const QByteArray& token_hash, const Session* session);
+	};
+}
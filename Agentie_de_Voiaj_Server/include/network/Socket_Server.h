@@ -3,6 +3,8 @@
 #include <QtCore/QObject>
 #include <QtNetwork/QTcpServer>
 #include <QtNetwork/QTcpSocket>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
 #include <QtCore/QThread>
 #include <QtCore/QMutex>
 #include <QtCore/QHash>
@@ -12,6 +14,7 @@
 
 #include "network/Network_Types.h"
 #include "database/Database_Manager.h"
+#include "database/Group_Commit.h"
 
 // Forward declarations
 class Protocol_Handler;
@@ -29,6 +32,7 @@ namespace SocketNetwork
 
 	private:
 		QTcpServer* tcp_server;
+		QLocalServer* local_server; // null when config.local_server_name is empty
 		Server_Config config;
 		std::shared_ptr<Database::Database_Manager> db_manager;
 		std::unique_ptr<Protocol_Handler> protocol_handler;
@@ -38,14 +42,17 @@ namespace SocketNetwork
 		QThread* accept_thread;
 		QTimer* cleanup_timer;
 
-		QHash<QTcpSocket*, std::shared_ptr<Client_Handler>> active_clients;
+		QHash<QIODevice*, std::shared_ptr<Client_Handler>> active_clients;
 		QMutex clients_mutex;
 		QMutex protocol_handler_mutex;
-		int client_count;
+		int client_count; // TCP clients, limited by config.max_clients
+		int local_client_count = 0; // local server clients, limited by config.max_local_clients
 
 		int total_connections;
 		int total_messages_received;
 		int total_messages_sent;
+		qint64 total_requests = 0; // counted only with AGENTIE_COUNT_ALLOCATIONS
+		qint64 total_request_allocations = 0;
 		QString server_start_time;
 
 	public:
@@ -61,9 +68,11 @@ namespace SocketNetwork
 		bool is_server_running() const;
 		int get_active_client_count() const;
 		QString get_server_address() const;
-		void send_message_to_client(QTcpSocket* client_socket, const QString& message);
+		void send_message_to_client(QIODevice* client_socket, const QString& message);
 
 		Server_Stats get_server_stats() const;
+		void record_request_allocations(quint64 allocations);
+		Database::Group_Commit_Stats get_group_commit_stats() const;
 		void reset_server_stats();
 
 	signals:
@@ -77,13 +86,16 @@ namespace SocketNetwork
 
 	private slots:
 		void handle_new_connection();
+		void handle_new_local_connection();
 		void handle_client_disconnected();
 		void cleanup_inactive_clients();
 
 	public:
-		void remove_client(QTcpSocket* client_socket);
+		void remove_client(QIODevice* client_socket);
 
 	private:
-		// Additional private methods can be added here if needed
+		void configure_socket(QTcpSocket* socket) const;
+		void add_client(QIODevice* socket, const Client_Info& client_info);
+		void count_removed_client(const Client_Handler& client_handler); // clients_mutex held
 	};
 }
\ No newline at end of file
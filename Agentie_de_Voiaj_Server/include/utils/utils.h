@@ -2,6 +2,7 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QDateTime>
+#include <QtCore/QVariant>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
@@ -134,6 +135,12 @@ namespace Utils
 		QString escape_json(const QString& input);
 		QString create_error_response(const QString& error_message, int error_code = -1);
 		QString create_success_response(const QString& data = QString(), const QString& message = "");
+
+		// Reply envelopes written straight into a reused UTF-8 buffer, same bytes as create_*_response
+		void append_string(QByteArray& out, QStringView text);
+		void append_value(QByteArray& out, const QVariant& value); // as QJsonValue::fromVariant would write it
+		void append_success_response(QByteArray& out, const QByteArray& data, const QString& message = QString());
+		void append_error_response(QByteArray& out, const QString& error_message, int error_code = -1);
 		QString format_json(const QString& json_str);
 	}
 
@@ -153,6 +160,10 @@ namespace Utils
 		qint64 get_available_memory_MB();
 		void log_memory_usage(const QString& context = "");
 		void log_system_info();
+
+		// Heap allocations made by the calling thread, counted only in builds with AGENTIE_COUNT_ALLOCATIONS
+		bool is_allocation_counting_enabled();
+		quint64 get_thread_allocation_count();
 	}
 
 	// Performance Utilities
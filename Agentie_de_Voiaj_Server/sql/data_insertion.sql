@@ -33,6 +33,9 @@ INSERT INTO Users (Username, Password_Hash, Password_Salt, Email, First_Name, La
 ('sarah_wilson', 'hashed_pass_4', 'sarah', 'sarah.wilson@outlook.com', 'Sarah', 'Wilson', '0724444444'),
 ('test_user', 'hashed_test_pass', 'test', 'test@test.com', 'Test', 'User', '0725555555');
 
+-- The seeded administrator; registering the name "admin" does not make anyone one
+UPDATE Users SET Is_Admin = 1 WHERE Username = 'admin';
+
 -- ======================================
 -- 2. DESTINATIONS
 -- ======================================
@@ -205,6 +205,7 @@ CREATE TABLE [dbo].[Users](
 	[First_Name] [varchar](50) NULL,
 	[Last_Name] [varchar](50) NULL,
 	[Phone] [varchar](15) NULL,
+	[Is_Admin] [int] NOT NULL,
 	[Date_Created] [datetime] NULL,
 	[Date_Modified] [datetime] NULL,
 PRIMARY KEY CLUSTERED 
@@ -363,6 +364,8 @@ ALTER TABLE [dbo].[Types_of_Transport] ADD  DEFAULT (getdate()) FOR [Date_Create
 GO
 ALTER TABLE [dbo].[Types_of_Transport] ADD  DEFAULT (getdate()) FOR [Date_Modified]
 GO
+ALTER TABLE [dbo].[Users] ADD  DEFAULT ((0)) FOR [Is_Admin]
+GO
 ALTER TABLE [dbo].[Users] ADD  DEFAULT (getdate()) FOR [Date_Created]
 GO
 ALTER TABLE [dbo].[Users] ADD  DEFAULT (getdate()) FOR [Date_Modified]
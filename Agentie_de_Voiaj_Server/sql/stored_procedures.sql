@@ -21,4 +21,144 @@ BEGIN
     GROUP BY d.Destination_ID, d.Name
     ORDER BY Total_Reservations DESC
 END
-GO
\ No newline at end of file
+GO
+
+----------------------------------------------------------------------------------
+
+IF EXISTS (
+    SELECT 1
+    FROM sys.objects
+    WHERE object_id = OBJECT_ID(N'sp_Book_Offer')
+      AND type = 'P'
+)
+    DROP PROCEDURE sp_Book_Offer;
+GO
+
+-- Books an offer in one call: conditional seat update, reservation insert and
+-- optional traveller rows, all in one transaction.
+-- @Persons is a JSON array of {"full_name", "cnp", "birth_date", "person_type"}
+-- (QODBC cannot bind table-valued parameters). Requires SQL Server 2016+.
+-- @Result_Code: 0 = booked, 1 = offer not found or not active, 2 = not enough seats
+CREATE PROCEDURE sp_Book_Offer
+    @User_ID INT,
+    @Offer_ID INT,
+    @Number_of_Persons INT,
+    @Persons NVARCHAR(MAX) = NULL,
+    @Reservation_ID INT OUTPUT,
+    @Total_Price DECIMAL(10,2) OUTPUT,
+    @Result_Code INT OUTPUT
+AS
+BEGIN
+    SET NOCOUNT ON;
+    SET XACT_ABORT ON;
+
+    SET @Reservation_ID = NULL;
+    SET @Total_Price = NULL;
+
+    DECLARE @Updated TABLE (Price_per_Person DECIMAL(10,2));
+
+    BEGIN TRANSACTION;
+
+    UPDATE Offers
+    SET Reserved_Seats = Reserved_Seats + @Number_of_Persons
+    OUTPUT inserted.Price_per_Person INTO @Updated
+    WHERE Offer_ID = @Offer_ID
+      AND Status = 'active'
+      AND Reserved_Seats + @Number_of_Persons <= Total_Seats;
+
+    IF NOT EXISTS (SELECT 1 FROM @Updated)
+    BEGIN
+        ROLLBACK TRANSACTION;
+        SET @Result_Code = CASE WHEN EXISTS (SELECT 1 FROM Offers WHERE Offer_ID = @Offer_ID AND Status = 'active')
+                                THEN 2 ELSE 1 END;
+        RETURN;
+    END
+
+    SELECT @Total_Price = Price_per_Person * @Number_of_Persons FROM @Updated;
+
+    INSERT INTO Reservations (User_ID, Offer_ID, Number_of_Persons, Total_Price, Status)
+    VALUES (@User_ID, @Offer_ID, @Number_of_Persons, @Total_Price, 'pending');
+
+    SET @Reservation_ID = SCOPE_IDENTITY();
+
+    IF @Persons IS NOT NULL
+        INSERT INTO Reservation_Persons (Reservation_ID, Full_Name, CNP, Birth_Date, Person_Type)
+        SELECT @Reservation_ID, p.Full_Name, p.CNP, p.Birth_Date, p.Person_Type
+        FROM OPENJSON(@Persons)
+        WITH (
+            Full_Name VARCHAR(100) '$.full_name',
+            CNP VARCHAR(15) '$.cnp',
+            Birth_Date DATE '$.birth_date',
+            Person_Type VARCHAR(20) '$.person_type'
+        ) p;
+
+    COMMIT TRANSACTION;
+    SET @Result_Code = 0;
+END
+GO
+
+----------------------------------------------------------------------------------
+
+IF EXISTS (
+    SELECT 1
+    FROM sys.objects
+    WHERE object_id = OBJECT_ID(N'sp_Cancel_Reservation')
+      AND type = 'P'
+)
+    DROP PROCEDURE sp_Cancel_Reservation;
+GO
+
+-- Cancels a reservation and frees its seats in one call, returning what was freed
+-- and the status, price and date it had (the server's statistics and revenue rollup follow it).
+-- @Result_Code: 0 = cancelled, 1 = reservation not found, 2 = already cancelled
+CREATE PROCEDURE sp_Cancel_Reservation
+    @Reservation_ID INT,
+    @Offer_ID INT OUTPUT,
+    @Number_of_Persons INT OUTPUT,
+    @Previous_Status VARCHAR(20) OUTPUT,
+    @Total_Price DECIMAL(10,2) OUTPUT,
+    @Reservation_Date DATETIME OUTPUT,
+    @Result_Code INT OUTPUT
+AS
+BEGIN
+    SET NOCOUNT ON;
+    SET XACT_ABORT ON;
+
+    SET @Offer_ID = NULL;
+    SET @Number_of_Persons = NULL;
+    SET @Previous_Status = NULL;
+    SET @Total_Price = NULL;
+    SET @Reservation_Date = NULL;
+
+    DECLARE @Cancelled TABLE (Offer_ID INT, Number_of_Persons INT, Previous_Status VARCHAR(20), Total_Price DECIMAL(10,2),
+                              Reservation_Date DATETIME);
+
+    BEGIN TRANSACTION;
+
+    UPDATE Reservations
+    SET Status = 'cancelled'
+    OUTPUT inserted.Offer_ID, inserted.Number_of_Persons, deleted.Status, inserted.Total_Price, inserted.Reservation_Date
+    INTO @Cancelled
+    WHERE Reservation_ID = @Reservation_ID
+      AND Status <> 'cancelled';
+
+    IF NOT EXISTS (SELECT 1 FROM @Cancelled)
+    BEGIN
+        ROLLBACK TRANSACTION;
+        SET @Result_Code = CASE WHEN EXISTS (SELECT 1 FROM Reservations WHERE Reservation_ID = @Reservation_ID)
+                                THEN 2 ELSE 1 END;
+        RETURN;
+    END
+
+    SELECT @Offer_ID = Offer_ID, @Number_of_Persons = Number_of_Persons,
+           @Previous_Status = Previous_Status, @Total_Price = Total_Price, @Reservation_Date = Reservation_Date
+    FROM @Cancelled;
+
+    UPDATE Offers
+    SET Reserved_Seats = Reserved_Seats - @Number_of_Persons
+    WHERE Offer_ID = @Offer_ID;
+
+    COMMIT TRANSACTION;
+    SET @Result_Code = 0;
+END
+GO
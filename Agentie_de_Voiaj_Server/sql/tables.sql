@@ -16,6 +16,7 @@ CREATE TABLE dbo.Users
     First_Name VARCHAR(50),
     Last_Name VARCHAR(50),
     Phone VARCHAR(15),
+    Is_Admin INT NOT NULL DEFAULT 0,
     Date_Created DATETIME DEFAULT GETDATE(),
     Date_Modified DATETIME DEFAULT GETDATE()
 );
@@ -193,4 +194,75 @@ CREATE TABLE dbo.Reservation_Persons
         CNP VARCHAR(15) NOT NULL,
         Birth_Date DATE NOT NULL,
         Person_Type VARCHAR(20) NOT NULL
-    );
\ No newline at end of file
+    );
+-------------------------------------------------------------------------------
+
+IF EXISTS (
+    SELECT 1
+    FROM sys.objects
+    WHERE object_id = OBJECT_ID(N'dbo.Write_Behind_Applied')
+      AND type = 'U'
+)
+    DROP TABLE dbo.Write_Behind_Applied;
+
+-- Bookings persisted by the server's write-behind queue, keyed by journal token
+CREATE TABLE dbo.Write_Behind_Applied
+    (
+        Token VARCHAR(64) PRIMARY KEY,
+        Reservation_ID INT NOT NULL,
+        Applied_At DATETIME DEFAULT GETDATE()
+    );
+-------------------------------------------------------------------------------
+
+IF EXISTS (
+    SELECT 1
+    FROM sys.objects
+    WHERE object_id = OBJECT_ID(N'dbo.Booking_Statistics_Snapshot')
+      AND type = 'U'
+)
+    DROP TABLE dbo.Booking_Statistics_Snapshot;
+
+-- Last values of the server's in-memory booking statistics, one row per statistic
+CREATE TABLE dbo.Booking_Statistics_Snapshot
+    (
+        Stat_Name VARCHAR(100) PRIMARY KEY,
+        Stat_Value DECIMAL(18,2) NOT NULL,
+        Snapshot_At DATETIME DEFAULT GETDATE()
+    );
+-------------------------------------------------------------------------------
+
+IF EXISTS (
+    SELECT 1
+    FROM sys.objects
+    WHERE object_id = OBJECT_ID(N'dbo.Reservation_Daily_Rollup')
+      AND type = 'U'
+)
+    DROP TABLE dbo.Reservation_Daily_Rollup;
+
+-- Reservations summed per day, destination and status for the revenue reports
+CREATE TABLE dbo.Reservation_Daily_Rollup
+    (
+        Rollup_Date DATE NOT NULL,
+        Destination_ID INT NOT NULL,
+        Status VARCHAR(20) NOT NULL,
+        Reservations INT NOT NULL,
+        Persons INT NOT NULL,
+        Revenue DECIMAL(18,2) NOT NULL,
+        PRIMARY KEY (Rollup_Date, Destination_ID, Status)
+    );
+-------------------------------------------------------------------------------
+
+IF EXISTS (
+    SELECT 1
+    FROM sys.objects
+    WHERE object_id = OBJECT_ID(N'dbo.Reservation_Rollup_Watermark')
+      AND type = 'U'
+)
+    DROP TABLE dbo.Reservation_Rollup_Watermark;
+
+-- Last day whose rollup is complete (a single row)
+CREATE TABLE dbo.Reservation_Rollup_Watermark
+    (
+        Complete_Through DATE NOT NULL,
+        Updated_At DATETIME DEFAULT GETDATE()
+    );
@@ -3,9 +3,14 @@
 #include <QtCore/QObject>
 #include <QtCore/QThread>
 #include <QtCore/QDebug>
+#include <QtCore/QCommandLineParser>
 #include "utils/utils.h"
 #include "database/Database_Manager.h"
+#include "database/Bulk_Importer.h"
+#include "database/Dataset_Generator.h"
+#include "database/Connection_Supervisor.h"
 #include "network/Socket_Server.h"
+#include "network/Loopback_Benchmark.h"
 #include "config.h"
 
 using namespace Database;
@@ -18,6 +23,14 @@ class ServerApplication : public QObject
 private:
     Socket_Server* server;
     QTimer* stats_timer;
+    std::shared_ptr<Database_Manager> db_manager;
+    QTimer* catalog_refresh_timer;
+    QTimer* catalog_reload_timer;
+    QTimer* write_behind_timer;
+    QTimer* seat_reconcile_timer;
+    QTimer* statistics_snapshot_timer;
+    QTimer* revenue_rollup_timer;
+    Connection_Supervisor* connection_supervisor;
 
 public slots:
     void handleShutdown()
@@ -27,6 +40,18 @@ public slots:
         {
             server->stop();
         }
+
+        // Persist what is still queued; anything left is replayed from the journal
+        if (db_manager)
+        {
+            int flushed = 0;
+            do
+            {
+                flushed = db_manager->flush_write_behind();
+            } while (flushed > 0 && db_manager->get_pending_write_count() > 0);
+
+            db_manager->snapshot_booking_statistics();
+        }
         QCoreApplication::quit();
     }
 
@@ -41,11 +66,119 @@ public slots:
             Utils::Logger::info("Messages received: " + QString::number(stats.total_messages_received));
             Utils::Logger::info("Messages sent: " + QString::number(stats.total_messages_sent));
             Utils::Logger::info("Uptime: " + stats.uptime);
+            if (stats.allocations_per_request >= 0)
+            {
+                Utils::Logger::info(QString("Allocations per request: %1").arg(stats.allocations_per_request, 0, 'f', 1));
+            }
+            if (db_manager && db_manager->get_rejected_write_count() > 0)
+            {
+                Utils::Logger::warning(QString("Rejected bookings kept in the journal: %1").arg(db_manager->get_rejected_write_count()));
+            }
+
+            auto commit_stats = server->get_group_commit_stats();
+            if (commit_stats.batches > 0)
+            {
+                QStringList buckets;
+                for (int i = 0; i < commit_stats.batch_size_histogram.size(); ++i)
+                {
+                    buckets << QString("%1: %2").arg(Database::Group_Commit_Stats::get_bucket_label(i))
+                                                .arg(commit_stats.batch_size_histogram[i]);
+                }
+                Utils::Logger::info(QString("Group commits: %1 batches, %2 operations, avg %3, max %4, avg wait %5 ms")
+                                    .arg(commit_stats.batches)
+                                    .arg(commit_stats.operations)
+                                    .arg(commit_stats.average_batch_size, 0, 'f', 2)
+                                    .arg(commit_stats.max_batch_size)
+                                    .arg(commit_stats.average_wait_ms, 0, 'f', 2));
+                Utils::Logger::info("Batch sizes: " + buckets.join(", "));
+            }
+
+            if (connection_supervisor && connection_supervisor->get_state() != Circuit_State::CLOSED)
+            {
+                auto supervisor_stats = connection_supervisor->get_stats();
+                Utils::Logger::info(QString("Database circuit %1 for %2 ms, %3 failed probes: %4")
+                                    .arg(Connection_Supervisor_Stats::get_state_name(supervisor_stats.state))
+                                    .arg(supervisor_stats.outage_ms)
+                                    .arg(supervisor_stats.attempt)
+                                    .arg(supervisor_stats.last_error));
+            }
+        }
+    }
+
+    void onDatabaseRestored()
+    {
+        // Catch up at once on what piled up during the outage instead of waiting for the timers
+        flushWriteBehind();
+        refreshOfferCatalog();
+    }
+
+    void refreshOfferCatalog()
+    {
+        if (db_manager)
+        {
+            db_manager->refresh_offer_catalog();
+        }
+    }
+
+    void reloadOfferCatalog()
+    {
+        if (db_manager && db_manager->is_offer_catalog_ready())
+        {
+            db_manager->load_offer_catalog();
+        }
+
+        // Destinations edited outside the server are picked up on the same cycle
+        if (db_manager && db_manager->is_destination_index_ready())
+        {
+            db_manager->load_destination_index();
+        }
+    }
+
+    void flushWriteBehind()
+    {
+        if (db_manager)
+        {
+            db_manager->flush_write_behind();
+        }
+    }
+
+    void reconcileSeatInventory()
+    {
+        if (db_manager)
+        {
+            db_manager->reconcile_seat_inventory();
+        }
+    }
+
+    void snapshotBookingStatistics()
+    {
+        if (db_manager)
+        {
+            db_manager->snapshot_booking_statistics();
+        }
+    }
+
+    void refreshRevenueRollup()
+    {
+        if (!db_manager)
+        {
+            return;
+        }
+
+        // A full step means the backfill is still behind, keep going from the event loop
+        if (db_manager->refresh_revenue_rollup() >= Config::Statistics::ROLLUP_DAYS_PER_RUN)
+        {
+            QTimer::singleShot(0, this, &ServerApplication::refreshRevenueRollup);
         }
     }
 
 public:
-    ServerApplication(QObject* parent = nullptr) : QObject(parent), server(nullptr), stats_timer(nullptr) {}
+    ServerApplication(QObject* parent = nullptr)
+        : QObject(parent), server(nullptr), stats_timer(nullptr),
+          catalog_refresh_timer(nullptr), catalog_reload_timer(nullptr),
+          write_behind_timer(nullptr), seat_reconcile_timer(nullptr),
+          statistics_snapshot_timer(nullptr), revenue_rollup_timer(nullptr),
+          connection_supervisor(nullptr) {}
     
     void setServer(Socket_Server* s) 
     { 
@@ -54,6 +187,59 @@ public:
         connect(stats_timer, &QTimer::timeout, this, &ServerApplication::printServerStats);
         stats_timer->start(30000); // 30 seconds
     }
+
+    void setDatabaseManager(std::shared_ptr<Database_Manager> db)
+    {
+        db_manager = db;
+        if (!db_manager)
+        {
+            return;
+        }
+
+        // Reconnects in the background after the database goes away, requests fail fast meanwhile
+        if (!db_manager->is_running_in_demo_mode())
+        {
+            connection_supervisor = new Connection_Supervisor(db_manager, this);
+            connect(connection_supervisor, &Connection_Supervisor::connection_restored, this, &ServerApplication::onDatabaseRestored);
+        }
+
+        if (db_manager->is_offer_catalog_ready())
+        {
+            catalog_refresh_timer = new QTimer(this);
+            connect(catalog_refresh_timer, &QTimer::timeout, this, &ServerApplication::refreshOfferCatalog);
+            catalog_refresh_timer->start(Config::Cache::CATALOG_REFRESH_INTERVAL_MS);
+
+            catalog_reload_timer = new QTimer(this);
+            connect(catalog_reload_timer, &QTimer::timeout, this, &ServerApplication::reloadOfferCatalog);
+            catalog_reload_timer->start(Config::Cache::CATALOG_FULL_RELOAD_INTERVAL_MS);
+        }
+
+        if (db_manager->is_seat_inventory_ready())
+        {
+            write_behind_timer = new QTimer(this);
+            connect(write_behind_timer, &QTimer::timeout, this, &ServerApplication::flushWriteBehind);
+            write_behind_timer->start(Config::Booking::WRITE_BEHIND_FLUSH_INTERVAL_MS);
+
+            seat_reconcile_timer = new QTimer(this);
+            connect(seat_reconcile_timer, &QTimer::timeout, this, &ServerApplication::reconcileSeatInventory);
+            seat_reconcile_timer->start(Config::Booking::SEAT_RECONCILE_INTERVAL_MS);
+        }
+
+        if (db_manager->is_booking_statistics_ready())
+        {
+            statistics_snapshot_timer = new QTimer(this);
+            connect(statistics_snapshot_timer, &QTimer::timeout, this, &ServerApplication::snapshotBookingStatistics);
+            statistics_snapshot_timer->start(Config::Statistics::SNAPSHOT_INTERVAL_MS);
+        }
+
+        if (db_manager->is_revenue_rollup_ready())
+        {
+            revenue_rollup_timer = new QTimer(this);
+            connect(revenue_rollup_timer, &QTimer::timeout, this, &ServerApplication::refreshRevenueRollup);
+            revenue_rollup_timer->start(Config::Statistics::ROLLUP_INTERVAL_MS);
+            QTimer::singleShot(0, this, &ServerApplication::refreshRevenueRollup); // backfill right after startup
+        }
+    }
 };
 
 // Original server main function - commented out for database testing
@@ -62,6 +248,102 @@ int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
     
+    // Command line: without options the server runs, --import and --generate load data and exit,
+    // --grant-admin makes a user an administrator and exits, --replay-rejected-bookings retries dead-lettered bookings,
+    // --bench measures the protocol stack without sockets and exits
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Agentie de Voiaj server");
+    parser.addHelpOption();
+    QCommandLineOption import_option("import", "Bulk import <file> (CSV or JSON Lines) and exit.", "file");
+    QCommandLineOption entity_option("entity", "What --import loads: destinations, accommodations or offers.", "entity", "offers");
+    QCommandLineOption format_option("format", "Input format for --import: csv or jsonl (default: from the extension).", "format");
+    QCommandLineOption backend_option("backend", "Storage backend: sqlserver or sqlite.", "backend", Config::Storage::DEFAULT_BACKEND);
+    QCommandLineOption database_option("database", "Database file for --backend sqlite.", "path", Config::Storage::SQLITE_PATH);
+    QCommandLineOption generate_option("generate", "Generate a synthetic dataset of <scale> (demo, small, medium, large or a number of offers), load it and exit.", "scale");
+    QCommandLineOption demo_scale_option("demo-scale", "Synthetic dataset served when running in demo mode.", "scale", Config::Dataset::DEMO_SCALE);
+    QCommandLineOption seed_option("seed", "Seed of the synthetic dataset, the same seed gives the same rows.", "seed", QString::number(Config::Dataset::DEFAULT_SEED));
+    QCommandLineOption grant_admin_option("grant-admin", "Make <username> an administrator (admin commands, BULK_IMPORT) and exit.", "username");
+    QCommandLineOption replay_rejected_option("replay-rejected-bookings", "Queue the bookings the database rejected again before the server starts.");
+    QCommandLineOption bench_option("bench", "Send requests through <sessions> in-process loopback sessions, report timings and exit.", "sessions");
+    QCommandLineOption bench_requests_option("bench-requests", "Requests each --bench session sends.", "count", "20");
+    QCommandLineOption bench_script_option("bench-script", "Requests for --bench, one JSON object per line (default: listings and searches).", "file");
+    QCommandLineOption bench_max_failures_option("bench-max-failures", "Failed --bench requests tolerated before the exit code is non-zero.", "count", "0");
+    parser.addOption(import_option);
+    parser.addOption(entity_option);
+    parser.addOption(format_option);
+    parser.addOption(backend_option);
+    parser.addOption(database_option);
+    parser.addOption(generate_option);
+    parser.addOption(demo_scale_option);
+    parser.addOption(seed_option);
+    parser.addOption(grant_admin_option);
+    parser.addOption(replay_rejected_option);
+    parser.addOption(bench_option);
+    parser.addOption(bench_requests_option);
+    parser.addOption(bench_script_option);
+    parser.addOption(bench_max_failures_option);
+    parser.process(app);
+    
+    Storage_Backend backend = Storage_Backend::SQL_SERVER;
+    if (!Sql_Dialect::parse_backend(parser.value(backend_option), backend))
+    {
+        qCritical() << "Unknown --backend" << parser.value(backend_option) << "- expected sqlserver or sqlite";
+        return 1;
+    }
+    
+    Import_Entity import_entity = Import_Entity::OFFERS;
+    if (parser.isSet(import_option) && !Bulk_Importer::parse_entity(parser.value(entity_option), import_entity))
+    {
+        qCritical() << "Unknown --entity" << parser.value(entity_option) << "- expected destinations, accommodations or offers";
+        return 1;
+    }
+    
+    Dataset_Scale generate_scale;
+    if (parser.isSet(generate_option) && !Dataset_Scale::parse(parser.value(generate_option), generate_scale))
+    {
+        qCritical() << "Unknown --generate scale" << parser.value(generate_option) << "- expected demo, small, medium, large or a number of offers";
+        return 1;
+    }
+    
+    Dataset_Scale demo_scale;
+    if (!Dataset_Scale::parse(parser.value(demo_scale_option), demo_scale))
+    {
+        qCritical() << "Unknown --demo-scale" << parser.value(demo_scale_option) << "- expected demo, small, medium, large or a number of offers";
+        return 1;
+    }
+    
+    bool seed_ok = false;
+    quint64 dataset_seed = parser.value(seed_option).toULongLong(&seed_ok);
+    if (!seed_ok)
+    {
+        qCritical() << "Invalid --seed" << parser.value(seed_option) << "- expected a non-negative integer";
+        return 1;
+    }
+    
+    int bench_sessions = parser.value(bench_option).toInt();
+    int bench_requests = parser.value(bench_requests_option).toInt();
+    if (parser.isSet(bench_option) && (bench_sessions <= 0 || bench_requests <= 0))
+    {
+        qCritical() << "Invalid --bench" << parser.value(bench_option) << "or --bench-requests" << parser.value(bench_requests_option) << "- expected positive integers";
+        return 1;
+    }
+    
+    bool bench_max_failures_ok = false;
+    qint64 bench_max_failures = parser.value(bench_max_failures_option).toLongLong(&bench_max_failures_ok);
+    if (!bench_max_failures_ok || bench_max_failures < 0)
+    {
+        qCritical() << "Invalid --bench-max-failures" << parser.value(bench_max_failures_option) << "- expected a non-negative integer";
+        return 1;
+    }
+    
+    QList<QByteArray> bench_script = Loopback_Benchmark::get_default_script();
+    QString bench_script_error;
+    if (parser.isSet(bench_script_option) && !Loopback_Benchmark::load_script(parser.value(bench_script_option), bench_script, bench_script_error))
+    {
+        qCritical().noquote() << "Invalid --bench-script:" << bench_script_error;
+        return 1;
+    }
+    
     // Initialize logging system first
     Utils::Logger::initialize_logging();
     
@@ -95,6 +377,23 @@ int main(int argc, char *argv[])
         bool connected = false;
         QString successful_server;
         
+        // The embedded backend has no server to look for, the file is created on first use
+        if (backend == Storage_Backend::SQLITE)
+        {
+            QString database_path = parser.value(database_option);
+            db_manager = std::make_shared<Database_Manager>("", database_path, "", "", Storage_Backend::SQLITE);
+            connected = db_manager->connect();
+            if (connected)
+            {
+                Utils::Logger::info("✅ Opened SQLite database: " + database_path);
+            }
+            else
+            {
+                Utils::Logger::warning("❌ Could not open SQLite database " + database_path + ": " + db_manager->get_last_error());
+            }
+            server_options.clear();
+        }
+        
         for (const auto& server : server_options)
         {
             Utils::Logger::debug("Trying database server: " + server);
@@ -129,6 +428,12 @@ int main(int argc, char *argv[])
             }
         }
         
+        if (!connected && (parser.isSet(import_option) || parser.isSet(generate_option) || parser.isSet(grant_admin_option)))
+        {
+            Utils::Logger::error("Cannot import, generate data or grant roles without a database connection");
+            return 1;
+        }
+        
         if (!connected)
         {
             Utils::Logger::error("Cannot connect to any SQL Server instance!");
@@ -140,8 +445,7 @@ int main(int argc, char *argv[])
             qDebug() << "\n📋 DEMO MODE FEATURES:";
             qDebug() << "  ✅ User authentication (demo/demo123, admin/admin123, test/test123)";
             qDebug() << "  ✅ User registration (mock responses)";
-            qDebug() << "  ✅ View destinations (Paris, Rome)";
-            qDebug() << "  ✅ View offers (Paris Weekend, Rome Adventure)";
+            qDebug() << "  ✅ View destinations and offers (generated, see --demo-scale and --seed)";
             qDebug() << "  ✅ All server functionality for testing";
             qDebug() << "\n📢 To enable REAL database:";
             qDebug() << "  1. Install SQL Server LocalDB or Express";
@@ -156,6 +460,9 @@ int main(int argc, char *argv[])
             // Create a dummy database manager that will handle errors gracefully
             db_manager = std::make_shared<Database_Manager>("dummy", "dummy", "", "");
             Utils::Logger::warning("Server starting in DEMO MODE with mock data");
+            
+            Dataset_Generator generator(dataset_seed, demo_scale);
+            db_manager->load_demo_dataset(generator.generate_demo_destinations(), generator.generate_demo_offers());
         }
         if (connected)
         {
@@ -171,12 +478,117 @@ int main(int argc, char *argv[])
             {
                 Utils::Logger::info("Database schema ready");
             }
+            
+            // Administrators are made here, on the server machine, never through the protocol
+            if (parser.isSet(grant_admin_option))
+            {
+                Query_Result result = db_manager->set_user_admin(parser.value(grant_admin_option), true);
+                if (!result.is_success())
+                {
+                    qCritical().noquote() << "Cannot grant administrator rights:" << result.message;
+                    return 1;
+                }
+                qInfo().noquote() << parser.value(grant_admin_option) << "is now an administrator";
+                return 0;
+            }
+            
+            if (parser.isSet(import_option))
+            {
+                QString path = parser.value(import_option);
+                Import_Format format = Bulk_Importer::detect_format(path);
+                if (parser.isSet(format_option))
+                {
+                    format = parser.value(format_option).toLower() == "csv" ? Import_Format::CSV : Import_Format::JSON_LINES;
+                }
+                
+                Bulk_Importer importer(db_manager);
+                Import_Stats stats = importer.run(import_entity, path, format);
+                qInfo().noquote() << "Import" << path << "into" << Bulk_Importer::get_table_name(import_entity) + ":" << stats.to_string();
+                for (const QString& error : std::as_const(stats.errors))
+                {
+                    qWarning().noquote() << "  " << error;
+                }
+                // Nothing imported but something went wrong (unreadable file, every row rejected)
+                bool failed = stats.rows_imported == 0 && !stats.errors.isEmpty();
+                return failed ? 1 : 0;
+            }
+            
+            if (parser.isSet(generate_option))
+            {
+                Dataset_Generator generator(dataset_seed, generate_scale);
+                Query_Result result = generator.load_into(db_manager);
+                if (!result.is_success())
+                {
+                    qCritical().noquote() << "Dataset generation failed:" << result.message;
+                    return 1;
+                }
+                qInfo().noquote() << result.message;
+                return 0;
+            }
+            
+            // Build the in-memory offer catalog used by GET_OFFERS / SEARCH_OFFERS
+            if (!db_manager->load_offer_catalog())
+            {
+                Utils::Logger::warning("Offer catalog not loaded - offer listings will query the database");
+            }
+
+            if (!db_manager->load_destination_index())
+            {
+                Utils::Logger::warning("Destination index not built - destination search falls back to LIKE");
+            }
+
+            // Dead letters go back in the queue first, the journal replay below persists them
+            if (parser.isSet(replay_rejected_option))
+            {
+                int requeued = db_manager->requeue_rejected_bookings();
+                if (requeued < 0)
+                {
+                    Utils::Logger::error("Cannot replay rejected bookings: booking journal unavailable");
+                }
+                else
+                {
+                    Utils::Logger::info(QString("Queued %1 rejected bookings again").arg(requeued));
+                }
+            }
+            
+            // Replays the booking journal before the first client can book
+            if (!db_manager->load_seat_inventory())
+            {
+                Utils::Logger::warning("Seat inventory not loaded - bookings go straight to the database");
+            }
+
+            // After the journal replay, so queued bookings are counted once
+            if (!db_manager->load_booking_statistics())
+            {
+                Utils::Logger::warning("Booking statistics not loaded - statistics queries scan the tables");
+            }
+
+            if (!db_manager->load_revenue_rollup())
+            {
+                Utils::Logger::warning("Revenue rollup not loaded - revenue reports scan Reservations");
+            }
         }
         else
         {
             Utils::Logger::warning("Database functionality disabled - running in fallback mode");
         }
         
+        // Same handlers, caches and database as the server would use, but no socket is opened
+        if (parser.isSet(bench_option))
+        {
+            Loopback_Benchmark benchmark(db_manager);
+            Benchmark_Stats stats = benchmark.run(bench_sessions, bench_requests, bench_script);
+            qInfo().noquote() << "Benchmark:" << stats.to_string();
+            
+            // A run that measured errors is not a measurement: scripts and CI see it in the exit code
+            if (stats.failed_requests > bench_max_failures)
+            {
+                qCritical() << "Benchmark failed:" << stats.failed_requests << "requests failed, --bench-max-failures is" << bench_max_failures;
+                return 1;
+            }
+            return 0;
+        }
+        
         // Create server configuration
         Server_Config config;
         config.ip_address = "0.0.0.0"; // Listen on all interfaces
@@ -190,6 +602,7 @@ int main(int argc, char *argv[])
         serverApp.setServer(&server); // Set server for signal handling
         
         server.set_database_manager(db_manager);
+        serverApp.setDatabaseManager(db_manager);
         
         // Connect Qt signals for graceful shutdown
         QObject::connect(&app, &QCoreApplication::aboutToQuit, &serverApp, &ServerApplication::handleShutdown);
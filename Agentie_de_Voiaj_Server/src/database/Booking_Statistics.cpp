@@ -0,0 +1,425 @@
+#include "database/Booking_Statistics.h"
+
+#include <QtCore/QMutexLocker>
+#include <algorithm>
+
+using namespace Database;
+
+namespace
+{
+    const QStringList RESERVATION_STATUSES = { "pending", "confirmed", "paid", "cancelled" };
+}
+
+// Loading
+void Booking_Statistics::rebuild(const QList<QHash<QString, QVariant>>& reservation_groups,
+    const QList<QHash<QString, QVariant>>& registration_days,
+    const QList<QHash<QString, QVariant>>& destination_rows,
+    const QList<QHash<QString, QVariant>>& offer_rows)
+{
+    QMutexLocker locker(&mutex);
+
+    destinations.clear();
+    destination_by_offer.clear();
+    active_bookings_by_offer.clear();
+    bookings_by_status.clear();
+    bookings_by_day.clear();
+    registrations_by_day.clear();
+    total_users = 0;
+    revenue_bookings = 0;
+    revenue_total = 0.0;
+    revenue_persons = 0;
+
+    for (const auto& row : destination_rows)
+    {
+        Destination_Totals totals;
+        totals.name = row.value("Name").toString();
+        totals.country = row.value("Country").toString();
+        destinations.insert(row.value("Destination_ID").toInt(), totals);
+    }
+
+    for (const auto& row : offer_rows)
+    {
+        destination_by_offer.insert(row.value("Offer_ID").toInt(), row.value("Destination_ID").toInt());
+    }
+
+    // One row per (offer, status, day) with the count, persons and revenue of that group
+    for (const auto& row : reservation_groups)
+    {
+        apply_locked(row.value("Offer_ID").toInt(),
+                     row.value("Bookings").toLongLong(),
+                     row.value("Persons").toLongLong(),
+                     row.value("Revenue").toDouble(),
+                     row.value("Status").toString(),
+                     row.value("Reservation_Day").toDate(),
+                     1);
+    }
+
+    for (const auto& row : registration_days)
+    {
+        qint64 users = row.value("Users").toLongLong();
+        QDate day = row.value("Created_Day").toDate();
+        if (day.isValid())
+        {
+            registrations_by_day[day] += users;
+        }
+        total_users += users;
+    }
+
+    ++version;
+    loaded = true;
+}
+
+void Booking_Statistics::clear()
+{
+    QMutexLocker locker(&mutex);
+
+    destinations.clear();
+    destination_by_offer.clear();
+    active_bookings_by_offer.clear();
+    bookings_by_status.clear();
+    bookings_by_day.clear();
+    registrations_by_day.clear();
+    total_users = 0;
+    revenue_bookings = 0;
+    revenue_total = 0.0;
+    revenue_persons = 0;
+    ++version;
+    loaded = false;
+}
+
+bool Booking_Statistics::is_loaded() const
+{
+    QMutexLocker locker(&mutex);
+    return loaded;
+}
+
+quint64 Booking_Statistics::get_version() const
+{
+    QMutexLocker locker(&mutex);
+    return version;
+}
+
+// Events from the write paths
+void Booking_Statistics::record_booking(int offer_id, int person_count, qreal total_price,
+    const QDate& day, const QString& status)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    apply_locked(offer_id, 1, person_count, total_price, status, day, 1);
+    ++version;
+}
+
+void Booking_Statistics::record_booking_removed(int offer_id, int person_count, qreal total_price,
+    const QDate& day, const QString& status)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    apply_locked(offer_id, 1, person_count, total_price, status, day, -1);
+    ++version;
+}
+
+void Booking_Statistics::record_status_change(int offer_id, int person_count, qreal total_price,
+    const QString& old_status, const QString& new_status)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded || old_status == new_status)
+    {
+        return;
+    }
+
+    // The reservation keeps its day, so the per-day buckets do not move
+    apply_locked(offer_id, 1, person_count, total_price, old_status, QDate(), -1);
+    apply_locked(offer_id, 1, person_count, total_price, new_status, QDate(), 1);
+    ++version;
+}
+
+void Booking_Statistics::record_registration(const QDate& day)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    registrations_by_day[day] += 1;
+    ++total_users;
+    ++version;
+}
+
+void Booking_Statistics::record_user_removed(const QDate& day)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    auto it = registrations_by_day.find(day);
+    if (it != registrations_by_day.end() && --it.value() <= 0)
+    {
+        registrations_by_day.erase(it);
+    }
+    total_users = qMax<qint64>(0, total_users - 1);
+    ++version;
+}
+
+// Catalog changes
+bool Booking_Statistics::knows_offer(int offer_id) const
+{
+    QMutexLocker locker(&mutex);
+    return destination_by_offer.contains(offer_id);
+}
+
+void Booking_Statistics::set_offer_destination(int offer_id, int destination_id)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    auto current = destination_by_offer.constFind(offer_id);
+    if (current != destination_by_offer.constEnd() && current.value() != destination_id)
+    {
+        // The offer's bookings now count for its new destination
+        qint64 active = active_bookings_by_offer.value(offer_id);
+        auto old_totals = destinations.find(current.value());
+        if (old_totals != destinations.end())
+        {
+            old_totals->active_bookings -= active;
+        }
+
+        auto new_totals = destinations.find(destination_id);
+        if (new_totals != destinations.end())
+        {
+            new_totals->active_bookings += active;
+        }
+    }
+
+    destination_by_offer.insert(offer_id, destination_id);
+    ++version;
+}
+
+void Booking_Statistics::set_destination(int destination_id, const QString& name, const QString& country)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    Destination_Totals& totals = destinations[destination_id];
+    totals.name = name;
+    totals.country = country;
+    ++version;
+}
+
+void Booking_Statistics::remove_destination(int destination_id)
+{
+    QMutexLocker locker(&mutex);
+    if (!loaded)
+    {
+        return;
+    }
+
+    destinations.remove(destination_id);
+    ++version;
+}
+
+// Reads
+QList<QHash<QString, QVariant>> Booking_Statistics::get_popular_destinations(int limit) const
+{
+    QMutexLocker locker(&mutex);
+
+    QList<int> ids = destinations.keys();
+    std::sort(ids.begin(), ids.end(), [this](int a, int b) {
+        qint64 count_a = destinations.constFind(a)->active_bookings;
+        qint64 count_b = destinations.constFind(b)->active_bookings;
+        return count_a != count_b ? count_a > count_b : a < b;
+    });
+
+    QList<QHash<QString, QVariant>> rows;
+    for (int i = 0; i < ids.size() && i < limit; ++i)
+    {
+        const Destination_Totals& totals = *destinations.constFind(ids[i]);
+
+        QHash<QString, QVariant> row;
+        row["Destination_ID"] = ids[i];
+        row["Name"] = totals.name;
+        row["Country"] = totals.country;
+        row["Booking_Count"] = totals.active_bookings;
+        rows.append(row);
+    }
+    return rows;
+}
+
+QHash<QString, QVariant> Booking_Statistics::get_booking_statistics(const QDate& today) const
+{
+    QMutexLocker locker(&mutex);
+
+    qint64 total = 0;
+    for (qint64 count : bookings_by_status)
+    {
+        total += count;
+    }
+
+    QHash<QString, QVariant> row;
+    row["Total_Bookings"] = total;
+    row["Pending_Bookings"] = bookings_by_status.value("pending");
+    row["Confirmed_Bookings"] = bookings_by_status.value("confirmed");
+    row["Paid_Bookings"] = bookings_by_status.value("paid");
+    row["Cancelled_Bookings"] = bookings_by_status.value("cancelled");
+    row["Bookings_This_Month"] = count_since_locked(bookings_by_day, today.addMonths(-1));
+    return row;
+}
+
+QHash<QString, QVariant> Booking_Statistics::get_user_statistics(const QDate& today) const
+{
+    QMutexLocker locker(&mutex);
+
+    QHash<QString, QVariant> row;
+    row["Total_Users"] = total_users;
+    row["New_Users_This_Month"] = count_since_locked(registrations_by_day, today.addMonths(-1));
+    row["New_Users_This_Week"] = count_since_locked(registrations_by_day, today.addDays(-7));
+    return row;
+}
+
+QHash<QString, QVariant> Booking_Statistics::get_revenue_report() const
+{
+    QMutexLocker locker(&mutex);
+
+    // SUM and AVG over no rows are NULL in SQL, keep that
+    QHash<QString, QVariant> row;
+    row["Total_Reservations"] = revenue_bookings;
+    row["Total_Revenue"] = revenue_bookings > 0 ? QVariant(revenue_total) : QVariant();
+    row["Average_Booking_Value"] = revenue_bookings > 0 ? QVariant(revenue_total / revenue_bookings) : QVariant();
+    row["Total_Persons"] = revenue_bookings > 0 ? QVariant(revenue_persons) : QVariant();
+    return row;
+}
+
+// Consistency
+QList<QPair<QString, qreal>> Booking_Statistics::get_snapshot(const QDate& today) const
+{
+    QMutexLocker locker(&mutex);
+    return get_snapshot_locked(today);
+}
+
+QStringList Booking_Statistics::compare(const Booking_Statistics& recount, const QDate& today) const
+{
+    QList<QPair<QString, qreal>> mine = get_snapshot(today);
+    QList<QPair<QString, qreal>> theirs = recount.get_snapshot(today);
+
+    QHash<QString, qreal> expected;
+    for (const auto& entry : theirs)
+    {
+        expected.insert(entry.first, entry.second);
+    }
+
+    QStringList differences;
+    for (const auto& entry : mine)
+    {
+        qreal recounted = expected.take(entry.first);
+        if (qRound64(entry.second * 100) != qRound64(recounted * 100))
+        {
+            differences << QString("%1: %2 in memory, %3 in the database")
+                           .arg(entry.first).arg(entry.second, 0, 'f', 2).arg(recounted, 0, 'f', 2);
+        }
+    }
+
+    for (auto it = expected.constBegin(); it != expected.constEnd(); ++it)
+    {
+        if (qRound64(it.value() * 100) != 0)
+        {
+            differences << QString("%1: 0.00 in memory, %2 in the database")
+                           .arg(it.key()).arg(it.value(), 0, 'f', 2);
+        }
+    }
+
+    differences.sort();
+    return differences;
+}
+
+// Private helpers
+void Booking_Statistics::apply_locked(int offer_id, qint64 bookings, qint64 persons, qreal revenue,
+    const QString& status, const QDate& day, int sign)
+{
+    bookings_by_status[status] += sign * bookings;
+
+    if (day.isValid())
+    {
+        qint64& on_day = bookings_by_day[day];
+        on_day += sign * bookings;
+        if (on_day <= 0)
+        {
+            bookings_by_day.remove(day);
+        }
+    }
+
+    if (status != "cancelled")
+    {
+        active_bookings_by_offer[offer_id] += sign * bookings;
+
+        auto destination = destination_by_offer.constFind(offer_id);
+        if (destination != destination_by_offer.constEnd())
+        {
+            auto totals = destinations.find(destination.value());
+            if (totals != destinations.end())
+            {
+                totals->active_bookings += sign * bookings;
+            }
+        }
+    }
+
+    if (is_revenue_status(status))
+    {
+        revenue_bookings += sign * bookings;
+        revenue_total += sign * revenue;
+        revenue_persons += sign * persons;
+    }
+}
+
+qint64 Booking_Statistics::count_since_locked(const QMap<QDate, qint64>& by_day, const QDate& first_day) const
+{
+    qint64 total = 0;
+    for (auto it = by_day.lowerBound(first_day); it != by_day.constEnd(); ++it)
+    {
+        total += it.value();
+    }
+    return total;
+}
+
+QList<QPair<QString, qreal>> Booking_Statistics::get_snapshot_locked(const QDate& today) const
+{
+    QList<QPair<QString, qreal>> entries;
+
+    for (const QString& status : RESERVATION_STATUSES)
+    {
+        entries.append({ "Bookings." + status, qreal(bookings_by_status.value(status)) });
+    }
+    entries.append({ "Bookings.This_Month", qreal(count_since_locked(bookings_by_day, today.addMonths(-1))) });
+    entries.append({ "Users.Total", qreal(total_users) });
+    entries.append({ "Users.This_Month", qreal(count_since_locked(registrations_by_day, today.addMonths(-1))) });
+    entries.append({ "Users.This_Week", qreal(count_since_locked(registrations_by_day, today.addDays(-7))) });
+    entries.append({ "Revenue.Reservations", qreal(revenue_bookings) });
+    entries.append({ "Revenue.Total", revenue_total });
+    entries.append({ "Revenue.Persons", qreal(revenue_persons) });
+
+    for (auto it = destinations.constBegin(); it != destinations.constEnd(); ++it)
+    {
+        entries.append({ QString("Destination.%1.Bookings").arg(it.key()), qreal(it->active_bookings) });
+    }
+    return entries;
+}
+
+bool Booking_Statistics::is_revenue_status(const QString& status)
+{
+    return status == "confirmed" || status == "paid";
+}
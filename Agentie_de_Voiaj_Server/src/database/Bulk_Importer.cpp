@@ -0,0 +1,536 @@
+#include "database/Bulk_Importer.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QDate>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+using namespace Database;
+
+QString Import_Stats::to_string() const
+{
+    return QString("%1 rows read, %2 imported, %3 rejected in %4 transactions, %5 ms (%6 rows/s)")
+        .arg(rows_read)
+        .arg(rows_imported)
+        .arg(rows_rejected)
+        .arg(transactions)
+        .arg(elapsed_ms)
+        .arg(rows_per_second, 0, 'f', 0);
+}
+
+// Constructor
+Bulk_Importer::Bulk_Importer(std::shared_ptr<Database_Manager> db_manager)
+    : db_manager(db_manager)
+{
+}
+
+// Import lifecycle
+bool Bulk_Importer::open(Import_Entity entity, const QString& path, Import_Format format, QString& error)
+{
+    this->entity = entity;
+    this->format = format;
+    columns = get_columns(entity);
+    stats = Import_Stats();
+    csv_header.clear();
+    line_number = 0;
+    at_end = false;
+
+    if (input.isOpen())
+    {
+        input.close();
+    }
+
+    input.setFileName(path);
+    if (!input.open(QIODevice::ReadOnly))
+    {
+        error = QString("Cannot open %1: %2").arg(path, input.errorString());
+        return false;
+    }
+
+    if (format == Import_Format::CSV)
+    {
+        if (!read_csv_fields(csv_header) || csv_header.isEmpty())
+        {
+            error = "CSV file has no header row";
+            input.close();
+            return false;
+        }
+
+        // Strip a UTF-8 byte order mark left by spreadsheet exports
+        if (csv_header.first().startsWith(QChar(0xFEFF)))
+        {
+            csv_header.first().remove(0, 1);
+        }
+        for (QString& name : csv_header)
+        {
+            name = name.trimmed().toLower();
+        }
+    }
+
+    clock.start();
+    return true;
+}
+
+bool Bulk_Importer::import_next_chunk()
+{
+    if (at_end || !input.isOpen())
+    {
+        return false;
+    }
+
+    QStringList value_rows;
+    QList<qint64> lines;
+    value_rows.reserve(Config::Import::ROWS_PER_TRANSACTION);
+
+    QHash<QString, QString> record;
+    while (value_rows.size() < Config::Import::ROWS_PER_TRANSACTION)
+    {
+        if (!read_record(record))
+        {
+            at_end = true;
+            break;
+        }
+        if (record.isEmpty())
+        {
+            continue; // blank line
+        }
+
+        stats.rows_read++;
+        qint64 record_line = line_number;
+
+        QString values_sql;
+        QString error;
+        if (!build_values(record, values_sql, error))
+        {
+            reject(record_line, error);
+            continue;
+        }
+
+        value_rows.append(values_sql);
+        lines.append(record_line);
+    }
+
+    insert_chunk(value_rows, lines);
+    return !at_end;
+}
+
+Import_Stats Bulk_Importer::finish()
+{
+    if (input.isOpen())
+    {
+        input.close();
+    }
+
+    // Caches are rebuilt once for the whole import, never per row
+    if (stats.rows_imported > 0)
+    {
+        if (entity == Import_Entity::DESTINATIONS && db_manager->is_destination_index_ready())
+        {
+            db_manager->load_destination_index();
+        }
+        if (entity == Import_Entity::DESTINATIONS && db_manager->is_booking_statistics_ready())
+        {
+            db_manager->load_booking_statistics(); // new destinations join the popularity ranking
+        }
+        if (entity == Import_Entity::OFFERS)
+        {
+            if (db_manager->is_offer_catalog_ready())
+            {
+                db_manager->load_offer_catalog();
+            }
+            db_manager->reconcile_seat_inventory(); // picks up the new active offers
+        }
+    }
+
+    stats.elapsed_ms = clock.isValid() ? clock.elapsed() : 0;
+    stats.rows_per_second = stats.elapsed_ms > 0 ? stats.rows_imported * 1000.0 / stats.elapsed_ms : 0.0;
+
+    Utils::Logger::info(QString("Bulk import into %1: %2").arg(get_table_name(entity), stats.to_string()));
+    return stats;
+}
+
+Import_Stats Bulk_Importer::run(Import_Entity entity, const QString& path, Import_Format format)
+{
+    QString error;
+    if (!open(entity, path, format, error))
+    {
+        Import_Stats failed;
+        failed.errors.append(error);
+        return failed;
+    }
+
+    while (import_next_chunk())
+    {
+        Utils::Logger::info(QString("Bulk import into %1: %2 rows so far").arg(get_table_name(entity)).arg(stats.rows_imported));
+    }
+    return finish();
+}
+
+const Import_Stats& Bulk_Importer::get_stats() const
+{
+    return stats;
+}
+
+Import_Entity Bulk_Importer::get_entity() const
+{
+    return entity;
+}
+
+// Static helpers
+bool Bulk_Importer::parse_entity(const QString& name, Import_Entity& entity)
+{
+    QString lower = name.trimmed().toLower();
+    if (lower == "destinations")
+    {
+        entity = Import_Entity::DESTINATIONS;
+        return true;
+    }
+    if (lower == "accommodations")
+    {
+        entity = Import_Entity::ACCOMMODATIONS;
+        return true;
+    }
+    if (lower == "offers")
+    {
+        entity = Import_Entity::OFFERS;
+        return true;
+    }
+    return false;
+}
+
+bool Bulk_Importer::resolve_import_path(const QString& requested, QString& path, QString& error)
+{
+    // A client names a file relative to the import directory, nothing outside it can be reached
+    QString relative = QDir::fromNativeSeparators(requested.trimmed());
+    if (relative.isEmpty() || QDir::isAbsolutePath(relative) || relative.contains(':') ||
+        relative.split('/').contains(".."))
+    {
+        error = "Import path must be a file name relative to the import directory";
+        return false;
+    }
+
+    QString root = QDir(Config::Import::IMPORT_DIRECTORY).canonicalPath();
+    if (root.isEmpty())
+    {
+        error = "Import directory not found";
+        return false;
+    }
+
+    // canonicalFilePath() resolves symbolic links, a link pointing out of the directory is refused too
+    QString resolved = QFileInfo(QDir(root).filePath(relative)).canonicalFilePath();
+    if (resolved.isEmpty() || !resolved.startsWith(root + '/') || !QFileInfo(resolved).isFile())
+    {
+        error = "File not found in the import directory: " + requested;
+        return false;
+    }
+
+    path = resolved;
+    return true;
+}
+
+Import_Format Bulk_Importer::detect_format(const QString& path)
+{
+    QString extension = Utils::File::get_file_extension(path).toLower();
+    return (extension == "jsonl" || extension == "ndjson" || extension == "json") ? Import_Format::JSON_LINES
+                                                                                  : Import_Format::CSV;
+}
+
+QString Bulk_Importer::get_table_name(Import_Entity entity)
+{
+    switch (entity)
+    {
+    case Import_Entity::DESTINATIONS:
+        return "Destinations";
+    case Import_Entity::ACCOMMODATIONS:
+        return "Accommodations";
+    case Import_Entity::OFFERS:
+    default:
+        return "Offers";
+    }
+}
+
+QList<Bulk_Importer::Column> Bulk_Importer::get_columns(Import_Entity entity)
+{
+    switch (entity)
+    {
+    case Import_Entity::DESTINATIONS:
+        return {
+            { "Name", "name", Column_Kind::TEXT, true, "" },
+            { "Country", "country", Column_Kind::TEXT, true, "" },
+            { "Description", "description", Column_Kind::TEXT, false, "" },
+            { "Image_Path", "image_path", Column_Kind::TEXT, false, "" }
+        };
+    case Import_Entity::ACCOMMODATIONS:
+        return {
+            { "Name", "name", Column_Kind::TEXT, true, "" },
+            { "Destination_ID", "destination_id", Column_Kind::INTEGER, true, "" },
+            { "Type_of_Accommodation", "accommodation_type_id", Column_Kind::INTEGER, true, "" },
+            { "Category", "category", Column_Kind::TEXT, false, "" },
+            { "Address", "address", Column_Kind::TEXT, false, "" },
+            { "Facilities", "facilities", Column_Kind::TEXT, false, "" },
+            { "Rating", "rating", Column_Kind::DECIMAL, false, "" },
+            { "Description", "description", Column_Kind::TEXT, false, "" }
+        };
+    case Import_Entity::OFFERS:
+    default:
+        return {
+            { "Name", "name", Column_Kind::TEXT, true, "" },
+            { "Destination_ID", "destination_id", Column_Kind::INTEGER, true, "" },
+            { "Accommodation_ID", "accommodation_id", Column_Kind::INTEGER, true, "" },
+            { "Types_of_Transport_ID", "transport_type_id", Column_Kind::INTEGER, true, "" },
+            { "Price_per_Person", "price_per_person", Column_Kind::DECIMAL, true, "" },
+            { "Duration_Days", "duration_days", Column_Kind::INTEGER, true, "" },
+            { "Departure_Date", "departure_date", Column_Kind::DATE, true, "" },
+            { "Return_Date", "return_date", Column_Kind::DATE, true, "" },
+            { "Total_Seats", "total_seats", Column_Kind::INTEGER, true, "" },
+            { "Reserved_Seats", "reserved_seats", Column_Kind::INTEGER, false, "0" },
+            { "Included_Services", "included_services", Column_Kind::TEXT, false, "" },
+            { "Description", "description", Column_Kind::TEXT, false, "" },
+            { "Status", "status", Column_Kind::TEXT, false, "'active'" }
+        };
+    }
+}
+
+// Reading
+bool Bulk_Importer::read_record(QHash<QString, QString>& record)
+{
+    record.clear();
+
+    if (format == Import_Format::CSV)
+    {
+        QStringList fields;
+        if (!read_csv_fields(fields))
+        {
+            return false;
+        }
+        if (fields.size() == 1 && fields.first().trimmed().isEmpty())
+        {
+            return true;
+        }
+
+        for (int i = 0; i < fields.size() && i < csv_header.size(); ++i)
+        {
+            record.insert(csv_header[i], fields[i]);
+        }
+        if (fields.size() != csv_header.size())
+        {
+            record.insert("#error", QString("expected %1 fields, found %2").arg(csv_header.size()).arg(fields.size()));
+        }
+        return true;
+    }
+
+    if (input.atEnd())
+    {
+        return false;
+    }
+
+    QByteArray line = input.readLine().trimmed();
+    ++line_number;
+    if (line.isEmpty())
+    {
+        return true;
+    }
+
+    QJsonParseError parse_error;
+    QJsonDocument doc = QJsonDocument::fromJson(line, &parse_error);
+    if (parse_error.error != QJsonParseError::NoError || !doc.isObject())
+    {
+        record.insert("#error", "not a JSON object: " + parse_error.errorString());
+        return true;
+    }
+
+    QJsonObject object = doc.object();
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it)
+    {
+        record.insert(it.key().toLower(), it.value().isNull() ? QString() : it.value().toVariant().toString());
+    }
+    return true;
+}
+
+bool Bulk_Importer::read_csv_fields(QStringList& fields)
+{
+    fields.clear();
+    if (input.atEnd())
+    {
+        return false;
+    }
+
+    // A quoted field may span lines, keep reading until its quote closes
+    QString field;
+    bool in_quotes = false;
+    do
+    {
+        QString line = QString::fromUtf8(input.readLine());
+        ++line_number;
+        if (line.endsWith('\n'))
+        {
+            line.chop(1);
+        }
+        if (line.endsWith('\r'))
+        {
+            line.chop(1);
+        }
+
+        for (int i = 0; i < line.size(); ++i)
+        {
+            QChar c = line[i];
+            if (in_quotes)
+            {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    field += '"';
+                    ++i;
+                }
+                else if (c == '"')
+                {
+                    in_quotes = false;
+                }
+                else
+                {
+                    field += c;
+                }
+            }
+            else if (c == '"')
+            {
+                in_quotes = true;
+            }
+            else if (c == ',')
+            {
+                fields.append(field);
+                field.clear();
+            }
+            else
+            {
+                field += c;
+            }
+        }
+
+        if (in_quotes)
+        {
+            field += '\n';
+        }
+    } while (in_quotes && !input.atEnd());
+
+    fields.append(field);
+    return true;
+}
+
+// Validation and SQL values
+bool Bulk_Importer::build_values(const QHash<QString, QString>& record, QString& values_sql, QString& error)
+{
+    if (record.contains("#error"))
+    {
+        error = record.value("#error");
+        return false;
+    }
+
+    QStringList values;
+    values.reserve(columns.size());
+
+    for (const Column& column : std::as_const(columns))
+    {
+        QString text = record.value(column.name.toLower(), record.value(column.alias)).trimmed();
+        if (text.isEmpty())
+        {
+            if (column.required)
+            {
+                error = "missing " + column.name;
+                return false;
+            }
+            values.append(column.default_sql.isEmpty() ? "NULL" : column.default_sql);
+            continue;
+        }
+
+        bool ok = true;
+        switch (column.kind)
+        {
+        case Column_Kind::TEXT:
+            values.append("'" + db_manager->escape_string(text) + "'");
+            break;
+        case Column_Kind::INTEGER:
+            values.append(QString::number(text.toLongLong(&ok)));
+            break;
+        case Column_Kind::DECIMAL:
+            values.append(QString::number(text.toDouble(&ok), 'f', 2));
+            break;
+        case Column_Kind::DATE:
+        {
+            QDate date = QDate::fromString(text.left(10), Qt::ISODate);
+            ok = date.isValid();
+            values.append("'" + date.toString(Qt::ISODate) + "'");
+            break;
+        }
+        }
+
+        if (!ok)
+        {
+            error = QString("invalid %1 '%2'").arg(column.name, text);
+            return false;
+        }
+    }
+
+    values_sql = "(" + values.join(", ") + ")";
+    return true;
+}
+
+// Database
+void Bulk_Importer::insert_chunk(const QStringList& value_rows, const QList<qint64>& lines)
+{
+    if (value_rows.isEmpty())
+    {
+        return;
+    }
+
+    QStringList column_names;
+    for (const Column& column : std::as_const(columns))
+    {
+        column_names.append(column.name);
+    }
+    QString table = get_table_name(entity);
+
+    Query_Result result = db_manager->bulk_insert(table, column_names, value_rows);
+    stats.transactions++;
+    if (result.is_success())
+    {
+        stats.rows_imported += value_rows.size();
+        return;
+    }
+
+    if (result.type == Result_Type::ERROR_CONNECTION)
+    {
+        for (qint64 line : lines)
+        {
+            reject(line, result.message);
+        }
+        return;
+    }
+
+    // Some row broke a constraint, find it (and only it) by inserting one at a time
+    Utils::Logger::warning(QString("Bulk import chunk into %1 failed, retrying %2 rows one by one: %3")
+                           .arg(table).arg(value_rows.size()).arg(result.message));
+    for (int i = 0; i < value_rows.size(); ++i)
+    {
+        Query_Result row_result = db_manager->bulk_insert(table, column_names, { value_rows[i] });
+        stats.transactions++;
+        if (row_result.is_success())
+        {
+            stats.rows_imported++;
+        }
+        else
+        {
+            reject(lines[i], row_result.message);
+        }
+    }
+}
+
+void Bulk_Importer::reject(qint64 line, const QString& error)
+{
+    stats.rows_rejected++;
+    if (stats.errors.size() < Config::Import::MAX_REPORTED_ERRORS)
+    {
+        stats.errors.append(QString("line %1: %2").arg(line).arg(error));
+    }
+}
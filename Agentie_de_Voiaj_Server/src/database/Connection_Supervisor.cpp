@@ -0,0 +1,172 @@
+#include "database/Connection_Supervisor.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QRandomGenerator>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+
+using namespace Database;
+
+QString Connection_Supervisor_Stats::get_state_name(Circuit_State state)
+{
+    switch (state)
+    {
+        case Circuit_State::CLOSED: return "closed";
+        case Circuit_State::OPEN: return "open";
+        case Circuit_State::HALF_OPEN: return "half-open";
+    }
+    return "unknown";
+}
+
+// Probe
+void Connection_Probe::probe(const QString& driver, const QString& database_name, const QString& connect_options)
+{
+    QString connection_name = QString("db_probe_%1").arg(reinterpret_cast<quintptr>(this));
+    bool reachable = false;
+    QString error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(driver, connection_name);
+        db.setDatabaseName(database_name);
+        db.setConnectOptions(connect_options);
+        if (db.open())
+        {
+            {
+                QSqlQuery query(db);
+                reachable = query.exec("SELECT 1");
+                if (!reachable)
+                {
+                    error = query.lastError().text();
+                }
+            }
+            db.close();
+        }
+        else
+        {
+            error = db.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection_name);
+
+    emit finished(reachable, error);
+}
+
+// Constructor
+Connection_Supervisor::Connection_Supervisor(std::shared_ptr<Database_Manager> db_manager, QObject* parent)
+    : QObject(parent), db_manager(db_manager), probe_timer(new QTimer(this)), probe(new Connection_Probe())
+{
+    probe_timer->setSingleShot(true);
+    connect(probe_timer, &QTimer::timeout, this, &Connection_Supervisor::start_probe);
+
+    probe->moveToThread(&probe_thread);
+    connect(this, &Connection_Supervisor::probe_requested, probe, &Connection_Probe::probe);
+    connect(probe, &Connection_Probe::finished, this, &Connection_Supervisor::on_probe_finished);
+    probe_thread.start();
+
+    // Reported from inside the failing statement, with the connection mutex held:
+    // queue it so the supervisor reacts from its own thread once the call has returned
+    this->db_manager->set_connection_lost_handler([this](const QString& error) {
+        QMetaObject::invokeMethod(this, [this, error]() { report_connection_lost(error); }, Qt::QueuedConnection);
+    });
+}
+
+Connection_Supervisor::~Connection_Supervisor()
+{
+    db_manager->set_connection_lost_handler(nullptr);
+
+    // A probe in progress finishes first, at most one Connection Timeout
+    probe_thread.quit();
+    probe_thread.wait();
+    delete probe;
+}
+
+// State
+Circuit_State Connection_Supervisor::get_state() const
+{
+    return stats.state;
+}
+
+Connection_Supervisor_Stats Connection_Supervisor::get_stats() const
+{
+    Connection_Supervisor_Stats current = stats;
+    current.outage_ms = stats.state == Circuit_State::CLOSED ? 0 : outage_clock.elapsed();
+    return current;
+}
+
+// Outage handling
+void Connection_Supervisor::report_connection_lost(const QString& error)
+{
+    // Statements that failed together report once; the probe cycle is already running
+    if (stats.state != Circuit_State::CLOSED)
+    {
+        return;
+    }
+
+    stats.state = Circuit_State::OPEN;
+    stats.attempt = 0;
+    stats.last_error = error;
+    ++stats.outages;
+    outage_clock.start();
+
+    Utils::Logger::warning("Database connection lost, requests fail fast until it is back: " + error);
+    emit connection_lost(error);
+    schedule_probe();
+}
+
+void Connection_Supervisor::start_probe()
+{
+    stats.state = Circuit_State::HALF_OPEN;
+    ++stats.probes;
+
+    const Sql_Dialect& dialect = db_manager->get_dialect();
+    emit probe_requested(dialect.get_driver_name(), db_manager->get_connection_string(), dialect.get_connect_options());
+}
+
+void Connection_Supervisor::on_probe_finished(bool reachable, const QString& error)
+{
+    // The server answers, so reopening the real connection does not wait for a timeout
+    QString failure = error;
+    if (reachable)
+    {
+        if (db_manager->reconnect())
+        {
+            qint64 outage_ms = outage_clock.elapsed();
+            Utils::Logger::info(QString("Database connection restored after %1 ms and %2 probes")
+                                .arg(outage_ms).arg(stats.attempt + 1));
+
+            stats.state = Circuit_State::CLOSED;
+            stats.attempt = 0;
+            stats.last_error.clear();
+            emit connection_restored(outage_ms);
+            return;
+        }
+        failure = db_manager->get_last_error();
+    }
+
+    stats.state = Circuit_State::OPEN;
+    stats.last_error = failure;
+    ++stats.attempt;
+    schedule_probe();
+}
+
+void Connection_Supervisor::schedule_probe()
+{
+    int delay_ms = get_backoff_delay_ms();
+    Utils::Logger::debug(QString("Next database probe in %1 ms (attempt %2)").arg(delay_ms).arg(stats.attempt + 1));
+    probe_timer->start(delay_ms);
+}
+
+int Connection_Supervisor::get_backoff_delay_ms() const
+{
+    // Doubles per failed probe up to the cap; the jitter keeps restarted servers from probing in step
+    qint64 delay = Config::Database::RECONNECT_INITIAL_DELAY_MS;
+    for (int i = 0; i < stats.attempt && delay < Config::Database::RECONNECT_MAX_DELAY_MS; ++i)
+    {
+        delay *= 2;
+    }
+    delay = qMin<qint64>(delay, Config::Database::RECONNECT_MAX_DELAY_MS);
+
+    double jitter = Config::Database::RECONNECT_JITTER * (2.0 * QRandomGenerator::global()->generateDouble() - 1.0);
+    return qMax(1, static_cast<int>(delay * (1.0 + jitter)));
+}
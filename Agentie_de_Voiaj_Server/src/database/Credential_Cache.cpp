@@ -0,0 +1,92 @@
+#include "database/Credential_Cache.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QMutexLocker>
+
+using namespace Database;
+
+Credential_Cache::Credential_Cache(int max_entries, qint64 ttl_ms)
+    : max_entries(max_entries), ttl_ms(ttl_ms)
+{
+}
+
+// Lookups
+bool Credential_Cache::find(const QString& username, User_Credentials& credentials)
+{
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(username);
+    if (found == index.constEnd())
+    {
+        return false;
+    }
+
+    auto it = found.value();
+    if (it->expires_at_ms <= QDateTime::currentMSecsSinceEpoch())
+    {
+        index.remove(username);
+        entries.erase(it);
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, it);
+    credentials = it->credentials;
+    return true;
+}
+
+int Credential_Cache::size() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(entries.size());
+}
+
+// Updates
+void Credential_Cache::store(const QString& username, const User_Credentials& credentials)
+{
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(username);
+    if (found != index.constEnd())
+    {
+        entries.erase(found.value());
+    }
+
+    Entry entry;
+    entry.username = username;
+    entry.credentials = credentials;
+    entry.expires_at_ms = QDateTime::currentMSecsSinceEpoch() + ttl_ms;
+    entries.push_front(entry);
+    index.insert(username, entries.begin());
+
+    while (static_cast<int>(entries.size()) > max_entries)
+    {
+        index.remove(entries.back().username);
+        entries.pop_back();
+    }
+}
+
+void Credential_Cache::invalidate_user(int user_id)
+{
+    QMutexLocker locker(&mutex);
+
+    // The same user may be cached under several spellings of a case-insensitive username
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->credentials.user_id == user_id)
+        {
+            index.remove(it->username);
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void Credential_Cache::clear()
+{
+    QMutexLocker locker(&mutex);
+    entries.clear();
+    index.clear();
+}
@@ -1,27 +1,48 @@
 #include "database/Database_Manager.h"
+#include "config.h"
 #include <QCoreApplication>
 #include <QSqlDriver>
 #include <QDebug>
 #include <QCryptographicHash>
 #include <QRandomGenerator>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
 #include <QDateTime>
 #include <QThread>
-#include <chrono>
-#include <thread>
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
 
 using namespace Database;
 
 // Constructor
 Database_Manager::Database_Manager() 
-    : is_connected(false), is_demo_mode(false)
+    : dialect(Sql_Dialect::create(Sql_Dialect::get_default_backend())), is_connected(false), is_demo_mode(false), offer_catalog(std::make_unique<Offer_Catalog>()),
+      destination_index(std::make_unique<Destination_Index>()),
+      seat_inventory(std::make_unique<Seat_Inventory>()),
+      write_behind_queue(std::make_unique<Write_Behind_Queue>(Config::Booking::JOURNAL_PATH)),
+      booking_statistics(std::make_unique<Booking_Statistics>()),
+      revenue_rollup(std::make_unique<Revenue_Rollup>()),
+      query_stats(std::make_unique<Query_Stats>(Config::Diagnostics::MAX_QUERY_SHAPES)),
+      credential_cache(std::make_unique<Credential_Cache>(Config::Cache::CREDENTIAL_CACHE_SIZE,
+                                                          Config::Cache::CREDENTIAL_CACHE_TTL_MS))
 {
     initialize_qt_sql();
 }
 
 Database_Manager::Database_Manager(const QString& server, const QString& database, 
-    const QString& username, const QString& password)
-    : server(server), database(database), username(username), password(password),
-      is_connected(false), is_demo_mode(false)
+    const QString& username, const QString& password, Storage_Backend backend)
+    : dialect(Sql_Dialect::create(backend)), server(server), database(database), username(username), password(password),
+      is_connected(false), is_demo_mode(false), offer_catalog(std::make_unique<Offer_Catalog>()),
+      destination_index(std::make_unique<Destination_Index>()),
+      seat_inventory(std::make_unique<Seat_Inventory>()),
+      write_behind_queue(std::make_unique<Write_Behind_Queue>(Config::Booking::JOURNAL_PATH)),
+      booking_statistics(std::make_unique<Booking_Statistics>()),
+      revenue_rollup(std::make_unique<Revenue_Rollup>()),
+      query_stats(std::make_unique<Query_Stats>(Config::Diagnostics::MAX_QUERY_SHAPES)),
+      credential_cache(std::make_unique<Credential_Cache>(Config::Cache::CREDENTIAL_CACHE_SIZE,
+                                                          Config::Cache::CREDENTIAL_CACHE_TTL_MS))
 {
     // Check if this is a dummy instance (demo mode)
     if (server == "dummy" && database == "dummy")
@@ -45,9 +66,10 @@ Database_Manager::~Database_Manager()
 // Initialize Qt SQL
 bool Database_Manager::initialize_qt_sql()
 {
-    if (!QSqlDatabase::isDriverAvailable("QODBC"))
+    QString driver = dialect->get_driver_name();
+    if (!QSqlDatabase::isDriverAvailable(driver))
     {
-        log_error("initialize_qt_sql", "QODBC driver not available");
+        log_error("initialize_qt_sql", driver + " driver not available");
         return false;
     }
 
@@ -55,7 +77,7 @@ bool Database_Manager::initialize_qt_sql()
     QString connection_name = QString("db_conn_%1_%2").arg(
         reinterpret_cast<quintptr>(this)).arg(QDateTime::currentMSecsSinceEpoch());
     
-    db = QSqlDatabase::addDatabase("QODBC", connection_name);
+    db = QSqlDatabase::addDatabase(driver, connection_name);
     return true;
 }
 
@@ -73,26 +95,8 @@ void Database_Manager::cleanup_qt_sql()
 // Build connection string
 QString Database_Manager::build_connection_string() const
 {
-    QString conn_str = "DRIVER={ODBC Driver 17 for SQL Server};";
-    conn_str += QString("SERVER=%1;").arg(server);
-    
-    // Use Windows Authentication if username/password are empty
-    if (username.isEmpty() && password.isEmpty())
-    {
-        conn_str += QString("DATABASE=%1;").arg(database);
-        conn_str += "Trusted_Connection=yes;";
-        conn_str += "Connection Timeout=30;";
-    }
-    else
-    {
-        conn_str += QString("DATABASE=%1;").arg(database);
-        conn_str += QString("UID=%1;").arg(username);
-        conn_str += QString("PWD=%1;").arg(password);
-        conn_str += "Trusted_Connection=no;";
-        conn_str += "Connection Timeout=30;";
-    }
-    
-    return conn_str;
+    // ODBC connection string for SQL Server, the database file for SQLite
+    return dialect->get_database_name(server, database, username, password);
 }
 
 // Connection methods
@@ -111,11 +115,28 @@ bool Database_Manager::connect()
         return false;
     }
 
+    // An embedded database is created on open, but not its directory
+    if (dialect->is_embedded())
+    {
+        QDir().mkpath(QFileInfo(connection_string).absolutePath());
+    }
+
     db.setDatabaseName(connection_string);
+    db.setConnectOptions(dialect->get_connect_options());
     
     if (db.open())
     {
+        for (const QString& statement : dialect->get_session_statements())
+        {
+            QSqlQuery session_query(db);
+            if (!session_query.exec(statement))
+            {
+                qWarning() << "Session setting failed:" << statement << session_query.lastError().text();
+            }
+        }
+
         is_connected = true;
+        procedure_availability.clear(); // the server may have changed while we were away
         qInfo() << "Database connection successful to:" << server << "\\" << database;
         return true;
     }
@@ -174,6 +195,18 @@ bool Database_Manager::reconnect()
     return connect();
 }
 
+void Database_Manager::set_connection_lost_handler(std::function<void(const QString&)> handler)
+{
+    QMutexLocker locker(&db_mutex);
+    connection_lost_handler = std::move(handler);
+}
+
+void Database_Manager::set_credentials_revoked_handler(std::function<void(int)> handler)
+{
+    QMutexLocker locker(&db_mutex);
+    credentials_revoked_handler = std::move(handler);
+}
+
 void Database_Manager::set_configuration_params(const QString& server, const QString& database,
     const QString& username, const QString& password)
 {
@@ -189,35 +222,39 @@ QString Database_Manager::get_connection_string() const
     return connection_string;
 }
 
+const Sql_Dialect& Database_Manager::get_dialect() const
+{
+    return *dialect;
+}
+
 // Core query methods
 Query_Result Database_Manager::execute_query(const QString& query)
 {
+    QElapsedTimer timer;
+    timer.start();
     QMutexLocker locker(&db_mutex);
+    qint64 wait_ns = timer.nsecsElapsed();
     
     if (!is_connected)
     {
-        return Query_Result(Result_Type::ERROR_CONNECTION, "Not connected to database");
+        return Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_UNAVAILABLE);
     }
 
     QSqlQuery sql_query(db);
     if (!sql_query.exec(query))
     {
-        QString error = get_sql_error(sql_query.lastError());
-        log_error("execute_query", error);
-        return Query_Result(Result_Type::ERROR_EXECUTION, error);
+        Query_Result result = make_error_result("execute_query", sql_query.lastError());
+        record_query_timing(query, QString(), timer, wait_ns, result);
+        return result;
     }
 
     // Check if this is a SELECT query
     QString upper_query = query.toUpper().trimmed();
     
-    if (upper_query.startsWith("SELECT"))
-    {
-        return process_select_result(sql_query);
-    }
-    else
-    {
-        return process_execution_result(sql_query);
-    }
+    Query_Result result = upper_query.startsWith("SELECT") ? process_select_result(sql_query)
+                                                           : process_execution_result(sql_query);
+    record_query_timing(query, QString(), timer, wait_ns, result);
+    return result;
 }
 
 Query_Result Database_Manager::execute_select(const QString& query)
@@ -225,6 +262,45 @@ Query_Result Database_Manager::execute_select(const QString& query)
     return execute_query(query);
 }
 
+Query_Result Database_Manager::stream_select(const QString& query, const Row_Handler& handle_row)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&db_mutex);
+    qint64 wait_ns = timer.nsecsElapsed();
+
+    if (!is_connected)
+    {
+        return Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_UNAVAILABLE);
+    }
+
+    // Forward only: the driver drops each row once next() moves on, nothing is collected here
+    QSqlQuery sql_query(db);
+    sql_query.setForwardOnly(true);
+    if (!sql_query.exec(query))
+    {
+        Query_Result result = make_error_result("stream_select", sql_query.lastError());
+        record_query_timing(query, QString(), timer, wait_ns, result);
+        return result;
+    }
+
+    // The handler stopping early is not an error: a full page or a client that went away
+    Query_Result result;
+    bool stopped = false;
+    while (!stopped && sql_query.next())
+    {
+        result.affected_rows++;
+        stopped = !handle_row(sql_query);
+    }
+
+    if (!stopped && sql_query.lastError().isValid())
+    {
+        result = make_error_result("stream_select", sql_query.lastError());
+    }
+    record_query_timing(query, QString(), timer, wait_ns, result);
+    return result;
+}
+
 Query_Result Database_Manager::execute_insert(const QString& query)
 {
     return execute_query(query);
@@ -243,38 +319,39 @@ Query_Result Database_Manager::execute_delete(const QString& query)
 // Advanced features
 Query_Result Database_Manager::execute_prepared(const QString& query, const QHash<QString, QVariant>& params)
 {
+    QElapsedTimer timer;
+    timer.start();
     QMutexLocker locker(&db_mutex);
+    qint64 wait_ns = timer.nsecsElapsed();
     
     if (!is_connected)
     {
-        return Query_Result(Result_Type::ERROR_CONNECTION, "Not connected to database");
+        return Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_UNAVAILABLE);
     }
 
     QSqlQuery sql_query(db);
     sql_query.prepare(query);
     
     // Bind parameters
+    QStringList bind_values;
     for (auto it = params.constBegin(); it != params.constEnd(); ++it)
     {
         sql_query.bindValue(it.key(), it.value());
+        bind_values << it.key() + "=" + it.value().toString();
     }
     
     if (!sql_query.exec())
     {
-        QString error = get_sql_error(sql_query.lastError());
-        log_error("execute_prepared", error);
-        return Query_Result(Result_Type::ERROR_EXECUTION, error);
+        Query_Result result = make_error_result("execute_prepared", sql_query.lastError());
+        record_query_timing(query, bind_values.join(", "), timer, wait_ns, result);
+        return result;
     }
 
     QString upper_query = query.toUpper().trimmed();
-    if (upper_query.startsWith("SELECT"))
-    {
-        return process_select_result(sql_query);
-    }
-    else
-    {
-        return process_execution_result(sql_query);
-    }
+    Query_Result result = upper_query.startsWith("SELECT") ? process_select_result(sql_query)
+                                                           : process_execution_result(sql_query);
+    record_query_timing(query, bind_values.join(", "), timer, wait_ns, result);
+    return result;
 }
 
 // Transaction support
@@ -286,6 +363,7 @@ bool Database_Manager::begin_transaction()
 
 bool Database_Manager::commit_transaction()
 {
+    // The statements were counted as they ran; on this connection their rows showed already
     QMutexLocker locker(&db_mutex);
     return db.commit();
 }
@@ -293,6 +371,8 @@ bool Database_Manager::commit_transaction()
 bool Database_Manager::rollback_transaction()
 {
     QMutexLocker locker(&db_mutex);
+    // Replies cached while the transaction was open may hold rows it never kept
+    mark_data_changed();
     return db.rollback();
 }
 
@@ -336,11 +416,177 @@ Query_Result Database_Manager::execute_stored_procedure(const QString& procedure
     return execute_query(query);
 }
 
+Query_Result Database_Manager::execute_batch(const QString& query)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&db_mutex);
+    qint64 wait_ns = timer.nsecsElapsed();
+    
+    if (!is_connected)
+    {
+        return Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_UNAVAILABLE);
+    }
+
+    QSqlQuery sql_query(db);
+    if (!sql_query.exec(query))
+    {
+        Query_Result result = make_error_result("execute_batch", sql_query.lastError());
+        record_query_timing(query, QString(), timer, wait_ns, result);
+        return result;
+    }
+
+    // A multi-statement batch answers with the first result set that has rows
+    mark_data_changed(query);
+    Query_Result result(Result_Type::SUCCESS, "Batch executed");
+    do
+    {
+        if (sql_query.isSelect())
+        {
+            result = process_select_result(sql_query);
+            break;
+        }
+    } while (sql_query.nextResult());
+
+    record_query_timing(query, QString(), timer, wait_ns, result);
+    return result;
+}
+
+Query_Result Database_Manager::call_procedure(const QString& procedure_name, const QVariantList& inputs,
+    const QList<QPair<QString, QVariant>>& outputs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&db_mutex);
+    qint64 wait_ns = timer.nsecsElapsed();
+    
+    if (!is_connected)
+    {
+        return Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_UNAVAILABLE);
+    }
+
+    QStringList placeholders;
+    for (int i = 0; i < inputs.size() + outputs.size(); ++i)
+    {
+        placeholders << "?";
+    }
+
+    QString call = QString("{CALL %1(%2)}").arg(procedure_name, placeholders.join(", "));
+    QSqlQuery sql_query(db);
+    sql_query.prepare(call);
+
+    QStringList bind_values;
+    for (const QVariant& input : inputs)
+    {
+        sql_query.addBindValue(input);
+        bind_values << input.toString();
+    }
+    // The initial value decides the ODBC type the output is read back as
+    for (const auto& output : outputs)
+    {
+        sql_query.addBindValue(output.second, QSql::Out);
+    }
+
+    if (!sql_query.exec())
+    {
+        Query_Result result = make_error_result("call_procedure", sql_query.lastError());
+        record_query_timing(call, bind_values.join(", "), timer, wait_ns, result);
+        return result;
+    }
+
+    // Output parameters are only sent after every result set has been consumed
+    while (sql_query.nextResult())
+    {
+    }
+    mark_data_changed();
+
+    QHash<QString, QVariant> row;
+    for (int i = 0; i < outputs.size(); ++i)
+    {
+        row.insert(outputs[i].first, sql_query.boundValue(inputs.size() + i));
+    }
+
+    Query_Result result(Result_Type::SUCCESS, "Procedure executed");
+    result.data.append(row);
+    record_query_timing(call, bind_values.join(", "), timer, wait_ns, result);
+    return result;
+}
+
+bool Database_Manager::is_procedure_available(const QString& procedure_name)
+{
+    if (is_demo_mode || !dialect->supports_procedures())
+    {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&db_mutex);
+        auto cached = procedure_availability.constFind(procedure_name);
+        if (cached != procedure_availability.constEnd())
+        {
+            return cached.value();
+        }
+    }
+
+    Query_Result result = execute_query(QString("SELECT OBJECT_ID(N'dbo.%1', N'P') AS Procedure_ID")
+                                       .arg(escape_string(procedure_name)));
+    if (!result.is_success() || result.data.isEmpty())
+    {
+        // Not cached, the next call asks again
+        return false;
+    }
+
+    bool available = !result.data[0]["Procedure_ID"].isNull();
+    if (!available)
+    {
+        qWarning() << "Stored procedure" << procedure_name << "is not installed, using the statement fallback";
+    }
+
+    QMutexLocker locker(&db_mutex);
+    procedure_availability.insert(procedure_name, available);
+    return available;
+}
+
+// Bulk loading
+Query_Result Database_Manager::bulk_insert(const QString& table, const QStringList& columns, const QStringList& value_rows)
+{
+    if (value_rows.isEmpty())
+    {
+        return Query_Result(Result_Type::SUCCESS, "Nothing to insert");
+    }
+
+    if (!begin_transaction())
+    {
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to begin transaction");
+    }
+
+    QString insert_prefix = QString("INSERT INTO %1 (%2) VALUES ").arg(table, columns.join(", "));
+    int rows_per_statement = qMin(Config::Import::ROWS_PER_STATEMENT, dialect->get_max_insert_rows());
+    for (int start = 0; start < value_rows.size(); start += rows_per_statement)
+    {
+        Query_Result result = execute_query(insert_prefix + value_rows.mid(start, rows_per_statement).join(", "));
+        if (!result.is_success())
+        {
+            rollback_transaction();
+            return result;
+        }
+    }
+
+    if (!commit_transaction())
+    {
+        rollback_transaction();
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to commit transaction");
+    }
+
+    Query_Result result(Result_Type::SUCCESS, QString("%1 rows inserted into %2").arg(value_rows.size()).arg(table));
+    result.affected_rows = value_rows.size();
+    return result;
+}
+
 // Schema operations
 bool Database_Manager::table_exists(const QString& table_name)
 {
-    QString query = QString("SELECT 1 FROM INFORMATION_SCHEMA.TABLES WHERE TABLE_NAME = '%1'")
-                   .arg(escape_string(table_name));
+    QString query = dialect->get_table_exists_sql(escape_string(table_name));
     Query_Result result = execute_select(query);
     return result.is_success() && result.has_data();
 }
@@ -348,8 +594,7 @@ bool Database_Manager::table_exists(const QString& table_name)
 QStringList Database_Manager::get_table_columns(const QString& table_name)
 {
     QStringList columns;
-    QString query = QString("SELECT COLUMN_NAME FROM INFORMATION_SCHEMA.COLUMNS WHERE TABLE_NAME = '%1' ORDER BY ORDINAL_POSITION")
-                   .arg(escape_string(table_name));
+    QString query = dialect->get_table_columns_sql(escape_string(table_name));
     Query_Result result = execute_select(query);
     
     if (result.is_success())
@@ -374,8 +619,10 @@ bool Database_Manager::create_tables_if_not_exists()
         get_create_offers_table_sql(),
         get_create_reservations_table_sql(),
         get_create_reservation_persons_table_sql(),
-        get_create_indexes_sql()
+        get_create_write_behind_table_sql(),
+        get_create_statistics_snapshot_table_sql()
     };
+    create_queries << get_create_revenue_rollup_tables_sql() << get_create_indexes_sql();
     
     for (const QString& query : create_queries)
     {
@@ -387,6 +634,17 @@ bool Database_Manager::create_tables_if_not_exists()
         }
     }
     
+    // Users created before roles existed: nobody is an administrator until granted one
+    if (!get_table_columns("Users").contains("Is_Admin", Qt::CaseInsensitive))
+    {
+        Query_Result result = execute_query("ALTER TABLE Users ADD Is_Admin INT NOT NULL DEFAULT 0");
+        if (!result.is_success())
+        {
+            log_error("create_tables_if_not_exists", "Failed to add Users.Is_Admin: " + result.message);
+            return false;
+        }
+    }
+    
     return true;
 }
 
@@ -418,9 +676,42 @@ Query_Result Database_Manager::process_execution_result(QSqlQuery& query)
 {
     Query_Result result;
     result.affected_rows = query.numRowsAffected();
+    mark_data_changed(query.lastQuery());
     return result;
 }
 
+void Database_Manager::mark_data_changed(const QString& statement)
+{
+    // Counted even when nothing matched: a stale cached reply costs more than a refill.
+    // Logins, registrations and profile edits name no listing table and leave the versions alone
+    for (Listing listing : { Listing::DESTINATIONS, Listing::OFFERS, Listing::RESERVATIONS })
+    {
+        bool reads_changed_table = statement.isEmpty();
+        for (const QString& table : get_listing_tables(listing))
+        {
+            reads_changed_table = reads_changed_table || statement.contains(table, Qt::CaseInsensitive);
+        }
+        if (reads_changed_table)
+        {
+            ++listing_versions[static_cast<int>(listing)];
+        }
+    }
+}
+
+void Database_Manager::notify_credentials_revoked(int user_id)
+{
+    // Copied under the lock and called outside it, the handler takes locks of its own
+    std::function<void(int)> handler;
+    {
+        QMutexLocker locker(&db_mutex);
+        handler = credentials_revoked_handler;
+    }
+    if (handler)
+    {
+        handler(user_id);
+    }
+}
+
 // Error handling
 bool Database_Manager::handle_sql_error(const QSqlError& error)
 {
@@ -429,6 +720,27 @@ bool Database_Manager::handle_sql_error(const QSqlError& error)
     return false;
 }
 
+Query_Result Database_Manager::make_error_result(const QString& operation, const QSqlError& error)
+{
+    QString message = get_sql_error(error);
+    log_error(operation, message);
+
+    if (!dialect->is_connection_error(error))
+    {
+        return Query_Result(Result_Type::ERROR_EXECUTION, message);
+    }
+
+    // The link is gone: fail fast from now on instead of waiting out a timeout per
+    // statement, the supervisor reconnects in the background
+    db.close();
+    is_connected = false;
+    if (connection_lost_handler)
+    {
+        connection_lost_handler(message);
+    }
+    return Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_UNAVAILABLE);
+}
+
 QString Database_Manager::get_sql_error(const QSqlError& error)
 {
     return QString("SQL Error: %1 - %2").arg(error.nativeErrorCode(), error.text());
@@ -481,6 +793,11 @@ Query_Result Database_Manager::create_mock_response(const QString& operation)
     if (operation == "get_destinations")
     {
         Query_Result result(Result_Type::SUCCESS, "Demo destinations retrieved");
+        if (!demo_destinations.isEmpty())
+        {
+            result.data = demo_destinations;
+            return result;
+        }
         
         // Mock destination 1
         QHash<QString, QVariant> dest1;
@@ -532,6 +849,16 @@ Query_Result Database_Manager::create_mock_response(const QString& operation)
     }
 }
 
+void Database_Manager::load_demo_dataset(const QList<QHash<QString, QVariant>>& destinations,
+    const QList<QHash<QString, QVariant>>& offers)
+{
+    // The offer catalog is never loaded from SQL in demo mode, so it holds the generated offers
+    demo_destinations = destinations;
+    offer_catalog->load(offers);
+    Utils::Logger::info(QString("Demo dataset loaded: %1 destinations, %2 active offers")
+                        .arg(demo_destinations.size()).arg(offer_catalog->size()));
+}
+
 // Static utilities
 QString Database_Manager::hash_password(const QString& password, const QString& salt)
 {
@@ -540,6 +867,25 @@ QString Database_Manager::hash_password(const QString& password, const QString&
     return hash.result().toHex();
 }
 
+bool Database_Manager::verify_password(const QString& password, const QString& salt, const QString& expected_hash)
+{
+    // Hex digests compared case-insensitively, like the old Password_Hash = '...' lookup did.
+    // Every byte is compared so the time taken does not tell how much of the hash matched.
+    QByteArray actual = hash_password(password, salt).toLatin1();
+    QByteArray expected = expected_hash.trimmed().toLower().toLatin1();
+    if (actual.size() != expected.size())
+    {
+        return false;
+    }
+
+    char difference = 0;
+    for (int i = 0; i < actual.size(); ++i)
+    {
+        difference |= actual[i] ^ expected[i];
+    }
+    return difference == 0;
+}
+
 QString Database_Manager::generate_salt()
 {
     QByteArray salt;
@@ -564,6 +910,88 @@ bool Database_Manager::validate_cnp(const QString& cnp)
     return ok;
 }
 
+QStringList Database_Manager::get_listing_fields(Listing listing)
+{
+    QStringList fields;
+    for (const auto& column : get_listing_columns(listing))
+    {
+        fields.append(column.first);
+    }
+    return fields;
+}
+
+// Listing columns
+const QList<QPair<QString, QString>>& Database_Manager::get_listing_columns(Listing listing)
+{
+    static const QList<QPair<QString, QString>> destination_columns = {
+        { "Destination_ID", "Destination_ID" }, { "Name", "Name" }, { "Country", "Country" },
+        { "Description", "Description" }, { "Image_Path", "Image_Path" },
+        { "Date_Created", "Date_Created" }, { "Date_Modified", "Date_Modified" }
+    };
+    static const QList<QPair<QString, QString>> offer_columns = {
+        { "Offer_ID", "o.Offer_ID" }, { "Name", "o.Name" }, { "Destination_ID", "o.Destination_ID" },
+        { "Accommodation_ID", "o.Accommodation_ID" }, { "Types_of_Transport_ID", "o.Types_of_Transport_ID" },
+        { "Price_per_Person", "o.Price_per_Person" }, { "Duration_Days", "o.Duration_Days" },
+        { "Departure_Date", "o.Departure_Date" }, { "Return_Date", "o.Return_Date" },
+        { "Total_Seats", "o.Total_Seats" }, { "Reserved_Seats", "o.Reserved_Seats" },
+        { "Included_Services", "o.Included_Services" }, { "Description", "o.Description" },
+        { "Status", "o.Status" }, { "Date_Created", "o.Date_Created" }, { "Date_Modified", "o.Date_Modified" },
+        { "Destination_Name", "d.Name as Destination_Name" }, { "Country", "d.Country" },
+        { "Accommodation_Name", "a.Name as Accommodation_Name" }, { "Transport_Name", "t.Name as Transport_Name" }
+    };
+    static const QList<QPair<QString, QString>> reservation_columns = {
+        { "Reservation_ID", "r.Reservation_ID" }, { "User_ID", "r.User_ID" }, { "Offer_ID", "r.Offer_ID" },
+        { "Number_of_Persons", "r.Number_of_Persons" }, { "Total_Price", "r.Total_Price" },
+        { "Reservation_Date", "r.Reservation_Date" }, { "Status", "r.Status" }, { "Notes", "r.Notes" },
+        { "Offer_Name", "o.Name as Offer_Name" }, { "Destination_Name", "d.Name as Destination_Name" },
+        { "Country", "d.Country" }
+    };
+
+    switch (listing)
+    {
+    case Listing::DESTINATIONS:
+        return destination_columns;
+    case Listing::OFFERS:
+        return offer_columns;
+    case Listing::RESERVATIONS:
+    default:
+        return reservation_columns;
+    }
+}
+
+const QStringList& Database_Manager::get_listing_tables(Listing listing)
+{
+    // Every table the listing's query joins: a write naming one of them changes its version
+    static const QStringList destination_tables = { "Destinations" };
+    static const QStringList offer_tables = { "Offers", "Destinations", "Accommodations", "Types_of_Transport" };
+    static const QStringList reservation_tables = { "Reservations", "Offers", "Destinations" };
+
+    switch (listing)
+    {
+    case Listing::DESTINATIONS:
+        return destination_tables;
+    case Listing::OFFERS:
+        return offer_tables;
+    case Listing::RESERVATIONS:
+    default:
+        return reservation_tables;
+    }
+}
+
+QString Database_Manager::get_select_list(Listing listing, const QStringList& fields)
+{
+    // Expressions keep the table's order whatever order the fields were asked in
+    QStringList expressions;
+    for (const auto& column : get_listing_columns(listing))
+    {
+        if (fields.isEmpty() || fields.contains(column.first))
+        {
+            expressions.append(column.second);
+        }
+    }
+    return expressions.join(", ");
+}
+
 // User management
 Query_Result Database_Manager::authenticate_user(const QString& username, const QString& password)
 {
@@ -606,40 +1034,85 @@ Query_Result Database_Manager::authenticate_user(const QString& username, const
         return Query_Result(Result_Type::ERROR_CONSTRAINT, "Invalid username or password format");
     }
     
-    // First get the user's salt from database
-    QString salt_query = QString("SELECT Password_Salt FROM Users WHERE Username = '%1'").arg(escape_string(username));
-    Query_Result salt_result = execute_select(salt_query);
-    if (!salt_result.is_success() || salt_result.data.isEmpty())
-    {
-        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "Invalid username or password");
-    }
-    
-    QString stored_salt = salt_result.data[0]["Password_Salt"].toString();
-    QString hashed_password = hash_password(password, stored_salt);
-    
-    QString query = QString("SELECT User_ID, Username, Email, First_Name, Last_Name, Phone FROM Users WHERE Username = '%1' AND Password_Hash = '%2'")
-                   .arg(escape_string(username), escape_string(hashed_password));
-    return execute_select(query);
-}
-
-Query_Result Database_Manager::register_user(const User_Data& user_data)
-{
-    // Demo mode - return mock registration
-    if (is_demo_mode)
+    // A repeated login is verified from the cache. A mismatch still asks the database,
+    // the password may have been changed outside the server since it was cached.
+    User_Credentials credentials;
+    if (Config::Cache::ENABLE_CREDENTIAL_CACHE && credential_cache->find(username, credentials) &&
+        verify_password(password, credentials.password_salt, credentials.password_hash))
     {
-        // Basic validation
-        if (!validate_email(user_data.email))
+        // A match is only trusted while the stored hash is still the cached one: an old
+        // password must stop working as soon as it is changed, not when the entry expires
+        Query_Result current = execute_prepared(
+            "SELECT Password_Salt, Password_Hash FROM Users WHERE User_ID = :user_id",
+            { { ":user_id", credentials.user_id } });
+        if (!current.is_success())
         {
-            return Query_Result(Result_Type::ERROR_CONSTRAINT, "Invalid email format");
+            return current;
         }
-        
-        // Mock successful registration (simulate username already exists for some cases)
-        if (user_data.username == "admin" || user_data.username == "test")
+        if (!current.data.isEmpty() &&
+            current.data[0]["Password_Salt"].toString() == credentials.password_salt &&
+            current.data[0]["Password_Hash"].toString() == credentials.password_hash)
         {
-            qWarning() << QString("DEMO MODE: Registration failed - username already exists: %1").arg(user_data.username);
-            return Query_Result(Result_Type::ERROR_CONSTRAINT, "Username already exists");
+            Query_Result result(Result_Type::SUCCESS, "Authentication successful");
+            result.data.append(credentials.profile);
+            return result;
         }
-        
+        credential_cache->invalidate_user(credentials.user_id);
+    }
+
+    // Salt, hash and profile in one round trip, the hash is checked here
+    Query_Result user_result = execute_prepared(
+        "SELECT User_ID, Username, Email, First_Name, Last_Name, Phone, Password_Salt, Password_Hash "
+        "FROM Users WHERE Username = :username",
+        { { ":username", username } });
+    if (!user_result.is_success())
+    {
+        return user_result;
+    }
+    if (user_result.data.isEmpty())
+    {
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "Invalid username or password");
+    }
+
+    QHash<QString, QVariant> profile = user_result.data[0];
+    credentials.user_id = profile["User_ID"].toInt();
+    credentials.password_salt = profile.take("Password_Salt").toString();
+    credentials.password_hash = profile.take("Password_Hash").toString();
+    credentials.profile = profile;
+
+    if (!verify_password(password, credentials.password_salt, credentials.password_hash))
+    {
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "Invalid username or password");
+    }
+
+    if (Config::Cache::ENABLE_CREDENTIAL_CACHE)
+    {
+        credential_cache->store(username, credentials);
+    }
+
+    Query_Result result(Result_Type::SUCCESS, "Authentication successful");
+    result.data.append(profile);
+    return result;
+}
+
+Query_Result Database_Manager::register_user(const User_Data& user_data)
+{
+    // Demo mode - return mock registration
+    if (is_demo_mode)
+    {
+        // Basic validation
+        if (!validate_email(user_data.email))
+        {
+            return Query_Result(Result_Type::ERROR_CONSTRAINT, "Invalid email format");
+        }
+        
+        // Mock successful registration (simulate username already exists for some cases)
+        if (user_data.username == "admin" || user_data.username == "test")
+        {
+            qWarning() << QString("DEMO MODE: Registration failed - username already exists: %1").arg(user_data.username);
+            return Query_Result(Result_Type::ERROR_CONSTRAINT, "Username already exists");
+        }
+        
         qInfo() << QString("DEMO MODE: Registration successful for new user: %1").arg(user_data.username);
         return Query_Result(Result_Type::SUCCESS, "Demo user registration successful");
     }
@@ -663,7 +1136,12 @@ Query_Result Database_Manager::register_user(const User_Data& user_data)
                         escape_string(user_data.last_name),
                         escape_string(user_data.phone_number));
     
-    return execute_insert(query);
+    Query_Result result = execute_insert(query);
+    if (result.is_success())
+    {
+        booking_statistics->record_registration(QDate::currentDate());
+    }
+    return result;
 }
 
 Query_Result Database_Manager::get_user_by_id(int user_id)
@@ -672,6 +1150,30 @@ Query_Result Database_Manager::get_user_by_id(int user_id)
     return execute_select(query);
 }
 
+bool Database_Manager::is_user_admin(int user_id)
+{
+    // The demo accounts are fixed, admin/admin123 is the only administrator
+    if (is_demo_mode)
+    {
+        return user_id == 1;
+    }
+
+    Query_Result result = execute_select(QString("SELECT Is_Admin FROM Users WHERE User_ID = %1").arg(user_id));
+    return result.is_success() && !result.data.isEmpty() && result.data[0]["Is_Admin"].toInt() != 0;
+}
+
+Query_Result Database_Manager::set_user_admin(const QString& username, bool is_admin)
+{
+    Query_Result result = execute_update(QString("UPDATE Users SET Is_Admin = %1, Date_Modified = %2 WHERE Username = '%3'")
+                                         .arg(is_admin ? 1 : 0)
+                                         .arg(dialect->now(), escape_string(username)));
+    if (result.is_success() && result.affected_rows == 0)
+    {
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "User not found: " + username);
+    }
+    return result;
+}
+
 Query_Result Database_Manager::get_user_by_username(const QString& username)
 {
     QString query = QString("SELECT User_ID, Username, Email, First_Name, Last_Name, Phone, Date_Created, Date_Modified FROM Users WHERE Username = '%1'").arg(escape_string(username));
@@ -680,47 +1182,66 @@ Query_Result Database_Manager::get_user_by_username(const QString& username)
 
 Query_Result Database_Manager::update_user(const User_Data& user)
 {
-    QString query = QString("UPDATE Users SET Email = '%1', First_Name = '%2', Last_Name = '%3', Phone = '%4', Date_Modified = GETDATE() WHERE User_ID = %5")
+    QString query = QString("UPDATE Users SET Email = '%1', First_Name = '%2', Last_Name = '%3', Phone = '%4', Date_Modified = " + dialect->now() + " WHERE User_ID = %5")
                    .arg(escape_string(user.email),
                         escape_string(user.first_name),
                         escape_string(user.last_name),
                         escape_string(user.phone_number))
                    .arg(user.id);
     
-    return execute_update(query);
+    Query_Result result = execute_update(query);
+    if (result.is_success())
+    {
+        credential_cache->invalidate_user(user.id); // the cached profile is what login answers with
+    }
+    return result;
 }
 
 Query_Result Database_Manager::delete_user(int user_id)
 {
-    QString query = QString("DELETE FROM Users WHERE User_ID = %1").arg(user_id);
-    return execute_delete(query);
+    // Returns the removed user's Date_Created so the registration counts follow
+    QString query = QString(R"(
+        SET NOCOUNT ON;
+        DECLARE @deleted TABLE (Date_Created DATETIME);
+        DELETE FROM Users OUTPUT deleted.Date_Created INTO @deleted WHERE User_ID = %1;
+        SELECT Date_Created FROM @deleted;
+    )").arg(user_id);
+    if (!dialect->supports_batches())
+    {
+        query = QString("DELETE FROM Users WHERE User_ID = %1 RETURNING Date_Created").arg(user_id);
+    }
+
+    Query_Result result = execute_batch(query);
+    if (result.is_success())
+    {
+        credential_cache->invalidate_user(user_id);
+        notify_credentials_revoked(user_id);
+        result.affected_rows = result.data.size();
+        for (const auto& row : result.data)
+        {
+            booking_statistics->record_user_removed(row["Date_Created"].toDate());
+        }
+    }
+    return result;
 }
 
 Query_Result Database_Manager::change_password(int user_id, const QString& old_password, const QString& new_password)
 {
-    // First verify old password
-    Query_Result user_result = get_user_by_id(user_id);
-    if (!user_result.is_success() || user_result.data.isEmpty())
+    // Current salt and hash in one round trip, the old password is checked here
+    Query_Result user_result = execute_prepared(
+        "SELECT Password_Salt, Password_Hash FROM Users WHERE User_ID = :user_id",
+        { { ":user_id", user_id } });
+    if (!user_result.is_success())
     {
-        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "User not found");
+        return user_result;
     }
-    
-    // Get current salt to verify old password
-    QString current_salt_query = QString("SELECT Password_Salt FROM Users WHERE User_ID = %1").arg(user_id);
-    Query_Result salt_result = execute_select(current_salt_query);
-    if (!salt_result.is_success() || salt_result.data.isEmpty())
+    if (user_result.data.isEmpty())
     {
-        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "User salt not found");
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "User not found");
     }
     
-    QString current_salt = salt_result.data[0]["Password_Salt"].toString();
-    QString old_hash = hash_password(old_password, current_salt);
-    
-    QString verify_query = QString("SELECT User_ID FROM Users WHERE User_ID = %1 AND Password_Hash = '%2'")
-                          .arg(user_id).arg(escape_string(old_hash));
-    Query_Result verify_result = execute_select(verify_query);
-    
-    if (!verify_result.is_success() || verify_result.data.isEmpty())
+    if (!verify_password(old_password, user_result.data[0]["Password_Salt"].toString(),
+                         user_result.data[0]["Password_Hash"].toString()))
     {
         return Query_Result(Result_Type::ERROR_EXECUTION, "Invalid old password");
     }
@@ -728,10 +1249,16 @@ Query_Result Database_Manager::change_password(int user_id, const QString& old_p
     // Generate new salt and hash for new password
     QString new_salt = generate_salt();
     QString new_hash = hash_password(new_password, new_salt);
-    QString update_query = QString("UPDATE Users SET Password_Hash = '%1', Password_Salt = '%2', Date_Modified = GETDATE() WHERE User_ID = %3")
+    QString update_query = QString("UPDATE Users SET Password_Hash = '%1', Password_Salt = '%2', Date_Modified = " + dialect->now() + " WHERE User_ID = %3")
                           .arg(escape_string(new_hash), escape_string(new_salt)).arg(user_id);
     
-    return execute_update(update_query);
+    Query_Result result = execute_update(update_query);
+    if (result.is_success())
+    {
+        credential_cache->invalidate_user(user_id);
+        notify_credentials_revoked(user_id); // tokens handed out with the old password stop working
+    }
+    return result;
 }
 
 // Destination management
@@ -741,6 +1268,12 @@ Query_Result Database_Manager::get_all_destinations()
     return execute_select(query);
 }
 
+Query_Result Database_Manager::get_all_destinations(const Listing_Request& request, const Row_Handler& handle_row)
+{
+    QString query = "SELECT " + get_select_list(Listing::DESTINATIONS, request.fields) + " FROM Destinations ORDER BY Name";
+    return stream_select(query, handle_row);
+}
+
 Query_Result Database_Manager::get_destination_by_id(int destination_id)
 {
     QString query = QString("SELECT Destination_ID, Name, Country, Description, Image_Path, Date_Created, Date_Modified FROM Destinations WHERE Destination_ID = %1").arg(destination_id);
@@ -755,25 +1288,56 @@ Query_Result Database_Manager::add_destination(const Destination_Data& destinati
                         escape_string(destination.description),
                         escape_string(destination.image_path));
     
-    return execute_insert(query);
+    Query_Result result = execute_insert(query);
+    if (result.is_success() && is_destination_index_ready())
+    {
+        // The new Destination_ID is not returned by the insert, reload the index
+        load_destination_index();
+    }
+    if (result.is_success() && is_booking_statistics_ready())
+    {
+        Query_Result added = execute_select(QString("SELECT Destination_ID, Name, Country FROM Destinations WHERE Name = '%1' AND Country = '%2'")
+                                           .arg(escape_string(destination.name), escape_string(destination.country)));
+        for (const auto& row : added.data)
+        {
+            booking_statistics->set_destination(row["Destination_ID"].toInt(), row["Name"].toString(), row["Country"].toString());
+        }
+    }
+    return result;
 }
 
 Query_Result Database_Manager::update_destination(const Destination_Data& destination)
 {
-    QString query = QString("UPDATE Destinations SET Name = '%1', Country = '%2', Description = '%3', Image_Path = '%4', Date_Modified = GETDATE() WHERE Destination_ID = %5")
+    QString query = QString("UPDATE Destinations SET Name = '%1', Country = '%2', Description = '%3', Image_Path = '%4', Date_Modified = " + dialect->now() + " WHERE Destination_ID = %5")
                    .arg(escape_string(destination.name),
                         escape_string(destination.country),
                         escape_string(destination.description),
                         escape_string(destination.image_path))
                    .arg(destination.id);
     
-    return execute_update(query);
+    Query_Result result = execute_update(query);
+    if (result.is_success())
+    {
+        offer_catalog->update_destination(destination.id, destination.name, destination.country);
+        destination_index->upsert(destination.id, destination.name, destination.country);
+        if (result.affected_rows > 0)
+        {
+            booking_statistics->set_destination(destination.id, destination.name, destination.country);
+        }
+    }
+    return result;
 }
 
 Query_Result Database_Manager::delete_destination(int destination_id)
 {
     QString query = QString("DELETE FROM Destinations WHERE Destination_ID = %1").arg(destination_id);
-    return execute_delete(query);
+    Query_Result result = execute_delete(query);
+    if (result.is_success())
+    {
+        destination_index->remove(destination_id);
+        booking_statistics->remove_destination(destination_id);
+    }
+    return result;
 }
 
 // Transport types management
@@ -800,7 +1364,7 @@ Query_Result Database_Manager::add_transport_type(const Transport_Type_Data& tra
 
 Query_Result Database_Manager::update_transport_type(const Transport_Type_Data& transport_type)
 {
-    QString query = QString("UPDATE Types_of_Transport SET Name = '%1', Description = '%2', Date_Modified = GETDATE() WHERE Transport_Type_ID = %3")
+    QString query = QString("UPDATE Types_of_Transport SET Name = '%1', Description = '%2', Date_Modified = " + dialect->now() + " WHERE Transport_Type_ID = %3")
                    .arg(escape_string(transport_type.name),
                         escape_string(transport_type.description))
                    .arg(transport_type.id);
@@ -838,7 +1402,7 @@ Query_Result Database_Manager::add_accommodation_type(const Accommodation_Type_D
 
 Query_Result Database_Manager::update_accommodation_type(const Accommodation_Type_Data& accommodation_type)
 {
-    QString query = QString("UPDATE Types_of_Accommodation SET Name = '%1', Description = '%2', Date_Modified = GETDATE() WHERE Accommodation_Type_ID = %3")
+    QString query = QString("UPDATE Types_of_Accommodation SET Name = '%1', Description = '%2', Date_Modified = " + dialect->now() + " WHERE Accommodation_Type_ID = %3")
                    .arg(escape_string(accommodation_type.name),
                         escape_string(accommodation_type.description))
                    .arg(accommodation_type.id);
@@ -893,7 +1457,7 @@ Query_Result Database_Manager::update_accommodation(const Accommodation_Data& ac
 {
     QString query = QString("UPDATE Accommodations SET Name = '%1', Destination_ID = %2, Type_of_Accommodation = %3, "
                            "Category = '%4', Address = '%5', Facilities = '%6', Rating = %7, Description = '%8', "
-                           "Date_Modified = GETDATE() WHERE Accommodation_ID = %9")
+                           "Date_Modified = " + dialect->now() + " WHERE Accommodation_ID = %9")
                    .arg(escape_string(accommodation.name))
                    .arg(accommodation.destination_id)
                    .arg(accommodation.accommodation_type_id)
@@ -930,21 +1494,72 @@ Query_Result Database_Manager::get_all_offers()
 
 Query_Result Database_Manager::get_available_offers()
 {
-    QString query = "SELECT o.Offer_ID, o.Name, o.Destination_ID, o.Accommodation_ID, o.Types_of_Transport_ID, "
-                   "o.Price_per_Person, o.Duration_Days, o.Departure_Date, o.Return_Date, o.Total_Seats, "
-                   "o.Reserved_Seats, o.Included_Services, o.Description, o.Status, o.Date_Created, o.Date_Modified, "
-                   "d.Name as Destination_Name, d.Country, a.Name as Accommodation_Name, t.Name as Transport_Name "
+    return get_available_offers(Listing_Request());
+}
+
+Query_Result Database_Manager::get_available_offers(const Listing_Request& request)
+{
+    if (serves_offers_from_catalog())
+    {
+        Offer_Search_Criteria criteria;
+        criteria.only_future_departures = true;
+        criteria.after_departure = request.after_key.toDate();
+        criteria.after_offer_id = request.after_id;
+        criteria.limit = request.limit;
+        criteria.fields = request.fields;
+
+        Query_Result result(Result_Type::SUCCESS, "Offers retrieved from catalog");
+        result.data = offer_catalog->search(criteria);
+        return result;
+    }
+
+    return execute_select(get_available_offers_sql(request));
+}
+
+Query_Result Database_Manager::get_available_offers(const Listing_Request& request, const Row_Handler& handle_row)
+{
+    return stream_select(get_available_offers_sql(request), handle_row);
+}
+
+QString Database_Manager::get_available_offers_sql(const Listing_Request& request) const
+{
+    QString query = "SELECT " + (request.limit > 0 ? dialect->top(request.limit) : QString()) +
+                   get_select_list(Listing::OFFERS, request.fields) + " "
                    "FROM Offers o "
                    "LEFT JOIN Destinations d ON o.Destination_ID = d.Destination_ID "
                    "LEFT JOIN Accommodations a ON o.Accommodation_ID = a.Accommodation_ID "
                    "LEFT JOIN Types_of_Transport t ON o.Types_of_Transport_ID = t.Transport_Type_ID "
-                   "WHERE o.Status = 'active' AND o.Reserved_Seats < o.Total_Seats AND o.Departure_Date > GETDATE() "
-                   "ORDER BY o.Departure_Date";
-    return execute_select(query);
+                   "WHERE o.Status = 'active' AND o.Reserved_Seats < o.Total_Seats AND o.Departure_Date > " + dialect->now();
+
+    if (request.has_after())
+    {
+        query += " AND " + get_keyset_condition(request, "o.Departure_Date", "o.Offer_ID", false);
+    }
+
+    query += " ORDER BY o.Departure_Date, o.Offer_ID";
+    if (request.limit > 0)
+    {
+        query += dialect->limit(request.limit);
+    }
+    return query;
 }
 
 Query_Result Database_Manager::get_offer_by_id(int offer_id)
 {
+    // Active offers are in the catalog with every column, the detail view needs no query
+    QHash<QString, QVariant> row;
+    if (serves_offers_from_catalog() && offer_catalog->get_offer(offer_id, row))
+    {
+        Query_Result result(Result_Type::SUCCESS, "Offer retrieved from catalog");
+        result.data.append(row);
+        return result;
+    }
+
+    if (is_demo_mode)
+    {
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, Config::ErrorMessages::OFFER_NOT_FOUND);
+    }
+
     QString query = QString("SELECT o.Offer_ID, o.Name, o.Destination_ID, o.Accommodation_ID, o.Types_of_Transport_ID, "
                            "o.Price_per_Person, o.Duration_Days, o.Departure_Date, o.Return_Date, o.Total_Seats, "
                            "o.Reserved_Seats, o.Included_Services, o.Description, o.Status, o.Date_Created, o.Date_Modified, "
@@ -958,12 +1573,42 @@ Query_Result Database_Manager::get_offer_by_id(int offer_id)
 }
 
 Query_Result Database_Manager::search_offers(const QString& destination, qreal min_price, qreal max_price,
-    const QString& start_date, const QString& end_date)
+    const QString& start_date, const QString& end_date, const Listing_Request& request)
 {
-    QString query = "SELECT o.Offer_ID, o.Name, o.Destination_ID, o.Accommodation_ID, o.Types_of_Transport_ID, "
-                   "o.Price_per_Person, o.Duration_Days, o.Departure_Date, o.Return_Date, o.Total_Seats, "
-                   "o.Reserved_Seats, o.Included_Services, o.Description, o.Status, o.Date_Created, o.Date_Modified, "
-                   "d.Name as Destination_Name, d.Country, a.Name as Accommodation_Name, t.Name as Transport_Name "
+    if (serves_offers_from_catalog())
+    {
+        Offer_Search_Criteria criteria;
+        criteria.min_price = min_price;
+        criteria.max_price = max_price;
+        criteria.start_date = QDate::fromString(start_date, "yyyy-MM-dd");
+        criteria.end_date = QDate::fromString(end_date, "yyyy-MM-dd");
+        criteria.after_departure = request.after_key.toDate();
+        criteria.after_offer_id = request.after_id;
+        criteria.limit = request.limit;
+        criteria.fields = request.fields;
+
+        if (!destination.isEmpty())
+        {
+            criteria.filter_destinations = true;
+            if (!resolve_destination_ids(destination, criteria.destination_ids))
+            {
+                criteria.destination_ids = offer_catalog->match_destinations(destination);
+            }
+        }
+
+        // Dates the catalog cannot parse are left to SQL Server's own parsing
+        bool dates_ok = (start_date.isEmpty() || criteria.start_date.isValid()) &&
+                        (end_date.isEmpty() || criteria.end_date.isValid());
+        if (dates_ok)
+        {
+            Query_Result result(Result_Type::SUCCESS, "Offers retrieved from catalog");
+            result.data = offer_catalog->search(criteria);
+            return result;
+        }
+    }
+
+    QString query = "SELECT " + (request.limit > 0 ? dialect->top(request.limit) : QString()) +
+                   get_select_list(Listing::OFFERS, request.fields) + " "
                    "FROM Offers o "
                    "LEFT JOIN Destinations d ON o.Destination_ID = d.Destination_ID "
                    "LEFT JOIN Accommodations a ON o.Accommodation_ID = a.Accommodation_ID "
@@ -972,7 +1617,25 @@ Query_Result Database_Manager::search_offers(const QString& destination, qreal m
 
     if (!destination.isEmpty())
     {
-        query += QString(" AND (d.Name LIKE '%%1%' OR d.Country LIKE '%%1%')").arg(escape_string(destination));
+        QSet<int> destination_ids;
+        if (resolve_destination_ids(destination, destination_ids))
+        {
+            if (destination_ids.isEmpty())
+            {
+                return Query_Result(Result_Type::SUCCESS, "No matching destinations");
+            }
+
+            QStringList id_list;
+            for (int id : std::as_const(destination_ids))
+            {
+                id_list << QString::number(id);
+            }
+            query += QString(" AND o.Destination_ID IN (%1)").arg(id_list.join(","));
+        }
+        else
+        {
+            query += QString(" AND (d.Name LIKE '%%1%' OR d.Country LIKE '%%1%')").arg(escape_string(destination));
+        }
     }
     
     if (min_price > 0)
@@ -995,7 +1658,16 @@ Query_Result Database_Manager::search_offers(const QString& destination, qreal m
         query += QString(" AND o.Return_Date <= '%1'").arg(escape_string(end_date));
     }
     
-    query += " ORDER BY o.Departure_Date";
+    if (request.has_after())
+    {
+        query += " AND " + get_keyset_condition(request, "o.Departure_Date", "o.Offer_ID", false);
+    }
+    
+    query += " ORDER BY o.Departure_Date, o.Offer_ID";
+    if (request.limit > 0)
+    {
+        query += dialect->limit(request.limit);
+    }
     
     return execute_select(query);
 }
@@ -1019,7 +1691,12 @@ Query_Result Database_Manager::add_offer(const Offer_Data& offer)
                         escape_string(offer.description),
                         escape_string(offer.status));
     
-    return execute_insert(query);
+    Query_Result result = execute_insert(query);
+    if (result.is_success())
+    {
+        refresh_offer_catalog();
+    }
+    return result;
 }
 
 Query_Result Database_Manager::update_offer(const Offer_Data& offer)
@@ -1027,7 +1704,7 @@ Query_Result Database_Manager::update_offer(const Offer_Data& offer)
     QString query = QString("UPDATE Offers SET Name = '%1', Destination_ID = %2, Accommodation_ID = %3, "
                            "Types_of_Transport_ID = %4, Price_per_Person = %5, Duration_Days = %6, "
                            "Departure_Date = '%7', Return_Date = '%8', Total_Seats = %9, Reserved_Seats = %10, "
-                           "Included_Services = '%11', Description = '%12', Status = '%13', Date_Modified = GETDATE() "
+                           "Included_Services = '%11', Description = '%12', Status = '%13', Date_Modified = " + dialect->now() + " "
                            "WHERE Offer_ID = %14")
                    .arg(escape_string(offer.name))
                    .arg(offer.destination_id)
@@ -1044,102 +1721,940 @@ Query_Result Database_Manager::update_offer(const Offer_Data& offer)
                         escape_string(offer.status))
                    .arg(offer.id);
     
-    return execute_update(query);
+    // Reserved_Seats is written as sent, so keep bookings out until the inventory follows
+    QWriteLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
+    Query_Result result = execute_update(query);
+    if (result.is_success())
+    {
+        refresh_offer_catalog();
+
+        if (result.affected_rows > 0)
+        {
+            booking_statistics->set_offer_destination(offer.id, offer.destination_id);
+        }
+
+        if (is_seat_inventory_ready())
+        {
+            if (offer.status == "active")
+            {
+                int queued_seats = write_behind_queue->get_pending_seats_by_offer().value(offer.id, 0);
+                seat_inventory->set_offer(offer.id, offer.total_seats, offer.reserved_seats + queued_seats,
+                                          offer.price_per_person);
+            }
+            else
+            {
+                seat_inventory->remove_offer(offer.id);
+            }
+        }
+    }
+    return result;
 }
 
 Query_Result Database_Manager::delete_offer(int offer_id)
 {
     QString query = QString("DELETE FROM Offers WHERE Offer_ID = %1").arg(offer_id);
-    return execute_delete(query);
+    Query_Result result = execute_delete(query);
+    if (result.is_success())
+    {
+        offer_catalog->remove_offer(offer_id);
+        seat_inventory->remove_offer(offer_id);
+    }
+    return result;
 }
 
-// Reservation management
-Query_Result Database_Manager::book_offer(int user_id, int offer_id, int person_count)
+// Offer catalog
+bool Database_Manager::load_offer_catalog()
 {
-    // Begin transaction FIRST to ensure atomic operation
-    if (!begin_transaction())
-    {
-        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to begin transaction");
-    }
-    
-    // ATOMICALLY check availability and reserve seats with row locking
-    QString lock_query = QString("SELECT Total_Seats, Reserved_Seats, Price_per_Person "
-                                 "FROM Offers WITH (UPDLOCK, ROWLOCK) WHERE Offer_ID = %1").arg(offer_id);
-    
-    Query_Result offer_result = execute_query(lock_query);
-    if (!offer_result.is_success() || offer_result.data.isEmpty())
-    {
-        rollback_transaction();
-        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "Offer not found");
-    }
-    
-    auto offer_data = offer_result.data[0];
-    int total_seats = offer_data["Total_Seats"].toInt();
-    int reserved_seats = offer_data["Reserved_Seats"].toInt();
-    int available_seats = total_seats - reserved_seats;
-    
-    // Check seat availability within the locked transaction
-    if (person_count > available_seats)
+    if (!Config::Cache::ENABLE_OFFER_CATALOG || is_demo_mode)
     {
-        rollback_transaction();
-        return Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats");
+        return false;
     }
-    
-    qreal price_per_person = offer_data["Price_per_Person"].toReal();
-    qreal total_price = price_per_person * person_count;
-    
-    // Insert reservation first
-    QString insert_query = QString("INSERT INTO Reservations (User_ID, Offer_ID, Number_of_Persons, Total_Price, Status) VALUES (%1, %2, %3, %4, 'pending')")
-                          .arg(user_id).arg(offer_id).arg(person_count).arg(total_price);
-    
-    Query_Result insert_result = execute_query(insert_query);
-    if (!insert_result.is_success())
+
+    Query_Result result = execute_select(get_offer_catalog_sql() + " WHERE o.Status = 'active'");
+    if (!result.is_success())
     {
-        rollback_transaction();
-        return insert_result;
+        log_error("load_offer_catalog", result.message);
+        offer_catalog->clear();
+        return false;
     }
-    
-    // Update offer reserved seats with constraint check in SQL
-    QString update_query = QString("UPDATE Offers SET Reserved_Seats = Reserved_Seats + %1 "
-                                  "WHERE Offer_ID = %2 AND Reserved_Seats + %1 <= Total_Seats")
-                          .arg(person_count).arg(offer_id);
-    
-    Query_Result update_result = execute_query(update_query);
-    if (!update_result.is_success())
+
+    offer_catalog->load(result.data);
+    Utils::Logger::info(QString("Offer catalog loaded: %1 active offers").arg(offer_catalog->size()));
+    return true;
+}
+
+bool Database_Manager::refresh_offer_catalog()
+{
+    if (!is_offer_catalog_ready())
     {
-        rollback_transaction();
-        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to update reserved seats");
+        return false;
     }
-    
-    // Verify the update affected a row (seat constraint was satisfied)
-    if (update_result.affected_rows == 0)
+
+    QDateTime watermark = offer_catalog->get_watermark();
+    if (!watermark.isValid())
     {
-        rollback_transaction();
-        return Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats - concurrent booking detected");
+        return load_offer_catalog();
     }
-    
-    if (!commit_transaction())
+
+    // '>=' re-reads rows sharing the watermark timestamp; upserts are idempotent
+    QString query = get_offer_catalog_sql() + QString(" WHERE o.Date_Modified >= %1")
+                   .arg(dialect->datetime_literal(watermark));
+    Query_Result result = execute_select(query);
+    if (!result.is_success())
     {
-        rollback_transaction();
-        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to commit transaction");
+        log_error("refresh_offer_catalog", result.message);
+        return false;
     }
-    
-    return Query_Result(Result_Type::SUCCESS, "Booking created successfully");
+
+    offer_catalog->apply_changes(result.data);
+    return true;
 }
 
-Query_Result Database_Manager::get_user_reservations(int user_id)
+bool Database_Manager::is_offer_catalog_ready() const
 {
-    QString query = QString("SELECT r.Reservation_ID, r.User_ID, r.Offer_ID, r.Number_of_Persons, r.Total_Price, "
-                           "r.Reservation_Date, r.Status, r.Notes, "
-                           "o.Name as Offer_Name, d.Name as Destination_Name, d.Country "
-                           "FROM Reservations r "
-                           "LEFT JOIN Offers o ON r.Offer_ID = o.Offer_ID "
-                           "LEFT JOIN Destinations d ON o.Destination_ID = d.Destination_ID "
-                           "WHERE r.User_ID = %1 ORDER BY r.Reservation_Date DESC").arg(user_id);
-    return execute_select(query);
+    return Config::Cache::ENABLE_OFFER_CATALOG && !is_demo_mode && offer_catalog->is_loaded();
 }
 
-Query_Result Database_Manager::get_offer_reservations(int offer_id)
+bool Database_Manager::serves_offers_from_catalog() const
+{
+    // Demo mode has no SQL to fall back on: the generated offers are only in the catalog
+    return is_offer_catalog_ready() || (is_demo_mode && offer_catalog->is_loaded());
+}
+
+// Destination index
+bool Database_Manager::load_destination_index()
+{
+    if (!Config::Cache::ENABLE_DESTINATION_INDEX || is_demo_mode)
+    {
+        return false;
+    }
+
+    Query_Result result = execute_select("SELECT Destination_ID, Name, Country FROM Destinations");
+    if (!result.is_success())
+    {
+        log_error("load_destination_index", result.message);
+        destination_index->clear();
+        return false;
+    }
+
+    destination_index->build(result.data);
+    Utils::Logger::info(QString("Destination index built: %1 destinations").arg(destination_index->size()));
+    return true;
+}
+
+bool Database_Manager::is_destination_index_ready() const
+{
+    return Config::Cache::ENABLE_DESTINATION_INDEX && !is_demo_mode && destination_index->is_built();
+}
+
+bool Database_Manager::resolve_destination_ids(const QString& text, QSet<int>& destination_ids) const
+{
+    if (!is_destination_index_ready())
+    {
+        return false;
+    }
+
+    destination_ids = destination_index->lookup(text, Config::Cache::DESTINATION_MIN_SIMILARITY);
+    return true;
+}
+
+// Seat inventory and write-behind queue
+bool Database_Manager::load_seat_inventory()
+{
+    if (!Config::Booking::ENABLE_SEAT_INVENTORY || is_demo_mode)
+    {
+        return false;
+    }
+
+    if (!write_behind_queue->open())
+    {
+        log_error("load_seat_inventory", "Booking journal unavailable");
+        return false;
+    }
+
+    // Recovery: persist what the previous run acknowledged but never wrote
+    int recovered = write_behind_queue->size();
+    if (recovered > 0)
+    {
+        int persisted = 0;
+        int flushed = 0;
+        do
+        {
+            flushed = flush_write_behind(recovered);
+            persisted += flushed;
+        } while (flushed > 0 && write_behind_queue->size() > 0);
+        Utils::Logger::info(QString("Write-behind recovery: %1 of %2 bookings persisted").arg(persisted).arg(recovered));
+    }
+
+    QWriteLocker sync_locker(&seat_sync_lock);
+
+    Query_Result result = execute_select("SELECT Offer_ID, Total_Seats, Reserved_Seats, Price_per_Person "
+                                         "FROM Offers WHERE Status = 'active'");
+    if (!result.is_success())
+    {
+        log_error("load_seat_inventory", result.message);
+        seat_inventory->clear();
+        return false;
+    }
+
+    seat_inventory->reconcile(result.data, write_behind_queue->get_pending_seats_by_offer());
+    Utils::Logger::info(QString("Seat inventory loaded: %1 active offers").arg(seat_inventory->size()));
+    return true;
+}
+
+int Database_Manager::reconcile_seat_inventory()
+{
+    if (!is_seat_inventory_ready())
+    {
+        return 0;
+    }
+
+    // Exclusive: no booking, cancel or flush may move seats while both sides are read
+    QWriteLocker sync_locker(&seat_sync_lock);
+
+    Query_Result result = execute_select("SELECT Offer_ID, Total_Seats, Reserved_Seats, Price_per_Person "
+                                         "FROM Offers WHERE Status = 'active'");
+    if (!result.is_success())
+    {
+        log_error("reconcile_seat_inventory", result.message);
+        return 0;
+    }
+
+    int corrected = seat_inventory->reconcile(result.data, write_behind_queue->get_pending_seats_by_offer());
+    if (corrected > 0)
+    {
+        Utils::Logger::warning(QString("Seat inventory reconciled: %1 offers corrected").arg(corrected));
+    }
+    return corrected;
+}
+
+int Database_Manager::flush_write_behind(int max_count)
+{
+    if (is_demo_mode || !write_behind_queue->is_open())
+    {
+        return 0;
+    }
+
+    if (max_count < 0)
+    {
+        max_count = Config::Booking::WRITE_BEHIND_BATCH_SIZE;
+    }
+
+    // SQL Server accepts at most 1000 rows in one VALUES list
+    qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    const QList<Pending_Booking> batch = write_behind_queue->peek_ready(qMin(max_count, 1000), now_ms);
+    if (batch.isEmpty())
+    {
+        return 0;
+    }
+
+    QList<Batch_Operation> operations;
+    operations.reserve(batch.size());
+    for (const Pending_Booking& booking : batch)
+    {
+        Batch_Operation operation;
+        operation.kind = Batch_Operation::Kind::BOOK;
+        operation.user_id = booking.user_id;
+        operation.offer_id = booking.offer_id;
+        operation.person_count = booking.person_count;
+        operation.total_price = booking.total_price;
+        operation.created_at = booking.created_at;
+        operation.token = booking.token;
+        operations.append(operation);
+    }
+
+    // The whole queue head goes to SQL as one group commit, a bad row only fails itself
+    QList<Query_Result> results;
+    apply_batch(operations, results);
+
+    QReadLocker sync_locker(&seat_sync_lock);
+
+    int persisted = 0;
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        const Pending_Booking& booking = batch[i];
+        const Query_Result& result = results[i];
+
+        if (result.is_success())
+        {
+            write_behind_queue->mark_done(booking.token);
+            ++persisted;
+            continue;
+        }
+
+        // Connection trouble: keep it queued for the next flush
+        if (result.type == Result_Type::ERROR_CONNECTION)
+        {
+            continue;
+        }
+
+        // The client was told it is booked: only a constraint makes that final, and even then the
+        // booking is kept as a dead letter in the journal for the operator to look at and replay
+        if (result.type == Result_Type::ERROR_CONSTRAINT &&
+            write_behind_queue->mark_rejected(booking.token, result.message))
+        {
+            log_error("flush_write_behind", QString("Booking %1 (user %2, offer %3, %4 persons) rejected, kept in the journal "
+                                                    "for --replay-rejected-bookings: %5")
+                      .arg(booking.token)
+                      .arg(booking.user_id)
+                      .arg(booking.offer_id)
+                      .arg(booking.person_count)
+                      .arg(result.message));
+            seat_inventory->release(booking.offer_id, booking.person_count);
+            offer_catalog->adjust_reserved_seats(booking.offer_id, -booking.person_count);
+            booking_statistics->record_booking_removed(booking.offer_id, booking.person_count, booking.total_price,
+                                                       booking.created_at.date());
+            continue;
+        }
+
+        // Deadlock victim, lock or query timeout, trigger: may pass later, so it stays queued and backs off
+        int attempts = booking.attempts + 1;
+        qint64 delay_ms = qMin<qint64>(qint64(Config::Booking::WRITE_BEHIND_FLUSH_INTERVAL_MS) << qMin(attempts, 16),
+                                       Config::Booking::WRITE_BEHIND_RETRY_MAX_DELAY_MS);
+        write_behind_queue->mark_failed(booking.token, now_ms + delay_ms);
+        Utils::Logger::warning(QString("Write-behind: booking %1 failed (attempt %2), retrying in %3 ms: %4")
+                               .arg(booking.token)
+                               .arg(attempts)
+                               .arg(delay_ms)
+                               .arg(result.message));
+    }
+
+    return persisted;
+}
+
+int Database_Manager::get_pending_write_count() const
+{
+    return write_behind_queue->size();
+}
+
+int Database_Manager::get_rejected_write_count() const
+{
+    return write_behind_queue->get_rejected_count();
+}
+
+int Database_Manager::requeue_rejected_bookings()
+{
+    if (is_demo_mode || !write_behind_queue->open())
+    {
+        return -1;
+    }
+
+    // Before load_seat_inventory(): its recovery flush persists them and the seats are counted again
+    return write_behind_queue->requeue_rejected();
+}
+
+bool Database_Manager::is_seat_inventory_ready() const
+{
+    return Config::Booking::ENABLE_SEAT_INVENTORY && !is_demo_mode && seat_inventory->is_loaded();
+}
+
+// Reservation management
+Query_Result Database_Manager::book_offer(int user_id, int offer_id, int person_count,
+    const QList<Reservation_Person_Data>& persons)
+{
+    // Active offers are decided in memory and persisted by the write-behind queue.
+    // The journal does not carry travellers, so bookings with persons go to SQL directly.
+    Query_Result memory_result;
+    if (persons.isEmpty() && reserve_in_memory(user_id, offer_id, person_count, memory_result))
+    {
+        return memory_result;
+    }
+
+    QReadLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
+    // Seats of an active offer are still taken in memory first, the database lags behind the queue
+    bool held_in_memory = false;
+    if (!persons.isEmpty() && sync_locker.readWriteLock())
+    {
+        qreal price_per_person = 0.0;
+        Reserve_Status status = seat_inventory->try_reserve(offer_id, person_count, price_per_person);
+        if (status == Reserve_Status::NOT_ENOUGH_SEATS)
+        {
+            return Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats");
+        }
+        held_in_memory = status == Reserve_Status::RESERVED;
+    }
+
+    Query_Result result = is_procedure_available("sp_Book_Offer")
+        ? book_offer_with_procedure(user_id, offer_id, person_count, persons)
+        : book_offer_with_statements(user_id, offer_id, person_count, persons);
+
+    if (!result.is_success())
+    {
+        if (held_in_memory)
+        {
+            seat_inventory->release(offer_id, person_count);
+        }
+        return result;
+    }
+
+    offer_catalog->adjust_reserved_seats(offer_id, person_count);
+    if (!held_in_memory)
+    {
+        seat_inventory->add_reserved(offer_id, person_count); // in case a reconcile picked the offer up meanwhile
+    }
+    record_statistics_booking(offer_id, person_count, result.data[0]["Total_Price"].toDouble(), QDate::currentDate());
+    return result;
+}
+
+Query_Result Database_Manager::book_offer_with_procedure(int user_id, int offer_id, int person_count,
+    const QList<Reservation_Person_Data>& persons)
+{
+    QVariant persons_json(QMetaType::fromType<QString>()); // NULL when no travellers are attached
+    if (!persons.isEmpty())
+    {
+        QJsonArray persons_array;
+        for (const Reservation_Person_Data& person : persons)
+        {
+            QJsonObject person_object;
+            person_object["full_name"] = person.full_name;
+            person_object["cnp"] = person.cnp;
+            person_object["birth_date"] = person.birth_date;
+            person_object["person_type"] = person.person_type;
+            persons_array.append(person_object);
+        }
+        persons_json = QString::fromUtf8(QJsonDocument(persons_array).toJson(QJsonDocument::Compact));
+    }
+
+    Query_Result result = call_procedure("sp_Book_Offer",
+        { user_id, offer_id, person_count, persons_json },
+        { { "Reservation_ID", 0 }, { "Total_Price", 0.0 }, { "Result_Code", -1 } });
+    if (!result.is_success())
+    {
+        return result;
+    }
+
+    switch (result.data[0]["Result_Code"].toInt())
+    {
+    case 0:
+        result.message = "Booking created successfully";
+        result.affected_rows = 1;
+        return result;
+    case 1:
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, Config::ErrorMessages::OFFER_NOT_FOUND);
+    case 2:
+        return Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats");
+    default:
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Unexpected result from sp_Book_Offer");
+    }
+}
+
+Query_Result Database_Manager::book_offer_with_statements(int user_id, int offer_id, int person_count,
+    const QList<Reservation_Person_Data>& persons)
+{
+    // Begin transaction FIRST to ensure atomic operation
+    if (!begin_transaction())
+    {
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to begin transaction");
+    }
+    
+    // ATOMICALLY check availability and reserve seats with row locking
+    QString lock_query = QString("SELECT Total_Seats, Reserved_Seats, Price_per_Person "
+                                 "FROM Offers" + dialect->update_lock_hint() + " WHERE Offer_ID = %1").arg(offer_id);
+    
+    Query_Result offer_result = execute_query(lock_query);
+    if (!offer_result.is_success() || offer_result.data.isEmpty())
+    {
+        rollback_transaction();
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, Config::ErrorMessages::OFFER_NOT_FOUND);
+    }
+    
+    auto offer_data = offer_result.data[0];
+    int total_seats = offer_data["Total_Seats"].toInt();
+    int reserved_seats = offer_data["Reserved_Seats"].toInt();
+    int available_seats = total_seats - reserved_seats;
+    
+    // Check seat availability within the locked transaction
+    if (person_count > available_seats)
+    {
+        rollback_transaction();
+        return Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats");
+    }
+    
+    qreal price_per_person = offer_data["Price_per_Person"].toReal();
+    qreal total_price = price_per_person * person_count;
+    
+    // Insert reservation first, reading back its id for the travellers
+    QString insert_query = dialect->get_insert_returning_id_sql(
+        QString("INSERT INTO Reservations (User_ID, Offer_ID, Number_of_Persons, Total_Price, Status) VALUES (%1, %2, %3, %4, 'pending')")
+            .arg(user_id).arg(offer_id).arg(person_count).arg(total_price),
+        "Reservation_ID");
+    
+    Query_Result insert_result = execute_batch(insert_query);
+    if (!insert_result.is_success() || insert_result.data.isEmpty())
+    {
+        rollback_transaction();
+        return insert_result.is_success() ? Query_Result(Result_Type::ERROR_EXECUTION, "Failed to create reservation") : insert_result;
+    }
+    int reservation_id = insert_result.data[0]["Reservation_ID"].toInt();
+    
+    // Update offer reserved seats with constraint check in SQL
+    QString update_query = QString("UPDATE Offers SET Reserved_Seats = Reserved_Seats + %1 "
+                                  "WHERE Offer_ID = %2 AND Reserved_Seats + %1 <= Total_Seats")
+                          .arg(person_count).arg(offer_id);
+    
+    Query_Result update_result = execute_query(update_query);
+    if (!update_result.is_success())
+    {
+        rollback_transaction();
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to update reserved seats");
+    }
+    
+    // Verify the update affected a row (seat constraint was satisfied)
+    if (update_result.affected_rows == 0)
+    {
+        rollback_transaction();
+        return Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats - concurrent booking detected");
+    }
+    
+    for (Reservation_Person_Data person : persons)
+    {
+        person.reservation_id = reservation_id;
+        Query_Result person_result = add_reservation_person(person);
+        if (!person_result.is_success())
+        {
+            rollback_transaction();
+            return person_result;
+        }
+    }
+    
+    if (!commit_transaction())
+    {
+        rollback_transaction();
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to commit transaction");
+    }
+    
+    Query_Result result(Result_Type::SUCCESS, "Booking created successfully");
+    result.data.append({ { "Reservation_ID", reservation_id }, { "Total_Price", total_price } });
+    result.affected_rows = 1;
+    return result;
+}
+
+bool Database_Manager::reserve_in_memory(int user_id, int offer_id, int person_count, Query_Result& result)
+{
+    if (!is_seat_inventory_ready())
+    {
+        return false;
+    }
+
+    QReadLocker sync_locker(&seat_sync_lock);
+
+    qreal price_per_person = 0.0;
+    Reserve_Status status = seat_inventory->try_reserve(offer_id, person_count, price_per_person);
+    if (status == Reserve_Status::UNKNOWN_OFFER)
+    {
+        // Not an active offer in memory, let the database decide
+        return false;
+    }
+
+    if (status == Reserve_Status::NOT_ENOUGH_SEATS)
+    {
+        result = Query_Result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats");
+        return true;
+    }
+
+    Pending_Booking booking;
+    booking.token = Utils::Random::generate_uuid();
+    booking.user_id = user_id;
+    booking.offer_id = offer_id;
+    booking.person_count = person_count;
+    booking.total_price = price_per_person * person_count;
+    booking.created_at = QDateTime::currentDateTime();
+
+    if (!write_behind_queue->enqueue(booking))
+    {
+        seat_inventory->release(offer_id, person_count);
+        result = Query_Result(Result_Type::ERROR_EXECUTION, "Failed to record booking");
+        return true;
+    }
+
+    offer_catalog->adjust_reserved_seats(offer_id, person_count);
+    record_statistics_booking(offer_id, person_count, booking.total_price, booking.created_at.date());
+    result = Query_Result(Result_Type::SUCCESS, "Booking created successfully");
+    return true;
+}
+
+bool Database_Manager::apply_batch(const QList<Batch_Operation>& operations, QList<Query_Result>& results)
+{
+    if (apply_batch_transaction(operations, results))
+    {
+        return true;
+    }
+    if (operations.size() <= 1 || results.first().type == Result_Type::ERROR_CONNECTION)
+    {
+        return false;
+    }
+
+    // A foreign key, a trigger or a deadlock fails the whole transaction; each operation
+    // is retried in a transaction of its own so only the offending request fails
+    Utils::Logger::warning(QString("Batch of %1 operations failed, applying them one by one: %2")
+                           .arg(operations.size()).arg(results.first().message));
+    for (int i = 0; i < operations.size(); ++i)
+    {
+        QList<Query_Result> single_result;
+        apply_batch_transaction({ operations[i] }, single_result);
+        results[i] = single_result.first();
+    }
+    return true;
+}
+
+bool Database_Manager::apply_batch_transaction(const QList<Batch_Operation>& operations, QList<Query_Result>& results)
+{
+    results.clear();
+    if (operations.isEmpty())
+    {
+        return true;
+    }
+
+    QList<Batch_Operation> bookings;
+    QList<Batch_Operation> cancellations;
+    QList<int> booking_positions;
+    QList<int> cancellation_positions;
+    for (int i = 0; i < operations.size(); ++i)
+    {
+        if (operations[i].kind == Batch_Operation::Kind::BOOK)
+        {
+            bookings.append(operations[i]);
+            booking_positions.append(i);
+        }
+        else
+        {
+            cancellations.append(operations[i]);
+            cancellation_positions.append(i);
+        }
+    }
+
+    auto fail_all = [&](const Query_Result& error) {
+        results = QList<Query_Result>(operations.size(), error);
+        return false;
+    };
+
+    QReadLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
+    if (!begin_transaction())
+    {
+        return fail_all(Query_Result(Result_Type::ERROR_CONNECTION, "Failed to begin transaction"));
+    }
+
+    QList<QHash<QString, QVariant>> booking_rows;
+    QList<QHash<QString, QVariant>> cancellation_rows;
+    if (!dialect->supports_batches())
+    {
+        Query_Result error;
+        if (!apply_batch_with_statements(bookings, cancellations, booking_rows, cancellation_rows, error))
+        {
+            rollback_transaction();
+            return fail_all(error);
+        }
+    }
+
+    if (dialect->supports_batches() && !bookings.isEmpty())
+    {
+        Query_Result batch_result = execute_batch(get_batch_booking_sql(bookings));
+        if (!batch_result.is_success() || batch_result.data.size() != bookings.size())
+        {
+            rollback_transaction();
+            return fail_all(batch_result.is_success() ? Query_Result(Result_Type::ERROR_EXECUTION, "Unexpected booking batch result")
+                                                      : batch_result);
+        }
+        booking_rows = batch_result.data;
+    }
+
+    if (dialect->supports_batches() && !cancellations.isEmpty())
+    {
+        Query_Result batch_result = execute_batch(get_batch_cancel_sql(cancellations));
+        if (!batch_result.is_success() || batch_result.data.size() != cancellations.size())
+        {
+            rollback_transaction();
+            return fail_all(batch_result.is_success() ? Query_Result(Result_Type::ERROR_EXECUTION, "Unexpected cancellation batch result")
+                                                      : batch_result);
+        }
+        cancellation_rows = batch_result.data;
+    }
+
+    if (!commit_transaction())
+    {
+        rollback_transaction();
+        return fail_all(Query_Result(Result_Type::ERROR_EXECUTION, "Failed to commit transaction"));
+    }
+
+    results = QList<Query_Result>(operations.size());
+
+    // Rows come back ordered by Seq, which is the 1-based position in the sub-batch
+    for (const auto& row : std::as_const(booking_rows))
+    {
+        int index = row.value("Seq").toInt() - 1;
+        const Batch_Operation& booking = bookings[index];
+        int outcome = row.value("Outcome").toInt();
+
+        Query_Result result(Result_Type::ERROR_CONSTRAINT, "Not enough available seats");
+        if (outcome != 0)
+        {
+            result = Query_Result(Result_Type::SUCCESS, outcome == 1 ? "Booking created successfully" : "Booking already persisted");
+            result.data.append(row);
+
+            // A queued booking keeps the day it was accepted, which may already be rolled up
+            if (outcome == 1)
+            {
+                revenue_rollup->mark_dirty(booking.created_at.date());
+            }
+
+            // Write-behind bookings were counted in memory when they were accepted
+            if (outcome == 1 && booking.token.isEmpty())
+            {
+                offer_catalog->adjust_reserved_seats(booking.offer_id, booking.person_count);
+                seat_inventory->add_reserved(booking.offer_id, booking.person_count);
+                record_statistics_booking(booking.offer_id, booking.person_count,
+                                          row.value("Total_Price").toDouble(), QDate::currentDate());
+            }
+        }
+        results[booking_positions[index]] = result;
+    }
+
+    for (const auto& row : std::as_const(cancellation_rows))
+    {
+        int index = row.value("Seq").toInt() - 1;
+        int outcome = row.value("Outcome").toInt();
+
+        Query_Result result;
+        if (outcome == 1)
+        {
+            int offer_id = row.value("Offer_ID").toInt();
+            int person_count = row.value("Number_of_Persons").toInt();
+            offer_catalog->adjust_reserved_seats(offer_id, -person_count);
+            seat_inventory->release(offer_id, person_count);
+            booking_statistics->record_status_change(offer_id, person_count, row.value("Total_Price").toDouble(),
+                                                     row.value("Previous_Status").toString(), "cancelled");
+            revenue_rollup->mark_dirty(row.value("Reservation_Date").toDate());
+
+            result = Query_Result(Result_Type::SUCCESS, "Reservation cancelled successfully");
+            result.data.append(row);
+        }
+        else if (row.value("Current_Status").isNull())
+        {
+            result = Query_Result(Result_Type::DB_ERROR_NO_DATA, "Reservation not found");
+        }
+        else
+        {
+            result = Query_Result(Result_Type::ERROR_CONSTRAINT, "Reservation already cancelled");
+        }
+        results[cancellation_positions[index]] = result;
+    }
+
+    return true;
+}
+
+bool Database_Manager::apply_batch_with_statements(const QList<Batch_Operation>& bookings,
+    const QList<Batch_Operation>& cancellations, QList<QHash<QString, QVariant>>& booking_rows,
+    QList<QHash<QString, QVariant>>& cancellation_rows, Query_Result& error)
+{
+    // Same rows as the batch SQL, one operation at a time inside the caller's transaction.
+    // Seats are taken by a guarded UPDATE per booking, so a row that does not fit only
+    // rejects itself, as it does in get_batch_booking_sql().
+    for (int i = 0; i < bookings.size(); ++i)
+    {
+        const Batch_Operation& booking = bookings[i];
+        QHash<QString, QVariant> row = { { "Seq", i + 1 },
+                                         { "Offer_ID", booking.offer_id },
+                                         { "Number_of_Persons", booking.person_count },
+                                         { "Outcome", 0 },
+                                         { "Reservation_ID", QVariant() },
+                                         { "Total_Price", QVariant() } };
+
+        if (!booking.token.isEmpty())
+        {
+            Query_Result replayed = execute_select(QString("SELECT Reservation_ID FROM Write_Behind_Applied WHERE Token = '%1'")
+                                                   .arg(escape_string(booking.token)));
+            if (!replayed.is_success())
+            {
+                error = replayed;
+                return false;
+            }
+            if (!replayed.data.isEmpty())
+            {
+                row["Outcome"] = 2;
+                row["Reservation_ID"] = replayed.data[0]["Reservation_ID"];
+                booking_rows.append(row);
+                continue;
+            }
+        }
+
+        Query_Result seats = execute_update(QString("UPDATE Offers SET Reserved_Seats = Reserved_Seats + %1 "
+                                                    "WHERE Offer_ID = %2 AND Status = 'active' AND Reserved_Seats + %1 <= Total_Seats")
+                                            .arg(booking.person_count).arg(booking.offer_id));
+        if (!seats.is_success())
+        {
+            error = seats;
+            return false;
+        }
+        if (seats.affected_rows == 0)
+        {
+            booking_rows.append(row);
+            continue;
+        }
+
+        QString insert_query = QString("INSERT INTO Reservations (User_ID, Offer_ID, Number_of_Persons, Total_Price, Status, Reservation_Date) "
+                                       "SELECT %1, Offer_ID, %2, %3, 'pending', %4 FROM Offers WHERE Offer_ID = %5")
+                              .arg(booking.user_id)
+                              .arg(booking.person_count)
+                              .arg(booking.total_price < 0 ? QString("%1 * Price_per_Person").arg(booking.person_count)
+                                                           : QString::number(booking.total_price, 'f', 2),
+                                   booking.created_at.isValid() ? dialect->datetime_literal(booking.created_at) : dialect->now())
+                              .arg(booking.offer_id);
+        Query_Result inserted = execute_batch(dialect->get_insert_returning_id_sql(insert_query, "Reservation_ID"));
+        if (!inserted.is_success() || inserted.data.isEmpty())
+        {
+            error = inserted.is_success() ? Query_Result(Result_Type::ERROR_EXECUTION, "Failed to create reservation") : inserted;
+            return false;
+        }
+
+        int reservation_id = inserted.data[0]["Reservation_ID"].toInt();
+        QVariant total_price = booking.total_price;
+        if (booking.total_price < 0)
+        {
+            Query_Result priced = execute_select(QString("SELECT Total_Price FROM Reservations WHERE Reservation_ID = %1").arg(reservation_id));
+            total_price = priced.data.isEmpty() ? QVariant() : priced.data[0]["Total_Price"];
+        }
+
+        if (!booking.token.isEmpty())
+        {
+            Query_Result applied = execute_insert(QString("INSERT INTO Write_Behind_Applied (Token, Reservation_ID) VALUES ('%1', %2)")
+                                                  .arg(escape_string(booking.token)).arg(reservation_id));
+            if (!applied.is_success())
+            {
+                error = applied;
+                return false;
+            }
+        }
+
+        row["Outcome"] = 1;
+        row["Reservation_ID"] = reservation_id;
+        row["Total_Price"] = total_price;
+        booking_rows.append(row);
+    }
+
+    // A reservation repeated in the batch finds itself already cancelled the second time
+    for (int i = 0; i < cancellations.size(); ++i)
+    {
+        int reservation_id = cancellations[i].reservation_id;
+        QHash<QString, QVariant> row = { { "Seq", i + 1 },
+                                         { "Reservation_ID", reservation_id },
+                                         { "Offer_ID", QVariant() },
+                                         { "Number_of_Persons", QVariant() },
+                                         { "Current_Status", QVariant() },
+                                         { "Previous_Status", QVariant() },
+                                         { "Total_Price", QVariant() },
+                                         { "Reservation_Date", QVariant() },
+                                         { "Outcome", 0 } };
+
+        Query_Result current = execute_select(QString("SELECT Offer_ID, Number_of_Persons, Status, Total_Price, Reservation_Date "
+                                                      "FROM Reservations WHERE Reservation_ID = %1").arg(reservation_id));
+        if (!current.is_success())
+        {
+            error = current;
+            return false;
+        }
+        if (current.data.isEmpty())
+        {
+            cancellation_rows.append(row);
+            continue;
+        }
+
+        const auto& reservation = current.data[0];
+        row["Current_Status"] = "cancelled";
+        if (reservation["Status"].toString() == "cancelled")
+        {
+            cancellation_rows.append(row);
+            continue;
+        }
+
+        int offer_id = reservation["Offer_ID"].toInt();
+        int person_count = reservation["Number_of_Persons"].toInt();
+        QStringList statements = {
+            QString("UPDATE Reservations SET Status = 'cancelled' WHERE Reservation_ID = %1").arg(reservation_id),
+            QString("UPDATE Offers SET Reserved_Seats = Reserved_Seats - %1 WHERE Offer_ID = %2").arg(person_count).arg(offer_id)
+        };
+        for (const QString& statement : statements)
+        {
+            Query_Result update_result = execute_update(statement);
+            if (!update_result.is_success())
+            {
+                error = update_result;
+                return false;
+            }
+        }
+
+        row["Offer_ID"] = offer_id;
+        row["Number_of_Persons"] = person_count;
+        row["Previous_Status"] = reservation["Status"];
+        row["Total_Price"] = reservation["Total_Price"];
+        row["Reservation_Date"] = reservation["Reservation_Date"];
+        row["Outcome"] = 1;
+        cancellation_rows.append(row);
+    }
+
+    return true;
+}
+
+Query_Result Database_Manager::get_user_reservations(int user_id)
+{
+    return execute_select(get_user_reservations_sql(user_id));
+}
+
+Query_Result Database_Manager::get_user_reservations(int user_id, const Listing_Request& request, const Row_Handler& handle_row)
+{
+    return stream_select(get_user_reservations_sql(user_id, request), handle_row);
+}
+
+QString Database_Manager::get_user_reservations_sql(int user_id, const Listing_Request& request) const
+{
+    QString query = QString("SELECT " + (request.limit > 0 ? dialect->top(request.limit) : QString()) +
+                           get_select_list(Listing::RESERVATIONS, request.fields) + " "
+                           "FROM Reservations r "
+                           "LEFT JOIN Offers o ON r.Offer_ID = o.Offer_ID "
+                           "LEFT JOIN Destinations d ON o.Destination_ID = d.Destination_ID "
+                           "WHERE r.User_ID = %1").arg(user_id);
+
+    if (request.has_after())
+    {
+        query += " AND " + get_keyset_condition(request, "r.Reservation_Date", "r.Reservation_ID", true);
+    }
+
+    query += " ORDER BY r.Reservation_Date DESC, r.Reservation_ID DESC";
+    if (request.limit > 0)
+    {
+        query += dialect->limit(request.limit);
+    }
+    return query;
+}
+
+QString Database_Manager::get_keyset_condition(const Listing_Request& request, const QString& key_column,
+    const QString& id_column, bool descending) const
+{
+    QString op = descending ? "<" : ">";
+    QString id_after = QString("%1 %2 %3").arg(id_column, op).arg(request.after_id);
+
+    // NULL sorts lowest on both backends: NULL keys come last in descending order,
+    // after one of them only the NULL rows with a lower id are left
+    if (request.after_key.isNull())
+    {
+        return QString("(%1 IS NULL AND %2)").arg(key_column, id_after);
+    }
+
+    QString key = request.after_key.metaType().id() == QMetaType::QDate
+        ? dialect->date_literal(request.after_key.toDate())
+        : dialect->datetime_literal(request.after_key.toDateTime());
+
+    QString condition = QString("(%1 %2 %3 OR (%1 = %3 AND %4)").arg(key_column, op, key, id_after);
+    if (descending)
+    {
+        condition += QString(" OR %1 IS NULL").arg(key_column);
+    }
+    return condition + ")";
+}
+
+Query_Result Database_Manager::get_offer_reservations(int offer_id)
 {
     QString query = QString("SELECT r.Reservation_ID, r.User_ID, r.Offer_ID, r.Number_of_Persons, r.Total_Price, "
                            "r.Reservation_Date, r.Status, r.Notes, "
@@ -1166,6 +2681,44 @@ Query_Result Database_Manager::get_reservation_by_id(int reservation_id)
 
 Query_Result Database_Manager::cancel_reservation(int reservation_id)
 {
+    // One round trip: the procedure cancels, frees the seats and reports what it freed
+    if (is_procedure_available("sp_Cancel_Reservation"))
+    {
+        QReadLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
+        Query_Result result = call_procedure("sp_Cancel_Reservation", { reservation_id },
+            { { "Offer_ID", 0 }, { "Number_of_Persons", 0 }, { "Previous_Status", QString() },
+              { "Total_Price", 0.0 }, { "Reservation_Date", QDateTime() }, { "Result_Code", -1 } });
+        if (!result.is_success())
+        {
+            return result;
+        }
+
+        switch (result.data[0]["Result_Code"].toInt())
+        {
+        case 0:
+            break;
+        case 1:
+            return Query_Result(Result_Type::DB_ERROR_NO_DATA, "Reservation not found");
+        case 2:
+            return Query_Result(Result_Type::ERROR_CONSTRAINT, "Reservation already cancelled");
+        default:
+            return Query_Result(Result_Type::ERROR_EXECUTION, "Unexpected result from sp_Cancel_Reservation");
+        }
+
+        int offer_id = result.data[0]["Offer_ID"].toInt();
+        int person_count = result.data[0]["Number_of_Persons"].toInt();
+        offer_catalog->adjust_reserved_seats(offer_id, -person_count);
+        seat_inventory->release(offer_id, person_count);
+        booking_statistics->record_status_change(offer_id, person_count, result.data[0]["Total_Price"].toDouble(),
+                                                 result.data[0]["Previous_Status"].toString(), "cancelled");
+        revenue_rollup->mark_dirty(result.data[0]["Reservation_Date"].toDate());
+
+        result.message = "Reservation cancelled successfully";
+        result.affected_rows = 1;
+        return result;
+    }
+
     // Get reservation details first
     Query_Result reservation_result = get_reservation_by_id(reservation_id);
     if (!reservation_result.is_success() || reservation_result.data.isEmpty())
@@ -1183,6 +2736,8 @@ Query_Result Database_Manager::cancel_reservation(int reservation_id)
         return Query_Result(Result_Type::ERROR_CONSTRAINT, "Reservation already cancelled");
     }
     
+    QReadLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
     // Begin transaction
     if (!begin_transaction())
     {
@@ -1215,14 +2770,71 @@ Query_Result Database_Manager::cancel_reservation(int reservation_id)
         return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to commit transaction");
     }
     
+    offer_catalog->adjust_reserved_seats(offer_id, -person_count);
+    seat_inventory->release(offer_id, person_count);
+    booking_statistics->record_status_change(offer_id, person_count, reservation_data["Total_Price"].toDouble(),
+                                             current_status, "cancelled");
+    revenue_rollup->mark_dirty(reservation_data["Reservation_Date"].toDate());
     return Query_Result(Result_Type::SUCCESS, "Reservation cancelled successfully");
 }
 
 Query_Result Database_Manager::update_reservation_status(int reservation_id, const QString& status)
 {
-    QString query = QString("UPDATE Reservations SET Status = '%1' WHERE Reservation_ID = %2")
-                   .arg(escape_string(status)).arg(reservation_id);
-    return execute_update(query);
+    // The previous status comes back with the update so the statistics can move the booking.
+    // Reservations has triggers, so OUTPUT has to go through a table variable.
+    QString query = QString(R"(
+        SET NOCOUNT ON;
+        DECLARE @changed TABLE (Offer_ID INT, Number_of_Persons INT, Total_Price DECIMAL(10,2), Previous_Status VARCHAR(20),
+                                Reservation_Date DATETIME);
+        UPDATE Reservations SET Status = '%1'
+        OUTPUT inserted.Offer_ID, inserted.Number_of_Persons, inserted.Total_Price, deleted.Status, inserted.Reservation_Date INTO @changed
+        WHERE Reservation_ID = %2;
+        SELECT Offer_ID, Number_of_Persons, Total_Price, Previous_Status, Reservation_Date FROM @changed;
+    )").arg(escape_string(status)).arg(reservation_id);
+
+    Query_Result result;
+    if (dialect->supports_batches())
+    {
+        result = execute_batch(query);
+    }
+    else
+    {
+        // RETURNING only sees the new row, so the previous status is read first in the same transaction
+        if (!begin_transaction())
+        {
+            return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to begin transaction");
+        }
+
+        result = execute_select(QString("SELECT Offer_ID, Number_of_Persons, Total_Price, Status AS Previous_Status, Reservation_Date "
+                                        "FROM Reservations WHERE Reservation_ID = %1").arg(reservation_id));
+        if (result.is_success() && !result.data.isEmpty())
+        {
+            Query_Result update_result = execute_update(QString("UPDATE Reservations SET Status = '%1' WHERE Reservation_ID = %2")
+                                                        .arg(escape_string(status)).arg(reservation_id));
+            if (!update_result.is_success())
+            {
+                result = update_result;
+            }
+        }
+
+        if (!result.is_success() || !commit_transaction())
+        {
+            rollback_transaction();
+            return result.is_success() ? Query_Result(Result_Type::ERROR_EXECUTION, "Failed to commit transaction") : result;
+        }
+    }
+
+    if (result.is_success())
+    {
+        result.affected_rows = result.data.size();
+        for (const auto& row : result.data)
+        {
+            booking_statistics->record_status_change(row["Offer_ID"].toInt(), row["Number_of_Persons"].toInt(),
+                                                     row["Total_Price"].toDouble(), row["Previous_Status"].toString(), status);
+            revenue_rollup->mark_dirty(row["Reservation_Date"].toDate());
+        }
+    }
+    return result;
 }
 
 // Reservation persons
@@ -1266,17 +2878,41 @@ Query_Result Database_Manager::delete_reservation_person(int person_id)
 // Statistics
 Query_Result Database_Manager::get_popular_destinations(int limit)
 {
-    QString query = QString("SELECT TOP %1 d.Destination_ID, d.Name, d.Country, COUNT(r.Reservation_ID) as Booking_Count "
-                           "FROM Destinations d "
-                           "LEFT JOIN Offers o ON d.Destination_ID = o.Destination_ID "
-                           "LEFT JOIN Reservations r ON o.Offer_ID = r.Offer_ID AND r.Status != 'cancelled' "
-                           "GROUP BY d.Destination_ID, d.Name, d.Country "
-                           "ORDER BY Booking_Count DESC").arg(limit);
+    if (is_booking_statistics_ready())
+    {
+        Query_Result result(Result_Type::SUCCESS, "Popular destinations from booking statistics");
+        result.data = booking_statistics->get_popular_destinations(limit);
+        return result;
+    }
+
+    QString query = "SELECT " + dialect->top(limit) + "d.Destination_ID, d.Name, d.Country, COUNT(r.Reservation_ID) as Booking_Count "
+                    "FROM Destinations d "
+                    "LEFT JOIN Offers o ON d.Destination_ID = o.Destination_ID "
+                    "LEFT JOIN Reservations r ON o.Offer_ID = r.Offer_ID AND r.Status != 'cancelled' "
+                    "GROUP BY d.Destination_ID, d.Name, d.Country "
+                    "ORDER BY Booking_Count DESC" + dialect->limit(limit);
     return execute_select(query);
 }
 
 Query_Result Database_Manager::get_revenue_report(const QString& start_date, const QString& end_date)
 {
+    // All-time totals are kept in memory, a date range still needs the table
+    if (start_date.isEmpty() && end_date.isEmpty() && is_booking_statistics_ready())
+    {
+        Query_Result result(Result_Type::SUCCESS, "Revenue report from booking statistics");
+        result.data.append(booking_statistics->get_revenue_report());
+        return result;
+    }
+
+    // Date ranges sum the daily rollup; anything the bounds do not parse as keeps the old query
+    QDateTime start_bound;
+    QDateTime end_bound;
+    if (is_revenue_rollup_ready() && Revenue_Rollup::parse_start_bound(start_date, start_bound) &&
+        Revenue_Rollup::parse_end_bound(end_date, end_bound))
+    {
+        return run_revenue_report(start_bound, end_bound, Revenue_Period::NONE);
+    }
+
     QString query = "SELECT COUNT(r.Reservation_ID) as Total_Reservations, "
                    "SUM(r.Total_Price) as Total_Revenue, "
                    "AVG(r.Total_Price) as Average_Booking_Value, "
@@ -1299,52 +2935,585 @@ Query_Result Database_Manager::get_revenue_report(const QString& start_date, con
 
 Query_Result Database_Manager::get_user_statistics()
 {
+    if (is_booking_statistics_ready())
+    {
+        Query_Result result(Result_Type::SUCCESS, "User statistics from booking statistics");
+        result.data.append(booking_statistics->get_user_statistics(QDate::currentDate()));
+        return result;
+    }
+
     QString query = "SELECT COUNT(*) as Total_Users, "
-                   "COUNT(CASE WHEN Date_Created >= DATEADD(month, -1, GETDATE()) THEN 1 END) as New_Users_This_Month, "
-                   "COUNT(CASE WHEN Date_Created >= DATEADD(week, -1, GETDATE()) THEN 1 END) as New_Users_This_Week "
+                   "COUNT(CASE WHEN Date_Created >= " + dialect->now_plus(-1, Date_Part::MONTH) + " THEN 1 END) as New_Users_This_Month, "
+                   "COUNT(CASE WHEN Date_Created >= " + dialect->now_plus(-1, Date_Part::WEEK) + " THEN 1 END) as New_Users_This_Week "
                    "FROM Users";
     return execute_select(query);
 }
 
 Query_Result Database_Manager::get_booking_statistics()
 {
+    if (is_booking_statistics_ready())
+    {
+        Query_Result result(Result_Type::SUCCESS, "Booking statistics from memory");
+        result.data.append(booking_statistics->get_booking_statistics(QDate::currentDate()));
+        return result;
+    }
+
     QString query = "SELECT COUNT(*) as Total_Bookings, "
                    "COUNT(CASE WHEN Status = 'pending' THEN 1 END) as Pending_Bookings, "
                    "COUNT(CASE WHEN Status = 'confirmed' THEN 1 END) as Confirmed_Bookings, "
                    "COUNT(CASE WHEN Status = 'paid' THEN 1 END) as Paid_Bookings, "
                    "COUNT(CASE WHEN Status = 'cancelled' THEN 1 END) as Cancelled_Bookings, "
-                   "COUNT(CASE WHEN Reservation_Date >= DATEADD(month, -1, GETDATE()) THEN 1 END) as Bookings_This_Month "
+                   "COUNT(CASE WHEN Reservation_Date >= " + dialect->now_plus(-1, Date_Part::MONTH) + " THEN 1 END) as Bookings_This_Month "
                    "FROM Reservations";
     return execute_select(query);
 }
 
-// Private helpers
-bool Database_Manager::retry_operation(std::function<bool()> operation, int max_attempts)
+Query_Result Database_Manager::get_revenue_by_period(const QString& start_date, const QString& end_date, Revenue_Period period)
+{
+    QDateTime start_bound;
+    QDateTime end_bound;
+    if (!Revenue_Rollup::parse_start_bound(start_date, start_bound) || !Revenue_Rollup::parse_end_bound(end_date, end_bound))
+    {
+        return Query_Result(Result_Type::ERROR_CONSTRAINT, "Invalid date, expected yyyy-MM-dd or an ISO date and time");
+    }
+
+    // Without a loaded rollup the same query reads everything from Reservations
+    return run_revenue_report(start_bound, end_bound, period);
+}
+
+// Booking statistics
+bool Database_Manager::load_booking_statistics()
+{
+    if (!Config::Statistics::ENABLE_BOOKING_STATISTICS || is_demo_mode)
+    {
+        return false;
+    }
+
+    // Exclusive: a booking accepted while the tables are read would be missed or counted twice
+    QWriteLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
+    if (!recount_booking_statistics(*booking_statistics))
+    {
+        booking_statistics->clear();
+        return false;
+    }
+
+    Utils::Logger::info("Booking statistics loaded");
+    return true;
+}
+
+bool Database_Manager::is_booking_statistics_ready() const
+{
+    return Config::Statistics::ENABLE_BOOKING_STATISTICS && !is_demo_mode && booking_statistics->is_loaded();
+}
+
+bool Database_Manager::snapshot_booking_statistics()
+{
+    if (!is_booking_statistics_ready())
+    {
+        return false;
+    }
+
+    quint64 version = booking_statistics->get_version();
+    if (version == snapshot_version)
+    {
+        return true; // nothing changed since the last snapshot
+    }
+
+    QStringList rows;
+    for (const auto& entry : booking_statistics->get_snapshot(QDate::currentDate()))
+    {
+        rows << QString("('%1', %2)").arg(escape_string(entry.first)).arg(entry.second, 0, 'f', 2);
+    }
+
+    QStringList queries = { "DELETE FROM Booking_Statistics_Snapshot" };
+    int rows_per_statement = qMin(Config::Import::ROWS_PER_STATEMENT, dialect->get_max_insert_rows());
+    for (int i = 0; i < rows.size(); i += rows_per_statement)
+    {
+        queries << "INSERT INTO Booking_Statistics_Snapshot (Stat_Name, Stat_Value) VALUES "
+                   + rows.mid(i, rows_per_statement).join(", ");
+    }
+
+    Query_Result result = execute_transaction(queries);
+    if (!result.is_success())
+    {
+        log_error("snapshot_booking_statistics", result.message);
+        return false;
+    }
+
+    snapshot_version = version;
+    return true;
+}
+
+Query_Result Database_Manager::check_booking_statistics(bool repair)
+{
+    if (!is_booking_statistics_ready())
+    {
+        return Query_Result(Result_Type::DB_ERROR_NO_DATA, "Booking statistics are not loaded");
+    }
+
+    QWriteLocker sync_locker(is_seat_inventory_ready() ? &seat_sync_lock : nullptr);
+
+    Booking_Statistics recount;
+    if (!recount_booking_statistics(recount))
+    {
+        return Query_Result(Result_Type::ERROR_EXECUTION, "Failed to recount booking statistics");
+    }
+
+    QStringList differences = booking_statistics->compare(recount, QDate::currentDate());
+    bool repaired = false;
+    if (!differences.isEmpty())
+    {
+        Utils::Logger::warning(QString("Booking statistics differ from the database in %1 values").arg(differences.size()));
+        repaired = repair && recount_booking_statistics(*booking_statistics);
+    }
+
+    Query_Result result(Result_Type::SUCCESS, differences.isEmpty() ? "Booking statistics are consistent"
+                                                                    : "Booking statistics differ from the database");
+    result.data.append({ { "Consistent", differences.isEmpty() },
+                         { "Differences", differences },
+                         { "Repaired", repaired } });
+    return result;
+}
+
+bool Database_Manager::recount_booking_statistics(Booking_Statistics& statistics)
 {
-    for (int attempt = 1; attempt <= max_attempts; ++attempt)
+    Query_Result reservations = execute_select(
+        "SELECT Offer_ID, Status, " + dialect->date_of("Reservation_Date") + " AS Reservation_Day, COUNT(*) AS Bookings, "
+        "SUM(Number_of_Persons) AS Persons, SUM(Total_Price) AS Revenue "
+        "FROM Reservations GROUP BY Offer_ID, Status, " + dialect->date_of("Reservation_Date"));
+    Query_Result users = execute_select(
+        "SELECT " + dialect->date_of("Date_Created") + " AS Created_Day, COUNT(*) AS Users "
+        "FROM Users GROUP BY " + dialect->date_of("Date_Created"));
+    Query_Result destinations = execute_select("SELECT Destination_ID, Name, Country FROM Destinations");
+    Query_Result offers = execute_select("SELECT Offer_ID, Destination_ID FROM Offers");
+
+    for (const Query_Result* result : { &reservations, &users, &destinations, &offers })
     {
-        if (operation())
+        if (!result->is_success())
         {
-            return true;
+            log_error("recount_booking_statistics", result->message);
+            return false;
         }
-        
-        if (attempt < max_attempts)
+    }
+
+    // Bookings still in the write-behind queue are pending reservations that SQL has not seen yet
+    if (write_behind_queue->is_open())
+    {
+        const QList<Pending_Booking> pending = write_behind_queue->peek(write_behind_queue->size());
+
+        QStringList tokens;
+        for (const Pending_Booking& booking : pending)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY_MS));
+            tokens << "'" + escape_string(booking.token) + "'";
+        }
+
+        // A flush may have written some of them already without marking them done yet
+        QSet<QString> applied;
+        if (!tokens.isEmpty())
+        {
+            Query_Result applied_result = execute_select(QString("SELECT Token FROM Write_Behind_Applied WHERE Token IN (%1)")
+                                                         .arg(tokens.join(", ")));
+            for (const auto& row : applied_result.data)
+            {
+                applied.insert(row["Token"].toString());
+            }
+        }
+
+        for (const Pending_Booking& booking : pending)
+        {
+            if (applied.contains(booking.token))
+            {
+                continue;
+            }
+
+            reservations.data.append({ { "Offer_ID", booking.offer_id },
+                                       { "Status", "pending" },
+                                       { "Reservation_Day", booking.created_at.date() },
+                                       { "Bookings", 1 },
+                                       { "Persons", booking.person_count },
+                                       { "Revenue", booking.total_price } });
         }
     }
-    
-    return false;
+
+    statistics.rebuild(reservations.data, users.data, destinations.data, offers.data);
+    return true;
+}
+
+// Revenue rollup
+bool Database_Manager::load_revenue_rollup()
+{
+    if (!Config::Statistics::ENABLE_REVENUE_ROLLUP || is_demo_mode)
+    {
+        return false;
+    }
+
+    Query_Result watermark = execute_select("SELECT MAX(Complete_Through) AS Complete_Through FROM Reservation_Rollup_Watermark");
+    if (!watermark.is_success() || watermark.data.isEmpty())
+    {
+        log_error("load_revenue_rollup", watermark.message);
+        return false;
+    }
+
+    QDate complete_through = watermark.data[0]["Complete_Through"].toDate();
+    if (!complete_through.isValid())
+    {
+        // Never rolled up: the backfill starts at the first reservation
+        Query_Result first = execute_select("SELECT MIN(" + dialect->date_of("Reservation_Date") + ") AS First_Day FROM Reservations");
+        if (!first.is_success() || first.data.isEmpty())
+        {
+            log_error("load_revenue_rollup", first.message);
+            return false;
+        }
+
+        QDate first_day = first.data[0]["First_Day"].toDate();
+        complete_through = first_day.isValid() ? first_day.addDays(-1) : QDate::currentDate().addDays(-1);
+    }
+
+    revenue_rollup->set_complete_through(complete_through);
+
+    // Status changes made while the server was down were not seen, roll the last days again
+    for (int i = 1; i <= Config::Statistics::ROLLUP_STARTUP_REFRESH_DAYS; ++i)
+    {
+        QDate day = QDate::currentDate().addDays(-i);
+        if (day <= complete_through)
+        {
+            revenue_rollup->mark_dirty(day);
+        }
+    }
+
+    Utils::Logger::info("Revenue rollup complete through " + complete_through.toString(Qt::ISODate));
+    return true;
+}
+
+int Database_Manager::refresh_revenue_rollup(int max_days)
+{
+    if (!is_revenue_rollup_ready())
+    {
+        return 0;
+    }
+
+    if (max_days < 0)
+    {
+        max_days = Config::Statistics::ROLLUP_DAYS_PER_RUN;
+    }
+
+    int rolled = 0;
+
+    // Dirty days first: their rows are wrong, while the backlog is only missing.
+    // Days past the watermark are rolled up by the range below anyway.
+    QHash<QDate, quint64> dirty = revenue_rollup->get_dirty_days(max_days);
+    QDate complete_through = revenue_rollup->get_complete_through();
+    QList<QDate> days;
+    for (auto it = dirty.constBegin(); it != dirty.constEnd(); ++it)
+    {
+        if (it.key() <= complete_through)
+        {
+            days.append(it.key());
+        }
+    }
+
+    if (!days.isEmpty())
+    {
+        Query_Result result = execute_transaction(Revenue_Rollup::get_rollup_days_statements(*dialect, days));
+        if (!result.is_success())
+        {
+            log_error("refresh_revenue_rollup", result.message);
+            return 0;
+        }
+        rolled += days.size();
+    }
+    revenue_rollup->clear_dirty_days(dirty);
+
+    // Days that ended since the last run, at most max_days per call while backfilling
+    QDate yesterday = QDate::currentDate().addDays(-1);
+    QDate first_day = complete_through.addDays(1);
+    if (first_day <= yesterday && rolled < max_days)
+    {
+        QDate last_day = qMin(yesterday, first_day.addDays(max_days - rolled - 1));
+        Query_Result result = execute_transaction(Revenue_Rollup::get_rollup_range_statements(*dialect, first_day, last_day));
+        if (!result.is_success())
+        {
+            log_error("refresh_revenue_rollup", result.message);
+            return rolled;
+        }
+
+        revenue_rollup->set_complete_through(last_day);
+        rolled += first_day.daysTo(last_day) + 1;
+    }
+
+    return rolled;
+}
+
+bool Database_Manager::is_revenue_rollup_ready() const
+{
+    return Config::Statistics::ENABLE_REVENUE_ROLLUP && !is_demo_mode && revenue_rollup->is_loaded();
+}
+
+Query_Result Database_Manager::run_revenue_report(const QDateTime& start, const QDateTime& end_exclusive, Revenue_Period period)
+{
+    Query_Result result = execute_select(revenue_rollup->get_report_sql(*dialect, start, end_exclusive, period));
+    if (!result.is_success())
+    {
+        return result;
+    }
+
+    // Same columns as the table query: COUNT gives 0, SUM and AVG over no rows give NULL
+    for (auto& row : result.data)
+    {
+        qint64 reservations = row["Total_Reservations"].toLongLong();
+        row["Total_Reservations"] = reservations;
+        row["Average_Booking_Value"] = reservations > 0 ? QVariant(row["Total_Revenue"].toDouble() / reservations) : QVariant();
+    }
+    return result;
+}
+
+void Database_Manager::record_statistics_booking(int offer_id, int person_count, qreal total_price, const QDate& day)
+{
+    if (!is_booking_statistics_ready())
+    {
+        return;
+    }
+
+    // Offers added since the statistics were loaded are looked up once
+    if (!booking_statistics->knows_offer(offer_id))
+    {
+        Query_Result offer = execute_select(QString("SELECT Destination_ID FROM Offers WHERE Offer_ID = %1").arg(offer_id));
+        if (offer.is_success() && !offer.data.isEmpty())
+        {
+            booking_statistics->set_offer_destination(offer_id, offer.data[0]["Destination_ID"].toInt());
+        }
+    }
+
+    booking_statistics->record_booking(offer_id, person_count, total_price, day);
+}
+
+// Data version
+quint64 Database_Manager::get_data_version(Listing listing) const
+{
+    quint64 version = listing_versions[static_cast<int>(listing)].load();
+    if (listing == Listing::OFFERS)
+    {
+        // Booking and cancelling change the catalog before the write-behind reaches SQL
+        version += offer_catalog->get_version();
+    }
+    return version;
+}
+
+// Query statistics
+Query_Result Database_Manager::get_query_statistics(int top_count, bool reset)
+{
+    Query_Result result(Result_Type::SUCCESS, "Query statistics");
+    result.data = query_stats->get_top(top_count);
+
+    QHash<QString, QVariant> totals = query_stats->get_totals();
+    totals.insert("Query_Shape", "(all)");
+    result.data.prepend(totals);
+
+    if (reset)
+    {
+        query_stats->reset();
+    }
+    return result;
+}
+
+// Private helpers
+void Database_Manager::record_query_timing(const QString& query, const QString& bind_values,
+    const QElapsedTimer& timer, qint64 wait_ns, const Query_Result& result)
+{
+    if (!Config::Diagnostics::ENABLE_QUERY_STATS && !Config::Application::LOG_SQL_QUERIES)
+    {
+        return;
+    }
+
+    qint64 run_us = (timer.nsecsElapsed() - wait_ns) / 1000;
+    qint64 wait_us = wait_ns / 1000;
+    int rows = result.data.isEmpty() ? result.affected_rows : result.data.size();
+
+    if (Config::Diagnostics::ENABLE_QUERY_STATS)
+    {
+        query_stats->record(query, wait_us, run_us, rows, result.is_success());
+    }
+
+    bool slow = run_us >= Config::Diagnostics::SLOW_QUERY_THRESHOLD_MS * 1000LL;
+    if (!slow && !Config::Application::LOG_SQL_QUERIES)
+    {
+        return;
+    }
+
+    QString message = QString("%1 (%2 ms, waited %3 ms, %4 rows): %5")
+                     .arg(slow ? "Slow query" : "SQL")
+                     .arg(run_us / 1000.0, 0, 'f', 1)
+                     .arg(wait_us / 1000.0, 0, 'f', 1)
+                     .arg(rows)
+                     .arg(query.simplified());
+    if (!bind_values.isEmpty())
+    {
+        message += " [" + bind_values + "]";
+    }
+
+    if (slow)
+    {
+        Utils::Logger::warning(message);
+    }
+    else
+    {
+        Utils::Logger::debug(message);
+    }
+}
+
+QString Database_Manager::get_offer_catalog_sql() const
+{
+    // Same columns as the offer listing queries, so catalog rows serialize identically
+    return "SELECT o.Offer_ID, o.Name, o.Destination_ID, o.Accommodation_ID, o.Types_of_Transport_ID, "
+           "o.Price_per_Person, o.Duration_Days, o.Departure_Date, o.Return_Date, o.Total_Seats, "
+           "o.Reserved_Seats, o.Included_Services, o.Description, o.Status, o.Date_Created, o.Date_Modified, "
+           "d.Name as Destination_Name, d.Country, a.Name as Accommodation_Name, t.Name as Transport_Name "
+           "FROM Offers o "
+           "LEFT JOIN Destinations d ON o.Destination_ID = d.Destination_ID "
+           "LEFT JOIN Accommodations a ON o.Accommodation_ID = a.Accommodation_ID "
+           "LEFT JOIN Types_of_Transport t ON o.Types_of_Transport_ID = t.Transport_Type_ID";
+}
+
+QString Database_Manager::get_batch_booking_sql(const QList<Batch_Operation>& bookings)
+{
+    QStringList rows;
+    for (int i = 0; i < bookings.size(); ++i)
+    {
+        const Batch_Operation& booking = bookings[i];
+        rows << QString("(%1, %2, %3, %4, %5, %6, %7)")
+                .arg(i + 1)
+                .arg(booking.user_id)
+                .arg(booking.offer_id)
+                .arg(booking.person_count)
+                .arg(booking.total_price < 0 ? QString("NULL") : QString::number(booking.total_price, 'f', 2),
+                     booking.created_at.isValid() ? "'" + booking.created_at.toString("yyyy-MM-ddTHH:mm:ss.zzz") + "'" : QString("NULL"),
+                     booking.token.isEmpty() ? QString("NULL") : "'" + escape_string(booking.token) + "'");
+    }
+
+    // Seats are taken row by row in arrival order from what each offer has left,
+    // exactly as the one-statement-per-booking path would: a row that does not
+    // fit rejects itself only, later rows on the same offer still get the rest.
+    return QString(R"(
+        SET NOCOUNT ON;
+        DECLARE @batch TABLE (Seq INT PRIMARY KEY, User_ID INT, Offer_ID INT, Persons INT,
+                              Total_Price DECIMAL(10,2) NULL, Reservation_Date DATETIME NULL, Token VARCHAR(64) NULL);
+        DECLARE @replayed TABLE (Seq INT PRIMARY KEY, Reservation_ID INT);
+        DECLARE @seats TABLE (Offer_ID INT PRIMARY KEY, Remaining INT, Price_per_Person DECIMAL(10,2));
+        DECLARE @accepted TABLE (Seq INT PRIMARY KEY, User_ID INT, Offer_ID INT, Persons INT,
+                                 Total_Price DECIMAL(10,2), Reservation_Date DATETIME, Token VARCHAR(64) NULL);
+        DECLARE @inserted TABLE (Seq INT PRIMARY KEY, Reservation_ID INT);
+        DECLARE @seq INT;
+
+        INSERT INTO @batch (Seq, User_ID, Offer_ID, Persons, Total_Price, Reservation_Date, Token)
+        VALUES %1;
+
+        INSERT INTO @replayed (Seq, Reservation_ID)
+        SELECT b.Seq, w.Reservation_ID
+        FROM @batch b
+        JOIN Write_Behind_Applied w ON w.Token = b.Token;
+
+        INSERT INTO @seats (Offer_ID, Remaining, Price_per_Person)
+        SELECT o.Offer_ID, o.Total_Seats - o.Reserved_Seats, o.Price_per_Person
+        FROM Offers o WITH (UPDLOCK, ROWLOCK)
+        WHERE o.Status = 'active' AND o.Offer_ID IN (SELECT Offer_ID FROM @batch);
+
+        SET @seq = (SELECT MIN(Seq) FROM @batch);
+        WHILE @seq IS NOT NULL
+        BEGIN
+            INSERT INTO @accepted (Seq, User_ID, Offer_ID, Persons, Total_Price, Reservation_Date, Token)
+            SELECT b.Seq, b.User_ID, b.Offer_ID, b.Persons,
+                   COALESCE(b.Total_Price, b.Persons * s.Price_per_Person),
+                   COALESCE(b.Reservation_Date, GETDATE()),
+                   b.Token
+            FROM @batch b
+            JOIN @seats s ON s.Offer_ID = b.Offer_ID
+            WHERE b.Seq = @seq AND b.Persons <= s.Remaining
+              AND NOT EXISTS (SELECT 1 FROM @replayed p WHERE p.Seq = b.Seq);
+
+            IF @@ROWCOUNT > 0
+                UPDATE s SET Remaining = s.Remaining - b.Persons
+                FROM @seats s
+                JOIN @batch b ON b.Offer_ID = s.Offer_ID
+                WHERE b.Seq = @seq;
+
+            SET @seq = (SELECT MIN(Seq) FROM @batch WHERE Seq > @seq);
+        END
+
+        UPDATE o SET Reserved_Seats = o.Reserved_Seats + a.Seats
+        FROM Offers o
+        JOIN (SELECT Offer_ID, SUM(Persons) AS Seats FROM @accepted GROUP BY Offer_ID) a ON a.Offer_ID = o.Offer_ID;
+
+        MERGE INTO Reservations AS t
+        USING @accepted AS s ON 1 = 0
+        WHEN NOT MATCHED THEN
+            INSERT (User_ID, Offer_ID, Number_of_Persons, Total_Price, Status, Reservation_Date)
+            VALUES (s.User_ID, s.Offer_ID, s.Persons, s.Total_Price, 'pending', s.Reservation_Date)
+        OUTPUT s.Seq, inserted.Reservation_ID INTO @inserted (Seq, Reservation_ID);
+
+        INSERT INTO Write_Behind_Applied (Token, Reservation_ID)
+        SELECT a.Token, i.Reservation_ID
+        FROM @accepted a
+        JOIN @inserted i ON i.Seq = a.Seq
+        WHERE a.Token IS NOT NULL;
+
+        SELECT b.Seq, b.Offer_ID, b.Persons AS Number_of_Persons,
+               CASE WHEN i.Seq IS NOT NULL THEN 1 WHEN p.Seq IS NOT NULL THEN 2 ELSE 0 END AS Outcome,
+               COALESCE(i.Reservation_ID, p.Reservation_ID) AS Reservation_ID, a.Total_Price
+        FROM @batch b
+        LEFT JOIN @inserted i ON i.Seq = b.Seq
+        LEFT JOIN @replayed p ON p.Seq = b.Seq
+        LEFT JOIN @accepted a ON a.Seq = b.Seq
+        ORDER BY b.Seq;
+    )").arg(rows.join(",\n               "));
+}
+
+QString Database_Manager::get_batch_cancel_sql(const QList<Batch_Operation>& cancellations)
+{
+    QStringList rows;
+    for (int i = 0; i < cancellations.size(); ++i)
+    {
+        rows << QString("(%1, %2)").arg(i + 1).arg(cancellations[i].reservation_id);
+    }
+
+    // The same reservation twice in one batch is cancelled by its first request only
+    return QString(R"(
+        SET NOCOUNT ON;
+        DECLARE @cancel TABLE (Seq INT PRIMARY KEY, Reservation_ID INT);
+        DECLARE @cancelled TABLE (Reservation_ID INT PRIMARY KEY, Offer_ID INT, Persons INT,
+                                  Previous_Status VARCHAR(20), Total_Price DECIMAL(10,2), Reservation_Date DATETIME);
+
+        INSERT INTO @cancel (Seq, Reservation_ID)
+        VALUES %1;
+
+        UPDATE r SET Status = 'cancelled'
+        OUTPUT inserted.Reservation_ID, inserted.Offer_ID, inserted.Number_of_Persons, deleted.Status, inserted.Total_Price,
+               inserted.Reservation_Date
+        INTO @cancelled (Reservation_ID, Offer_ID, Persons, Previous_Status, Total_Price, Reservation_Date)
+        FROM Reservations r
+        WHERE r.Status <> 'cancelled' AND r.Reservation_ID IN (SELECT Reservation_ID FROM @cancel);
+
+        UPDATE o SET Reserved_Seats = o.Reserved_Seats - x.Seats
+        FROM Offers o
+        JOIN (SELECT Offer_ID, SUM(Persons) AS Seats FROM @cancelled GROUP BY Offer_ID) x ON x.Offer_ID = o.Offer_ID;
+
+        SELECT c.Seq, c.Reservation_ID, x.Offer_ID, x.Persons AS Number_of_Persons, r.Status AS Current_Status,
+               x.Previous_Status, x.Total_Price, x.Reservation_Date,
+               CASE WHEN x.Reservation_ID IS NOT NULL
+                         AND c.Seq = (SELECT MIN(c2.Seq) FROM @cancel c2 WHERE c2.Reservation_ID = c.Reservation_ID)
+                    THEN 1 ELSE 0 END AS Outcome
+        FROM @cancel c
+        LEFT JOIN @cancelled x ON x.Reservation_ID = c.Reservation_ID
+        LEFT JOIN Reservations r ON r.Reservation_ID = c.Reservation_ID
+        ORDER BY c.Seq;
+    )").arg(rows.join(",\n               "));
 }
 
 // Table creation SQL
 QString Database_Manager::get_create_users_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Users') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Users (
-                User_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Users", QString(R"(
+                User_ID %1,
                 Username VARCHAR(50) NOT NULL UNIQUE,
                 Password_Hash VARCHAR(255) NOT NULL,
                 Password_Salt VARCHAR(255) NOT NULL,
@@ -1352,70 +3521,51 @@ QString Database_Manager::get_create_users_table_sql()
                 First_Name VARCHAR(50),
                 Last_Name VARCHAR(50),
                 Phone VARCHAR(15),
-                Date_Created DATETIME DEFAULT GETDATE(),
-                Date_Modified DATETIME DEFAULT GETDATE()
-            )
-        END
-    )";
+                Is_Admin INT NOT NULL DEFAULT 0,
+                Date_Created DATETIME DEFAULT (%2),
+                Date_Modified DATETIME DEFAULT (%2)
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_destinations_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Destinations') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Destinations (
-                Destination_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Destinations", QString(R"(
+                Destination_ID %1,
                 Name VARCHAR(100) NOT NULL,
                 Country VARCHAR(100) NOT NULL,
                 Description TEXT,
                 Image_Path VARCHAR(255),
-                Date_Created DATETIME DEFAULT GETDATE(),
-                Date_Modified DATETIME DEFAULT GETDATE()
-            )
-        END
-    )";
+                Date_Created DATETIME DEFAULT (%2),
+                Date_Modified DATETIME DEFAULT (%2)
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_transport_types_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Types_of_Transport') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Types_of_Transport (
-                Transport_Type_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Types_of_Transport", QString(R"(
+                Transport_Type_ID %1,
                 Name VARCHAR(100) NOT NULL,
                 Description TEXT,
-                Date_Created DATETIME DEFAULT GETDATE(),
-                Date_Modified DATETIME DEFAULT GETDATE()
-            )
-        END
-    )";
+                Date_Created DATETIME DEFAULT (%2),
+                Date_Modified DATETIME DEFAULT (%2)
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_accommodation_types_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Types_of_Accommodation') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Types_of_Accommodation (
-                Accommodation_Type_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Types_of_Accommodation", QString(R"(
+                Accommodation_Type_ID %1,
                 Name VARCHAR(100) NOT NULL,
                 Description TEXT,
-                Date_Created DATETIME DEFAULT GETDATE(),
-                Date_Modified DATETIME DEFAULT GETDATE()
-            )
-        END
-    )";
+                Date_Created DATETIME DEFAULT (%2),
+                Date_Modified DATETIME DEFAULT (%2)
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_accommodations_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Accommodations') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Accommodations (
-                Accommodation_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Accommodations", QString(R"(
+                Accommodation_ID %1,
                 Name VARCHAR(100) NOT NULL,
                 Destination_ID INT NOT NULL,
                 Type_of_Accommodation INT NOT NULL,
@@ -1424,22 +3574,17 @@ QString Database_Manager::get_create_accommodations_table_sql()
                 Facilities TEXT,
                 Rating DECIMAL(4, 2) CHECK (Rating >= 0 AND Rating <= 10),
                 Description TEXT,
-                Date_Created DATETIME DEFAULT GETDATE(),
-                Date_Modified DATETIME DEFAULT GETDATE(),
-                FOREIGN KEY (Destination_ID) REFERENCES dbo.Destinations(Destination_ID),
-                FOREIGN KEY (Type_of_Accommodation) REFERENCES dbo.Types_of_Accommodation(Accommodation_Type_ID)
-            )
-        END
-    )";
+                Date_Created DATETIME DEFAULT (%2),
+                Date_Modified DATETIME DEFAULT (%2),
+                FOREIGN KEY (Destination_ID) REFERENCES Destinations(Destination_ID),
+                FOREIGN KEY (Type_of_Accommodation) REFERENCES Types_of_Accommodation(Accommodation_Type_ID)
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_offers_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Offers') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Offers (
-                Offer_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Offers", QString(R"(
+                Offer_ID %1,
                 Name VARCHAR(150) NOT NULL,
                 Destination_ID INT NOT NULL,
                 Accommodation_ID INT NOT NULL,
@@ -1453,76 +3598,95 @@ QString Database_Manager::get_create_offers_table_sql()
                 Included_Services TEXT,
                 Description TEXT,
                 Status VARCHAR(20) NOT NULL DEFAULT 'active',
-                Date_Created DATETIME DEFAULT GETDATE(),
-                Date_Modified DATETIME DEFAULT GETDATE(),
-                FOREIGN KEY (Destination_ID) REFERENCES dbo.Destinations(Destination_ID),
-                FOREIGN KEY (Accommodation_ID) REFERENCES dbo.Accommodations(Accommodation_ID),
-                FOREIGN KEY (Types_of_Transport_ID) REFERENCES dbo.Types_of_Transport(Transport_Type_ID),
+                Date_Created DATETIME DEFAULT (%2),
+                Date_Modified DATETIME DEFAULT (%2),
+                FOREIGN KEY (Destination_ID) REFERENCES Destinations(Destination_ID),
+                FOREIGN KEY (Accommodation_ID) REFERENCES Accommodations(Accommodation_ID),
+                FOREIGN KEY (Types_of_Transport_ID) REFERENCES Types_of_Transport(Transport_Type_ID),
                 CHECK (Status IN ('active', 'inactive', 'expired'))
-            )
-        END
-    )";
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_reservations_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Reservations') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Reservations (
-                Reservation_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Reservations", QString(R"(
+                Reservation_ID %1,
                 User_ID INT NOT NULL,
                 Offer_ID INT NOT NULL,
                 Number_of_Persons INT NOT NULL,
                 Total_Price DECIMAL(10,2) NOT NULL,
-                Reservation_Date DATETIME DEFAULT GETDATE(),
+                Reservation_Date DATETIME DEFAULT (%2),
                 Status VARCHAR(20) NOT NULL,
                 Notes TEXT,
-                FOREIGN KEY (User_ID) REFERENCES dbo.Users(User_ID),
-                FOREIGN KEY (Offer_ID) REFERENCES dbo.Offers(Offer_ID),
+                FOREIGN KEY (User_ID) REFERENCES Users(User_ID),
+                FOREIGN KEY (Offer_ID) REFERENCES Offers(Offer_ID),
                 CHECK (Status IN ('pending', 'confirmed', 'paid', 'cancelled'))
-            )
-        END
-    )";
+    )").arg(dialect->get_identity_column(), dialect->now()));
 }
 
 QString Database_Manager::get_create_reservation_persons_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.Reservation_Persons') AND type = 'U')
-        BEGIN
-            CREATE TABLE dbo.Reservation_Persons (
-                Reservation_Person_ID INT PRIMARY KEY IDENTITY(1,1),
+    return dialect->get_create_table_sql("Reservation_Persons", QString(R"(
+                Reservation_Person_ID %1,
                 Reservation_ID INT NOT NULL,
                 Full_Name VARCHAR(100) NOT NULL,
                 CNP VARCHAR(15) NOT NULL,
                 Birth_Date DATE NOT NULL,
                 Person_Type VARCHAR(20) NOT NULL,
-                FOREIGN KEY (Reservation_ID) REFERENCES dbo.Reservations(Reservation_ID)
-            )
-        END
-    )";
+                FOREIGN KEY (Reservation_ID) REFERENCES Reservations(Reservation_ID)
+    )").arg(dialect->get_identity_column()));
 }
 
-QString Database_Manager::get_create_indexes_sql()
+QString Database_Manager::get_create_write_behind_table_sql()
 {
-    return R"(
-        IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = 'IX_Users_Username')
-            CREATE INDEX IX_Users_Username ON Users(Username);
-        
-        IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = 'IX_Offers_Destination')
-            CREATE INDEX IX_Offers_Destination ON Offers(Destination_ID);
-        
-        IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = 'IX_Offers_Price')
-            CREATE INDEX IX_Offers_Price ON Offers(Price_per_Person);
-        
-        IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = 'IX_Offers_Status')
-            CREATE INDEX IX_Offers_Status ON Offers(Status);
-        
-        IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = 'IX_Reservations_User')
-            CREATE INDEX IX_Reservations_User ON Reservations(User_ID);
-        
-        IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = 'IX_Offers_Destination_Price')
-            CREATE INDEX IX_Offers_Destination_Price ON Offers(Destination_ID, Price_per_Person);
-    )";
-}
\ No newline at end of file
+    // One row per booking persisted from the write-behind queue, makes replay idempotent
+    return dialect->get_create_table_sql("Write_Behind_Applied", QString(R"(
+                Token VARCHAR(64) PRIMARY KEY,
+                Reservation_ID INT NOT NULL,
+                Applied_At DATETIME DEFAULT (%1)
+    )").arg(dialect->now()));
+}
+
+QString Database_Manager::get_create_statistics_snapshot_table_sql()
+{
+    // Last known value of every booking statistic, written by snapshot_booking_statistics()
+    return dialect->get_create_table_sql("Booking_Statistics_Snapshot", QString(R"(
+                Stat_Name VARCHAR(100) PRIMARY KEY,
+                Stat_Value DECIMAL(18,2) NOT NULL,
+                Snapshot_At DATETIME DEFAULT (%1)
+    )").arg(dialect->now()));
+}
+
+QStringList Database_Manager::get_create_revenue_rollup_tables_sql()
+{
+    // Per-day totals for the revenue reports, and how far back they are complete
+    return {
+        dialect->get_create_table_sql("Reservation_Daily_Rollup", R"(
+                Rollup_Date DATE NOT NULL,
+                Destination_ID INT NOT NULL,
+                Status VARCHAR(20) NOT NULL,
+                Reservations INT NOT NULL,
+                Persons INT NOT NULL,
+                Revenue DECIMAL(18,2) NOT NULL,
+                PRIMARY KEY (Rollup_Date, Destination_ID, Status)
+        )"),
+        dialect->get_create_table_sql("Reservation_Rollup_Watermark", QString(R"(
+                Complete_Through DATE NOT NULL,
+                Updated_At DATETIME DEFAULT (%1)
+        )").arg(dialect->now()))
+    };
+}
+
+QStringList Database_Manager::get_create_indexes_sql()
+{
+    return {
+        dialect->get_create_index_sql("IX_Users_Username", "Users", "Username"),
+        dialect->get_create_index_sql("IX_Offers_Destination", "Offers", "Destination_ID"),
+        dialect->get_create_index_sql("IX_Offers_Price", "Offers", "Price_per_Person"),
+        dialect->get_create_index_sql("IX_Offers_Status", "Offers", "Status"),
+        dialect->get_create_index_sql("IX_Reservations_User", "Reservations", "User_ID"),
+        dialect->get_create_index_sql("IX_Offers_Destination_Price", "Offers", "Destination_ID, Price_per_Person"),
+        dialect->get_create_index_sql("IX_Reservations_Date", "Reservations", "Reservation_Date",
+                                      "Status, Total_Price, Number_of_Persons, Offer_ID")
+    };
+}
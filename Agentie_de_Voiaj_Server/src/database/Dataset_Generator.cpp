@@ -0,0 +1,720 @@
+#include "database/Dataset_Generator.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTime>
+#include <QtCore/QDateTime>
+#include <limits>
+
+using namespace Database;
+
+namespace
+{
+    // splitmix64: cheap to seed per row, unlike QRandomGenerator's Mersenne twister
+    quint64 mix64(quint64 x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    class Row_Random
+    {
+    private:
+        quint64 state;
+
+    public:
+        explicit Row_Random(quint64 seed) : state(seed) {}
+
+        quint64 next()
+        {
+            state += 0x9E3779B97F4A7C15ULL;
+            return mix64(state);
+        }
+
+        int bounded(int lowest, int highest) // [lowest, highest)
+        {
+            if (highest <= lowest)
+            {
+                return lowest;
+            }
+            return lowest + static_cast<int>(next() % static_cast<quint64>(highest - lowest));
+        }
+
+        double real() // [0, 1)
+        {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        const char* pick(const QList<const char*>& items)
+        {
+            return items[bounded(0, items.size())];
+        }
+
+        QString pick_several(const QList<const char*>& items, int lowest, int highest)
+        {
+            QList<const char*> remaining = items;
+            QStringList picked;
+            int count = qMin(bounded(lowest, highest + 1), static_cast<int>(remaining.size()));
+            for (int i = 0; i < count; ++i)
+            {
+                picked.append(remaining.takeAt(bounded(0, remaining.size())));
+            }
+            return picked.join(", ");
+        }
+    };
+
+    struct City
+    {
+        const char* name;
+        const char* country;
+    };
+
+    const QList<City> CITIES = {
+        { "Paris", "France" }, { "Nice", "France" }, { "Rome", "Italy" }, { "Venice", "Italy" },
+        { "Florence", "Italy" }, { "Barcelona", "Spain" }, { "Madrid", "Spain" }, { "Seville", "Spain" },
+        { "Lisbon", "Portugal" }, { "Porto", "Portugal" }, { "London", "United Kingdom" },
+        { "Edinburgh", "United Kingdom" }, { "Amsterdam", "Netherlands" }, { "Berlin", "Germany" },
+        { "Munich", "Germany" }, { "Vienna", "Austria" }, { "Prague", "Czech Republic" },
+        { "Budapest", "Hungary" }, { "Krakow", "Poland" }, { "Athens", "Greece" }, { "Santorini", "Greece" },
+        { "Crete", "Greece" }, { "Istanbul", "Turkey" }, { "Antalya", "Turkey" }, { "Dubrovnik", "Croatia" },
+        { "Split", "Croatia" }, { "Brasov", "Romania" }, { "Sibiu", "Romania" }, { "Constanta", "Romania" },
+        { "Bucharest", "Romania" }, { "Sofia", "Bulgaria" }, { "Copenhagen", "Denmark" },
+        { "Stockholm", "Sweden" }, { "Reykjavik", "Iceland" }, { "Dubai", "United Arab Emirates" },
+        { "Cairo", "Egypt" }, { "Marrakech", "Morocco" }, { "New York", "United States" },
+        { "Tokyo", "Japan" }, { "Bali", "Indonesia" }, { "Bangkok", "Thailand" }, { "Maldives", "Maldives" }
+    };
+
+    // Appended once the city list runs out, so larger scales keep distinct names
+    const QList<const char*> AREAS = {
+        "Old Town", "Riverside", "Coast", "Hills", "Harbour", "North", "South", "Lakeside", "Downtown", "Valley"
+    };
+
+    const QList<const char*> DESTINATION_FEATURES = {
+        "historic old town", "sandy beaches", "famous museums", "local cuisine", "lively nightlife",
+        "mountain trails", "river cruises", "colourful markets", "Gothic cathedrals", "thermal spas",
+        "vineyards", "street festivals"
+    };
+
+    const QList<const char*> TRANSPORT_TYPES = { "Airplane", "Train", "Bus", "Private Car", "Cruise Ship" };
+    const QList<const char*> ACCOMMODATION_TYPES = { "Hotel", "Guesthouse", "Hostel", "Apartment", "Resort" };
+
+    const QList<const char*> ACCOMMODATION_PREFIXES = {
+        "Grand", "Royal", "Central", "Park", "Sunset", "Garden", "Plaza", "Harbour", "Boutique", "Palace"
+    };
+    const QList<const char*> ACCOMMODATION_SUFFIXES = { "Hotel", "Residence", "Suites", "Inn", "Lodge" };
+    const QList<const char*> CATEGORIES = { "3*", "4*", "5*", "-" };
+    const QList<const char*> STREETS = {
+        "Main Street", "Station Road", "Market Square", "Harbour Avenue", "Church Lane", "Park Boulevard",
+        "Castle Street", "River Walk"
+    };
+    const QList<const char*> FACILITIES = {
+        "Free WiFi", "Breakfast", "Pool", "Spa", "Fitness center", "Restaurant", "Bar", "Parking",
+        "Airport shuttle", "Air Conditioning", "24h Reception", "Shared kitchen"
+    };
+
+    const QList<const char*> OFFER_THEMES = {
+        "City Break", "Discovery", "Getaway", "Experience", "Escape", "Adventure", "Holiday", "Retreat"
+    };
+    const QList<const char*> SERVICES = {
+        "Breakfast", "Half board", "Airport transfer", "City tour", "Travel insurance", "Local guide",
+        "Museum tickets", "Boat trip", "Wine tasting"
+    };
+    const QList<const char*> NOTES = {
+        "Vegetarian meals", "Late check-in", "Ground floor room", "Travelling with a child", "Anniversary trip"
+    };
+
+    const QList<const char*> FIRST_NAMES = {
+        "Andrei", "Maria", "Elena", "Mihai", "Ioana", "Alexandru", "Ana", "Cristian", "Diana", "Stefan",
+        "John", "Mary", "Robert", "Laura", "David", "Sophie", "Lucas", "Emma", "Marco", "Giulia"
+    };
+    const QList<const char*> LAST_NAMES = {
+        "Popescu", "Ionescu", "Popa", "Dumitru", "Stan", "Stoica", "Gheorghe", "Matei", "Ciobanu", "Rusu",
+        "Smith", "Jones", "Brown", "Miller", "Wilson", "Rossi", "Bianchi", "Martin", "Bernard", "Schmidt"
+    };
+    const QList<const char*> EMAIL_DOMAINS = { "example.com", "example.org", "example.net" };
+
+    QString get_destination_name(int index)
+    {
+        int round = index / CITIES.size();
+        QString name = CITIES[index % CITIES.size()].name;
+        if (round > 0)
+        {
+            name += QString(" ") + AREAS[(round - 1) % AREAS.size()];
+        }
+        if (round > AREAS.size())
+        {
+            name += " " + QString::number((round - 1) / AREAS.size() + 1);
+        }
+        return name;
+    }
+
+    double to_price(double amount)
+    {
+        return qRound(amount) - 0.01; // xx.99, like the hand-made offers
+    }
+}
+
+// Scale
+bool Dataset_Scale::parse(const QString& text, Dataset_Scale& scale)
+{
+    QString name = text.trimmed().toLower();
+    if (name == "demo")
+    {
+        scale = { 40, 120, 1000, 500, 5000 };
+        return true;
+    }
+    if (name == "small")
+    {
+        scale = { 200, 1000, 10000, 5000, 50000 };
+        return true;
+    }
+    if (name == "medium")
+    {
+        scale = { 1000, 5000, 100000, 50000, 500000 };
+        return true;
+    }
+    if (name == "large")
+    {
+        scale = { 3000, 15000, 300000, 200000, 2000000 };
+        return true;
+    }
+
+    // A number of offers, everything else in the proportions of "large"
+    bool ok = false;
+    int offers = name.toInt(&ok);
+    if (!ok || offers <= 0)
+    {
+        return false;
+    }
+    scale.offers = offers;
+    scale.destinations = qMax(1, offers / 100);
+    scale.accommodations = qMax(1, offers / 20);
+    scale.users = qMax(1, static_cast<int>(static_cast<qint64>(offers) * 2 / 3));
+    scale.reservations = static_cast<qint64>(offers) * 20 / 3;
+    return true;
+}
+
+QString Dataset_Scale::to_string() const
+{
+    return QString("%1 destinations, %2 accommodations, %3 offers, %4 users, ~%5 reservations")
+           .arg(destinations).arg(accommodations).arg(offers).arg(users).arg(reservations);
+}
+
+// Constructor
+Dataset_Generator::Dataset_Generator(quint64 seed, const Dataset_Scale& scale, const QDate& anchor_date)
+    : seed(seed), scale(scale), anchor_date(anchor_date)
+{
+}
+
+const Dataset_Scale& Dataset_Generator::get_scale() const
+{
+    return scale;
+}
+
+void Dataset_Generator::set_ids(Table table, const QList<int>& table_ids)
+{
+    ids.insert(static_cast<int>(table), table_ids);
+}
+
+// Lookup tables
+int Dataset_Generator::get_transport_type_count() const
+{
+    const QList<int> table_ids = ids.value(static_cast<int>(Table::TRANSPORT_TYPES));
+    return table_ids.isEmpty() ? TRANSPORT_TYPES.size() : table_ids.size();
+}
+
+int Dataset_Generator::get_accommodation_type_count() const
+{
+    const QList<int> table_ids = ids.value(static_cast<int>(Table::ACCOMMODATION_TYPES));
+    return table_ids.isEmpty() ? ACCOMMODATION_TYPES.size() : table_ids.size();
+}
+
+QHash<QString, QVariant> Dataset_Generator::transport_type(int index) const
+{
+    QHash<QString, QVariant> row;
+    row["Name"] = TRANSPORT_TYPES[index % TRANSPORT_TYPES.size()];
+    row["Description"] = "Generated transport type";
+    return row;
+}
+
+QHash<QString, QVariant> Dataset_Generator::accommodation_type(int index) const
+{
+    QHash<QString, QVariant> row;
+    row["Name"] = ACCOMMODATION_TYPES[index % ACCOMMODATION_TYPES.size()];
+    row["Description"] = "Generated accommodation type";
+    return row;
+}
+
+// Catalog rows
+QHash<QString, QVariant> Dataset_Generator::destination(int index) const
+{
+    Row_Random random(row_seed(Table::DESTINATIONS, index));
+    const City& city = CITIES[index % CITIES.size()];
+    QString name = get_destination_name(index);
+
+    // Draws are made one per statement: the order of function arguments is unspecified
+    QString first_feature = random.pick(DESTINATION_FEATURES);
+    QString second_feature = random.pick(DESTINATION_FEATURES);
+
+    QHash<QString, QVariant> row;
+    row["Name"] = name;
+    row["Country"] = city.country;
+    row["Description"] = QString("%1 with %2 and %3").arg(name, first_feature, second_feature);
+    row["Image_Path"] = "/images/destinations/" + name.toLower().replace(' ', '_') + ".jpg";
+    return row;
+}
+
+QHash<QString, QVariant> Dataset_Generator::accommodation(int index) const
+{
+    Row_Random random(row_seed(Table::ACCOMMODATIONS, index));
+    int destination_index = get_destination_of_accommodation(index);
+    QString city = get_destination_name(destination_index);
+
+    QString prefix = random.pick(ACCOMMODATION_PREFIXES);
+    QString suffix = random.pick(ACCOMMODATION_SUFFIXES);
+
+    QHash<QString, QVariant> row;
+    row["Name"] = QString("%1 %2 %3").arg(prefix, suffix, city);
+    row["Destination_ID"] = get_id(Table::DESTINATIONS, destination_index);
+    row["Type_of_Accommodation"] = get_id(Table::ACCOMMODATION_TYPES, random.bounded(0, get_accommodation_type_count()));
+    row["Category"] = random.pick(CATEGORIES);
+    row["Address"] = QString("%1 %2, %3").arg(random.bounded(1, 300)).arg(random.pick(STREETS), city);
+    row["Facilities"] = random.pick_several(FACILITIES, 3, 6);
+    row["Rating"] = random.bounded(50, 100) / 10.0;
+    row["Description"] = QString("Comfortable stay in %1").arg(city);
+    return row;
+}
+
+Generated_Offer Dataset_Generator::offer(int index) const
+{
+    Row_Random random(row_seed(Table::OFFERS, index));
+    int accommodation_index = random.bounded(0, scale.accommodations);
+    int destination_index = get_destination_of_accommodation(accommodation_index);
+    int transport_index = random.bounded(0, get_transport_type_count());
+    QString destination_name = get_destination_name(destination_index);
+
+    int duration_days = random.bounded(2, 15);
+    QDate departure_date = anchor_date.addDays(random.bounded(-60, 366));
+    double price_per_person = to_price(80 + duration_days * random.bounded(40, 220));
+
+    QString status = "active";
+    if (departure_date < anchor_date)
+    {
+        status = "expired";
+    }
+    else if (random.real() < 0.1)
+    {
+        status = "inactive";
+    }
+
+    Generated_Offer generated;
+    generated.offer["Name"] = destination_name + " " + random.pick(OFFER_THEMES);
+    generated.offer["Destination_ID"] = get_id(Table::DESTINATIONS, destination_index);
+    generated.offer["Accommodation_ID"] = get_id(Table::ACCOMMODATIONS, accommodation_index);
+    generated.offer["Types_of_Transport_ID"] = get_id(Table::TRANSPORT_TYPES, transport_index);
+    generated.offer["Price_per_Person"] = price_per_person;
+    generated.offer["Duration_Days"] = duration_days;
+    generated.offer["Departure_Date"] = departure_date;
+    generated.offer["Return_Date"] = departure_date.addDays(duration_days);
+    generated.offer["Included_Services"] = random.pick_several(SERVICES, 2, 4);
+    generated.offer["Description"] = QString("%1 days in %2").arg(duration_days).arg(destination_name);
+    generated.offer["Status"] = status;
+
+    // Reservations are drawn with their offer so Reserved_Seats always matches them
+    int reserved_seats = 0;
+    double average = scale.offers > 0 ? static_cast<double>(scale.reservations) / scale.offers : 0.0;
+    int reservation_count = scale.users > 0 ? static_cast<int>(random.real() * 2.0 * average + 0.5) : 0;
+    for (int i = 0; i < reservation_count; ++i)
+    {
+        int persons = random.bounded(1, 5);
+        double roll = random.real();
+        QString reservation_status = roll < 0.10 ? "cancelled" : roll < 0.25 ? "pending" : roll < 0.60 ? "confirmed" : "paid";
+        if (reservation_status != "cancelled")
+        {
+            reserved_seats += persons;
+        }
+
+        QHash<QString, QVariant> reservation;
+        reservation["User_ID"] = get_id(Table::USERS, random.bounded(0, scale.users));
+        reservation["Offer_ID"] = get_id(Table::OFFERS, index);
+        reservation["Number_of_Persons"] = persons;
+        reservation["Total_Price"] = persons * price_per_person;
+        QDate reservation_day = departure_date.addDays(-random.bounded(1, 121));
+        int hour = random.bounded(8, 22);
+        int minute = random.bounded(0, 60);
+        reservation["Reservation_Date"] = QDateTime(reservation_day, QTime(hour, minute));
+        reservation["Status"] = reservation_status;
+        reservation["Notes"] = random.real() < 0.1 ? QVariant(QString(random.pick(NOTES))) : QVariant();
+        generated.reservations.append(reservation);
+    }
+
+    int spare_seats = random.bounded(0, 20);
+    int minimum_seats = random.bounded(10, 61);
+    generated.offer["Total_Seats"] = qMax(reserved_seats + spare_seats, minimum_seats);
+    generated.offer["Reserved_Seats"] = reserved_seats;
+
+    // Joined columns of the offer catalog rows, for the demo-mode backend
+    QDateTime created(departure_date.addDays(-random.bounded(30, 200)), QTime(9, 0));
+    generated.offer["Date_Created"] = created;
+    generated.offer["Date_Modified"] = created;
+    generated.offer["Destination_Name"] = destination_name;
+    generated.offer["Country"] = CITIES[destination_index % CITIES.size()].country;
+    generated.offer["Accommodation_Name"] = accommodation(accommodation_index).value("Name");
+    generated.offer["Transport_Name"] = TRANSPORT_TYPES[transport_index % TRANSPORT_TYPES.size()];
+    return generated;
+}
+
+QHash<QString, QVariant> Dataset_Generator::user(int index) const
+{
+    Row_Random random(row_seed(Table::USERS, index));
+    QString first_name = random.pick(FIRST_NAMES);
+    QString last_name = random.pick(LAST_NAMES);
+    QString username = QString("%1.%2%3").arg(first_name.toLower(), last_name.toLower()).arg(index + 1);
+
+    QByteArray salt;
+    for (int i = 0; i < 16; ++i)
+    {
+        salt.append(static_cast<char>(random.bounded(0, 256)));
+    }
+    QString salt_hex = salt.toHex();
+
+    QHash<QString, QVariant> row;
+    row["Username"] = username;
+    row["Password_Salt"] = salt_hex;
+    row["Password_Hash"] = Database_Manager::hash_password(Config::Dataset::USER_PASSWORD, salt_hex);
+    row["Email"] = username + "@" + random.pick(EMAIL_DOMAINS);
+    row["First_Name"] = first_name;
+    row["Last_Name"] = last_name;
+    row["Phone"] = QString("07%1").arg(random.bounded(0, 100000000), 8, 10, QChar('0'));
+    return row;
+}
+
+// Demo mode
+QList<QHash<QString, QVariant>> Dataset_Generator::generate_demo_destinations() const
+{
+    QList<QHash<QString, QVariant>> rows;
+    rows.reserve(scale.destinations);
+    for (int i = 0; i < scale.destinations; ++i)
+    {
+        QHash<QString, QVariant> row = destination(i);
+        row["Destination_ID"] = get_id(Table::DESTINATIONS, i);
+        rows.append(row);
+    }
+    return rows;
+}
+
+QList<QHash<QString, QVariant>> Dataset_Generator::generate_demo_offers() const
+{
+    QList<QHash<QString, QVariant>> rows;
+    rows.reserve(scale.offers);
+    for (int i = 0; i < scale.offers; ++i)
+    {
+        QHash<QString, QVariant> row = offer(i).offer;
+        row["Offer_ID"] = get_id(Table::OFFERS, i);
+        rows.append(row);
+    }
+    return rows;
+}
+
+// Database
+Query_Result Dataset_Generator::load_into(std::shared_ptr<Database_Manager> db_manager)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Utils::Logger::info(QString("Generating dataset (seed %1): %2").arg(seed).arg(scale.to_string()));
+
+    // Shared with the hand-made catalog, only filled in when empty
+    for (Table table : { Table::TRANSPORT_TYPES, Table::ACCOMMODATION_TYPES })
+    {
+        Query_Result existing = read_new_ids(db_manager, table, 0, -1);
+        if (!existing.is_success())
+        {
+            return existing;
+        }
+        if (ids.value(static_cast<int>(table)).isEmpty())
+        {
+            int count = table == Table::TRANSPORT_TYPES ? TRANSPORT_TYPES.size() : ACCOMMODATION_TYPES.size();
+            Query_Result result = insert_table(db_manager, table, count);
+            if (!result.is_success())
+            {
+                return result;
+            }
+        }
+    }
+
+    qint64 total_rows = 0;
+    const QList<QPair<Table, int>> tables = {
+        { Table::DESTINATIONS, scale.destinations },
+        { Table::ACCOMMODATIONS, scale.accommodations },
+        { Table::OFFERS, scale.offers },
+        { Table::USERS, scale.users }
+    };
+    for (const auto& [table, count] : tables)
+    {
+        Query_Result result = insert_table(db_manager, table, count);
+        if (!result.is_success())
+        {
+            return result;
+        }
+        total_rows += count;
+    }
+
+    // Reserved_Seats went in with the offers, the booking triggers would count every reservation again
+    const Sql_Dialect& dialect = db_manager->get_dialect();
+    QString disable_triggers = dialect.get_set_triggers_sql("Reservations", false);
+    if (!disable_triggers.isEmpty())
+    {
+        Query_Result result = db_manager->execute_query(disable_triggers);
+        if (!result.is_success())
+        {
+            return result;
+        }
+    }
+
+    qint64 reservations = 0;
+    Query_Result result = insert_reservations(db_manager, reservations);
+    total_rows += reservations;
+
+    QString enable_triggers = dialect.get_set_triggers_sql("Reservations", true);
+    if (!enable_triggers.isEmpty())
+    {
+        Query_Result enabled = db_manager->execute_query(enable_triggers);
+        if (!enabled.is_success())
+        {
+            Utils::Logger::error("Could not enable the Reservations triggers again, run: " + enable_triggers);
+            if (result.is_success())
+            {
+                result = enabled;
+            }
+        }
+    }
+    if (!result.is_success())
+    {
+        return result;
+    }
+
+    qint64 elapsed_ms = timer.elapsed();
+    Query_Result loaded(Result_Type::SUCCESS, QString("Generated dataset loaded: %1 rows (%2 reservations) in %3 ms, %4 rows/s")
+                        .arg(total_rows).arg(reservations).arg(elapsed_ms)
+                        .arg(elapsed_ms > 0 ? total_rows * 1000 / elapsed_ms : total_rows));
+    loaded.affected_rows = static_cast<int>(qMin<qint64>(total_rows, std::numeric_limits<int>::max()));
+    return loaded;
+}
+
+// Private helpers
+QHash<QString, QVariant> Dataset_Generator::get_row(Table table, int index) const
+{
+    switch (table)
+    {
+        case Table::TRANSPORT_TYPES: return transport_type(index);
+        case Table::ACCOMMODATION_TYPES: return accommodation_type(index);
+        case Table::DESTINATIONS: return destination(index);
+        case Table::ACCOMMODATIONS: return accommodation(index);
+        case Table::OFFERS: return offer(index).offer;
+        case Table::USERS: return user(index);
+    }
+    return QHash<QString, QVariant>();
+}
+
+int Dataset_Generator::get_id(Table table, int index) const
+{
+    auto found = ids.constFind(static_cast<int>(table));
+    if (found != ids.constEnd() && index < found->size())
+    {
+        return found->at(index);
+    }
+    return index + 1;
+}
+
+int Dataset_Generator::get_destination_of_accommodation(int accommodation_index) const
+{
+    // Round robin, so every destination has accommodations and offers
+    return scale.destinations > 0 ? accommodation_index % scale.destinations : 0;
+}
+
+quint64 Dataset_Generator::row_seed(Table table, int index) const
+{
+    return mix64(seed ^ mix64((static_cast<quint64>(table) << 32) | static_cast<quint32>(index)));
+}
+
+Query_Result Dataset_Generator::insert_table(std::shared_ptr<Database_Manager> db_manager, Table table, int count)
+{
+    QString table_name = get_table_name(table);
+    QString id_column = get_id_column(table);
+    QStringList columns = get_insert_columns(table);
+
+    // Identity values only grow: the new rows are the ones above the current maximum
+    Query_Result max_result = db_manager->execute_select(QString("SELECT MAX(%1) AS Max_ID FROM %2").arg(id_column, table_name));
+    if (!max_result.is_success())
+    {
+        return max_result;
+    }
+    int max_id_before = max_result.has_data() ? max_result.data[0].value("Max_ID").toInt() : 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList value_rows;
+    for (int i = 0; i < count; ++i)
+    {
+        value_rows.append(to_values_sql(*db_manager, get_row(table, i), columns));
+        if (value_rows.size() >= Config::Import::ROWS_PER_TRANSACTION || i == count - 1)
+        {
+            Query_Result result = db_manager->bulk_insert(table_name, columns, value_rows);
+            if (!result.is_success())
+            {
+                return Query_Result(result.type, QString("Loading %1 failed after %2 rows: %3").arg(table_name).arg(i + 1 - value_rows.size()).arg(result.message));
+            }
+            value_rows.clear();
+        }
+    }
+    Utils::Logger::info(QString("Generated %1 rows into %2 in %3 ms").arg(count).arg(table_name).arg(timer.elapsed()));
+
+    return read_new_ids(db_manager, table, max_id_before, count);
+}
+
+Query_Result Dataset_Generator::insert_reservations(std::shared_ptr<Database_Manager> db_manager, qint64& inserted)
+{
+    static const QStringList columns = {
+        "User_ID", "Offer_ID", "Number_of_Persons", "Total_Price", "Reservation_Date", "Status", "Notes"
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList value_rows;
+    for (int i = 0; i < scale.offers; ++i)
+    {
+        const Generated_Offer generated = offer(i);
+        for (const auto& reservation : generated.reservations)
+        {
+            value_rows.append(to_values_sql(*db_manager, reservation, columns));
+        }
+
+        if (value_rows.size() >= Config::Import::ROWS_PER_TRANSACTION || (i == scale.offers - 1 && !value_rows.isEmpty()))
+        {
+            Query_Result result = db_manager->bulk_insert("Reservations", columns, value_rows);
+            if (!result.is_success())
+            {
+                return Query_Result(result.type, QString("Loading Reservations failed after %1 rows: %2").arg(inserted).arg(result.message));
+            }
+            inserted += value_rows.size();
+            value_rows.clear();
+        }
+    }
+    Utils::Logger::info(QString("Generated %1 rows into Reservations in %2 ms").arg(inserted).arg(timer.elapsed()));
+
+    return Query_Result(Result_Type::SUCCESS, "Reservations loaded");
+}
+
+Query_Result Dataset_Generator::read_new_ids(std::shared_ptr<Database_Manager> db_manager, Table table, int after_id, int expected)
+{
+    QString id_column = get_id_column(table);
+    Query_Result result = db_manager->execute_select(QString("SELECT %1 FROM %2 WHERE %1 > %3 ORDER BY %1")
+                                                     .arg(id_column, get_table_name(table)).arg(after_id));
+    if (!result.is_success())
+    {
+        return result;
+    }
+
+    QList<int> table_ids;
+    table_ids.reserve(result.data.size());
+    for (const auto& row : result.data)
+    {
+        table_ids.append(row.value(id_column).toInt());
+    }
+
+    if (expected >= 0 && table_ids.size() != expected)
+    {
+        return Query_Result(Result_Type::ERROR_EXECUTION, QString("Expected %1 new rows in %2, found %3 - was it written to during the load?")
+                            .arg(expected).arg(get_table_name(table)).arg(table_ids.size()));
+    }
+
+    set_ids(table, table_ids);
+    return Query_Result(Result_Type::SUCCESS, QString("%1 ids read").arg(table_ids.size()));
+}
+
+QString Dataset_Generator::to_values_sql(Database_Manager& db_manager, const QHash<QString, QVariant>& row, const QStringList& columns)
+{
+    const Sql_Dialect& dialect = db_manager.get_dialect();
+    QStringList values;
+    for (const QString& column : columns)
+    {
+        QVariant value = row.value(column);
+        if (!value.isValid() || value.isNull())
+        {
+            values.append("NULL");
+            continue;
+        }
+
+        switch (value.typeId())
+        {
+            case QMetaType::QDate:
+                values.append(dialect.date_literal(value.toDate()));
+                break;
+            case QMetaType::QDateTime:
+                values.append(dialect.datetime_literal(value.toDateTime()));
+                break;
+            case QMetaType::Int:
+            case QMetaType::LongLong:
+                values.append(QString::number(value.toLongLong()));
+                break;
+            case QMetaType::Double:
+                values.append(QString::number(value.toDouble(), 'f', 2));
+                break;
+            default:
+                values.append("'" + db_manager.escape_string(value.toString()) + "'");
+                break;
+        }
+    }
+    return "(" + values.join(", ") + ")";
+}
+
+QString Dataset_Generator::get_table_name(Table table)
+{
+    switch (table)
+    {
+        case Table::TRANSPORT_TYPES: return "Types_of_Transport";
+        case Table::ACCOMMODATION_TYPES: return "Types_of_Accommodation";
+        case Table::DESTINATIONS: return "Destinations";
+        case Table::ACCOMMODATIONS: return "Accommodations";
+        case Table::OFFERS: return "Offers";
+        case Table::USERS: return "Users";
+    }
+    return QString();
+}
+
+QString Dataset_Generator::get_id_column(Table table)
+{
+    switch (table)
+    {
+        case Table::TRANSPORT_TYPES: return "Transport_Type_ID";
+        case Table::ACCOMMODATION_TYPES: return "Accommodation_Type_ID";
+        case Table::DESTINATIONS: return "Destination_ID";
+        case Table::ACCOMMODATIONS: return "Accommodation_ID";
+        case Table::OFFERS: return "Offer_ID";
+        case Table::USERS: return "User_ID";
+    }
+    return QString();
+}
+
+QStringList Dataset_Generator::get_insert_columns(Table table)
+{
+    switch (table)
+    {
+        case Table::TRANSPORT_TYPES:
+        case Table::ACCOMMODATION_TYPES:
+            return { "Name", "Description" };
+        case Table::DESTINATIONS:
+            return { "Name", "Country", "Description", "Image_Path" };
+        case Table::ACCOMMODATIONS:
+            return { "Name", "Destination_ID", "Type_of_Accommodation", "Category", "Address", "Facilities", "Rating", "Description" };
+        case Table::OFFERS:
+            return { "Name", "Destination_ID", "Accommodation_ID", "Types_of_Transport_ID", "Price_per_Person", "Duration_Days",
+                     "Departure_Date", "Return_Date", "Total_Seats", "Reserved_Seats", "Included_Services", "Description", "Status" };
+        case Table::USERS:
+            return { "Username", "Password_Hash", "Password_Salt", "Email", "First_Name", "Last_Name", "Phone" };
+    }
+    return QStringList();
+}
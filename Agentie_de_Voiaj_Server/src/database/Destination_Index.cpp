@@ -0,0 +1,299 @@
+#include "database/Destination_Index.h"
+
+#include <QtCore/QReadLocker>
+#include <QtCore/QWriteLocker>
+#include <QtCore/QChar>
+#include <algorithm>
+
+using namespace Database;
+
+// Maintenance
+void Destination_Index::build(const QList<QHash<QString, QVariant>>& rows)
+{
+    QWriteLocker locker(&lock);
+
+    entries.clear();
+    postings.clear();
+    entries.reserve(rows.size());
+
+    for (const auto& row : rows)
+    {
+        upsert_locked(row.value("Destination_ID").toInt(),
+                      row.value("Name").toString(),
+                      row.value("Country").toString());
+    }
+
+    built = true;
+}
+
+void Destination_Index::upsert(int destination_id, const QString& name, const QString& country)
+{
+    QWriteLocker locker(&lock);
+    upsert_locked(destination_id, name, country);
+}
+
+void Destination_Index::remove(int destination_id)
+{
+    QWriteLocker locker(&lock);
+    remove_locked(destination_id);
+}
+
+void Destination_Index::clear()
+{
+    QWriteLocker locker(&lock);
+    entries.clear();
+    postings.clear();
+    built = false;
+}
+
+bool Destination_Index::is_built() const
+{
+    QReadLocker locker(&lock);
+    return built;
+}
+
+int Destination_Index::size() const
+{
+    QReadLocker locker(&lock);
+    return entries.size();
+}
+
+// Lookups
+QSet<int> Destination_Index::find_substring(const QString& text) const
+{
+    QReadLocker locker(&lock);
+    return find_substring_locked(normalize(text));
+}
+
+QSet<int> Destination_Index::find_similar(const QString& text, qreal min_similarity) const
+{
+    QReadLocker locker(&lock);
+    return find_similar_locked(normalize(text), min_similarity);
+}
+
+QSet<int> Destination_Index::lookup(const QString& text, qreal min_similarity) const
+{
+    QReadLocker locker(&lock);
+
+    QString normalized = normalize(text);
+    QSet<int> ids = find_substring_locked(normalized);
+
+    // Fall back to fuzzy matching only when the exact substring finds nothing
+    if (ids.isEmpty() && normalized.length() >= 3)
+    {
+        ids = find_similar_locked(normalized, min_similarity);
+    }
+    return ids;
+}
+
+// Normalization helpers
+QString Destination_Index::normalize(const QString& text)
+{
+    // NFD splits "ș" into "s" + combining comma, "ă" into "a" + breve, etc.
+    QString decomposed = text.normalized(QString::NormalizationForm_D);
+
+    QString result;
+    result.reserve(decomposed.size());
+    bool pending_space = false;
+
+    for (QChar c : decomposed)
+    {
+        if (c.category() == QChar::Mark_NonSpacing)
+        {
+            continue;
+        }
+
+        if (c.isLetterOrNumber())
+        {
+            if (pending_space && !result.isEmpty())
+            {
+                result += QLatin1Char(' ');
+            }
+            pending_space = false;
+            result += c.toCaseFolded();
+        }
+        else
+        {
+            pending_space = true;
+        }
+    }
+
+    return result;
+}
+
+QSet<quint64> Destination_Index::trigrams(const QString& normalized, bool padded)
+{
+    QString text = padded ? QLatin1Char(' ') + normalized + QLatin1Char(' ') : normalized;
+
+    QSet<quint64> result;
+    for (int i = 0; i + 3 <= text.length(); ++i)
+    {
+        quint64 key = (static_cast<quint64>(text[i].unicode()) << 32) |
+                      (static_cast<quint64>(text[i + 1].unicode()) << 16) |
+                      static_cast<quint64>(text[i + 2].unicode());
+        result.insert(key);
+    }
+    return result;
+}
+
+// Private helpers
+void Destination_Index::upsert_locked(int destination_id, const QString& name, const QString& country)
+{
+    if (destination_id <= 0)
+    {
+        return;
+    }
+
+    remove_locked(destination_id);
+
+    Entry entry;
+    entry.name = normalize(name);
+    entry.country = normalize(country);
+
+    QStringList tokens = { entry.name, entry.country };
+    tokens += entry.name.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    tokens += entry.country.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+
+    for (const QString& token : tokens)
+    {
+        if (token.isEmpty())
+        {
+            continue;
+        }
+
+        QSet<quint64> token_set = trigrams(token);
+        entry.all_trigrams.unite(token_set);
+        entry.token_trigrams.append(token_set);
+    }
+
+    for (quint64 trigram : std::as_const(entry.all_trigrams))
+    {
+        postings[trigram].insert(destination_id);
+    }
+
+    entries.insert(destination_id, entry);
+}
+
+void Destination_Index::remove_locked(int destination_id)
+{
+    auto it = entries.find(destination_id);
+    if (it == entries.end())
+    {
+        return;
+    }
+
+    for (quint64 trigram : std::as_const(it.value().all_trigrams))
+    {
+        auto posting = postings.find(trigram);
+        if (posting != postings.end())
+        {
+            posting.value().remove(destination_id);
+            if (posting.value().isEmpty())
+            {
+                postings.erase(posting);
+            }
+        }
+    }
+
+    entries.erase(it);
+}
+
+QSet<int> Destination_Index::find_substring_locked(const QString& normalized) const
+{
+    QSet<int> ids;
+    if (normalized.isEmpty())
+    {
+        return ids;
+    }
+
+    auto verify = [&](int destination_id, const Entry& entry) {
+        if (entry.name.contains(normalized) || entry.country.contains(normalized))
+        {
+            ids.insert(destination_id);
+        }
+    };
+
+    // Too short for a trigram: the destination list is small, scan it
+    if (normalized.length() < 3)
+    {
+        for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        {
+            verify(it.key(), it.value());
+        }
+        return ids;
+    }
+
+    // Intersect posting lists, smallest first
+    QVector<const QSet<int>*> lists;
+    for (quint64 trigram : trigrams(normalized, false))
+    {
+        auto posting = postings.constFind(trigram);
+        if (posting == postings.constEnd())
+        {
+            return ids;
+        }
+        lists.append(&posting.value());
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const QSet<int>* a, const QSet<int>* b) {
+        return a->size() < b->size();
+    });
+
+    QSet<int> candidates = *lists.first();
+    for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i)
+    {
+        candidates.intersect(*lists[i]);
+    }
+
+    // Trigrams can match out of order, so confirm the real substring
+    for (int destination_id : std::as_const(candidates))
+    {
+        verify(destination_id, entries[destination_id]);
+    }
+    return ids;
+}
+
+QSet<int> Destination_Index::find_similar_locked(const QString& normalized, qreal min_similarity) const
+{
+    QSet<int> ids;
+    QSet<quint64> query_trigrams = trigrams(normalized);
+    if (query_trigrams.isEmpty())
+    {
+        return ids;
+    }
+
+    QSet<int> candidates;
+    for (quint64 trigram : std::as_const(query_trigrams))
+    {
+        auto posting = postings.constFind(trigram);
+        if (posting != postings.constEnd())
+        {
+            candidates.unite(posting.value());
+        }
+    }
+
+    for (int destination_id : std::as_const(candidates))
+    {
+        const Entry& entry = entries[destination_id];
+        for (const QSet<quint64>& token_set : entry.token_trigrams)
+        {
+            int shared = 0;
+            for (quint64 trigram : std::as_const(query_trigrams))
+            {
+                if (token_set.contains(trigram))
+                {
+                    ++shared;
+                }
+            }
+
+            qreal similarity = static_cast<qreal>(shared) /
+                               (query_trigrams.size() + token_set.size() - shared);
+            if (similarity >= min_similarity)
+            {
+                ids.insert(destination_id);
+                break;
+            }
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,128 @@
+#include "database/Group_Commit.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QMutexLocker>
+
+using namespace Database;
+
+QString Group_Commit_Stats::get_bucket_label(int bucket)
+{
+    int low = 1 << bucket;
+    int high = (1 << (bucket + 1)) - 1;
+    return low == high ? QString::number(low) : QString("%1-%2").arg(low).arg(high);
+}
+
+// Constructor
+Group_Commit::Group_Commit(std::shared_ptr<Database_Manager> db_manager, QObject* parent)
+    : QObject(parent), db_manager(db_manager), window_timer(new QTimer(this))
+{
+    window_timer->setSingleShot(true);
+    window_timer->setTimerType(Qt::PreciseTimer);
+    connect(window_timer, &QTimer::timeout, this, &Group_Commit::flush);
+}
+
+// Queueing
+void Group_Commit::submit(const Batch_Operation& operation, std::function<void(const Query_Result&)> on_complete)
+{
+    bool batch_full = false;
+    {
+        QMutexLocker locker(&mutex);
+        if (queue.isEmpty())
+        {
+            window_clock.start();
+            window_timer->start(Config::Booking::GROUP_COMMIT_WINDOW_MS);
+        }
+
+        queue.append({ operation, std::move(on_complete) });
+        batch_full = queue.size() >= Config::Booking::GROUP_COMMIT_MAX_BATCH;
+    }
+
+    if (batch_full)
+    {
+        flush();
+    }
+}
+
+int Group_Commit::get_queued_count() const
+{
+    QMutexLocker locker(&mutex);
+    return queue.size();
+}
+
+Group_Commit_Stats Group_Commit::get_stats() const
+{
+    QMutexLocker locker(&mutex);
+    return stats;
+}
+
+// Commit
+void Group_Commit::flush()
+{
+    QList<Queued_Operation> batch;
+    {
+        QMutexLocker locker(&mutex);
+        window_timer->stop();
+        batch.swap(queue);
+    }
+
+    if (batch.isEmpty())
+    {
+        return;
+    }
+
+    QList<Batch_Operation> operations;
+    operations.reserve(batch.size());
+    for (const Queued_Operation& queued : std::as_const(batch))
+    {
+        operations.append(queued.operation);
+    }
+
+    QList<Query_Result> results;
+    if (!db_manager)
+    {
+        results = QList<Query_Result>(operations.size(), Query_Result(Result_Type::ERROR_CONNECTION, Config::ErrorMessages::DB_CONNECTION_FAILED));
+    }
+    else if (!db_manager->apply_batch(operations, results))
+    {
+        Utils::Logger::warning(QString("Group commit of %1 operations failed: %2").arg(operations.size()).arg(results.first().message));
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        record_batch(operations.size(), window_clock.nsecsElapsed() / 1000);
+    }
+
+    // Callbacks may submit again (the next request of the same client), the queue is already swapped out
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        if (batch[i].on_complete)
+        {
+            batch[i].on_complete(results[i]);
+        }
+    }
+}
+
+// Private helpers
+void Group_Commit::record_batch(int batch_size, qint64 wait_us)
+{
+    int bucket = 0;
+    while ((2 << bucket) <= batch_size)
+    {
+        ++bucket;
+    }
+
+    if (stats.batch_size_histogram.size() <= bucket)
+    {
+        stats.batch_size_histogram.resize(bucket + 1);
+    }
+    stats.batch_size_histogram[bucket]++;
+
+    stats.batches++;
+    stats.operations += batch_size;
+    stats.max_batch_size = qMax(stats.max_batch_size, batch_size);
+    stats.average_batch_size = static_cast<qreal>(stats.operations) / stats.batches;
+
+    total_wait_us += wait_us;
+    stats.average_wait_ms = static_cast<qreal>(total_wait_us) / stats.batches / 1000.0;
+}
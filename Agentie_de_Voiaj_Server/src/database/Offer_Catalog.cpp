@@ -0,0 +1,600 @@
+#include "database/Offer_Catalog.h"
+
+#include <QtCore/QReadLocker>
+#include <QtCore/QWriteLocker>
+#include <algorithm>
+
+using namespace Database;
+
+// Loading and refresh
+void Offer_Catalog::load(const QList<QHash<QString, QVariant>>& rows)
+{
+    QWriteLocker locker(&lock);
+
+    offers.clear();
+    slot_by_offer_id.clear();
+    free_slots.clear();
+    slots_by_destination.clear();
+    destination_names.clear();
+    slots_by_available_seats.clear();
+    watermark = QDateTime();
+
+    offers.reserve(rows.size());
+    for (const auto& row : rows)
+    {
+        if (!is_catalog_status(row))
+        {
+            continue;
+        }
+
+        Catalog_Offer offer = offer_from_row(row);
+        if (slot_by_offer_id.contains(offer.offer_id))
+        {
+            continue;
+        }
+
+        int slot = offers.size();
+        offers.append(offer);
+        slot_by_offer_id.insert(offer.offer_id, slot);
+        index_slot(slot, false);
+
+        if (offer.date_modified > watermark)
+        {
+            watermark = offer.date_modified;
+        }
+    }
+
+    // Sorting once is cheaper than sorted inserts for a full load
+    rebuild_sorted_indexes();
+    loaded = true;
+    ++version;
+}
+
+void Offer_Catalog::apply_changes(const QList<QHash<QString, QVariant>>& rows)
+{
+    if (rows.isEmpty())
+    {
+        return; // a refresh that found nothing keeps cached responses valid
+    }
+
+    QWriteLocker locker(&lock);
+
+    for (const auto& row : rows)
+    {
+        upsert_locked(row);
+    }
+    ++version;
+}
+
+void Offer_Catalog::clear()
+{
+    QWriteLocker locker(&lock);
+
+    offers.clear();
+    slot_by_offer_id.clear();
+    free_slots.clear();
+    slots_by_destination.clear();
+    destination_names.clear();
+    slots_by_price.clear();
+    slots_by_departure.clear();
+    slots_by_return.clear();
+    slots_by_available_seats.clear();
+    watermark = QDateTime();
+    loaded = false;
+    ++version;
+}
+
+bool Offer_Catalog::is_loaded() const
+{
+    QReadLocker locker(&lock);
+    return loaded;
+}
+
+QDateTime Offer_Catalog::get_watermark() const
+{
+    QReadLocker locker(&lock);
+    return watermark;
+}
+
+int Offer_Catalog::size() const
+{
+    QReadLocker locker(&lock);
+    return slot_by_offer_id.size();
+}
+
+quint64 Offer_Catalog::get_version() const
+{
+    return version.load();
+}
+
+// In-place updates from the write paths
+void Offer_Catalog::remove_offer(int offer_id)
+{
+    QWriteLocker locker(&lock);
+    remove_locked(offer_id);
+    ++version;
+}
+
+bool Offer_Catalog::adjust_reserved_seats(int offer_id, int delta)
+{
+    QWriteLocker locker(&lock);
+
+    auto it = slot_by_offer_id.constFind(offer_id);
+    if (it == slot_by_offer_id.constEnd())
+    {
+        return false;
+    }
+
+    Catalog_Offer& offer = offers[it.value()];
+    int new_reserved = offer.reserved_seats + delta;
+    if (new_reserved < 0 || new_reserved > offer.total_seats)
+    {
+        return false;
+    }
+
+    // Only the seats index depends on Reserved_Seats, so only it is touched
+    int old_available = offer.get_available_seats();
+    auto seats_it = slots_by_available_seats.find(old_available);
+    if (seats_it != slots_by_available_seats.end())
+    {
+        seats_it.value().remove(it.value());
+        if (seats_it.value().isEmpty())
+        {
+            slots_by_available_seats.erase(seats_it);
+        }
+    }
+
+    offer.reserved_seats = new_reserved;
+    offer.row["Reserved_Seats"] = new_reserved;
+    slots_by_available_seats[offer.get_available_seats()].insert(it.value());
+    ++version;
+    return true;
+}
+
+void Offer_Catalog::update_destination(int destination_id, const QString& name, const QString& country)
+{
+    QWriteLocker locker(&lock);
+
+    destination_names[destination_id] = qMakePair(name.toLower(), country.toLower());
+
+    for (int slot : slots_by_destination.value(destination_id))
+    {
+        offers[slot].row["Destination_Name"] = name;
+        offers[slot].row["Country"] = country;
+    }
+    ++version;
+}
+
+// Queries
+QList<QHash<QString, QVariant>> Offer_Catalog::get_available_offers() const
+{
+    Offer_Search_Criteria criteria;
+    criteria.only_future_departures = true;
+    return search(criteria);
+}
+
+QList<QHash<QString, QVariant>> Offer_Catalog::search(const Offer_Search_Criteria& criteria) const
+{
+    QReadLocker locker(&lock);
+
+    QDate today = QDate::currentDate();
+    QVector<int> result_slots;
+    for (int slot : candidate_slots(criteria))
+    {
+        if (matches(offers[slot], criteria, today))
+        {
+            result_slots.append(slot);
+        }
+    }
+
+    // Same order as the SQL listing: ORDER BY o.Departure_Date, o.Offer_ID
+    auto by_departure = [this](int a, int b) {
+        const Catalog_Offer& left = offers[a];
+        const Catalog_Offer& right = offers[b];
+        if (left.departure_date != right.departure_date)
+        {
+            return left.departure_date < right.departure_date;
+        }
+        return left.offer_id < right.offer_id;
+    };
+
+    if (criteria.limit > 0 && result_slots.size() > criteria.limit)
+    {
+        std::partial_sort(result_slots.begin(), result_slots.begin() + criteria.limit, result_slots.end(), by_departure);
+        result_slots.resize(criteria.limit);
+    }
+    else
+    {
+        std::sort(result_slots.begin(), result_slots.end(), by_departure);
+    }
+
+    QList<QHash<QString, QVariant>> rows;
+    rows.reserve(result_slots.size());
+    for (int slot : result_slots)
+    {
+        if (criteria.fields.isEmpty())
+        {
+            rows.append(offers[slot].row);
+            continue;
+        }
+
+        QHash<QString, QVariant> row;
+        row.reserve(criteria.fields.size());
+        for (const QString& field : criteria.fields)
+        {
+            row.insert(field, offers[slot].row.value(field));
+        }
+        rows.append(row);
+    }
+    return rows;
+}
+
+bool Offer_Catalog::get_offer(int offer_id, QHash<QString, QVariant>& row) const
+{
+    QReadLocker locker(&lock);
+
+    auto it = slot_by_offer_id.constFind(offer_id);
+    if (it == slot_by_offer_id.constEnd())
+    {
+        return false;
+    }
+
+    row = offers[it.value()].row;
+    return true;
+}
+
+QSet<int> Offer_Catalog::match_destinations(const QString& text) const
+{
+    QReadLocker locker(&lock);
+
+    QSet<int> ids;
+    QString needle = text.trimmed().toLower();
+    for (auto it = destination_names.constBegin(); it != destination_names.constEnd(); ++it)
+    {
+        if (it.value().first.contains(needle) || it.value().second.contains(needle))
+        {
+            ids.insert(it.key());
+        }
+    }
+    return ids;
+}
+
+// Private helpers
+void Offer_Catalog::upsert_locked(const QHash<QString, QVariant>& row)
+{
+    int offer_id = row.value("Offer_ID").toInt();
+    if (offer_id <= 0)
+    {
+        return;
+    }
+
+    Catalog_Offer offer = offer_from_row(row);
+    if (offer.date_modified > watermark)
+    {
+        watermark = offer.date_modified;
+    }
+
+    // Offers that are no longer active simply drop out of the catalog
+    if (!is_catalog_status(row))
+    {
+        remove_locked(offer_id);
+        return;
+    }
+
+    auto it = slot_by_offer_id.constFind(offer_id);
+    if (it != slot_by_offer_id.constEnd())
+    {
+        int slot = it.value();
+        unindex_slot(slot);
+        offers[slot] = offer;
+        index_slot(slot, true);
+        return;
+    }
+
+    int slot;
+    if (!free_slots.isEmpty())
+    {
+        slot = free_slots.takeLast();
+        offers[slot] = offer;
+    }
+    else
+    {
+        slot = offers.size();
+        offers.append(offer);
+    }
+
+    slot_by_offer_id.insert(offer_id, slot);
+    index_slot(slot, true);
+}
+
+void Offer_Catalog::remove_locked(int offer_id)
+{
+    auto it = slot_by_offer_id.find(offer_id);
+    if (it == slot_by_offer_id.end())
+    {
+        return;
+    }
+
+    int slot = it.value();
+    unindex_slot(slot);
+    slot_by_offer_id.erase(it);
+
+    offers[slot] = Catalog_Offer();
+    free_slots.append(slot);
+}
+
+void Offer_Catalog::index_slot(int slot, bool keep_sorted)
+{
+    Catalog_Offer& offer = offers[slot];
+    offer.in_use = true;
+
+    slots_by_destination[offer.destination_id].append(slot);
+    slots_by_available_seats[offer.get_available_seats()].insert(slot);
+
+    QString name = offer.row.value("Destination_Name").toString().toLower();
+    QString country = offer.row.value("Country").toString().toLower();
+    destination_names[offer.destination_id] = qMakePair(name, country);
+
+    if (!keep_sorted)
+    {
+        return;
+    }
+
+    auto by_price = [this](int s) { return qMakePair(offers[s].price_per_person, offers[s].offer_id); };
+    auto by_departure = [this](int s) { return qMakePair(offers[s].departure_date, offers[s].offer_id); };
+    auto by_return = [this](int s) { return qMakePair(offers[s].return_date, offers[s].offer_id); };
+
+    auto price_key = by_price(slot);
+    slots_by_price.insert(std::partition_point(slots_by_price.begin(), slots_by_price.end(),
+        [&](int s) { return by_price(s) < price_key; }), slot);
+
+    auto departure_key = by_departure(slot);
+    slots_by_departure.insert(std::partition_point(slots_by_departure.begin(), slots_by_departure.end(),
+        [&](int s) { return by_departure(s) < departure_key; }), slot);
+
+    auto return_key = by_return(slot);
+    slots_by_return.insert(std::partition_point(slots_by_return.begin(), slots_by_return.end(),
+        [&](int s) { return by_return(s) < return_key; }), slot);
+}
+
+void Offer_Catalog::unindex_slot(int slot)
+{
+    const Catalog_Offer& offer = offers[slot];
+
+    auto dest_it = slots_by_destination.find(offer.destination_id);
+    if (dest_it != slots_by_destination.end())
+    {
+        dest_it.value().removeOne(slot);
+        if (dest_it.value().isEmpty())
+        {
+            slots_by_destination.erase(dest_it);
+            destination_names.remove(offer.destination_id); // its last offer moved away or left the catalog
+        }
+    }
+
+    auto seats_it = slots_by_available_seats.find(offer.get_available_seats());
+    if (seats_it != slots_by_available_seats.end())
+    {
+        seats_it.value().remove(slot);
+        if (seats_it.value().isEmpty())
+        {
+            slots_by_available_seats.erase(seats_it);
+        }
+    }
+
+    slots_by_price.removeOne(slot);
+    slots_by_departure.removeOne(slot);
+    slots_by_return.removeOne(slot);
+}
+
+void Offer_Catalog::rebuild_sorted_indexes()
+{
+    slots_by_price.clear();
+    slots_by_departure.clear();
+    slots_by_return.clear();
+
+    for (int slot : std::as_const(slot_by_offer_id))
+    {
+        slots_by_price.append(slot);
+    }
+    slots_by_departure = slots_by_price;
+    slots_by_return = slots_by_price;
+
+    std::sort(slots_by_price.begin(), slots_by_price.end(), [this](int a, int b) {
+        return qMakePair(offers[a].price_per_person, offers[a].offer_id) <
+               qMakePair(offers[b].price_per_person, offers[b].offer_id);
+    });
+    std::sort(slots_by_departure.begin(), slots_by_departure.end(), [this](int a, int b) {
+        return qMakePair(offers[a].departure_date, offers[a].offer_id) <
+               qMakePair(offers[b].departure_date, offers[b].offer_id);
+    });
+    std::sort(slots_by_return.begin(), slots_by_return.end(), [this](int a, int b) {
+        return qMakePair(offers[a].return_date, offers[a].offer_id) <
+               qMakePair(offers[b].return_date, offers[b].offer_id);
+    });
+}
+
+bool Offer_Catalog::matches(const Catalog_Offer& offer, const Offer_Search_Criteria& criteria, const QDate& today) const
+{
+    if (!offer.in_use)
+    {
+        return false;
+    }
+
+    if (criteria.filter_destinations && !criteria.destination_ids.contains(offer.destination_id))
+    {
+        return false;
+    }
+
+    if (criteria.min_price > 0 && offer.price_per_person < criteria.min_price)
+    {
+        return false;
+    }
+
+    if (criteria.max_price > 0 && offer.price_per_person > criteria.max_price)
+    {
+        return false;
+    }
+
+    if (criteria.start_date.isValid() && offer.departure_date < criteria.start_date)
+    {
+        return false;
+    }
+
+    if (criteria.end_date.isValid() && offer.return_date > criteria.end_date)
+    {
+        return false;
+    }
+
+    if (criteria.only_future_departures && offer.departure_date <= today)
+    {
+        return false;
+    }
+
+    if (criteria.after_offer_id > 0 &&
+        qMakePair(offer.departure_date, offer.offer_id) <= qMakePair(criteria.after_departure, criteria.after_offer_id))
+    {
+        return false;
+    }
+
+    return offer.get_available_seats() >= criteria.min_available_seats;
+}
+
+QVector<int> Offer_Catalog::candidate_slots(const Offer_Search_Criteria& criteria) const
+{
+    // Every index yields a candidate range, sized without copying it; only the
+    // shortest one is copied out and intersected with the remaining predicates in matches()
+    enum class Source { SORTED_RANGE, DESTINATIONS, SEATS };
+    Source best = Source::SORTED_RANGE;
+    const int* best_begin = slots_by_departure.constData();
+    const int* best_end = best_begin + slots_by_departure.size();
+    qsizetype best_size = best_end - best_begin;
+
+    auto consider = [&](const int* begin, const int* end) {
+        if (end - begin < best_size)
+        {
+            best = Source::SORTED_RANGE;
+            best_begin = begin;
+            best_end = end;
+            best_size = end - begin;
+        }
+    };
+
+    if (criteria.filter_destinations)
+    {
+        qsizetype destination_size = 0;
+        for (int destination_id : criteria.destination_ids)
+        {
+            auto found = slots_by_destination.constFind(destination_id);
+            if (found != slots_by_destination.constEnd())
+            {
+                destination_size += found.value().size();
+            }
+        }
+        if (destination_size < best_size)
+        {
+            best = Source::DESTINATIONS;
+            best_size = destination_size;
+        }
+    }
+
+    if (criteria.min_price > 0 || criteria.max_price > 0)
+    {
+        const int* lo = slots_by_price.constData();
+        const int* hi = lo + slots_by_price.size();
+        if (criteria.min_price > 0)
+        {
+            lo = std::partition_point(lo, hi, [&](int s) { return offers[s].price_per_person < criteria.min_price; });
+        }
+        if (criteria.max_price > 0)
+        {
+            hi = std::partition_point(lo, hi, [&](int s) { return offers[s].price_per_person <= criteria.max_price; });
+        }
+        consider(lo, hi);
+    }
+
+    if (criteria.start_date.isValid() || criteria.only_future_departures || criteria.after_offer_id > 0)
+    {
+        QDate today = QDate::currentDate();
+        auto after_key = qMakePair(criteria.after_departure, criteria.after_offer_id);
+        const int* begin = slots_by_departure.constData();
+        const int* end = begin + slots_by_departure.size();
+        const int* lo = std::partition_point(begin, end, [&](int s) {
+            const QDate& departure = offers[s].departure_date;
+            return (criteria.start_date.isValid() && departure < criteria.start_date) ||
+                   (criteria.only_future_departures && departure <= today) ||
+                   (criteria.after_offer_id > 0 && qMakePair(departure, offers[s].offer_id) <= after_key);
+        });
+        consider(lo, end);
+    }
+
+    if (criteria.end_date.isValid())
+    {
+        const int* begin = slots_by_return.constData();
+        const int* hi = std::partition_point(begin, begin + slots_by_return.size(),
+            [&](int s) { return offers[s].return_date <= criteria.end_date; });
+        consider(begin, hi);
+    }
+
+    if (criteria.min_available_seats > 1)
+    {
+        qsizetype seat_size = 0;
+        for (auto it = slots_by_available_seats.lowerBound(criteria.min_available_seats);
+             it != slots_by_available_seats.cend(); ++it)
+        {
+            seat_size += it.value().size();
+        }
+        if (seat_size < best_size)
+        {
+            best = Source::SEATS;
+            best_size = seat_size;
+        }
+    }
+
+    QVector<int> candidates;
+    candidates.reserve(best_size);
+    switch (best)
+    {
+    case Source::DESTINATIONS:
+        for (int destination_id : criteria.destination_ids)
+        {
+            candidates += slots_by_destination.value(destination_id);
+        }
+        break;
+    case Source::SEATS:
+        for (auto it = slots_by_available_seats.lowerBound(criteria.min_available_seats);
+             it != slots_by_available_seats.cend(); ++it)
+        {
+            for (int slot : it.value())
+            {
+                candidates.append(slot);
+            }
+        }
+        break;
+    case Source::SORTED_RANGE:
+    default:
+        candidates = QVector<int>(best_begin, best_end);
+        break;
+    }
+    return candidates;
+}
+
+Catalog_Offer Offer_Catalog::offer_from_row(const QHash<QString, QVariant>& row)
+{
+    Catalog_Offer offer;
+    offer.offer_id = row.value("Offer_ID").toInt();
+    offer.destination_id = row.value("Destination_ID").toInt();
+    offer.price_per_person = row.value("Price_per_Person").toDouble();
+    offer.departure_date = row.value("Departure_Date").toDate();
+    offer.return_date = row.value("Return_Date").toDate();
+    offer.total_seats = row.value("Total_Seats").toInt();
+    offer.reserved_seats = row.value("Reserved_Seats").toInt();
+    offer.date_modified = row.value("Date_Modified").toDateTime();
+    offer.row = row;
+    return offer;
+}
+
+bool Offer_Catalog::is_catalog_status(const QHash<QString, QVariant>& row)
+{
+    return row.value("Status").toString() == "active";
+}
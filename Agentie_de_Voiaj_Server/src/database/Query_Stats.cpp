@@ -0,0 +1,193 @@
+#include "database/Query_Stats.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRegularExpression>
+#include <algorithm>
+
+using namespace Database;
+
+namespace
+{
+    const QString OTHER_SHAPE = "(other)";
+    constexpr int MAX_SHAPE_LENGTH = 2000;
+
+    bool is_identifier_char(QChar c)
+    {
+        return c.isLetterOrNumber() || c == '_' || c == '@' || c == '#';
+    }
+}
+
+Query_Stats::Query_Stats(int max_shapes)
+    : max_shapes(max_shapes)
+{
+}
+
+// Recording
+void Query_Stats::record(const QString& query, qint64 wait_us, qint64 run_us, int rows, bool succeeded)
+{
+    // Normalized outside the lock, it is the expensive part
+    QString shape = normalize(query);
+
+    QMutexLocker locker(&mutex);
+
+    auto it = shapes.find(shape);
+    if (it == shapes.end() && shapes.size() >= max_shapes)
+    {
+        it = shapes.find(OTHER_SHAPE);
+        shape = OTHER_SHAPE;
+    }
+    if (it == shapes.end())
+    {
+        it = shapes.insert(shape, Shape_Totals());
+    }
+    add(it.value(), wait_us, run_us, rows, succeeded);
+    add(totals, wait_us, run_us, rows, succeeded);
+}
+
+void Query_Stats::reset()
+{
+    QMutexLocker locker(&mutex);
+    shapes.clear();
+    totals = Shape_Totals();
+}
+
+// Reads
+QList<QHash<QString, QVariant>> Query_Stats::get_top(int count) const
+{
+    QList<QPair<QString, Shape_Totals>> entries;
+    {
+        QMutexLocker locker(&mutex);
+        entries.reserve(shapes.size());
+        for (auto it = shapes.constBegin(); it != shapes.constEnd(); ++it)
+        {
+            entries.append({ it.key(), it.value() });
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.second.total_us > b.second.total_us;
+    });
+
+    QList<QHash<QString, QVariant>> rows;
+    for (int i = 0; i < entries.size() && i < count; ++i)
+    {
+        QHash<QString, QVariant> row = to_row(entries[i].second);
+        row.insert("Query_Shape", entries[i].first);
+        rows.append(row);
+    }
+    return rows;
+}
+
+QHash<QString, QVariant> Query_Stats::get_totals() const
+{
+    QMutexLocker locker(&mutex);
+    QHash<QString, QVariant> row = to_row(totals);
+    row.insert("Shapes", shapes.size());
+    return row;
+}
+
+// Normalization
+QString Query_Stats::normalize(const QString& query)
+{
+    QString shape;
+    shape.reserve(qMin(query.size(), MAX_SHAPE_LENGTH));
+
+    const int length = query.size();
+    for (int i = 0; i < length && shape.size() < MAX_SHAPE_LENGTH; ++i)
+    {
+        QChar c = query[i];
+
+        if (c == '\'')
+        {
+            // String literal, '' is an escaped quote inside it; N'...' keeps no prefix
+            ++i;
+            while (i < length && !(query[i] == '\'' && (i + 1 >= length || query[i + 1] != '\'')))
+            {
+                i += query[i] == '\'' ? 2 : 1;
+            }
+            if (shape.endsWith('N') && (shape.size() == 1 || !is_identifier_char(shape[shape.size() - 2])))
+            {
+                shape.chop(1);
+            }
+            shape += '?';
+        }
+        else if (c.isDigit() && (shape.isEmpty() || !is_identifier_char(shape.back())))
+        {
+            while (i + 1 < length && (query[i + 1].isDigit() || query[i + 1] == '.'))
+            {
+                ++i;
+            }
+            shape += '?';
+        }
+        else if (c.isSpace())
+        {
+            if (!shape.isEmpty() && shape.back() != ' ')
+            {
+                shape += ' ';
+            }
+        }
+        else
+        {
+            shape += c;
+        }
+    }
+
+    // IN lists and multi-row VALUES differ per call only in how many values they carry
+    static const QRegularExpression value_list(R"(\?(?:\s*,\s*\?)+)");
+    static const QRegularExpression row_list(R"(\((?:\?|\?\.\.\.)\)(?:\s*,\s*\((?:\?|\?\.\.\.)\))+)");
+    shape.replace(value_list, "?...");
+    shape.replace(row_list, "(?...), ...");
+
+    return shape.trimmed();
+}
+
+// Private helpers
+void Query_Stats::add(Shape_Totals& target, qint64 wait_us, qint64 run_us, int rows, bool succeeded)
+{
+    ++target.calls;
+    if (!succeeded)
+    {
+        ++target.errors;
+    }
+    target.rows += rows;
+    target.total_us += run_us;
+    target.max_us = qMax(target.max_us, run_us);
+    target.wait_us += wait_us;
+
+    auto bound = std::lower_bound(BUCKET_BOUNDS_US.begin(), BUCKET_BOUNDS_US.end(), run_us);
+    ++target.histogram[std::distance(BUCKET_BOUNDS_US.begin(), bound)];
+}
+
+QHash<QString, QVariant> Query_Stats::to_row(const Shape_Totals& source)
+{
+    double calls = qMax<qint64>(source.calls, 1);
+    return {
+        { "Calls", source.calls },
+        { "Errors", source.errors },
+        { "Rows", source.rows },
+        { "Total_Ms", source.total_us / 1000.0 },
+        { "Avg_Ms", source.total_us / 1000.0 / calls },
+        { "P50_Ms", percentile_ms(source, 0.50) },
+        { "P95_Ms", percentile_ms(source, 0.95) },
+        { "P99_Ms", percentile_ms(source, 0.99) },
+        { "Max_Ms", source.max_us / 1000.0 },
+        { "Avg_Wait_Ms", source.wait_us / 1000.0 / calls }
+    };
+}
+
+double Query_Stats::percentile_ms(const Shape_Totals& source, double fraction)
+{
+    // Upper bound of the bucket the percentile falls in, capped by the slowest call seen
+    qint64 needed = qMax<qint64>(1, static_cast<qint64>(source.calls * fraction + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += source.histogram[i];
+        if (seen >= needed)
+        {
+            qint64 bound = i < static_cast<int>(BUCKET_BOUNDS_US.size()) ? BUCKET_BOUNDS_US[i] : source.max_us;
+            return qMin(bound, source.max_us) / 1000.0;
+        }
+    }
+    return source.max_us / 1000.0;
+}
@@ -0,0 +1,311 @@
+#include "database/Revenue_Rollup.h"
+
+#include <QtCore/QMutexLocker>
+#include <algorithm>
+
+using namespace Database;
+
+// State
+void Revenue_Rollup::set_complete_through(const QDate& day)
+{
+    QMutexLocker locker(&mutex);
+    complete_through = day;
+    loaded = true;
+}
+
+QDate Revenue_Rollup::get_complete_through() const
+{
+    QMutexLocker locker(&mutex);
+    return complete_through;
+}
+
+bool Revenue_Rollup::is_loaded() const
+{
+    QMutexLocker locker(&mutex);
+    return loaded;
+}
+
+void Revenue_Rollup::clear()
+{
+    QMutexLocker locker(&mutex);
+    complete_through = QDate();
+    dirty_days.clear();
+    loaded = false;
+}
+
+// Dirty days
+void Revenue_Rollup::mark_dirty(const QDate& day)
+{
+    // Today is never rolled up, it is always read from Reservations
+    if (!day.isValid() || day >= QDate::currentDate())
+    {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    dirty_days.insert(day, ++mark_sequence);
+}
+
+QHash<QDate, quint64> Revenue_Rollup::get_dirty_days(int max_count) const
+{
+    QMutexLocker locker(&mutex);
+
+    QHash<QDate, quint64> days;
+    for (auto it = dirty_days.constBegin(); it != dirty_days.constEnd() && days.size() < max_count; ++it)
+    {
+        days.insert(it.key(), it.value());
+    }
+    return days;
+}
+
+void Revenue_Rollup::clear_dirty_days(const QHash<QDate, quint64>& rolled_up)
+{
+    QMutexLocker locker(&mutex);
+
+    // A day marked again while it was being rolled up keeps its newer mark
+    for (auto it = rolled_up.constBegin(); it != rolled_up.constEnd(); ++it)
+    {
+        auto current = dirty_days.constFind(it.key());
+        if (current != dirty_days.constEnd() && current.value() == it.value())
+        {
+            dirty_days.remove(it.key());
+        }
+    }
+}
+
+// SQL
+QString Revenue_Rollup::get_report_sql(const Sql_Dialect& dialect, const QDateTime& start, const QDateTime& end_exclusive,
+    Revenue_Period period) const
+{
+    QDate through;
+    QList<QDate> dirty;
+    {
+        QMutexLocker locker(&mutex);
+        if (loaded)
+        {
+            through = complete_through;
+            dirty = dirty_days.keys();
+        }
+    }
+
+    bool lower_bounded = start.isValid();
+    bool upper_bounded = end_exclusive.isValid();
+
+    auto raw_range = [&dialect](const QDateTime& from, const QDateTime& to) {
+        QStringList parts;
+        if (from.isValid())
+        {
+            parts << "Reservation_Date >= " + dialect.datetime_literal(from);
+        }
+        if (to.isValid())
+        {
+            parts << "Reservation_Date < " + dialect.datetime_literal(to);
+        }
+        return parts.isEmpty() ? QString("1 = 1") : "(" + parts.join(" AND ") + ")";
+    };
+
+    // Whole days inside the range that are already rolled up
+    QDate first_day;
+    if (lower_bounded)
+    {
+        first_day = start == start.date().startOfDay() ? start.date() : start.date().addDays(1);
+    }
+    QDate last_day = through;
+    if (last_day.isValid() && upper_bounded)
+    {
+        last_day = std::min(last_day, end_exclusive.date().addDays(-1));
+    }
+    bool use_rollup = last_day.isValid() && (!lower_bounded || first_day <= last_day);
+
+    QStringList raw_ranges;
+    QStringList rollup_filter = { "Status IN ('confirmed', 'paid')" };
+    if (!use_rollup)
+    {
+        raw_ranges << raw_range(start, end_exclusive);
+    }
+    else
+    {
+        // Partial first day, then everything after the last rolled up day (normally just today)
+        if (lower_bounded)
+        {
+            if (start < first_day.startOfDay())
+            {
+                raw_ranges << raw_range(start, first_day.startOfDay());
+            }
+            rollup_filter << "Rollup_Date >= " + dialect.date_literal(first_day);
+        }
+        rollup_filter << "Rollup_Date <= " + dialect.date_literal(last_day);
+
+        QDateTime after_rollup = last_day.addDays(1).startOfDay();
+        if (!upper_bounded || after_rollup < end_exclusive)
+        {
+            raw_ranges << raw_range(after_rollup, end_exclusive);
+        }
+
+        // Days changed since they were rolled up are read from Reservations instead
+        QStringList excluded;
+        for (const QDate& day : std::as_const(dirty))
+        {
+            if ((!lower_bounded || day >= first_day) && day <= last_day)
+            {
+                excluded << dialect.date_literal(day);
+                raw_ranges << raw_range(day.startOfDay(), day.addDays(1).startOfDay());
+            }
+        }
+        if (!excluded.isEmpty())
+        {
+            rollup_filter << "Rollup_Date NOT IN (" + excluded.join(", ") + ")";
+        }
+    }
+
+    QStringList sources;
+    if (use_rollup)
+    {
+        sources << "SELECT Rollup_Date AS Day, Reservations, Revenue, Persons "
+                   "FROM Reservation_Daily_Rollup WHERE " + rollup_filter.join(" AND ");
+    }
+    if (!raw_ranges.isEmpty())
+    {
+        sources << "SELECT " + dialect.date_of("Reservation_Date") + " AS Day, 1 AS Reservations, Total_Price AS Revenue, "
+                   "Number_of_Persons AS Persons FROM Reservations "
+                   "WHERE Status IN ('confirmed', 'paid') AND (" + raw_ranges.join(" OR ") + ")";
+    }
+
+    QString bucket;
+    switch (period)
+    {
+    case Revenue_Period::DAY:
+        bucket = "Day";
+        break;
+    case Revenue_Period::MONTH:
+        bucket = dialect.month_start("Day");
+        break;
+    case Revenue_Period::YEAR:
+        bucket = dialect.year_start("Day");
+        break;
+    case Revenue_Period::NONE:
+        break;
+    }
+
+    QString query = "SELECT " + (bucket.isEmpty() ? QString() : bucket + " AS Period_Start, ") +
+                    "SUM(Reservations) AS Total_Reservations, SUM(Revenue) AS Total_Revenue, SUM(Persons) AS Total_Persons "
+                    "FROM (" + sources.join(" UNION ALL ") + ") buckets";
+    if (!bucket.isEmpty())
+    {
+        query += " GROUP BY " + bucket + " ORDER BY Period_Start";
+    }
+    return query;
+}
+
+QStringList Revenue_Rollup::get_rollup_range_statements(const Sql_Dialect& dialect, const QDate& first_day, const QDate& last_day)
+{
+    QString first = dialect.date_literal(first_day);
+    QString last = dialect.date_literal(last_day);
+
+    // The range is compared as times so the Reservation_Date index can seek
+    QString range = QString("r.Reservation_Date >= %1 AND r.Reservation_Date < %2")
+                   .arg(dialect.datetime_literal(first_day.startOfDay()), dialect.datetime_literal(last_day.addDays(1).startOfDay()));
+
+    // The watermark table holds one row; replaced inside the same transaction
+    return {
+        QString("DELETE FROM Reservation_Daily_Rollup WHERE Rollup_Date >= %1 AND Rollup_Date <= %2").arg(first, last),
+        get_rollup_insert_sql(dialect, range),
+        "DELETE FROM Reservation_Rollup_Watermark",
+        QString("INSERT INTO Reservation_Rollup_Watermark (Complete_Through) VALUES (%1)").arg(last)
+    };
+}
+
+QStringList Revenue_Rollup::get_rollup_days_statements(const Sql_Dialect& dialect, const QList<QDate>& days)
+{
+    QStringList literals;
+    for (const QDate& day : days)
+    {
+        literals << dialect.date_literal(day);
+    }
+    QString day_list = literals.join(", ");
+
+    return {
+        QString("DELETE FROM Reservation_Daily_Rollup WHERE Rollup_Date IN (%1)").arg(day_list),
+        get_rollup_insert_sql(dialect, QString("%1 IN (%2)").arg(dialect.date_of("r.Reservation_Date"), day_list))
+    };
+}
+
+// Report bounds
+bool Revenue_Rollup::parse_start_bound(const QString& text, QDateTime& bound)
+{
+    QString trimmed = text.trimmed();
+    bound = QDateTime();
+    if (trimmed.isEmpty())
+    {
+        return true;
+    }
+
+    QDate day = QDate::fromString(trimmed, Qt::ISODate);
+    bound = day.isValid() ? day.startOfDay() : QDateTime::fromString(QString(trimmed).replace(' ', 'T'), Qt::ISODate);
+    return bound.isValid();
+}
+
+bool Revenue_Rollup::parse_end_bound(const QString& text, QDateTime& bound_exclusive)
+{
+    QString trimmed = text.trimmed();
+    bound_exclusive = QDateTime();
+    if (trimmed.isEmpty())
+    {
+        return true;
+    }
+
+    // The end is inclusive for the caller: a date covers that whole day
+    QDate day = QDate::fromString(trimmed, Qt::ISODate);
+    if (day.isValid())
+    {
+        bound_exclusive = day.addDays(1).startOfDay();
+        return true;
+    }
+
+    QDateTime moment = QDateTime::fromString(QString(trimmed).replace(' ', 'T'), Qt::ISODate);
+    if (!moment.isValid())
+    {
+        return false;
+    }
+    bound_exclusive = moment.addMSecs(1);
+    return true;
+}
+
+bool Revenue_Rollup::parse_period(const QString& text, Revenue_Period& period)
+{
+    QString name = text.trimmed().toLower();
+    if (name.isEmpty() || name == "none" || name == "total")
+    {
+        period = Revenue_Period::NONE;
+    }
+    else if (name == "day")
+    {
+        period = Revenue_Period::DAY;
+    }
+    else if (name == "month")
+    {
+        period = Revenue_Period::MONTH;
+    }
+    else if (name == "year")
+    {
+        period = Revenue_Period::YEAR;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Private helpers
+QString Revenue_Rollup::get_rollup_insert_sql(const Sql_Dialect& dialect, const QString& reservation_filter)
+{
+    QString day = dialect.date_of("r.Reservation_Date");
+    return QString("INSERT INTO Reservation_Daily_Rollup (Rollup_Date, Destination_ID, Status, Reservations, Persons, Revenue) "
+                   "SELECT %1, o.Destination_ID, r.Status, COUNT(*), "
+                   "SUM(r.Number_of_Persons), SUM(r.Total_Price) "
+                   "FROM Reservations r "
+                   "JOIN Offers o ON o.Offer_ID = r.Offer_ID "
+                   "WHERE %2 "
+                   "GROUP BY %1, o.Destination_ID, r.Status").arg(day, reservation_filter);
+}
@@ -0,0 +1,194 @@
+#include "database/Seat_Inventory.h"
+#include "utils/utils.h"
+
+#include <QtCore/QReadLocker>
+#include <QtCore/QWriteLocker>
+
+using namespace Database;
+
+// Loading
+void Seat_Inventory::load(const QList<QHash<QString, QVariant>>& rows)
+{
+    QWriteLocker locker(&lock);
+
+    offers.clear();
+    offers.reserve(rows.size());
+
+    for (const auto& row : rows)
+    {
+        auto seats = std::make_shared<Offer_Seats>();
+        seats->total_seats.store(row.value("Total_Seats").toInt());
+        seats->reserved_seats.store(row.value("Reserved_Seats").toInt());
+        seats->price_per_person.store(row.value("Price_per_Person").toReal());
+        offers.insert(row.value("Offer_ID").toInt(), seats);
+    }
+
+    loaded = true;
+}
+
+int Seat_Inventory::reconcile(const QList<QHash<QString, QVariant>>& rows, const QHash<int, int>& pending_seats)
+{
+    QWriteLocker locker(&lock);
+
+    int corrected = 0;
+    QHash<int, std::shared_ptr<Offer_Seats>> reconciled;
+    reconciled.reserve(rows.size());
+
+    for (const auto& row : rows)
+    {
+        int offer_id = row.value("Offer_ID").toInt();
+        int expected_reserved = row.value("Reserved_Seats").toInt() + pending_seats.value(offer_id, 0);
+
+        std::shared_ptr<Offer_Seats> seats = offers.value(offer_id);
+        if (!seats)
+        {
+            seats = std::make_shared<Offer_Seats>();
+        }
+        else if (seats->reserved_seats.load() != expected_reserved)
+        {
+            Utils::Logger::warning(QString("Seat inventory drift on offer %1: memory %2, database+queued %3")
+                                   .arg(offer_id)
+                                   .arg(seats->reserved_seats.load())
+                                   .arg(expected_reserved));
+            ++corrected;
+        }
+
+        seats->total_seats.store(row.value("Total_Seats").toInt());
+        seats->reserved_seats.store(expected_reserved);
+        seats->price_per_person.store(row.value("Price_per_Person").toReal());
+        reconciled.insert(offer_id, seats);
+    }
+
+    offers.swap(reconciled);
+    loaded = true;
+    return corrected;
+}
+
+void Seat_Inventory::clear()
+{
+    QWriteLocker locker(&lock);
+    offers.clear();
+    loaded = false;
+}
+
+bool Seat_Inventory::is_loaded() const
+{
+    QReadLocker locker(&lock);
+    return loaded;
+}
+
+int Seat_Inventory::size() const
+{
+    QReadLocker locker(&lock);
+    return offers.size();
+}
+
+// Booking decisions
+Reserve_Status Seat_Inventory::try_reserve(int offer_id, int seats, qreal& price_per_person)
+{
+    std::shared_ptr<Offer_Seats> offer = find(offer_id);
+    if (!offer)
+    {
+        return Reserve_Status::UNKNOWN_OFFER;
+    }
+
+    int reserved = offer->reserved_seats.load(std::memory_order_relaxed);
+    do
+    {
+        if (seats <= 0 || reserved + seats > offer->total_seats.load(std::memory_order_acquire))
+        {
+            return Reserve_Status::NOT_ENOUGH_SEATS;
+        }
+    } while (!offer->reserved_seats.compare_exchange_weak(reserved, reserved + seats,
+                                                           std::memory_order_acq_rel,
+                                                           std::memory_order_relaxed));
+
+    price_per_person = offer->price_per_person.load(std::memory_order_relaxed);
+    return Reserve_Status::RESERVED;
+}
+
+void Seat_Inventory::release(int offer_id, int seats)
+{
+    std::shared_ptr<Offer_Seats> offer = find(offer_id);
+    if (!offer)
+    {
+        return;
+    }
+
+    // Never go below zero, a release can race a reconcile that already dropped it
+    int reserved = offer->reserved_seats.load(std::memory_order_relaxed);
+    int released;
+    do
+    {
+        released = qMax(0, reserved - seats);
+    } while (!offer->reserved_seats.compare_exchange_weak(reserved, released,
+                                                           std::memory_order_acq_rel,
+                                                           std::memory_order_relaxed));
+}
+
+void Seat_Inventory::add_reserved(int offer_id, int seats)
+{
+    // Seats the database already granted, so no capacity check here
+    std::shared_ptr<Offer_Seats> offer = find(offer_id);
+    if (offer)
+    {
+        offer->reserved_seats.fetch_add(seats, std::memory_order_acq_rel);
+    }
+}
+
+bool Seat_Inventory::contains(int offer_id) const
+{
+    QReadLocker locker(&lock);
+    return offers.contains(offer_id);
+}
+
+int Seat_Inventory::get_available_seats(int offer_id) const
+{
+    std::shared_ptr<Offer_Seats> offer = find(offer_id);
+    if (!offer)
+    {
+        return 0;
+    }
+    return qMax(0, offer->total_seats.load() - offer->reserved_seats.load());
+}
+
+// Offer maintenance
+void Seat_Inventory::set_offer(int offer_id, int total_seats, int reserved_seats, qreal price_per_person)
+{
+    QWriteLocker locker(&lock);
+
+    std::shared_ptr<Offer_Seats>& seats = offers[offer_id];
+    if (!seats)
+    {
+        seats = std::make_shared<Offer_Seats>();
+    }
+    seats->total_seats.store(total_seats);
+    seats->reserved_seats.store(reserved_seats);
+    seats->price_per_person.store(price_per_person);
+}
+
+void Seat_Inventory::update_offer(int offer_id, int total_seats, qreal price_per_person)
+{
+    std::shared_ptr<Offer_Seats> offer = find(offer_id);
+    if (!offer)
+    {
+        return;
+    }
+
+    // Reserved_Seats stays as counted here; a lowered total only blocks new bookings
+    offer->total_seats.store(total_seats);
+    offer->price_per_person.store(price_per_person);
+}
+
+void Seat_Inventory::remove_offer(int offer_id)
+{
+    QWriteLocker locker(&lock);
+    offers.remove(offer_id);
+}
+
+// Private helpers
+std::shared_ptr<Seat_Inventory::Offer_Seats> Seat_Inventory::find(int offer_id) const
+{
+    QReadLocker locker(&lock);
+    return offers.value(offer_id);
+}
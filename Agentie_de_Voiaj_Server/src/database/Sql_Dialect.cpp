@@ -0,0 +1,394 @@
+#include "database/Sql_Dialect.h"
+#include "config.h"
+
+using namespace Database;
+
+// Factory
+std::unique_ptr<Sql_Dialect> Sql_Dialect::create(Storage_Backend backend)
+{
+    if (backend == Storage_Backend::SQLITE)
+    {
+        return std::make_unique<Sqlite_Dialect>();
+    }
+    return std::make_unique<Sql_Server_Dialect>();
+}
+
+bool Sql_Dialect::parse_backend(const QString& text, Storage_Backend& backend)
+{
+    QString name = text.trimmed().toLower();
+    if (name == "sqlserver" || name == "mssql" || name == "odbc")
+    {
+        backend = Storage_Backend::SQL_SERVER;
+    }
+    else if (name == "sqlite")
+    {
+        backend = Storage_Backend::SQLITE;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+Storage_Backend Sql_Dialect::get_default_backend()
+{
+    Storage_Backend backend = Storage_Backend::SQL_SERVER;
+    parse_backend(Config::Storage::DEFAULT_BACKEND, backend);
+    return backend;
+}
+
+// SQL Server - connection
+Storage_Backend Sql_Server_Dialect::get_backend() const
+{
+    return Storage_Backend::SQL_SERVER;
+}
+
+QString Sql_Server_Dialect::get_driver_name() const
+{
+    return "QODBC";
+}
+
+QString Sql_Server_Dialect::get_database_name(const QString& server, const QString& database,
+    const QString& username, const QString& password) const
+{
+    QString conn_str = "DRIVER={ODBC Driver 17 for SQL Server};";
+    conn_str += QString("SERVER=%1;").arg(server);
+    conn_str += QString("DATABASE=%1;").arg(database);
+
+    // Use Windows Authentication if username/password are empty
+    if (username.isEmpty() && password.isEmpty())
+    {
+        conn_str += "Trusted_Connection=yes;";
+    }
+    else
+    {
+        conn_str += QString("UID=%1;").arg(username);
+        conn_str += QString("PWD=%1;").arg(password);
+        conn_str += "Trusted_Connection=no;";
+    }
+    conn_str += QString("Connection Timeout=%1;").arg(Config::Database::CONNECTION_TIMEOUT);
+
+    return conn_str;
+}
+
+QString Sql_Server_Dialect::get_connect_options() const
+{
+    return QString();
+}
+
+QStringList Sql_Server_Dialect::get_session_statements() const
+{
+    return {};
+}
+
+bool Sql_Server_Dialect::is_embedded() const
+{
+    return false;
+}
+
+bool Sql_Server_Dialect::is_connection_error(const QSqlError& error) const
+{
+    if (error.type() == QSqlError::ConnectionError)
+    {
+        return true;
+    }
+
+    // SQLSTATE class 08 is a connection exception (08S01 link failure, 08001 cannot connect);
+    // QODBC joins the states of every diagnostic record with ';'
+    const QStringList states = error.nativeErrorCode().split(';', Qt::SkipEmptyParts);
+    for (const QString& state : states)
+    {
+        if (state.trimmed().startsWith("08"))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// SQL Server - capabilities
+bool Sql_Server_Dialect::supports_procedures() const
+{
+    return true;
+}
+
+bool Sql_Server_Dialect::supports_batches() const
+{
+    return true;
+}
+
+int Sql_Server_Dialect::get_max_insert_rows() const
+{
+    return Config::Import::ROWS_PER_STATEMENT;
+}
+
+// SQL Server - expressions
+QString Sql_Server_Dialect::now() const
+{
+    return "GETDATE()";
+}
+
+QString Sql_Server_Dialect::now_plus(int amount, Date_Part part) const
+{
+    QString unit = part == Date_Part::MONTH ? "month" : part == Date_Part::WEEK ? "week" : "day";
+    return QString("DATEADD(%1, %2, GETDATE())").arg(unit).arg(amount);
+}
+
+QString Sql_Server_Dialect::date_of(const QString& expression) const
+{
+    return QString("CAST(%1 AS DATE)").arg(expression);
+}
+
+QString Sql_Server_Dialect::month_start(const QString& expression) const
+{
+    return QString("DATEFROMPARTS(YEAR(%1), MONTH(%1), 1)").arg(expression);
+}
+
+QString Sql_Server_Dialect::year_start(const QString& expression) const
+{
+    return QString("DATEFROMPARTS(YEAR(%1), 1, 1)").arg(expression);
+}
+
+QString Sql_Server_Dialect::date_literal(const QDate& day) const
+{
+    // yyyyMMdd is read the same way whatever the session's DATEFORMAT
+    return "'" + day.toString("yyyyMMdd") + "'";
+}
+
+QString Sql_Server_Dialect::datetime_literal(const QDateTime& moment) const
+{
+    return "'" + moment.toString("yyyy-MM-ddTHH:mm:ss.zzz") + "'";
+}
+
+// SQL Server - statements
+QString Sql_Server_Dialect::top(int count) const
+{
+    return QString("TOP %1 ").arg(count);
+}
+
+QString Sql_Server_Dialect::limit(int) const
+{
+    return QString();
+}
+
+QString Sql_Server_Dialect::update_lock_hint() const
+{
+    return " WITH (UPDLOCK, ROWLOCK)";
+}
+
+QString Sql_Server_Dialect::get_identity_column() const
+{
+    return "INT PRIMARY KEY IDENTITY(1,1)";
+}
+
+QString Sql_Server_Dialect::get_insert_returning_id_sql(const QString& insert_sql, const QString& id_column) const
+{
+    return QString("%1; SELECT CAST(SCOPE_IDENTITY() AS INT) AS %2").arg(insert_sql, id_column);
+}
+
+QString Sql_Server_Dialect::get_create_table_sql(const QString& table, const QString& columns) const
+{
+    return QString(R"(
+        IF NOT EXISTS (SELECT * FROM sys.objects WHERE object_id = OBJECT_ID(N'dbo.%1') AND type = 'U')
+        BEGIN
+            CREATE TABLE dbo.%1 (%2)
+        END
+    )").arg(table, columns);
+}
+
+QString Sql_Server_Dialect::get_create_index_sql(const QString& index, const QString& table,
+    const QString& columns, const QString& included_columns) const
+{
+    QString query = QString("IF NOT EXISTS (SELECT * FROM sys.indexes WHERE name = '%1') CREATE INDEX %1 ON %2(%3)")
+                   .arg(index, table, columns);
+    if (!included_columns.isEmpty())
+    {
+        query += QString(" INCLUDE (%1)").arg(included_columns);
+    }
+    return query;
+}
+
+QString Sql_Server_Dialect::get_table_exists_sql(const QString& table) const
+{
+    return QString("SELECT 1 FROM INFORMATION_SCHEMA.TABLES WHERE TABLE_NAME = '%1'").arg(table);
+}
+
+QString Sql_Server_Dialect::get_table_columns_sql(const QString& table) const
+{
+    return QString("SELECT COLUMN_NAME FROM INFORMATION_SCHEMA.COLUMNS WHERE TABLE_NAME = '%1' ORDER BY ORDINAL_POSITION").arg(table);
+}
+
+QString Sql_Server_Dialect::get_set_triggers_sql(const QString& table, bool enabled) const
+{
+    return QString("%1 TRIGGER ALL ON %2").arg(enabled ? "ENABLE" : "DISABLE", table);
+}
+
+// SQLite - connection
+Storage_Backend Sqlite_Dialect::get_backend() const
+{
+    return Storage_Backend::SQLITE;
+}
+
+QString Sqlite_Dialect::get_driver_name() const
+{
+    return "QSQLITE";
+}
+
+QString Sqlite_Dialect::get_database_name(const QString&, const QString& database,
+    const QString&, const QString&) const
+{
+    // The database is the file; server and credentials do not apply
+    return database.isEmpty() ? Config::Storage::SQLITE_PATH : database;
+}
+
+QString Sqlite_Dialect::get_connect_options() const
+{
+    // Waits for a checkpoint or another process instead of failing with SQLITE_BUSY
+    return QString("QSQLITE_BUSY_TIMEOUT=%1").arg(Config::Storage::SQLITE_BUSY_TIMEOUT_MS);
+}
+
+QStringList Sqlite_Dialect::get_session_statements() const
+{
+    return {
+        "PRAGMA journal_mode = WAL",
+        "PRAGMA synchronous = NORMAL",
+        "PRAGMA foreign_keys = ON",
+        "PRAGMA temp_store = MEMORY",
+        QString("PRAGMA cache_size = -%1").arg(Config::Storage::SQLITE_CACHE_SIZE_KB),
+        QString("PRAGMA mmap_size = %1").arg(Config::Storage::SQLITE_MMAP_SIZE)
+    };
+}
+
+bool Sqlite_Dialect::is_embedded() const
+{
+    return true;
+}
+
+bool Sqlite_Dialect::is_connection_error(const QSqlError& error) const
+{
+    if (error.type() == QSqlError::ConnectionError)
+    {
+        return true;
+    }
+
+    // SQLITE_IOERR and SQLITE_CANTOPEN: the file went away under us (unmounted volume, deleted directory)
+    int code = error.nativeErrorCode().toInt() & 0xff;
+    return code == 10 || code == 14;
+}
+
+// SQLite - capabilities
+bool Sqlite_Dialect::supports_procedures() const
+{
+    return false;
+}
+
+bool Sqlite_Dialect::supports_batches() const
+{
+    // QSQLITE prepares one statement per exec, the rest of the text is ignored
+    return false;
+}
+
+int Sqlite_Dialect::get_max_insert_rows() const
+{
+    // A multi-row VALUES is a compound SELECT, capped by SQLITE_MAX_COMPOUND_SELECT
+    return Config::Storage::SQLITE_MAX_INSERT_ROWS;
+}
+
+// SQLite - expressions
+QString Sqlite_Dialect::now() const
+{
+    // Same text shape as datetime_literal(), so stored times compare as strings
+    return "strftime('%Y-%m-%d %H:%M:%f', 'now', 'localtime')";
+}
+
+QString Sqlite_Dialect::now_plus(int amount, Date_Part part) const
+{
+    int count = part == Date_Part::WEEK ? amount * 7 : amount;
+    QString unit = part == Date_Part::MONTH ? "months" : "days";
+    return QString("strftime('%Y-%m-%d %H:%M:%f', 'now', 'localtime', '%1%2 %3')")
+           .arg(count < 0 ? "" : "+").arg(count).arg(unit);
+}
+
+QString Sqlite_Dialect::date_of(const QString& expression) const
+{
+    return QString("date(%1)").arg(expression);
+}
+
+QString Sqlite_Dialect::month_start(const QString& expression) const
+{
+    return QString("strftime('%Y-%m-01', %1)").arg(expression);
+}
+
+QString Sqlite_Dialect::year_start(const QString& expression) const
+{
+    return QString("strftime('%Y-01-01', %1)").arg(expression);
+}
+
+QString Sqlite_Dialect::date_literal(const QDate& day) const
+{
+    return "'" + day.toString("yyyy-MM-dd") + "'";
+}
+
+QString Sqlite_Dialect::datetime_literal(const QDateTime& moment) const
+{
+    return "'" + moment.toString("yyyy-MM-dd HH:mm:ss.zzz") + "'";
+}
+
+// SQLite - statements
+QString Sqlite_Dialect::top(int) const
+{
+    return QString();
+}
+
+QString Sqlite_Dialect::limit(int count) const
+{
+    return QString(" LIMIT %1").arg(count);
+}
+
+QString Sqlite_Dialect::update_lock_hint() const
+{
+    // One writer at a time for the whole file, the transaction is the lock
+    return QString();
+}
+
+QString Sqlite_Dialect::get_identity_column() const
+{
+    return "INTEGER PRIMARY KEY AUTOINCREMENT";
+}
+
+QString Sqlite_Dialect::get_insert_returning_id_sql(const QString& insert_sql, const QString& id_column) const
+{
+    return QString("%1 RETURNING %2").arg(insert_sql, id_column);
+}
+
+QString Sqlite_Dialect::get_create_table_sql(const QString& table, const QString& columns) const
+{
+    return QString("CREATE TABLE IF NOT EXISTS %1 (%2)").arg(table, columns);
+}
+
+QString Sqlite_Dialect::get_create_index_sql(const QString& index, const QString& table,
+    const QString& columns, const QString& included_columns) const
+{
+    // No INCLUDE: the extra columns go at the end of the key, which covers the same queries
+    QString key = included_columns.isEmpty() ? columns : columns + ", " + included_columns;
+    return QString("CREATE INDEX IF NOT EXISTS %1 ON %2(%3)").arg(index, table, key);
+}
+
+QString Sqlite_Dialect::get_table_exists_sql(const QString& table) const
+{
+    return QString("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = '%1'").arg(table);
+}
+
+QString Sqlite_Dialect::get_table_columns_sql(const QString& table) const
+{
+    return QString("SELECT name AS COLUMN_NAME FROM pragma_table_info('%1') ORDER BY cid").arg(table);
+}
+
+QString Sqlite_Dialect::get_set_triggers_sql(const QString& table, bool enabled) const
+{
+    // The schema created by the server has no triggers, and SQLite cannot switch them off
+    Q_UNUSED(table);
+    Q_UNUSED(enabled);
+    return QString();
+}
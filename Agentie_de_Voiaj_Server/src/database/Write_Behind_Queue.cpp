@@ -0,0 +1,413 @@
+#include "database/Write_Behind_Queue.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QMutexLocker>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Database;
+
+// Constructor / Destructor
+Write_Behind_Queue::Write_Behind_Queue(const QString& journal_path)
+    : journal_path(journal_path)
+{
+}
+
+Write_Behind_Queue::~Write_Behind_Queue()
+{
+    close();
+}
+
+// Journal lifecycle
+bool Write_Behind_Queue::open()
+{
+    QMutexLocker locker(&mutex);
+
+    if (journal.isOpen())
+    {
+        return true;
+    }
+
+    Utils::File::create_directory(QFileInfo(journal_path).absolutePath());
+
+    // Replay: the last record of each token decides, "book" and "requeue" leave it pending,
+    // "rejected" dead-letters it and "done" drops it
+    pending.clear();
+    rejected.clear();
+    QFile existing(journal_path);
+    if (existing.exists())
+    {
+        if (!existing.open(QIODevice::ReadOnly))
+        {
+            Utils::Logger::error("Cannot read booking journal: " + existing.errorString());
+            return false;
+        }
+
+        QList<Pending_Booking> bookings;
+        QHash<QString, int> index_by_token;
+        int skipped = 0;
+        while (!existing.atEnd())
+        {
+            QByteArray line = existing.readLine().trimmed();
+            if (line.isEmpty())
+            {
+                continue;
+            }
+
+            // A torn last line from a crash mid-write is simply not replayed
+            QJsonParseError parse_error;
+            QJsonDocument doc = QJsonDocument::fromJson(line, &parse_error);
+            if (parse_error.error != QJsonParseError::NoError || !doc.isObject())
+            {
+                ++skipped;
+                continue;
+            }
+
+            QJsonObject record = doc.object();
+            QString op = record.value("op").toString();
+            QString token = record.value("token").toString();
+            if (token.isEmpty())
+            {
+                continue;
+            }
+
+            // A compacted dead letter carries the whole booking, like a "book" record
+            if (!index_by_token.contains(token) && (op == "book" || (op == "rejected" && record.contains("offer_id"))))
+            {
+                index_by_token.insert(token, bookings.size());
+                bookings.append(from_record(record));
+            }
+
+            auto found = index_by_token.constFind(token);
+            if (found == index_by_token.constEnd())
+            {
+                continue;
+            }
+
+            Pending_Booking& booking = bookings[found.value()];
+            if (op == "done")
+            {
+                booking.token.clear();
+                index_by_token.remove(token);
+            }
+            else if (op == "rejected")
+            {
+                booking.rejection = record.value("reason").toString();
+            }
+            else if (op == "requeue")
+            {
+                booking.rejection.clear();
+            }
+        }
+        existing.close();
+
+        for (const Pending_Booking& booking : std::as_const(bookings))
+        {
+            if (booking.token.isEmpty())
+            {
+                continue;
+            }
+            (booking.rejection.isEmpty() ? pending : rejected).append(booking);
+        }
+
+        if (skipped > 0)
+        {
+            Utils::Logger::warning(QString("Booking journal: skipped %1 unreadable records").arg(skipped));
+        }
+        if (!pending.isEmpty())
+        {
+            Utils::Logger::info(QString("Booking journal: recovered %1 pending bookings").arg(pending.size()));
+        }
+        if (!rejected.isEmpty())
+        {
+            Utils::Logger::warning(QString("Booking journal: %1 bookings were rejected by the database, "
+                                           "--replay-rejected-bookings queues them again").arg(rejected.size()));
+        }
+    }
+
+    return compact_locked();
+}
+
+void Write_Behind_Queue::close()
+{
+    QMutexLocker locker(&mutex);
+    if (journal.isOpen())
+    {
+        journal.close();
+    }
+}
+
+bool Write_Behind_Queue::is_open() const
+{
+    QMutexLocker locker(&mutex);
+    return journal.isOpen();
+}
+
+// Queue operations
+bool Write_Behind_Queue::enqueue(const Pending_Booking& booking)
+{
+    QMutexLocker locker(&mutex);
+
+    QJsonObject record = to_record(booking);
+    record["op"] = "book";
+    if (!append_record(record))
+    {
+        return false;
+    }
+
+    pending.append(booking);
+    return true;
+}
+
+QList<Pending_Booking> Write_Behind_Queue::peek(int max_count) const
+{
+    QMutexLocker locker(&mutex);
+    return pending.mid(0, max_count);
+}
+
+QList<Pending_Booking> Write_Behind_Queue::peek_ready(int max_count, qint64 now_ms) const
+{
+    QMutexLocker locker(&mutex);
+
+    // A booking waiting out its backoff does not hold up the ones behind it
+    QList<Pending_Booking> ready;
+    for (const Pending_Booking& booking : pending)
+    {
+        if (ready.size() >= max_count)
+        {
+            break;
+        }
+        if (booking.retry_at_ms <= now_ms)
+        {
+            ready.append(booking);
+        }
+    }
+    return ready;
+}
+
+void Write_Behind_Queue::mark_done(const QString& token)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = std::find_if(pending.begin(), pending.end(),
+                           [&](const Pending_Booking& booking) { return booking.token == token; });
+    if (it == pending.end())
+    {
+        return;
+    }
+    pending.erase(it);
+
+    QJsonObject record;
+    record["op"] = "done";
+    record["token"] = token;
+    if (!append_record(record))
+    {
+        // Harmless: on replay the entry is found in Write_Behind_Applied and skipped
+        Utils::Logger::warning("Booking journal: could not record completion of " + token);
+    }
+
+    if (++done_since_compaction >= Config::Booking::JOURNAL_COMPACT_THRESHOLD)
+    {
+        compact_locked();
+    }
+}
+
+int Write_Behind_Queue::mark_failed(const QString& token, qint64 retry_at_ms)
+{
+    QMutexLocker locker(&mutex);
+
+    for (Pending_Booking& booking : pending)
+    {
+        if (booking.token == token)
+        {
+            booking.retry_at_ms = retry_at_ms;
+            return ++booking.attempts;
+        }
+    }
+    return 0;
+}
+
+bool Write_Behind_Queue::mark_rejected(const QString& token, const QString& reason)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = std::find_if(pending.begin(), pending.end(),
+                           [&](const Pending_Booking& booking) { return booking.token == token; });
+    if (it == pending.end())
+    {
+        return false;
+    }
+
+    // Journaled before it leaves the queue: a crash in between replays it as pending, never loses it
+    QJsonObject record;
+    record["op"] = "rejected";
+    record["token"] = token;
+    record["reason"] = reason;
+    if (!append_record(record))
+    {
+        return false;
+    }
+
+    Pending_Booking booking = *it;
+    pending.erase(it);
+    booking.rejection = reason;
+    rejected.append(booking);
+    return true;
+}
+
+int Write_Behind_Queue::requeue_rejected()
+{
+    QMutexLocker locker(&mutex);
+
+    int requeued = 0;
+    while (!rejected.isEmpty())
+    {
+        QJsonObject record;
+        record["op"] = "requeue";
+        record["token"] = rejected.first().token;
+        if (!append_record(record))
+        {
+            break;
+        }
+
+        Pending_Booking booking = rejected.takeFirst();
+        booking.rejection.clear();
+        booking.attempts = 0;
+        booking.retry_at_ms = 0;
+        pending.append(booking);
+        ++requeued;
+    }
+    return requeued;
+}
+
+int Write_Behind_Queue::size() const
+{
+    QMutexLocker locker(&mutex);
+    return pending.size();
+}
+
+int Write_Behind_Queue::get_rejected_count() const
+{
+    QMutexLocker locker(&mutex);
+    return rejected.size();
+}
+
+QHash<int, int> Write_Behind_Queue::get_pending_seats_by_offer() const
+{
+    QMutexLocker locker(&mutex);
+
+    QHash<int, int> seats;
+    for (const Pending_Booking& booking : pending)
+    {
+        seats[booking.offer_id] += booking.person_count;
+    }
+    return seats;
+}
+
+// Private helpers
+bool Write_Behind_Queue::append_record(const QJsonObject& record)
+{
+    if (!journal.isOpen())
+    {
+        return false;
+    }
+
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+
+    if (journal.write(line) != line.size() || !journal.flush() || !sync_to_disk(journal))
+    {
+        Utils::Logger::error("Booking journal write failed: " + journal.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool Write_Behind_Queue::compact_locked()
+{
+    if (journal.isOpen())
+    {
+        journal.close();
+    }
+
+    // Rewrite only the pending entries and the dead letters, then swap the file in atomically
+    QSaveFile compacted(journal_path);
+    if (!compacted.open(QIODevice::WriteOnly))
+    {
+        Utils::Logger::error("Cannot compact booking journal: " + compacted.errorString());
+        return false;
+    }
+
+    for (const Pending_Booking& booking : std::as_const(pending))
+    {
+        QJsonObject record = to_record(booking);
+        record["op"] = "book";
+        compacted.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+        compacted.write("\n");
+    }
+    for (const Pending_Booking& booking : std::as_const(rejected))
+    {
+        QJsonObject record = to_record(booking);
+        record["op"] = "rejected";
+        record["reason"] = booking.rejection;
+        compacted.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+        compacted.write("\n");
+    }
+
+    if (!compacted.flush() || !sync_to_disk(compacted) || !compacted.commit())
+    {
+        Utils::Logger::error("Cannot compact booking journal: " + compacted.errorString());
+        return false;
+    }
+
+    done_since_compaction = 0;
+    journal.setFileName(journal_path);
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        Utils::Logger::error("Cannot open booking journal: " + journal.errorString());
+        return false;
+    }
+    return true;
+}
+
+QJsonObject Write_Behind_Queue::to_record(const Pending_Booking& booking)
+{
+    QJsonObject record;
+    record["token"] = booking.token;
+    record["user_id"] = booking.user_id;
+    record["offer_id"] = booking.offer_id;
+    record["person_count"] = booking.person_count;
+    record["total_price"] = booking.total_price;
+    record["created_at"] = booking.created_at.toString(Qt::ISODateWithMs);
+    return record;
+}
+
+Pending_Booking Write_Behind_Queue::from_record(const QJsonObject& record)
+{
+    Pending_Booking booking;
+    booking.token = record.value("token").toString();
+    booking.user_id = record.value("user_id").toInt();
+    booking.offer_id = record.value("offer_id").toInt();
+    booking.person_count = record.value("person_count").toInt();
+    booking.total_price = record.value("total_price").toDouble();
+    booking.created_at = QDateTime::fromString(record.value("created_at").toString(), Qt::ISODateWithMs);
+    return booking;
+}
+
+bool Write_Behind_Queue::sync_to_disk(QFileDevice& file)
+{
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
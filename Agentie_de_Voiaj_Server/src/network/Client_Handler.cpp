@@ -5,15 +5,70 @@
 #include "config.h"
 
 #include <QtCore/QDebug>
-#include <QtCore/QDateTime>
 #include <QtCore/QThread>
+#include <QtCore/QVarLengthArray>
+
+#if defined(Q_OS_WIN)
+#include <winsock2.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
 using namespace SocketNetwork;
 
-Client_Handler::Client_Handler(QTcpSocket* socket, const Client_Info& info,
+namespace {
+    // Pieces handed to one gathered write, the rest goes through the socket's buffer
+    constexpr int MAX_GATHERED_PIECES = 64;
+
+    // Sends as much of pieces as the kernel takes in one call, without copying them together.
+    // Returns the bytes sent, 0 when nothing was (would block, error, or no gathered write here)
+    qint64 write_gathered(qintptr descriptor, const QList<QByteArray>& pieces)
+    {
+        if (descriptor < 0) {
+            return 0;
+        }
+        
+        int count = qMin(static_cast<int>(pieces.size()), MAX_GATHERED_PIECES);
+#if defined(Q_OS_WIN)
+        QVarLengthArray<WSABUF, MAX_GATHERED_PIECES> buffers(count);
+        for (int i = 0; i < count; ++i) {
+            buffers[i].buf = const_cast<char*>(pieces[i].constData());
+            buffers[i].len = static_cast<ULONG>(pieces[i].size());
+        }
+        DWORD sent = 0;
+        if (WSASend(static_cast<SOCKET>(descriptor), buffers.data(), static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) != 0) {
+            return 0;
+        }
+        return static_cast<qint64>(sent);
+#elif defined(Q_OS_UNIX)
+        QVarLengthArray<iovec, MAX_GATHERED_PIECES> buffers(count);
+        for (int i = 0; i < count; ++i) {
+            buffers[i].iov_base = const_cast<char*>(pieces[i].constData());
+            buffers[i].iov_len = static_cast<size_t>(pieces[i].size());
+        }
+        msghdr message = {};
+        message.msg_iov = buffers.data();
+        message.msg_iovlen = count;
+#ifdef MSG_NOSIGNAL
+        ssize_t sent = ::sendmsg(static_cast<int>(descriptor), &message, MSG_NOSIGNAL);
+#else
+        ssize_t sent = ::sendmsg(static_cast<int>(descriptor), &message, 0);
+#endif
+        return sent > 0 ? static_cast<qint64>(sent) : 0;
+#else
+        Q_UNUSED(descriptor);
+        Q_UNUSED(count);
+        return 0;
+#endif
+    }
+}
+
+Client_Handler::Client_Handler(QIODevice* socket, const Client_Info& info,
     std::shared_ptr<Database::Database_Manager> db_manager,
     Protocol_Handler* protocol_handler, Socket_Server* server)
-    : QObject(nullptr), client_socket(socket), client_info(info), db_manager(db_manager),
+    : Client_Session(info), client_socket(socket), tcp_socket(qobject_cast<QTcpSocket*>(socket)),
+      local_socket(qobject_cast<QLocalSocket*>(socket)), db_manager(db_manager),
       protocol_handler(protocol_handler), server(server), handler_thread(nullptr),
       is_running(false), keep_alive_timer(nullptr)
 {
@@ -21,8 +76,13 @@ Client_Handler::Client_Handler(QTcpSocket* socket, const Client_Info& info,
         client_socket->setParent(this);
         
         // Connect socket signals
-        connect(client_socket, &QTcpSocket::readyRead, this, &Client_Handler::handle_ready_read);
-        connect(client_socket, &QTcpSocket::disconnected, this, &Client_Handler::handle_disconnection);
+        connect(client_socket, &QIODevice::readyRead, this, &Client_Handler::handle_ready_read);
+        connect(client_socket, &QIODevice::bytesWritten, this, &Client_Handler::handle_bytes_written);
+        if (tcp_socket) {
+            connect(tcp_socket, &QTcpSocket::disconnected, this, &Client_Handler::handle_disconnection);
+        } else if (local_socket) {
+            connect(local_socket, &QLocalSocket::disconnected, this, &Client_Handler::handle_disconnection);
+        }
     }
     
     // Initialize keep-alive timer
@@ -65,6 +125,8 @@ void Client_Handler::stop_handling()
         return;
     }
     
+    // Replies still queued go to the socket, disconnectFromHost() below waits for them
+    flush_pending_locked();
     is_running = false;
     
     // Stop keep-alive timer
@@ -73,10 +135,16 @@ void Client_Handler::stop_handling()
     }
     
     // Close socket
-    if (client_socket && client_socket->state() != QAbstractSocket::UnconnectedState) {
-        client_socket->disconnectFromHost();
-        if (client_socket->state() != QAbstractSocket::UnconnectedState) {
-            client_socket->waitForDisconnected(3000); // Wait up to 3 seconds
+    if (tcp_socket && tcp_socket->state() != QAbstractSocket::UnconnectedState) {
+        tcp_socket->disconnectFromHost();
+        if (tcp_socket->state() != QAbstractSocket::UnconnectedState) {
+            tcp_socket->waitForDisconnected(3000); // Wait up to 3 seconds
+        }
+    }
+    if (local_socket && local_socket->state() != QLocalSocket::UnconnectedState) {
+        local_socket->disconnectFromServer();
+        if (local_socket->state() != QLocalSocket::UnconnectedState) {
+            local_socket->waitForDisconnected(3000);
         }
     }
     
@@ -88,91 +156,224 @@ bool Client_Handler::is_client_running() const
     return is_running && is_socket_valid();
 }
 
-bool Client_Handler::send_message(const QString& message)
+bool Client_Handler::write_output_locked()
 {
-    QMutexLocker locker(&send_mutex);
+    if (!is_socket_valid()) {
+        return false;
+    }
     
+    output_buffer.append("\r\n");
+    capture_output_locked();
+    
+    // Copied out exactly sized, so output_buffer stays unshared and keeps its capacity
+    bool queued = queue_output_locked(QByteArray(output_buffer.constData(), output_buffer.size()));
+    
+    // One large reply should not pin its buffer for the rest of the connection
+    if (output_buffer.capacity() > Config::Server::OUTPUT_BUFFER_RETAIN_BYTES) {
+        output_buffer = QByteArray();
+    }
+    
+    if (!queued) {
+        return false;
+    }
+    
+    messages_sent++;
+    update_last_activity();
+    return true;
+}
+
+bool Client_Handler::flush_output_locked()
+{
     if (!is_socket_valid()) {
+        output_buffer.resize(0);
         return false;
     }
     
-    try {
-        QString full_message = message + "\r\n";
-        QByteArray data = full_message.toUtf8();
-        
-        qint64 bytes_written = client_socket->write(data);
-        if (bytes_written == -1) {
-            return false;
-        }
-        
-        if (!client_socket->waitForBytesWritten(5000)) { // 5 second timeout
-            return false;
-        }
-        
-        messages_sent++;
-        update_last_activity();
-        return true;
+    // Part of a reply: no line ending, not counted as a message. It goes out now, behind
+    // the replies already queued, so the stream is not held in memory until the next tick
+    capture_output_locked();
+    pending_output.append(QByteArray(output_buffer.constData(), output_buffer.size()));
+    pending_bytes += output_buffer.size();
+    output_buffer.resize(0);
+    if (!flush_pending_locked()) {
+        return false;
     }
-    catch (const std::exception&) {
+    
+    // The socket buffers what the client has not read yet; one reply fits, a reader that fell this far behind goes
+    if (client_socket->bytesToWrite() > Config::Server::MAX_PENDING_OUTPUT_BYTES) {
+        drop_stalled_reader_locked();
         return false;
     }
+    
+    update_last_activity();
+    return true;
 }
 
-QString Client_Handler::receive_message()
+bool Client_Handler::queue_output_locked(const QByteArray& reply)
 {
+    pending_output.append(reply);
+    pending_bytes += reply.size();
+    
+    // Reading stops while output is backed up, so only a client that stopped reading gets this far behind
+    if (pending_bytes + client_socket->bytesToWrite() > Config::Server::MAX_PENDING_OUTPUT_BYTES) {
+        drop_stalled_reader_locked();
+        return false;
+    }
+    
+    // Everything queued until control returns to the event loop leaves in one write
+    if (!flush_scheduled) {
+        flush_scheduled = true;
+        QMetaObject::invokeMethod(this, &Client_Handler::flush_pending_output, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+bool Client_Handler::flush_pending_locked()
+{
+    if (pending_output.isEmpty()) {
+        return true;
+    }
+    
     if (!is_socket_valid()) {
-        return QString();
+        pending_output.clear();
+        pending_bytes = 0;
+        return false;
     }
     
-    // Check if data is available
-    if (!client_socket->canReadLine()) {
-        // Wait for data with timeout
-        if (!client_socket->waitForReadyRead(Config::Server::SOCKET_TIMEOUT_MS)) {
-            return QString();
-        }
+    // Straight to the kernel only while the socket has nothing buffered, or the order would break
+    qint64 sent = 0;
+    if (client_socket->bytesToWrite() == 0) {
+        sent = write_gathered(get_gather_descriptor(), pending_output);
     }
     
-    QByteArray data = client_socket->readLine();
-    if (data.isEmpty()) {
-        return QString();
+    // What the kernel did not take is left to the socket, which sends it when writable
+    bool written = true;
+    for (const QByteArray& piece : std::as_const(pending_output)) {
+        if (sent >= piece.size()) {
+            sent -= piece.size();
+            continue;
+        }
+        qint64 bytes_written = sent > 0 ? client_socket->write(piece.constData() + sent, piece.size() - sent)
+                                        : client_socket->write(piece);
+        sent = 0;
+        if (bytes_written == -1) {
+            written = false;
+            break;
+        }
     }
     
-    QString message = QString::fromUtf8(data).trimmed();
+    pending_output.clear();
+    pending_bytes = 0;
+    return written;
+}
+
+void Client_Handler::flush_pending_output()
+{
+    QMutexLocker locker(&send_mutex);
+    flush_scheduled = false;
+    bool written = flush_pending_locked();
+    locker.unlock();
     
-    messages_received++;
-    update_last_activity();
+    if (!written) {
+        handle_disconnection();
+        return;
+    }
     
-    return message;
+    // A gathered write that the kernel took whole never shows up as bytesWritten()
+    handle_bytes_written();
 }
 
-const Client_Info& Client_Handler::get_client_info() const
+void Client_Handler::drop_stalled_reader_locked()
 {
-    return client_info;
+    Utils::Logger::warning("Client stopped reading its replies, disconnecting: " + client_info.ip_address);
+    output_stalled = true;
+    pending_output.clear();
+    pending_bytes = 0;
+    
+    // Not from inside the write: the handler that produced the reply is still on the stack
+    QMetaObject::invokeMethod(this, &Client_Handler::handle_disconnection, Qt::QueuedConnection);
 }
 
-void Client_Handler::update_last_activity()
+bool Client_Handler::is_output_backed_up()
 {
-    client_info.last_activity_time = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    QMutexLocker locker(&send_mutex);
+    return client_socket && pending_bytes + client_socket->bytesToWrite() > Config::Server::STREAM_CHUNK_BYTES;
 }
 
-bool Client_Handler::is_authenticated() const
+void Client_Handler::handle_bytes_written()
 {
-    return client_info.is_authenticated;
+    // Requests left unread while replies drained are picked up once the backlog is gone
+    if (reading_paused && !is_output_backed_up()) {
+        reading_paused = false;
+        handle_ready_read();
+    }
 }
 
-void Client_Handler::set_authenticated(int user_id, const QString& username)
+bool Client_Handler::send_cached(const QByteArray& reply)
 {
-    client_info.is_authenticated = true;
-    client_info.user_id = user_id;
-    client_info.username = username;
+    QMutexLocker locker(&send_mutex);
+    if (!is_socket_valid()) {
+        return false;
+    }
+    
+    // Queued by reference: the shared bytes go to the kernel as they are, never copied per client
+    if (!queue_output_locked(reply)) {
+        return false;
+    }
+    
+    messages_sent++;
     update_last_activity();
+    return true;
 }
 
-qint64 Client_Handler::get_idle_time() const
+void Client_Handler::complete_deferred_response(const Response& response)
 {
-    QDateTime last_activity = QDateTime::fromString(client_info.last_activity_time, "yyyy-MM-dd hh:mm:ss");
-    QDateTime now = QDateTime::currentDateTime();
-    return last_activity.msecsTo(now);
+    awaiting_response = false;
+    
+    // The reply is part of its request's cost; the batch commit it waited for is shared
+    // by every request in the batch and is left out
+    quint64 allocations_before = Utils::Memory::get_thread_allocation_count();
+    bool sent = send_response(response);
+    if (server) {
+        server->record_request_allocations(deferred_allocations + Utils::Memory::get_thread_allocation_count() - allocations_before);
+    }
+    deferred_allocations = 0;
+    
+    if (!sent) {
+        handle_disconnection();
+        return;
+    }
+    
+    // Pick up requests that arrived while this one was in a batch
+    if (client_socket && client_socket->canReadLine()) {
+        QMetaObject::invokeMethod(this, &Client_Handler::handle_ready_read, Qt::QueuedConnection);
+    }
+}
+
+QByteArray Client_Handler::receive_message()
+{
+    if (!is_socket_valid()) {
+        return QByteArray();
+    }
+    
+    // Check if data is available
+    if (!client_socket->canReadLine()) {
+        // Wait for data with timeout
+        if (!client_socket->waitForReadyRead(Config::Server::SOCKET_TIMEOUT_MS)) {
+            return QByteArray();
+        }
+    }
+    
+    QByteArray data = client_socket->readLine();
+    if (data.isEmpty()) {
+        return QByteArray();
+    }
+    
+    messages_received++;
+    update_last_activity();
+    
+    // Stays UTF-8 all the way to the JSON parser; trimming an rvalue works in place
+    return std::move(data).trimmed();
 }
 
 void Client_Handler::handle_ready_read()
@@ -181,16 +382,34 @@ void Client_Handler::handle_ready_read()
         return;
     }
     
-    while (client_socket && client_socket->canReadLine()) {
-        QString message = receive_message();
+    // Responses go out in request order, so stop reading while one is deferred
+    while (client_socket && !awaiting_response && client_socket->canReadLine()) {
+        // A client that does not read its replies is not read either, until bytesWritten() drains them
+        if (is_output_backed_up()) {
+            reading_paused = true;
+            return;
+        }
+        
+
+        quint64 allocations_before = Utils::Memory::get_thread_allocation_count();
+        QByteArray message = receive_message();
         if (!message.isEmpty()) {
             emit messageReceived(message);
             
             // Process message directly
-            if (!process_message(message)) {
+            if (!process_request(protocol_handler, message)) {
                 handle_disconnection();
                 return;
             }
+            
+            // A deferred request is recorded once its reply has been written
+            quint64 allocations = Utils::Memory::get_thread_allocation_count() - allocations_before;
+            if (awaiting_response) {
+                deferred_allocations = allocations;
+            }
+            else if (server) {
+                server->record_request_allocations(allocations);
+            }
         }
     }
 }
@@ -217,54 +436,32 @@ void Client_Handler::handle_client_loop()
     // The functionality is handled by handle_ready_read() slot
 }
 
-bool Client_Handler::process_message(const QString& message)
+bool Client_Handler::is_open() const
 {
-    if (!protocol_handler) {
-        send_error_response(Config::ErrorMessages::SERVER_ERROR);
-        return false;
-    }
-    
-    try {
-        auto parsed_message = protocol_handler->parse_message(message);
-        
-        if (!parsed_message.is_valid) {
-            send_error_response(parsed_message.error_message);
-            return true; // Continue handling other messages
-        }
-        
-        auto response = protocol_handler->process_message(parsed_message, this);
-        
-        QString response_str;
-        if (response.success) {
-            response_str = Utils::JSON::create_success_response(response.data, response.message);
-        } else {
-            response_str = Utils::JSON::create_error_response(response.message, response.error_code);
-        }
-        
-        return send_message(response_str);
-    }
-    catch (const std::exception& e) {
-        send_error_response("Message processing error: " + QString::fromStdString(e.what()));
-        return true;
-    }
+    return is_socket_valid();
 }
 
 bool Client_Handler::is_socket_valid() const
 {
-    return client_socket && 
-           client_socket->state() == QAbstractSocket::ConnectedState && 
-           is_running;
-}
-
-void Client_Handler::send_error_response(const QString& error_message)
-{
-    QString response = Utils::JSON::create_error_response(error_message);
-    send_message(response);
+    if (!is_running || output_stalled) {
+        return false;
+    }
+    if (tcp_socket) {
+        return tcp_socket->state() == QAbstractSocket::ConnectedState;
+    }
+    return local_socket && local_socket->state() == QLocalSocket::ConnectedState;
 }
 
-void Client_Handler::send_success_response(const QString& data, const QString& message)
+qintptr Client_Handler::get_gather_descriptor() const
 {
-    QString response = Utils::JSON::create_success_response(data, message);
-    send_message(response);
+    if (tcp_socket) {
+        return tcp_socket->socketDescriptor();
+    }
+#if defined(Q_OS_UNIX)
+    // A Unix domain socket takes sendmsg() like TCP does; on Windows a local socket is a named pipe
+    if (local_socket) {
+        return local_socket->socketDescriptor();
+    }
+#endif
+    return -1;
 }
-
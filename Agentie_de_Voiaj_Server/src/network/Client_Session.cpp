@@ -0,0 +1,159 @@
+#include "network/Client_Session.h"
+#include "network/Protocol_Handler.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QDateTime>
+
+using namespace SocketNetwork;
+
+Client_Session::Client_Session(const Client_Info& info, QObject* parent)
+    : QObject(parent), client_info(info)
+{
+}
+
+// Replies
+bool Client_Session::send_message(const QString& message)
+{
+    QMutexLocker locker(&send_mutex);
+    output_buffer.resize(0);
+    output_buffer.append(message.toUtf8());
+    return write_output_locked();
+}
+
+bool Client_Session::send_response(const Response& response)
+{
+    // The envelope is written around the handler's JSON bytes, nothing is parsed again
+    QMutexLocker locker(&send_mutex);
+    output_buffer.resize(0);
+    if (response.success) {
+        Utils::JSON::append_success_response(output_buffer, response.data, response.message);
+    } else {
+        Utils::JSON::append_error_response(output_buffer, response.message, response.error_code);
+    }
+    return write_output_locked();
+}
+
+void Client_Session::send_error_response(const QString& error_message)
+{
+    QMutexLocker locker(&send_mutex);
+    output_buffer.resize(0);
+    Utils::JSON::append_error_response(output_buffer, error_message);
+    write_output_locked();
+}
+
+void Client_Session::send_success_response(const QString& data, const QString& message)
+{
+    QMutexLocker locker(&send_mutex);
+    output_buffer.resize(0);
+    Utils::JSON::append_success_response(output_buffer, data.toUtf8(), message);
+    write_output_locked();
+}
+
+bool Client_Session::process_request(Protocol_Handler* protocol_handler, const QByteArray& message)
+{
+    if (!protocol_handler) {
+        send_error_response(Config::ErrorMessages::SERVER_ERROR);
+        return false;
+    }
+
+    try {
+        auto parsed_message = protocol_handler->parse_message(message);
+
+        if (!parsed_message.is_valid) {
+            send_error_response(parsed_message.error_message);
+            return true; // Continue handling other messages
+        }
+
+        auto response = protocol_handler->process_message(parsed_message, this);
+
+        if (response.deferred) {
+            awaiting_response = true;
+            return true;
+        }
+
+        if (response.streamed) {
+            return is_open();
+        }
+
+        return send_response(response);
+    }
+    catch (const std::exception& e) {
+        send_error_response("Message processing error: " + QString::fromStdString(e.what()));
+        return true;
+    }
+}
+
+// Response cache
+void Client_Session::capture_output_locked()
+{
+    if (capture_limit < 0) {
+        return;
+    }
+
+    // Larger replies are not worth keeping, the copy is given up rather than grown
+    if (capture_buffer.size() + output_buffer.size() > capture_limit) {
+        capture_limit = -1;
+        capture_buffer = QByteArray();
+        return;
+    }
+    capture_buffer.append(output_buffer);
+}
+
+void Client_Session::begin_capture(qsizetype max_bytes)
+{
+    QMutexLocker locker(&send_mutex);
+    capture_buffer.resize(0);
+    capture_limit = max_bytes;
+    capture_messages_sent = messages_sent;
+}
+
+bool Client_Session::end_capture(QByteArray& reply)
+{
+    QMutexLocker locker(&send_mutex);
+
+    // A write that failed part way, or a broadcast that got in between, leaves a copy nobody should replay
+    bool captured = capture_limit >= 0 && messages_sent == capture_messages_sent + 1 && capture_buffer.endsWith("\r\n");
+    capture_limit = -1;
+    if (captured) {
+        reply = capture_buffer;
+    }
+    capture_buffer = QByteArray();
+    return captured;
+}
+
+// Client state
+const Client_Info& Client_Session::get_client_info() const
+{
+    return client_info;
+}
+
+void Client_Session::update_last_activity()
+{
+    client_info.last_activity_ms = QDateTime::currentMSecsSinceEpoch();
+}
+
+bool Client_Session::is_authenticated() const
+{
+    return client_info.is_authenticated;
+}
+
+void Client_Session::set_authenticated(int user_id, const QString& username)
+{
+    client_info.is_authenticated = true;
+    client_info.user_id = user_id;
+    client_info.username = username;
+    update_last_activity();
+}
+
+void Client_Session::clear_authentication()
+{
+    client_info.is_authenticated = false;
+    client_info.user_id = 0;
+    client_info.username.clear();
+}
+
+qint64 Client_Session::get_idle_time() const
+{
+    return QDateTime::currentMSecsSinceEpoch() - client_info.last_activity_ms;
+}
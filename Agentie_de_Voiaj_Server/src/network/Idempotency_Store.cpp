@@ -0,0 +1,235 @@
+#include "network/Idempotency_Store.h"
+#include "utils/utils.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QMutexLocker>
+
+using namespace SocketNetwork;
+
+Idempotency_Store::Idempotency_Store(int max_entries, qint64 ttl_ms, const QString& journal_path)
+    : max_entries(max_entries), ttl_ms(ttl_ms), journal_path(journal_path)
+{
+}
+
+Idempotency_Store::~Idempotency_Store()
+{
+    QMutexLocker locker(&mutex);
+    if (journal.isOpen()) {
+        journal.close();
+    }
+}
+
+bool Idempotency_Store::open()
+{
+    QMutexLocker locker(&mutex);
+
+    if (journal_path.isEmpty() || journal.isOpen()) {
+        return true;
+    }
+
+    Utils::File::create_directory(QFileInfo(journal_path).absolutePath());
+
+    QFile existing(journal_path);
+    if (existing.exists() && existing.open(QIODevice::ReadOnly)) {
+        qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+        while (!existing.atEnd()) {
+            QByteArray line = existing.readLine().trimmed();
+            QJsonDocument doc = QJsonDocument::fromJson(line);
+            if (!doc.isObject()) {
+                continue; // torn last line after a crash
+            }
+
+            QJsonObject record = doc.object();
+            qint64 expires_at_ms = record.value("expires_at").toInteger();
+            QString key = record.value("key").toString();
+            if (key.isEmpty() || expires_at_ms <= now_ms || index.contains(key)) {
+                continue;
+            }
+
+            Entry entry;
+            entry.key = key;
+            entry.fingerprint = record.value("fingerprint").toString().toLatin1();
+            entry.completed = true;
+            entry.expires_at_ms = expires_at_ms;
+            entry.response = Response(true, record.value("message").toString(), record.value("data").toString().toUtf8());
+
+            entries.push_front(entry); // the file runs oldest to newest
+            index.insert(key, entries.begin());
+        }
+        existing.close();
+        evict_locked();
+
+        if (!entries.empty()) {
+            Utils::Logger::info(QString("Idempotency journal: restored %1 keys").arg(entries.size()));
+        }
+    }
+
+    return compact_locked();
+}
+
+Idempotency_Status Idempotency_Store::begin(const QString& key, const QByteArray& fingerprint, Response& stored_response)
+{
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(key);
+    if (found != index.constEnd()) {
+        auto it = found.value();
+        if (it->completed && it->expires_at_ms <= QDateTime::currentMSecsSinceEpoch()) {
+            remove_locked(it);
+        }
+        else if (it->fingerprint != fingerprint) {
+            return Idempotency_Status::KEY_REUSED;
+        }
+        else if (!it->completed) {
+            return Idempotency_Status::IN_PROGRESS;
+        }
+        else {
+            entries.splice(entries.begin(), entries, it);
+            stored_response = it->response;
+            return Idempotency_Status::REPLAY;
+        }
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.fingerprint = fingerprint;
+    entries.push_front(entry);
+    index.insert(key, entries.begin());
+    evict_locked();
+    return Idempotency_Status::NEW;
+}
+
+void Idempotency_Store::complete(const QString& key, const Response& response)
+{
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(key);
+    if (found == index.constEnd()) {
+        return; // evicted while running
+    }
+
+    auto it = found.value();
+    it->completed = true;
+    it->response = response;
+    it->response.deferred = false;
+    it->expires_at_ms = QDateTime::currentMSecsSinceEpoch() + ttl_ms;
+
+    if (journal.isOpen()) {
+        append_record_locked(*it);
+        if (journal_records > 2 * max_entries) {
+            compact_locked();
+        }
+    }
+}
+
+void Idempotency_Store::abandon(const QString& key)
+{
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(key);
+    if (found != index.constEnd() && !found.value()->completed) {
+        remove_locked(found.value());
+    }
+}
+
+int Idempotency_Store::size() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(entries.size());
+}
+
+QString Idempotency_Store::make_key(int user_id, const QString& idempotency_key)
+{
+    return QString::number(user_id) + ':' + idempotency_key;
+}
+
+QByteArray Idempotency_Store::make_fingerprint(const QString& command, const QJsonObject& request)
+{
+    // QJsonObject keeps its keys sorted, so equal requests serialize identically
+    QJsonObject payload = request;
+    payload.remove("idempotency_key");
+    payload.remove("type");
+    payload.remove("command");
+
+    QByteArray text = command.toUtf8() + '\n' + QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    return QCryptographicHash::hash(text, QCryptographicHash::Sha1).toHex();
+}
+
+// Private helpers
+void Idempotency_Store::remove_locked(std::list<Entry>::iterator it)
+{
+    index.remove(it->key);
+    entries.erase(it);
+}
+
+void Idempotency_Store::evict_locked()
+{
+    while (static_cast<int>(entries.size()) > max_entries) {
+        remove_locked(std::prev(entries.end()));
+    }
+}
+
+bool Idempotency_Store::append_record_locked(const Entry& entry)
+{
+    // Flushed to the OS only, not synced: losing the last keys in a power cut
+    // lets those retries run again, which is no worse than having no key at all
+    QByteArray line = to_line(entry);
+    if (journal.write(line) != line.size() || !journal.flush()) {
+        Utils::Logger::warning("Idempotency journal: write failed: " + journal.errorString());
+        return false;
+    }
+
+    ++journal_records;
+    return true;
+}
+
+QByteArray Idempotency_Store::to_line(const Entry& entry)
+{
+    QJsonObject record;
+    record["key"] = entry.key;
+    record["fingerprint"] = QString::fromLatin1(entry.fingerprint);
+    record["expires_at"] = entry.expires_at_ms;
+    record["message"] = entry.response.message;
+    record["data"] = QString::fromUtf8(entry.response.data);
+    return QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool Idempotency_Store::compact_locked()
+{
+    if (journal.isOpen()) {
+        journal.close();
+    }
+
+    QSaveFile rewritten(journal_path);
+    if (!rewritten.open(QIODevice::WriteOnly)) {
+        Utils::Logger::error("Idempotency journal: cannot rewrite " + journal_path + ": " + rewritten.errorString());
+        return false;
+    }
+
+    journal_records = 0;
+    qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (!it->completed || it->expires_at_ms <= now_ms) {
+            continue;
+        }
+
+        rewritten.write(to_line(*it));
+        ++journal_records;
+    }
+
+    if (!rewritten.commit()) {
+        Utils::Logger::error("Idempotency journal: cannot rewrite " + journal_path + ": " + rewritten.errorString());
+        return false;
+    }
+
+    journal.setFileName(journal_path);
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        Utils::Logger::error("Idempotency journal: cannot open " + journal_path + ": " + journal.errorString());
+        return false;
+    }
+    return true;
+}
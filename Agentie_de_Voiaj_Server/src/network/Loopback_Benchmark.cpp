@@ -0,0 +1,149 @@
+#include "network/Loopback_Benchmark.h"
+#include "network/Loopback_Session.h"
+#include "network/Protocol_Handler.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <algorithm>
+#include <vector>
+
+using namespace SocketNetwork;
+
+namespace {
+    qint64 percentile_us(const std::vector<qint64>& sorted, qreal fraction)
+    {
+        if (sorted.empty()) {
+            return 0;
+        }
+        std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+}
+
+QString Benchmark_Stats::to_string() const
+{
+    return QString("%1 sessions, %2 requests (%3 failed), %4 reply bytes, %5 ms (%6 requests/s), "
+                   "p50 %7 us, p99 %8 us, max %9 us, %10 allocations/request")
+        .arg(sessions)
+        .arg(requests)
+        .arg(failed_requests)
+        .arg(reply_bytes)
+        .arg(elapsed_ms)
+        .arg(requests_per_second, 0, 'f', 0)
+        .arg(p50_us)
+        .arg(p99_us)
+        .arg(max_us)
+        .arg(allocations_per_request, 0, 'f', 1);
+}
+
+// Constructor
+Loopback_Benchmark::Loopback_Benchmark(std::shared_ptr<Database::Database_Manager> db_manager)
+    : db_manager(db_manager)
+{
+}
+
+Benchmark_Stats Loopback_Benchmark::run(int session_count, int requests_per_session, const QList<QByteArray>& script)
+{
+    Benchmark_Stats stats;
+    if (session_count <= 0 || requests_per_session <= 0 || script.isEmpty()) {
+        return stats;
+    }
+
+    // A handler of its own: the sessions share its caches and group commit, like a server's clients do
+    Protocol_Handler protocol_handler(db_manager);
+    std::vector<std::unique_ptr<Loopback_Session>> sessions;
+    sessions.reserve(session_count);
+    for (int i = 0; i < session_count; ++i) {
+        sessions.push_back(std::make_unique<Loopback_Session>(
+            Client_Info(nullptr, "loopback:" + QString::number(i), 0), &protocol_handler));
+    }
+
+    std::vector<qint64> latencies_us;
+    latencies_us.reserve(static_cast<std::size_t>(session_count) * requests_per_session);
+    quint64 allocations = 0;
+
+    QElapsedTimer clock;
+    clock.start();
+    for (int round = 0; round < requests_per_session; ++round) {
+        for (int i = 0; i < session_count; ++i) {
+            Loopback_Session& session = *sessions[i];
+            QByteArray request = script[(i + round) % script.size()] + '\n';
+
+            quint64 allocations_before = Utils::Memory::get_thread_allocation_count();
+            QElapsedTimer timer;
+            timer.start();
+            session.write(request);
+            bool replied = session.wait_for_reply(Config::Server::SOCKET_TIMEOUT_MS);
+            latencies_us.push_back(timer.nsecsElapsed() / 1000);
+            allocations += Utils::Memory::get_thread_allocation_count() - allocations_before;
+
+            // Checked outside the timed part, the client's parsing is not the server's cost
+            stats.requests++;
+            QByteArray reply = replied ? session.read_reply() : QByteArray();
+            if (reply.isEmpty() || !QJsonDocument::fromJson(reply).object().value("success").toBool()) {
+                stats.failed_requests++;
+            }
+        }
+    }
+    stats.elapsed_ms = clock.elapsed();
+
+    stats.sessions = session_count;
+    for (const auto& session : sessions) {
+        stats.reply_bytes += session->get_bytes_received();
+    }
+    if (stats.elapsed_ms > 0) {
+        stats.requests_per_second = stats.requests * 1000.0 / stats.elapsed_ms;
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    stats.p50_us = percentile_us(latencies_us, 0.50);
+    stats.p99_us = percentile_us(latencies_us, 0.99);
+    stats.max_us = latencies_us.back();
+    if (Utils::Memory::is_allocation_counting_enabled()) {
+        stats.allocations_per_request = static_cast<qreal>(allocations) / stats.requests;
+    }
+
+    Utils::Logger::info("Loopback benchmark: " + stats.to_string());
+    return stats;
+}
+
+// Scripts
+bool Loopback_Benchmark::load_script(const QString& path, QList<QByteArray>& script, QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "Cannot open " + path + ": " + file.errorString();
+        return false;
+    }
+
+    script.clear();
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (!line.isEmpty() && !line.startsWith('#')) {
+            script.append(line);
+        }
+    }
+
+    if (script.isEmpty()) {
+        error = path + " has no requests";
+        return false;
+    }
+    return true;
+}
+
+QList<QByteArray> Loopback_Benchmark::get_default_script()
+{
+    return {
+        R"({"type":"GET_DESTINATIONS"})",
+        R"({"type":"GET_OFFERS"})",
+        R"({"type":"GET_OFFERS","fields":"Offer_ID,Name,Price_per_Person,Departure_Date"})",
+        R"({"type":"SEARCH_OFFERS","max_price":1500})",
+        R"({"type":"SEARCH_OFFERS","destination":"Paris"})",
+        R"({"type":"GET_OFFER_DETAILS","offer_id":1})",
+        R"({"type":"KEEPALIVE"})",
+    };
+}
@@ -0,0 +1,160 @@
+#include "network/Loopback_Session.h"
+#include "network/Protocol_Handler.h"
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QTimer>
+
+using namespace SocketNetwork;
+
+Loopback_Session::Loopback_Session(const Client_Info& info, Protocol_Handler* protocol_handler, QObject* parent)
+    : Client_Session(info, parent), protocol_handler(protocol_handler)
+{
+}
+
+// Client side
+void Loopback_Session::write(const QByteArray& data)
+{
+    if (is_closed) {
+        return;
+    }
+
+    input.append(data);
+    process_input();
+}
+
+bool Loopback_Session::can_read_reply() const
+{
+    return received.contains("\r\n");
+}
+
+QByteArray Loopback_Session::read_reply()
+{
+    qsizetype end = received.indexOf("\r\n");
+    if (end < 0) {
+        return QByteArray();
+    }
+
+    QByteArray reply = received.left(end);
+    received.remove(0, end + 2);
+    return reply;
+}
+
+bool Loopback_Session::wait_for_reply(int timeout_ms)
+{
+    if (can_read_reply()) {
+        return true;
+    }
+    if (is_closed) {
+        return false;
+    }
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    QObject::connect(this, &Loopback_Session::replyReady, &loop, &QEventLoop::quit);
+    timeout.start(timeout_ms);
+    loop.exec();
+
+    return can_read_reply();
+}
+
+void Loopback_Session::close()
+{
+    QMutexLocker locker(&send_mutex);
+    is_closed = true;
+    input.clear();
+}
+
+// Requests
+void Loopback_Session::process_input()
+{
+    // Responses go out in request order, so stop reading while one is deferred
+    while (!is_closed && !awaiting_response) {
+        qsizetype end = input.indexOf('\n');
+        if (end < 0) {
+            return;
+        }
+
+        QByteArray message = input.left(end).trimmed();
+        input.remove(0, end + 1);
+        if (message.isEmpty()) {
+            continue;
+        }
+
+        messages_received++;
+        update_last_activity();
+        if (!process_request(protocol_handler, message)) {
+            close();
+        }
+    }
+}
+
+void Loopback_Session::complete_deferred_response(const Response& response)
+{
+    awaiting_response = false;
+
+    if (!send_response(response)) {
+        close();
+        return;
+    }
+    emit replyReady();
+
+    // Pick up requests that arrived while this one was in a batch
+    if (input.contains('\n')) {
+        QMetaObject::invokeMethod(this, &Loopback_Session::process_input, Qt::QueuedConnection);
+    }
+}
+
+// Transport
+bool Loopback_Session::is_open() const
+{
+    return !is_closed;
+}
+
+bool Loopback_Session::write_output_locked()
+{
+    if (is_closed) {
+        return false;
+    }
+
+    output_buffer.append("\r\n");
+    capture_output_locked();
+    received.append(output_buffer);
+    bytes_received += output_buffer.size();
+
+    messages_sent++;
+    update_last_activity();
+    return true;
+}
+
+bool Loopback_Session::flush_output_locked()
+{
+    if (is_closed) {
+        output_buffer.resize(0);
+        return false;
+    }
+
+    // Part of a reply: no line ending, not counted as a message
+    capture_output_locked();
+    received.append(output_buffer);
+    bytes_received += output_buffer.size();
+    output_buffer.resize(0);
+
+    update_last_activity();
+    return true;
+}
+
+bool Loopback_Session::send_cached(const QByteArray& reply)
+{
+    QMutexLocker locker(&send_mutex);
+    if (is_closed) {
+        return false;
+    }
+
+    received.append(reply);
+    bytes_received += reply.size();
+    messages_sent++;
+    update_last_activity();
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "network/Protocol_Handler.h"
-#include "network/Client_Handler.h"
+#include "network/Client_Session.h"
+#include "network/Response_Stream.h"
+#include "network/Command_Table.h"
 #include "utils/utils.h"
 #include "config.h"
 
@@ -9,15 +11,190 @@
 #include <QtCore/QJsonValue>
 #include <QtCore/QJsonParseError>
 #include <QtCore/QDebug>
+#include <QtCore/QPointer>
+#include <QtCore/QDateTime>
+
+#include <array>
+#include <iterator>
 
 using namespace SocketNetwork;
 
+// Every command the server answers, one line each. Names, opcodes and checks are
+// all taken from here: parse_message() finds the entry, dispatch() runs it.
+struct SocketNetwork::Command_Registry {
+    using Access = Protocol_Handler::Access;
+    using Listing = Database::Listing;
+    
+    static constexpr Protocol_Handler::Command COMMANDS[] = {
+        // type                                   label                    names                     handler                                                  access           idempotent  cached                  required
+        { Message_Type::AUTHENTICATION,          "AUTHENTICATION",        "AUTH LOGIN",             &Protocol_Handler::handle_authentication,                Access::ANYONE,  false,      std::nullopt,           "username password" },
+        { Message_Type::REGISTRATION,            "REGISTRATION",          "REGISTER SIGNUP",        &Protocol_Handler::handle_registration,                  Access::ANYONE,  false,      std::nullopt,           "username password email first_name last_name" },
+        { Message_Type::GET_DESTINATIONS,        "GET_DESTINATIONS",      "GET_DESTINATIONS",       &Protocol_Handler::handle_get_destinations,              Access::ANYONE,  false,      Listing::DESTINATIONS,  "" },
+        { Message_Type::GET_OFFERS,              "GET_OFFERS",            "GET_OFFERS",             &Protocol_Handler::handle_get_offers,                    Access::ANYONE,  false,      Listing::OFFERS,        "" },
+        { Message_Type::SEARCH_OFFERS,           "SEARCH_OFFERS",         "SEARCH_OFFERS",          &Protocol_Handler::handle_search_offers,                 Access::ANYONE,  false,      std::nullopt,           "" },
+        { Message_Type::GET_OFFER_DETAILS,       "GET_OFFER_DETAILS",     "GET_OFFER_DETAILS",      &Protocol_Handler::handle_get_offer_details,             Access::ANYONE,  false,      std::nullopt,           "offer_id" },
+        { Message_Type::BOOK_OFFER,              "BOOK_OFFER",            "BOOK_OFFER",             &Protocol_Handler::handle_book_offer,                    Access::USER,    true,       std::nullopt,           "offer_id" },
+        { Message_Type::GET_USER_RESERVATIONS,   "GET_USER_RESERVATIONS", "GET_USER_RESERVATIONS",  &Protocol_Handler::handle_get_user_reservations,         Access::USER,    false,      std::nullopt,           "" },
+        { Message_Type::CANCEL_RESERVATION,      "CANCEL_RESERVATION",    "CANCEL_RESERVATION",     &Protocol_Handler::handle_cancel_reservation,            Access::USER,    true,       std::nullopt,           "reservation_id" },
+        { Message_Type::GET_USER_INFO,           "GET_USER_INFO",         "GET_USER_INFO",          &Protocol_Handler::handle_get_user_info,                 Access::USER,    false,      std::nullopt,           "" },
+        { Message_Type::UPDATE_USER_INFO,        "UPDATE_USER_INFO",      "UPDATE_USER_INFO",       &Protocol_Handler::handle_update_user_info,              Access::USER,    false,      std::nullopt,           "" },
+        { Message_Type::RESUME_SESSION,          "RESUME_SESSION",        "RESUME_SESSION",         &Protocol_Handler::handle_resume_session,                Access::ANYONE,  false,      std::nullopt,           "" },
+        { Message_Type::LOGOUT,                  "LOGOUT",                "LOGOUT SIGNOUT",         &Protocol_Handler::handle_logout,                        Access::USER,    false,      std::nullopt,           "" },
+        { Message_Type::BULK_IMPORT,             "BULK_IMPORT",           "BULK_IMPORT",            &Protocol_Handler::handle_admin_bulk_import,             Access::ADMIN,   false,      std::nullopt,           "entity path" },
+        { Message_Type::CHECK_STATISTICS,        "CHECK_STATISTICS",      "CHECK_STATISTICS",       &Protocol_Handler::handle_admin_check_statistics,        Access::ADMIN,   false,      std::nullopt,           "" },
+        { Message_Type::GET_QUERY_STATS,         "GET_QUERY_STATS",       "GET_QUERY_STATS",        &Protocol_Handler::handle_admin_get_query_stats,         Access::ADMIN,   false,      std::nullopt,           "" },
+        { Message_Type::KEEPALIVE,               "KEEPALIVE",             "KEEPALIVE PING",         &Protocol_Handler::handle_keepalive,                     Access::ANYONE,  false,      std::nullopt,           "" },
+        { Message_Type::ERR,                     "ERROR",                 "ERROR",                  nullptr,                                                 Access::ANYONE,  false,      std::nullopt,           "" },
+    };
+};
+
+namespace {
+    // Calls visit(word) for each space separated word of text
+    template <typename Visit>
+    constexpr void for_each_word(std::string_view text, Visit&& visit)
+    {
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t end = text.find(' ', start);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            if (end > start) {
+                visit(text.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+    }
+    
+    template <typename Commands>
+    constexpr std::size_t count_names(const Commands& commands)
+    {
+        std::size_t count = 0;
+        for (const auto& command : commands) {
+            for_each_word(command.names, [&count](std::string_view) { ++count; });
+        }
+        return count;
+    }
+    
+    template <std::size_t NAME_COUNT, typename Commands>
+    constexpr std::array<Command_Name, NAME_COUNT> collect_names(const Commands& commands)
+    {
+        std::array<Command_Name, NAME_COUNT> names{};
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < std::size(commands); ++i) {
+            for_each_word(commands[i].names, [&](std::string_view name) {
+                names[next++] = Command_Name{ name, static_cast<int>(i) };
+            });
+        }
+        return names;
+    }
+    
+    // Opcode -> position in COMMANDS, -1 when unused
+    template <std::size_t OPCODE_COUNT, typename Commands>
+    constexpr std::array<int, OPCODE_COUNT> index_by_opcode(const Commands& commands)
+    {
+        std::array<int, OPCODE_COUNT> index{};
+        for (auto& entry : index) {
+            entry = -1;
+        }
+        for (std::size_t i = 0; i < std::size(commands); ++i) {
+            index[static_cast<std::size_t>(commands[i].type)] = static_cast<int>(i);
+        }
+        return index;
+    }
+    
+    template <typename Commands>
+    constexpr bool has_unique_types(const Commands& commands)
+    {
+        for (std::size_t i = 0; i < std::size(commands); ++i) {
+            if (commands[i].type == Message_Type::UNKNOWN) {
+                return false;
+            }
+            for (std::size_t j = i + 1; j < std::size(commands); ++j) {
+                if (commands[i].type == commands[j].type) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    
+    template <typename Commands>
+    constexpr int max_opcode(const Commands& commands)
+    {
+        int highest = 0;
+        for (const auto& command : commands) {
+            highest = static_cast<int>(command.type) > highest ? static_cast<int>(command.type) : highest;
+        }
+        return highest;
+    }
+    
+    constexpr auto& COMMANDS = Command_Registry::COMMANDS;
+    constexpr std::size_t OPCODE_COUNT = static_cast<std::size_t>(max_opcode(COMMANDS)) + 1;
+    constexpr auto COMMAND_BY_OPCODE = index_by_opcode<OPCODE_COUNT>(COMMANDS);
+    constexpr auto COMMAND_NAMES = collect_names<count_names(COMMANDS)>(COMMANDS);
+    constexpr auto COMMAND_TABLE = make_command_table<64>(COMMAND_NAMES);
+    
+    static_assert(has_unique_types(COMMANDS), "A message type is registered twice, or UNKNOWN is registered");
+    static_assert(COMMAND_TABLE.valid, "Command names collide in the hash table: a name is listed twice or the table needs more slots");
+}
+
 Protocol_Handler::Protocol_Handler(std::shared_ptr<Database::Database_Manager> db_manager)
     : db_manager(db_manager)
 {
+    if (db_manager && !db_manager->is_running_in_demo_mode() && Config::Booking::ENABLE_GROUP_COMMIT) {
+        group_commit = std::make_unique<Database::Group_Commit>(db_manager);
+    }
+    
+    if (Config::Idempotency::ENABLE_IDEMPOTENCY_KEYS) {
+        idempotency_store = std::make_unique<Idempotency_Store>(Config::Idempotency::MAX_KEYS,
+            Config::Idempotency::KEY_TTL_MS,
+            Config::Idempotency::PERSIST_KEYS ? Config::Idempotency::JOURNAL_PATH : QString());
+        if (!idempotency_store->open()) {
+            Utils::Logger::warning("Idempotency keys will not survive a restart");
+        }
+    }
+    
+    if (Config::Sessions::ENABLE_SESSION_RESUME) {
+        session_store = std::make_shared<Session_Store>(Config::Sessions::SHARD_COUNT,
+            Config::Sessions::SESSION_TTL_MS,
+            Config::Sessions::PERSIST_SESSIONS ? Config::Sessions::JOURNAL_PATH : QString());
+        if (!session_store->open()) {
+            Utils::Logger::warning("Sessions will not survive a restart");
+        }
+        
+        // A changed password or a deleted user must not stay logged in through a token.
+        // Weak: a handler replaced by set_database_manager() leaves nothing behind to call
+        if (db_manager) {
+            std::weak_ptr<Session_Store> sessions = session_store;
+            db_manager->set_credentials_revoked_handler([sessions](int user_id) {
+                if (auto store = sessions.lock()) {
+                    store->revoke_user(user_id);
+                }
+            });
+        }
+    }
+    
+    if (Config::Cache::ENABLE_RESPONSE_CACHE) {
+        response_cache = std::make_unique<Response_Cache>(Config::Cache::RESPONSE_CACHE_SIZE,
+            Config::Cache::RESPONSE_CACHE_TTL_MS, Config::Cache::RESPONSE_COMPRESS_MIN_BYTES);
+    }
+}
+
+Protocol_Handler::~Protocol_Handler()
+{
+    // Whatever is still queued gets committed and answered before the handler goes away
+    if (group_commit) {
+        group_commit->flush();
+    }
 }
 
-Parsed_Message Protocol_Handler::parse_message(const QString& json_message)
+const Database::Group_Commit* Protocol_Handler::get_group_commit() const
+{
+    return group_commit.get();
+}
+
+Parsed_Message Protocol_Handler::parse_message(const QByteArray& json_message)
 {
     Parsed_Message parsed;
     parsed.raw_message = json_message;
@@ -29,7 +206,7 @@ Parsed_Message Protocol_Handler::parse_message(const QString& json_message)
     
     try {
         QJsonParseError parse_error;
-        QJsonDocument doc = QJsonDocument::fromJson(json_message.toUtf8(), &parse_error);
+        QJsonDocument doc = QJsonDocument::fromJson(json_message, &parse_error);
         
         if (parse_error.error != QJsonParseError::NoError) {
             parsed.error_message = "JSON parse error: " + parse_error.errorString();
@@ -43,17 +220,17 @@ Parsed_Message Protocol_Handler::parse_message(const QString& json_message)
         
         parsed.json_data = doc.object();
         
-        // Extract command/type from JSON
-        if (!parsed.json_data.contains("type") && !parsed.json_data.contains("command")) {
-            parsed.error_message = "Missing 'type' or 'command' field in JSON message";
+        // Extract the opcode or command name from JSON
+        if (!parsed.json_data.contains("op") && !parsed.json_data.contains("type") && !parsed.json_data.contains("command")) {
+            parsed.error_message = "Missing 'op', 'type' or 'command' field in JSON message";
             return parsed;
         }
         
         parsed.type = get_message_type(parsed.json_data);
         
         if (parsed.type == Message_Type::UNKNOWN) {
-            QString command = parsed.json_data.contains("type") ? 
-                parsed.json_data["type"].toString() : 
+            QString command = parsed.json_data.contains("op") ? "op " + QString::number(parsed.json_data["op"].toInt(-1)) :
+                parsed.json_data.contains("type") ? parsed.json_data["type"].toString() :
                 parsed.json_data["command"].toString();
             parsed.error_message = "Unknown command: " + command;
             return parsed;
@@ -70,105 +247,54 @@ Parsed_Message Protocol_Handler::parse_message(const QString& json_message)
 
 Message_Type Protocol_Handler::get_message_type(const QJsonObject& json_obj)
 {
-    try {
-        QString command;
-        if (json_obj.contains("type")) {
-            command = json_obj["type"].toString();
-        }
-        else if (json_obj.contains("command")) {
-            command = json_obj["command"].toString();
-        }
-        else {
-            return Message_Type::UNKNOWN;
-        }
-        
-        // Convert to uppercase for comparison
-        QString cmd = Utils::String::to_upper(Utils::String::trim(command));
-        
-        if (cmd == "AUTH" || cmd == "LOGIN") return Message_Type::AUTHENTICATION;
-        if (cmd == "REGISTER" || cmd == "SIGNUP") return Message_Type::REGISTRATION;
-        if (cmd == "GET_DESTINATIONS") return Message_Type::GET_DESTINATIONS;
-        if (cmd == "GET_OFFERS") return Message_Type::GET_OFFERS;
-        if (cmd == "SEARCH_OFFERS") return Message_Type::SEARCH_OFFERS;
-        if (cmd == "BOOK_OFFER") return Message_Type::BOOK_OFFER;
-        if (cmd == "GET_USER_RESERVATIONS") return Message_Type::GET_USER_RESERVATIONS;
-        if (cmd == "CANCEL_RESERVATION") return Message_Type::CANCEL_RESERVATION;
-        if (cmd == "GET_USER_INFO") return Message_Type::GET_USER_INFO;
-        if (cmd == "UPDATE_USER_INFO") return Message_Type::UPDATE_USER_INFO;
-        if (cmd == "KEEPALIVE" || cmd == "PING") return Message_Type::KEEPALIVE;
-        if (cmd == "ERROR") return Message_Type::ERR;
-        
-        return Message_Type::UNKNOWN;
+    // A numeric opcode is the Message_Type value itself
+    QJsonValue op = json_obj.value("op");
+    if (op.isDouble()) {
+        const Command* command = find_command(static_cast<Message_Type>(op.toInt(-1)));
+        return command ? command->type : Message_Type::UNKNOWN;
     }
-    catch (const std::exception&) {
+    
+    QJsonValue name = json_obj.contains("type") ? json_obj.value("type") : json_obj.value("command");
+    if (!name.isString()) {
         return Message_Type::UNKNOWN;
     }
+    
+    // One hash and one comparison, case-insensitive, no upper-cased copy of the name
+    QString command = name.toString();
+    int index = COMMAND_TABLE.find(QStringView(command).trimmed());
+    return index >= 0 ? COMMANDS[index].type : Message_Type::UNKNOWN;
 }
 
 QString Protocol_Handler::message_type_to_string(Message_Type type)
 {
-    switch (type) {
-        case Message_Type::AUTHENTICATION: return "AUTHENTICATION";
-        case Message_Type::REGISTRATION: return "REGISTRATION";
-        case Message_Type::GET_DESTINATIONS: return "GET_DESTINATIONS";
-        case Message_Type::GET_OFFERS: return "GET_OFFERS";
-        case Message_Type::SEARCH_OFFERS: return "SEARCH_OFFERS";
-        case Message_Type::BOOK_OFFER: return "BOOK_OFFER";
-        case Message_Type::GET_USER_RESERVATIONS: return "GET_USER_RESERVATIONS";
-        case Message_Type::CANCEL_RESERVATION: return "CANCEL_RESERVATION";
-        case Message_Type::GET_USER_INFO: return "GET_USER_INFO";
-        case Message_Type::UPDATE_USER_INFO: return "UPDATE_USER_INFO";
-        case Message_Type::KEEPALIVE: return "KEEPALIVE";
-        case Message_Type::ERR: return "ERROR";
-        case Message_Type::UNKNOWN: return "UNKNOWN";
-        default: return "UNKNOWN";
+    const Command* command = find_command(type);
+    if (!command) {
+        return "UNKNOWN";
+    }
+    return QString::fromLatin1(command->label.data(), static_cast<qsizetype>(command->label.size()));
+}
+
+const Protocol_Handler::Command* Protocol_Handler::find_command(Message_Type type)
+{
+    int opcode = static_cast<int>(type);
+    if (opcode < 0 || opcode >= static_cast<int>(OPCODE_COUNT) || COMMAND_BY_OPCODE[opcode] < 0) {
+        return nullptr;
     }
+    return &COMMANDS[COMMAND_BY_OPCODE[opcode]];
 }
 
-Response Protocol_Handler::process_message(const Parsed_Message& parsed_message, Client_Handler* client_handler)
+Response Protocol_Handler::process_message(const Parsed_Message& parsed_message, Client_Session* session)
 {
-    if (!client_handler) {
+    if (!session) {
         return Response(false, Config::ErrorMessages::SERVER_ERROR);
     }
     
     try {
-        switch (parsed_message.type) {
-            case Message_Type::AUTHENTICATION:
-                return handle_authentication(parsed_message, client_handler);
-            
-            case Message_Type::REGISTRATION:
-                return handle_registration(parsed_message, client_handler);
-            
-            case Message_Type::GET_DESTINATIONS:
-                return handle_get_destinations(parsed_message, client_handler);
-            
-            case Message_Type::GET_OFFERS:
-                return handle_get_offers(parsed_message, client_handler);
-            
-            case Message_Type::SEARCH_OFFERS:
-                return handle_search_offers(parsed_message, client_handler);
-            
-            case Message_Type::BOOK_OFFER:
-                return handle_book_offer(parsed_message, client_handler);
-            
-            case Message_Type::GET_USER_RESERVATIONS:
-                return handle_get_user_reservations(parsed_message, client_handler);
-            
-            case Message_Type::CANCEL_RESERVATION:
-                return handle_cancel_reservation(parsed_message, client_handler);
-            
-            case Message_Type::GET_USER_INFO:
-                return handle_get_user_info(parsed_message, client_handler);
-            
-            case Message_Type::UPDATE_USER_INFO:
-                return handle_update_user_info(parsed_message, client_handler);
-            
-            case Message_Type::KEEPALIVE:
-                return handle_keepalive(parsed_message, client_handler);
-            
-            default:
-                return Response(false, "Unsupported message type");
+        const Command* command = find_command(parsed_message.type);
+        if (!command || !command->handler) {
+            return Response(false, "Unsupported message type");
         }
+        return dispatch(*command, parsed_message, session);
     }
     catch (const Utils::Exceptions::DatabaseException& e) {
         Utils::Logger::error("Database error: " + QString::fromStdString(e.what()));
@@ -188,6 +314,60 @@ Response Protocol_Handler::process_message(const Parsed_Message& parsed_message,
     }
 }
 
+Response Protocol_Handler::dispatch(const Command& command, const Parsed_Message& message, Client_Session* client)
+{
+    if (command.access != Access::ANYONE && !client->is_authenticated()) {
+        return Response(false, Config::ErrorMessages::AUTHENTICATION_FAILED);
+    }
+    
+    if (command.access == Access::ADMIN && !is_user_admin(client->get_client_info().user_id)) {
+        return Response(false, "Administrator rights required");
+    }
+    
+    QString missing;
+    for_each_word(command.required, [&message, &missing](std::string_view field) {
+        QLatin1String key(field.data(), static_cast<qsizetype>(field.size()));
+        if (missing.isEmpty() && !message.json_data.contains(key)) {
+            missing = key;
+        }
+    });
+    if (!missing.isEmpty()) {
+        return Response(false, "Missing required field: " + missing);
+    }
+    
+    if (command.cached && response_cache && db_manager) {
+        return dispatch_cached(command, message, client);
+    }
+    if (command.idempotent) {
+        return handle_idempotent(message, client, command.handler);
+    }
+    return (this->*command.handler)(message, client);
+}
+
+Response Protocol_Handler::dispatch_cached(const Command& command, const Parsed_Message& message, Client_Session* client)
+{
+    // Read before the handler runs: a write landing meanwhile leaves the reply under the older version
+    quint64 data_version = db_manager->get_data_version(*command.cached);
+    QByteArray key = Response_Cache::make_key(command.label, message.json_data);
+    bool compressed = message.json_data.value("accept_encoding").toString() == "zlib";
+    
+    QByteArray reply;
+    if (response_cache->find(key, data_version, compressed, reply)) {
+        Response response(true, Config::SuccessMessages::DATA_RETRIEVED);
+        response.streamed = true; // a failed write shows as the socket going away
+        client->send_cached(reply);
+        return response;
+    }
+    
+    // The first asker gets the plain reply as the handler streams it, the copy serves the rest
+    client->begin_capture(Config::Cache::RESPONSE_CACHE_MAX_REPLY_BYTES);
+    Response response = (this->*command.handler)(message, client);
+    if (client->end_capture(reply) && response.success && response.streamed) {
+        response_cache->store(key, data_version, reply);
+    }
+    return response;
+}
+
 QString Protocol_Handler::create_response(bool success, const QString& message,
     const QJsonValue& data, int error_code)
 {
@@ -226,17 +406,12 @@ QString Protocol_Handler::create_response(bool success, const QString& message,
     return doc.toJson(QJsonDocument::Compact);
 }
 
-Response Protocol_Handler::handle_authentication(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_authentication(const Parsed_Message& message, Client_Session* client)
 {
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
-    // Check required fields in JSON
-    if (!message.json_data.contains("username") || !message.json_data.contains("password")) {
-        return Response(false, "Missing required fields: username, password");
-    }
-    
     try {
         QString username = message.json_data["username"].toString();
         QString password = message.json_data["password"].toString();
@@ -246,7 +421,8 @@ Response Protocol_Handler::handle_authentication(const Parsed_Message& message,
         auto result = db_manager->authenticate_user(username, password);
         
         if (result.is_success() && result.has_data()) {
-            int user_id = result.data[0]["ID"].toInt();
+            // Demo mode answers with "ID", the database with "User_ID"
+            int user_id = result.data[0].value("User_ID", result.data[0].value("ID")).toInt();
             client->set_authenticated(user_id, username);
             
             Utils::Logger::info("Authentication SUCCESS: User '" + username + "' (ID:" + QString::number(user_id) + ") logged in from " + client->get_client_info().ip_address);
@@ -256,6 +432,11 @@ Response Protocol_Handler::handle_authentication(const Parsed_Message& message,
                 user_data[it.key()] = QJsonValue::fromVariant(it.value());
             }
             
+            // Sent back with RESUME_SESSION after a reconnect instead of the password
+            if (session_store) {
+                user_data["session_token"] = session_store->create(user_id, username, client->get_client_info().ip_address);
+            }
+            
             QJsonDocument doc(user_data);
             return Response(true, Config::SuccessMessages::LOGIN_SUCCESS, doc.toJson(QJsonDocument::Compact));
         }
@@ -269,20 +450,12 @@ Response Protocol_Handler::handle_authentication(const Parsed_Message& message,
     }
 }
 
-Response Protocol_Handler::handle_registration(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_registration(const Parsed_Message& message, Client_Session* client)
 {
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
-    // Check required fields in JSON
-    const QStringList required_fields = {"username", "password", "email", "first_name", "last_name"};
-    for (const QString& field : required_fields) {
-        if (!message.json_data.contains(field)) {
-            return Response(false, "Missing required field: " + field);
-        }
-    }
-    
     try {
         User_Data user_data;
         user_data.username = message.json_data["username"].toString();
@@ -313,67 +486,86 @@ Response Protocol_Handler::handle_registration(const Parsed_Message& message, Cl
     }
 }
 
-Response Protocol_Handler::handle_get_destinations(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_get_destinations(const Parsed_Message& message, Client_Session* client)
 {
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
+    Database::Listing_Request request;
+    QString fields_error = read_fields(message, Database::Listing::DESTINATIONS, { "Destination_ID" }, request);
+    if (!fields_error.isEmpty()) {
+        return Response(false, fields_error);
+    }
+    
+    // Rows go to the client as the cursor reads them, see Response_Stream
+    Response_Stream stream(client);
+    stream.set_fields(request.fields);
     try {
         // Check if we're in demo mode and use mock data
-        auto result = db_manager->is_running_in_demo_mode() ? 
-            db_manager->create_mock_response("get_destinations") : 
-            db_manager->get_all_destinations();
-        
-        if (result.is_success()) {
-            QJsonArray destinations_json = vector_to_json(result.data);
-            QString message_text = db_manager->is_running_in_demo_mode() ? 
-                "Demo destinations retrieved successfully" : 
-                Config::SuccessMessages::DATA_RETRIEVED;
-            
-            QJsonDocument doc(destinations_json);
-            return Response(true, message_text, doc.toJson(QJsonDocument::Compact));
-        }
-        else {
-            return Response(false, result.message);
+        if (db_manager->is_running_in_demo_mode()) {
+            auto result = db_manager->create_mock_response("get_destinations");
+            for (const auto& row : std::as_const(result.data)) {
+                stream.append_row(row);
+            }
+            return stream.finish(result.is_success(), result.is_success() ? "Demo destinations retrieved successfully" : result.message);
         }
+        
+        auto result = db_manager->get_all_destinations(request, [&stream](const QSqlQuery& row) {
+            return stream.append_row(row);
+        });
+        return stream.finish(result.is_success(), result.is_success() ? Config::SuccessMessages::DATA_RETRIEVED : result.message);
     }
     catch (const std::exception& e) {
-        return Response(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
+        return stream.finish(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
     }
 }
 
-Response Protocol_Handler::handle_get_offers(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_get_offers(const Parsed_Message& message, Client_Session* client)
 {
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
+    Database::Listing_Request request;
+    int page_size = read_page_request(message, false, request);
+    if (page_size < 0) {
+        return Response(false, "Invalid page token");
+    }
+    QString fields_error = read_fields(message, Database::Listing::OFFERS, { "Offer_ID", "Departure_Date" }, request);
+    if (!fields_error.isEmpty()) {
+        return Response(false, fields_error);
+    }
+    
+    Response_Stream stream(client);
+    stream.set_page(page_size, Config::Paging::MAX_PAGE_BYTES, "Departure_Date", "Offer_ID");
+    stream.set_fields(request.fields);
     try {
-        // Check if we're in demo mode and use mock data
-        auto result = db_manager->is_running_in_demo_mode() ? 
-            db_manager->create_mock_response("get_offers") : 
-            db_manager->get_available_offers();
-        
-        if (result.is_success()) {
-            QJsonArray offers_json = vector_to_json(result.data);
-            QString message_text = db_manager->is_running_in_demo_mode() ? 
+        // The catalog (or, in demo mode, the generated dataset) already has the rows and pages them
+        // by the same keyset; only the SQL fallback reads a cursor
+        if (db_manager->serves_offers_from_catalog()) {
+            auto result = db_manager->get_available_offers(request);
+            for (const auto& row : std::as_const(result.data)) {
+                if (!stream.append_row(row)) {
+                    break;
+                }
+            }
+            return finish_page(stream, result, db_manager->is_running_in_demo_mode() ? 
                 "Demo offers retrieved successfully" : 
-                Config::SuccessMessages::DATA_RETRIEVED;
-            
-            QJsonDocument doc(offers_json);
-            return Response(true, message_text, doc.toJson(QJsonDocument::Compact));
-        }
-        else {
-            return Response(false, result.message);
+                Config::SuccessMessages::DATA_RETRIEVED);
         }
+        
+        auto result = db_manager->get_available_offers(request, [&stream](const QSqlQuery& row) {
+            return stream.append_row(row);
+        });
+        return finish_page(stream, result, Config::SuccessMessages::DATA_RETRIEVED);
     }
     catch (const std::exception& e) {
-        return Response(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
+        return stream.finish(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
     }
 }
 
-Response Protocol_Handler::handle_search_offers(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_search_offers(const Parsed_Message& message, Client_Session* client)
 {
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
@@ -386,12 +578,27 @@ Response Protocol_Handler::handle_search_offers(const Parsed_Message& message, C
         QString start_date = message.json_data.contains("start_date") ? message.json_data["start_date"].toString() : "";
         QString end_date = message.json_data.contains("end_date") ? message.json_data["end_date"].toString() : "";
         
-        auto result = db_manager->search_offers(destination, min_price, max_price, start_date, end_date);
+        Database::Listing_Request request;
+        int page_size = read_page_request(message, false, request);
+        if (page_size < 0) {
+            return Response(false, "Invalid page token");
+        }
+        QString fields_error = read_fields(message, Database::Listing::OFFERS, { "Offer_ID", "Departure_Date" }, request);
+        if (!fields_error.isEmpty()) {
+            return Response(false, fields_error);
+        }
+        
+        auto result = db_manager->search_offers(destination, min_price, max_price, start_date, end_date, request);
         
         if (result.is_success()) {
-            QJsonArray offers_json = vector_to_json(result.data);
-            QJsonDocument doc(offers_json);
-            return Response(true, Config::SuccessMessages::DATA_RETRIEVED, doc.toJson(QJsonDocument::Compact));
+            Response_Stream stream(client);
+            stream.set_page(page_size, Config::Paging::MAX_PAGE_BYTES, "Departure_Date", "Offer_ID");
+            for (const auto& row : std::as_const(result.data)) {
+                if (!stream.append_row(row)) {
+                    break;
+                }
+            }
+            return finish_page(stream, result, Config::SuccessMessages::DATA_RETRIEVED);
         }
         else {
             return Response(false, result.message);
@@ -402,18 +609,37 @@ Response Protocol_Handler::handle_search_offers(const Parsed_Message& message, C
     }
 }
 
-Response Protocol_Handler::handle_book_offer(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_get_offer_details(const Parsed_Message& message, Client_Session* client)
 {
-    if (!client->is_authenticated()) {
-        return Response(false, Config::ErrorMessages::AUTHENTICATION_FAILED);
-    }
-    
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
-    if (!message.json_data.contains("offer_id")) {
-        return Response(false, "Missing required field: offer_id");
+    try {
+        // Every column of one offer, for the detail view the trimmed listing rows leave out
+        auto result = db_manager->get_offer_by_id(message.json_data["offer_id"].toInt());
+        
+        if (result.is_success() && result.has_data()) {
+            QJsonArray rows = vector_to_json(result.data);
+            QJsonDocument doc(rows.first().toObject());
+            return Response(true, Config::SuccessMessages::DATA_RETRIEVED, doc.toJson(QJsonDocument::Compact));
+        }
+        else if (result.is_success() || result.type == Database::Result_Type::DB_ERROR_NO_DATA) {
+            return Response(false, Config::ErrorMessages::OFFER_NOT_FOUND);
+        }
+        else {
+            return Response(false, result.message);
+        }
+    }
+    catch (const std::exception& e) {
+        return Response(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
+    }
+}
+
+Response Protocol_Handler::handle_book_offer(const Parsed_Message& message, Client_Session* client)
+{
+    if (!db_manager) {
+        return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
     try {
@@ -425,7 +651,51 @@ Response Protocol_Handler::handle_book_offer(const Parsed_Message& message, Clie
             return Response(false, "Invalid person count");
         }
         
-        auto result = db_manager->book_offer(client->get_client_info().user_id, offer_id, person_count);
+        // Optional travellers, stored with the reservation in the same transaction
+        QList<Reservation_Person_Data> persons;
+        if (message.json_data.contains("persons")) {
+            const QJsonArray persons_json = message.json_data["persons"].toArray();
+            if (persons_json.size() != person_count) {
+                return Response(false, "persons must list exactly person_count travellers");
+            }
+            for (const QJsonValue& value : persons_json) {
+                QJsonObject person_json = value.toObject();
+                Reservation_Person_Data person;
+                person.full_name = person_json["full_name"].toString();
+                person.cnp = person_json["cnp"].toString();
+                person.birth_date = person_json["birth_date"].toString();
+                person.person_type = person_json["person_type"].toString("adult");
+                if (person.full_name.isEmpty() || !Database::Database_Manager::validate_cnp(person.cnp)) {
+                    return Response(false, "Invalid traveller data");
+                }
+                persons.append(person);
+            }
+        }
+        
+        int user_id = client->get_client_info().user_id;
+        
+        // Bookings with travellers are a single stored procedure call, no batching needed
+        if (!persons.isEmpty()) {
+            Database::Query_Result result = db_manager->book_offer(user_id, offer_id, person_count, persons);
+            return result.is_success() ? Response(true, Config::SuccessMessages::RESERVATION_CREATED)
+                                       : Response(false, result.message);
+        }
+        
+        // Active offers are decided in memory; the rest joins the next group commit
+        Database::Query_Result result;
+        if (group_commit && !db_manager->reserve_in_memory(user_id, offer_id, person_count, result)) {
+            Database::Batch_Operation operation;
+            operation.kind = Database::Batch_Operation::Kind::BOOK;
+            operation.user_id = user_id;
+            operation.offer_id = offer_id;
+            operation.person_count = person_count;
+            return defer_to_group_commit(operation, client, Config::SuccessMessages::RESERVATION_CREATED,
+                get_idempotency_key(message, client));
+        }
+        
+        if (!group_commit) {
+            result = db_manager->book_offer(user_id, offer_id, person_count);
+        }
         
         if (result.is_success()) {
             return Response(true, Config::SuccessMessages::RESERVATION_CREATED);
@@ -439,50 +709,53 @@ Response Protocol_Handler::handle_book_offer(const Parsed_Message& message, Clie
     }
 }
 
-Response Protocol_Handler::handle_get_user_reservations(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_get_user_reservations(const Parsed_Message& message, Client_Session* client)
 {
-    if (!client->is_authenticated()) {
-        return Response(false, Config::ErrorMessages::AUTHENTICATION_FAILED);
-    }
-    
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
+    Database::Listing_Request request;
+    int page_size = read_page_request(message, true, request);
+    if (page_size < 0) {
+        return Response(false, "Invalid page token");
+    }
+    QString fields_error = read_fields(message, Database::Listing::RESERVATIONS, { "Reservation_ID", "Reservation_Date" }, request);
+    if (!fields_error.isEmpty()) {
+        return Response(false, fields_error);
+    }
+    
+    Response_Stream stream(client);
+    stream.set_page(page_size, Config::Paging::MAX_PAGE_BYTES, "Reservation_Date", "Reservation_ID");
     try {
-        auto result = db_manager->get_user_reservations(client->get_client_info().user_id);
-        
-        if (result.is_success()) {
-            QJsonArray reservations_json = vector_to_json(result.data);
-            QJsonDocument doc(reservations_json);
-            return Response(true, Config::SuccessMessages::DATA_RETRIEVED, doc.toJson(QJsonDocument::Compact));
-        }
-        else {
-            return Response(false, result.message);
-        }
+        auto result = db_manager->get_user_reservations(client->get_client_info().user_id, request, [&stream](const QSqlQuery& row) {
+            return stream.append_row(row);
+        });
+        return finish_page(stream, result, Config::SuccessMessages::DATA_RETRIEVED);
     }
     catch (const std::exception& e) {
-        return Response(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
+        return stream.finish(false, Config::ErrorMessages::SERVER_ERROR + ": " + QString::fromStdString(e.what()));
     }
 }
 
-Response Protocol_Handler::handle_cancel_reservation(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_cancel_reservation(const Parsed_Message& message, Client_Session* client)
 {
-    if (!client->is_authenticated()) {
-        return Response(false, Config::ErrorMessages::AUTHENTICATION_FAILED);
-    }
-    
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
     
-    if (!message.json_data.contains("reservation_id")) {
-        return Response(false, "Missing required field: reservation_id");
-    }
-    
     try {
         int reservation_id = message.json_data["reservation_id"].toInt();
         
+        if (group_commit) {
+            Database::Batch_Operation operation;
+            operation.kind = Database::Batch_Operation::Kind::CANCEL;
+            operation.user_id = client->get_client_info().user_id;
+            operation.reservation_id = reservation_id;
+            return defer_to_group_commit(operation, client, Config::SuccessMessages::RESERVATION_CANCELLED,
+                get_idempotency_key(message, client));
+        }
+        
         auto result = db_manager->cancel_reservation(reservation_id);
         
         if (result.is_success()) {
@@ -497,12 +770,8 @@ Response Protocol_Handler::handle_cancel_reservation(const Parsed_Message& messa
     }
 }
 
-Response Protocol_Handler::handle_get_user_info(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_get_user_info(const Parsed_Message& message, Client_Session* client)
 {
-    if (!client->is_authenticated()) {
-        return Response(false, Config::ErrorMessages::AUTHENTICATION_FAILED);
-    }
-    
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
@@ -527,12 +796,8 @@ Response Protocol_Handler::handle_get_user_info(const Parsed_Message& message, C
     }
 }
 
-Response Protocol_Handler::handle_update_user_info(const Parsed_Message& message, Client_Handler* client)
+Response Protocol_Handler::handle_update_user_info(const Parsed_Message& message, Client_Session* client)
 {
-    if (!client->is_authenticated()) {
-        return Response(false, Config::ErrorMessages::AUTHENTICATION_FAILED);
-    }
-    
     if (!db_manager) {
         return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
     }
@@ -573,15 +838,428 @@ Response Protocol_Handler::handle_update_user_info(const Parsed_Message& message
     }
 }
 
-Response Protocol_Handler::handle_keepalive(const Parsed_Message& /*message*/, Client_Handler* /*client*/)
+Response Protocol_Handler::handle_keepalive(const Parsed_Message& /*message*/, Client_Session* /*client*/)
 {
     return Response(true, "PONG");
 }
 
-bool Protocol_Handler::is_user_admin(int /*user_id*/)
+Response Protocol_Handler::handle_resume_session(const Parsed_Message& message, Client_Session* client)
+{
+    if (!session_store) {
+        return Response(false, "Session resume is disabled", "", Config::Sessions::SESSION_EXPIRED_ERROR_CODE);
+    }
+    
+    QString token = message.json_data["session_token"].toString();
+    if (token.isEmpty()) {
+        return Response(false, "Missing required field: session_token");
+    }
+    
+    // One hash lookup, no database: a reconnect storm after a restart costs no logins
+    Session session;
+    if (!session_store->resume(token, session)) {
+        return Response(false, Config::ErrorMessages::SESSION_EXPIRED, "", Config::Sessions::SESSION_EXPIRED_ERROR_CODE);
+    }
+    
+    client->set_authenticated(session.user_id, session.username);
+    if (Config::Application::LOG_CLIENT_REQUESTS) {
+        Utils::Logger::debug("Session resumed: User '" + session.username + "' (ID:" + QString::number(session.user_id) + ") from " + client->get_client_info().ip_address);
+    }
+    
+    QJsonObject data;
+    data["user_id"] = session.user_id;
+    data["username"] = session.username;
+    data["expires_at"] = QDateTime::fromMSecsSinceEpoch(session.expires_at_ms).toString(Qt::ISODate);
+    return Response(true, "Session resumed", QJsonDocument(data).toJson(QJsonDocument::Compact));
+}
+
+Response Protocol_Handler::handle_logout(const Parsed_Message& message, Client_Session* client)
+{
+    int user_id = client->get_client_info().user_id;
+    int revoked = 0;
+    if (session_store) {
+        if (message.json_data["all"].toBool()) {
+            revoked = session_store->revoke_user(user_id);
+        }
+        else if (session_store->revoke(message.json_data["session_token"].toString(), user_id)) {
+            revoked = 1;
+        }
+    }
+    
+    Utils::Logger::info("User '" + client->get_client_info().username + "' (ID:" + QString::number(user_id) + ") logged out, "
+        + QString::number(revoked) + " sessions closed");
+    client->clear_authentication();
+    
+    QJsonObject data;
+    data["sessions_closed"] = revoked;
+    return Response(true, "Logged out", QJsonDocument(data).toJson(QJsonDocument::Compact));
+}
+
+bool Protocol_Handler::is_user_admin(int user_id)
+{
+    // Users.Is_Admin, granted by the operator: a username anyone can register proves nothing
+    if (!db_manager || user_id <= 0) {
+        return false;
+    }
+    return db_manager->is_user_admin(user_id);
+}
+
+Response Protocol_Handler::handle_admin_bulk_import(const Parsed_Message& message, Client_Session* client)
+{
+    if (!db_manager || db_manager->is_running_in_demo_mode()) {
+        return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
+    }
+    
+    if (active_import) {
+        return Response(false, "A bulk import is already running");
+    }
+    
+    Database::Import_Entity entity;
+    if (!Database::Bulk_Importer::parse_entity(message.json_data["entity"].toString(), entity)) {
+        return Response(false, "Unknown entity, expected destinations, accommodations or offers");
+    }
+    
+    // The path is read by the server, from Config::Import::IMPORT_DIRECTORY only
+    QString path;
+    QString path_error;
+    if (!Database::Bulk_Importer::resolve_import_path(message.json_data["path"].toString(), path, path_error)) {
+        return Response(false, path_error);
+    }
+    Database::Import_Format format = Database::Bulk_Importer::detect_format(path);
+    if (message.json_data.contains("format")) {
+        format = message.json_data["format"].toString().toLower() == "csv" ? Database::Import_Format::CSV
+                                                                           : Database::Import_Format::JSON_LINES;
+    }
+    
+    auto importer = std::make_shared<Database::Bulk_Importer>(db_manager);
+    QString error;
+    if (!importer->open(entity, path, format, error)) {
+        return Response(false, error);
+    }
+    
+    Utils::Logger::info("Bulk import started by " + client->get_client_info().username + ": " + path);
+    active_import = importer;
+    
+    // A chunk per event loop turn keeps other clients served during a long import
+    QPointer<Client_Session> target(client);
+    import_timer = std::make_unique<QTimer>();
+    import_timer->setInterval(0);
+    QObject::connect(import_timer.get(), &QTimer::timeout, [this, target]() {
+        continue_bulk_import(target);
+    });
+    import_timer->start();
+    
+    Response response;
+    response.deferred = true;
+    return response;
+}
+
+void Protocol_Handler::continue_bulk_import(QPointer<Client_Session> target)
+{
+    if (!active_import || active_import->import_next_chunk()) {
+        return;
+    }
+    
+    import_timer->stop();
+    import_timer.release()->deleteLater(); // we are inside its timeout signal
+    
+    Database::Import_Stats stats = active_import->finish();
+    active_import.reset();
+    
+    if (!target) {
+        return;
+    }
+    
+    QJsonObject report;
+    report["rows_read"] = stats.rows_read;
+    report["rows_imported"] = stats.rows_imported;
+    report["rows_rejected"] = stats.rows_rejected;
+    report["transactions"] = stats.transactions;
+    report["elapsed_ms"] = stats.elapsed_ms;
+    report["rows_per_second"] = stats.rows_per_second;
+    report["errors"] = QJsonArray::fromStringList(stats.errors);
+    
+    QByteArray report_json = QJsonDocument(report).toJson(QJsonDocument::Compact);
+    target->complete_deferred_response(stats.rows_imported > 0 || stats.rows_rejected == 0
+        ? Response(true, "Bulk import completed: " + stats.to_string(), report_json)
+        : Response(false, "Bulk import failed: " + stats.to_string()));
+}
+
+Response Protocol_Handler::handle_admin_check_statistics(const Parsed_Message& message, Client_Session* client)
+{
+    if (!db_manager) {
+        return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
+    }
+    
+    // Recounts everything from the tables, meant for occasional checks only
+    bool repair = message.json_data["repair"].toBool();
+    auto result = db_manager->check_booking_statistics(repair);
+    if (!result.is_success() || result.data.isEmpty()) {
+        return Response(false, result.message);
+    }
+    
+    const auto& row = result.data[0];
+    QJsonObject report;
+    report["consistent"] = row["Consistent"].toBool();
+    report["differences"] = QJsonArray::fromStringList(row["Differences"].toStringList());
+    report["repaired"] = row["Repaired"].toBool();
+    
+    return Response(true, result.message, QJsonDocument(report).toJson(QJsonDocument::Compact));
+}
+
+Response Protocol_Handler::handle_admin_get_query_stats(const Parsed_Message& message, Client_Session* client)
 {
-    // Not implemented in college project scope - all users are regular clients
-    return false;
+    if (!db_manager) {
+        return Response(false, Config::ErrorMessages::DB_CONNECTION_FAILED);
+    }
+    
+    int top = message.json_data["top"].toInt(Config::Diagnostics::DEFAULT_TOP_QUERIES);
+    bool reset = message.json_data["reset"].toBool();
+    auto result = db_manager->get_query_statistics(qMax(top, 0), reset);
+    if (!result.is_success() || result.data.isEmpty()) {
+        return Response(false, result.message);
+    }
+    
+    auto to_json = [](const QHash<QString, QVariant>& row) {
+        QJsonObject entry;
+        entry["calls"] = row["Calls"].toLongLong();
+        entry["errors"] = row["Errors"].toLongLong();
+        entry["rows"] = row["Rows"].toLongLong();
+        entry["total_ms"] = row["Total_Ms"].toDouble();
+        entry["avg_ms"] = row["Avg_Ms"].toDouble();
+        entry["p50_ms"] = row["P50_Ms"].toDouble();
+        entry["p95_ms"] = row["P95_Ms"].toDouble();
+        entry["p99_ms"] = row["P99_Ms"].toDouble();
+        entry["max_ms"] = row["Max_Ms"].toDouble();
+        entry["avg_wait_ms"] = row["Avg_Wait_Ms"].toDouble();
+        return entry;
+    };
+    
+    // First row holds the totals, the rest are the slowest shapes by total time
+    QJsonObject totals = to_json(result.data[0]);
+    totals["shapes"] = result.data[0]["Shapes"].toInt();
+    
+    QJsonArray queries;
+    for (int i = 1; i < result.data.size(); ++i) {
+        QJsonObject entry = to_json(result.data[i]);
+        entry["query"] = result.data[i]["Query_Shape"].toString();
+        queries.append(entry);
+    }
+    
+    QJsonObject report;
+    report["totals"] = totals;
+    report["queries"] = queries;
+    report["slow_query_threshold_ms"] = Config::Diagnostics::SLOW_QUERY_THRESHOLD_MS;
+    report["reset"] = reset;
+    
+    return Response(true, result.message, QJsonDocument(report).toJson(QJsonDocument::Compact));
+}
+
+Response Protocol_Handler::defer_to_group_commit(const Database::Batch_Operation& operation,
+    Client_Session* client, const QString& success_message, const QString& idempotency_key)
+{
+    // The client may disconnect before the batch commits; the result is still recorded
+    // under its idempotency key so the retry after reconnecting gets it.
+    // The store outlives the callbacks: the destructor flushes the group commit first.
+    QPointer<Client_Session> target(client);
+    Idempotency_Store* store = idempotency_store.get();
+    group_commit->submit(operation, [target, success_message, store, idempotency_key](const Database::Query_Result& result) {
+        Response response = result.is_success() ? Response(true, success_message) : Response(false, result.message);
+        record_idempotent_result(store, idempotency_key, response);
+        if (target) {
+            target->complete_deferred_response(response);
+        }
+    });
+    
+    Response response;
+    response.deferred = true;
+    return response;
+}
+
+Response Protocol_Handler::handle_idempotent(const Parsed_Message& message, Client_Session* client,
+    Message_Handler handler)
+{
+    if (message.json_data.contains("idempotency_key")) {
+        QString raw_key = message.json_data["idempotency_key"].toString();
+        if (raw_key.isEmpty() || raw_key.size() > Config::Idempotency::MAX_KEY_LENGTH) {
+            return Response(false, Config::ErrorMessages::INVALID_IDEMPOTENCY_KEY);
+        }
+    }
+    
+    QString key = get_idempotency_key(message, client);
+    if (key.isEmpty()) {
+        return (this->*handler)(message, client);
+    }
+    
+    Response stored_response;
+    QByteArray fingerprint = Idempotency_Store::make_fingerprint(message_type_to_string(message.type), message.json_data);
+    switch (idempotency_store->begin(key, fingerprint, stored_response)) {
+        case Idempotency_Status::REPLAY:
+            return stored_response;
+        case Idempotency_Status::IN_PROGRESS:
+            return Response(false, Config::ErrorMessages::REQUEST_IN_PROGRESS, "",
+                Config::Idempotency::IN_PROGRESS_ERROR_CODE);
+        case Idempotency_Status::KEY_REUSED:
+            return Response(false, Config::ErrorMessages::IDEMPOTENCY_KEY_REUSED, "",
+                Config::Idempotency::KEY_REUSED_ERROR_CODE);
+        case Idempotency_Status::NEW:
+            break;
+    }
+    
+    Response response = (this->*handler)(message, client);
+    if (!response.deferred) {
+        record_idempotent_result(idempotency_store.get(), key, response);
+    }
+    return response;
+}
+
+QString Protocol_Handler::get_idempotency_key(const Parsed_Message& message, Client_Session* client) const
+{
+    // Keys are per user, and only trusted once the user is known
+    if (!idempotency_store || !client->is_authenticated()) {
+        return QString();
+    }
+    
+    QString raw_key = message.json_data["idempotency_key"].toString();
+    if (raw_key.isEmpty() || raw_key.size() > Config::Idempotency::MAX_KEY_LENGTH) {
+        return QString();
+    }
+    return Idempotency_Store::make_key(client->get_client_info().user_id, raw_key);
+}
+
+void Protocol_Handler::record_idempotent_result(Idempotency_Store* store, const QString& key, const Response& response)
+{
+    if (!store || key.isEmpty()) {
+        return;
+    }
+    
+    // Only successes are replayed, a failed request changed nothing and may run again
+    if (response.success) {
+        store->complete(key, response);
+    }
+    else {
+        store->abandon(key);
+    }
+}
+
+int Protocol_Handler::read_page_request(const Parsed_Message& message, bool datetime_key, Database::Listing_Request& request) const
+{
+    int page_size = message.json_data.value("limit").toInt(Config::Paging::DEFAULT_PAGE_SIZE);
+    if (page_size <= 0) {
+        page_size = Config::Paging::DEFAULT_PAGE_SIZE;
+    }
+    page_size = qMin(page_size, Config::Paging::MAX_PAGE_SIZE);
+    
+    QString after = message.json_data.value("after").toString();
+    if (!after.isEmpty() && !decode_page_token(after, datetime_key, request)) {
+        return -1;
+    }
+    
+    // One row more than the page tells whether another page follows
+    request.limit = page_size + 1;
+    return page_size;
+}
+
+Response Protocol_Handler::finish_page(Response_Stream& stream, const Database::Query_Result& result,
+    const QString& message_text) const
+{
+    if (!result.is_success()) {
+        return stream.finish(false, result.message);
+    }
+    
+    QString next_page;
+    if (stream.is_page_full()) {
+        next_page = encode_page_token(stream.get_last_key(), stream.get_last_id());
+    }
+    return stream.finish(true, message_text, next_page);
+}
+
+QString Protocol_Handler::encode_page_token(const QVariant& key, int id)
+{
+    // "<sort key>|<id>" in URL-safe base64; clients pass it back untouched
+    QString key_text;
+    if (key.metaType().id() == QMetaType::QDate) {
+        key_text = key.toDate().toString(Qt::ISODate);
+    } else if (key.metaType().id() == QMetaType::QDateTime) {
+        key_text = key.toDateTime().toString(Qt::ISODateWithMs);
+    } else if (!key.isNull()) {
+        key_text = key.toString(); // SQLite hands dates back as ISO text
+    }
+    
+    QByteArray raw = (key_text + '|' + QString::number(id)).toUtf8();
+    return QString::fromLatin1(raw.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+bool Protocol_Handler::decode_page_token(const QString& token, bool datetime_key, Database::Listing_Request& request)
+{
+    auto decoded = QByteArray::fromBase64Encoding(token.toLatin1(),
+        QByteArray::Base64UrlEncoding | QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded) {
+        return false;
+    }
+    
+    QString text = QString::fromUtf8(*decoded);
+    int separator = text.lastIndexOf('|');
+    bool id_ok = false;
+    int id = separator >= 0 ? text.mid(separator + 1).toInt(&id_ok) : 0;
+    if (!id_ok || id <= 0) {
+        return false;
+    }
+    
+    QString key_text = text.left(separator);
+    if (!key_text.isEmpty()) {
+        if (datetime_key) {
+            QDateTime moment = QDateTime::fromString(key_text, Qt::ISODateWithMs);
+            if (!moment.isValid()) {
+                return false;
+            }
+            request.after_key = moment;
+        } else {
+            QDate day = QDate::fromString(key_text, Qt::ISODate);
+            if (!day.isValid()) {
+                return false;
+            }
+            request.after_key = day;
+        }
+    }
+    
+    request.after_id = id;
+    return true;
+}
+
+QString Protocol_Handler::read_fields(const Parsed_Message& message, Database::Listing listing,
+    const QStringList& key_fields, Database::Listing_Request& request)
+{
+    // "fields": ["Name", "Price_per_Person"] or "Name,Price_per_Person"; missing = every column
+    QJsonValue value = message.json_data.value("fields");
+    QStringList asked;
+    if (value.isArray()) {
+        for (const QJsonValue& field : value.toArray()) {
+            asked.append(field.toString());
+        }
+    } else if (value.isString()) {
+        asked = value.toString().split(',', Qt::SkipEmptyParts);
+    } else if (!value.isUndefined() && !value.isNull()) {
+        return "Invalid fields";
+    }
+    
+    if (asked.isEmpty()) {
+        return QString();
+    }
+    
+    const QStringList allowed = Database::Database_Manager::get_listing_fields(listing);
+    QStringList fields = key_fields; // the page token and the client's row identity need them
+    for (const QString& field : std::as_const(asked)) {
+        QString name = field.trimmed();
+        if (!allowed.contains(name)) {
+            return "Unknown field: " + name;
+        }
+        if (!fields.contains(name)) {
+            fields.append(name);
+        }
+    }
+    
+    request.fields = fields;
+    return QString();
 }
 
 QJsonArray Protocol_Handler::vector_to_json(const QList<QHash<QString, QVariant>>& data)
@@ -0,0 +1,115 @@
+#include "network/Response_Cache.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QMutexLocker>
+
+using namespace SocketNetwork;
+
+namespace {
+    // Framing and routing fields, the same listing is asked for with any of them
+    const char* const IGNORED_PARAMS[] = { "type", "command", "op", "idempotency_key", "accept_encoding" };
+}
+
+Response_Cache::Response_Cache(int max_entries, qint64 ttl_ms, int compress_min_bytes)
+    : max_entries(max_entries), ttl_ms(ttl_ms), compress_min_bytes(compress_min_bytes)
+{
+}
+
+// Lookups
+bool Response_Cache::find(const QByteArray& key, quint64 data_version, bool compressed, QByteArray& reply)
+{
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(key);
+    if (found == index.constEnd()) {
+        return false;
+    }
+
+    auto it = found.value();
+    if (it->data_version < data_version || it->expires_at_ms <= QDateTime::currentMSecsSinceEpoch()) {
+        index.remove(key);
+        entries.erase(it);
+        return false;
+    }
+    if (it->data_version != data_version) {
+        return false; // stored by a caller that read the version after this one
+    }
+
+    entries.splice(entries.begin(), entries, it);
+    reply = compressed ? it->compressed : it->plain;
+    return true;
+}
+
+int Response_Cache::size() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(entries.size());
+}
+
+// Updates
+void Response_Cache::store(const QByteArray& key, quint64 data_version, const QByteArray& reply)
+{
+    // Compressed outside the lock, a large listing takes a while
+    QByteArray compressed = reply.size() >= compress_min_bytes ? compress_reply(reply) : reply;
+
+    QMutexLocker locker(&mutex);
+
+    auto found = index.constFind(key);
+    if (found != index.constEnd()) {
+        if (found.value()->data_version > data_version) {
+            return; // built from data that has changed since
+        }
+        entries.erase(found.value());
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.plain = reply;
+    entry.compressed = compressed;
+    entry.data_version = data_version;
+
+    // Offer listings leave out past departures, so nothing outlives the day it was built on
+    qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    qint64 midnight_ms = QDateTime(QDate::currentDate().addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+    entry.expires_at_ms = qMin(now_ms + ttl_ms, midnight_ms);
+
+    entries.push_front(entry);
+    index.insert(key, entries.begin());
+
+    while (static_cast<int>(entries.size()) > max_entries) {
+        index.remove(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void Response_Cache::clear()
+{
+    QMutexLocker locker(&mutex);
+    entries.clear();
+    index.clear();
+}
+
+QByteArray Response_Cache::make_key(std::string_view label, const QJsonObject& params)
+{
+    // QJsonObject keeps its keys sorted, so the same parameters always give the same text
+    QJsonObject normalized = params;
+    for (const char* name : IGNORED_PARAMS) {
+        normalized.remove(QLatin1String(name));
+    }
+
+    QByteArray key(label.data(), static_cast<qsizetype>(label.size()));
+    key.append(' ');
+    key.append(QJsonDocument(normalized).toJson(QJsonDocument::Compact));
+    return key;
+}
+
+QByteArray Response_Cache::compress_reply(const QByteArray& reply)
+{
+    // The protocol is one JSON object per line: the zlib stream travels as base64 inside one
+    QByteArray body = reply.endsWith("\r\n") ? reply.chopped(2) : reply;
+    QByteArray compressed("{\"encoding\":\"zlib\",\"payload\":\"");
+    compressed.append(qCompress(body).toBase64());
+    compressed.append("\"}\r\n");
+    return compressed.size() < reply.size() ? compressed : reply;
+}
@@ -0,0 +1,204 @@
+#include "network/Response_Stream.h"
+#include "network/Client_Session.h"
+#include "utils/utils.h"
+#include "config.h"
+
+#include <QtSql/QSqlRecord>
+
+#include <algorithm>
+
+using namespace SocketNetwork;
+
+Response_Stream::Response_Stream(Client_Session* client)
+    : client(client), locker(&client->send_mutex)
+{
+    client->output_buffer.resize(0);
+    client->output_buffer.append("{\"data\":[");
+}
+
+Response_Stream::~Response_Stream()
+{
+    // A handler that left without finishing still owes the client the end of the reply
+    if (!finished) {
+        finish(false, Config::ErrorMessages::SERVER_ERROR);
+    }
+}
+
+void Response_Stream::set_page(int max_rows, qint64 max_bytes, const QString& key_column, const QString& id_column)
+{
+    this->max_rows = max_rows;
+    this->max_bytes = max_bytes;
+    this->key_column = key_column;
+    this->id_column = id_column;
+}
+
+void Response_Stream::set_fields(const QStringList& fields)
+{
+    this->fields = fields;
+}
+
+// Rows
+bool Response_Stream::append_row(const QSqlQuery& row)
+{
+    if (!begin_row()) {
+        return false;
+    }
+
+    if (columns.isEmpty()) {
+        QSqlRecord record = row.record();
+        QStringList names;
+        for (int i = 0; i < record.count(); ++i) {
+            names.append(record.fieldName(i));
+        }
+        set_columns(names);
+    }
+
+    QByteArray& out = client->output_buffer;
+    out.append(row_count == 0 ? "{" : ",{");
+    for (int i = 0; i < columns.size(); ++i) {
+        if (i > 0) {
+            out.append(',');
+        }
+        out.append(columns[i].key);
+        Utils::JSON::append_value(out, row.value(columns[i].index));
+    }
+    return end_row(key_index >= 0 ? row.value(key_index) : QVariant(), id_index >= 0 ? row.value(id_index) : QVariant());
+}
+
+bool Response_Stream::append_row(const QHash<QString, QVariant>& row)
+{
+    if (!begin_row()) {
+        return false;
+    }
+
+    if (columns.isEmpty()) {
+        set_columns(row.keys());
+    }
+
+    QByteArray& out = client->output_buffer;
+    out.append(row_count == 0 ? "{" : ",{");
+    for (int i = 0; i < columns.size(); ++i) {
+        if (i > 0) {
+            out.append(',');
+        }
+        out.append(columns[i].key);
+        Utils::JSON::append_value(out, row.value(columns[i].name));
+    }
+    return end_row(row.value(key_column), row.value(id_column));
+}
+
+Response Response_Stream::finish(bool success, const QString& message, const QString& next_page)
+{
+    Response response(success, message);
+    response.streamed = true;
+    if (finished) {
+        return response;
+    }
+    finished = true;
+
+    if (!failed) {
+        QByteArray& out = client->output_buffer;
+        out.append("],\"message\":");
+        Utils::JSON::append_string(out, message);
+        if (!next_page.isEmpty()) {
+            out.append(",\"next_page\":");
+            Utils::JSON::append_string(out, next_page);
+        }
+        out.append(success ? ",\"success\":true}" : ",\"success\":false}");
+        client->write_output_locked();
+    }
+
+    locker.unlock();
+    return response;
+}
+
+int Response_Stream::get_row_count() const
+{
+    return row_count;
+}
+
+bool Response_Stream::is_page_full() const
+{
+    return page_full;
+}
+
+QVariant Response_Stream::get_last_key() const
+{
+    return last_key;
+}
+
+int Response_Stream::get_last_id() const
+{
+    return last_id;
+}
+
+// Private helpers
+bool Response_Stream::begin_row()
+{
+    if (failed || page_full) {
+        return false;
+    }
+
+    if (max_rows >= 0 && row_count >= max_rows) {
+        page_full = true;
+        return false;
+    }
+
+    row_start = client->output_buffer.size();
+    return true;
+}
+
+void Response_Stream::set_columns(const QStringList& names)
+{
+    for (int i = 0; i < names.size(); ++i) {
+        if (names[i] == key_column) {
+            key_index = i;
+        }
+        if (names[i] == id_column) {
+            id_index = i;
+        }
+        if (!fields.isEmpty() && !fields.contains(names[i])) {
+            continue;
+        }
+
+        Column column;
+        column.name = names[i];
+        column.index = i;
+        Utils::JSON::append_string(column.key, names[i]);
+        column.key.append(':');
+        columns.append(column);
+    }
+
+    std::sort(columns.begin(), columns.end(), [](const Column& a, const Column& b) {
+        return a.name < b.name;
+    });
+}
+
+bool Response_Stream::end_row(const QVariant& key, const QVariant& id)
+{
+    QByteArray& out = client->output_buffer;
+    out.append('}');
+
+    // The row that does not fit is taken back and starts the next page; the first one always goes
+    if (max_bytes >= 0 && row_count > 0 && bytes_flushed + out.size() > max_bytes) {
+        out.truncate(row_start);
+        page_full = true;
+        return false;
+    }
+
+    row_count++;
+    last_key = key;
+    last_id = id.toInt();
+
+    if (out.size() < Config::Server::STREAM_CHUNK_BYTES) {
+        return true;
+    }
+
+    bytes_flushed += out.size();
+    if (!client->flush_output_locked()) {
+        failed = true;
+        Utils::Logger::warning("Streamed reply aborted after " + QString::number(row_count) + " rows: " +
+            client->get_client_info().ip_address);
+    }
+    return !failed;
+}
@@ -0,0 +1,306 @@
+#include "network/Session_Store.h"
+#include "utils/utils.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QList>
+
+using namespace SocketNetwork;
+
+namespace {
+    // Expired sessions nobody resumes are swept after this many new ones
+    constexpr int PURGE_EVERY_OPENED = 1024;
+}
+
+Session_Store::Session_Store(int shard_count, qint64 ttl_ms, const QString& journal_path)
+    : shards(std::make_unique<Shard[]>(qMax(shard_count, 1))), shard_count(qMax(shard_count, 1)),
+      ttl_ms(ttl_ms), journal_path(journal_path)
+{
+}
+
+Session_Store::~Session_Store()
+{
+    QMutexLocker locker(&journal_mutex);
+    if (journal.isOpen()) {
+        journal.close();
+    }
+}
+
+bool Session_Store::open()
+{
+    if (journal_path.isEmpty()) {
+        return true;
+    }
+
+    {
+        QMutexLocker locker(&journal_mutex);
+        if (journal.isOpen()) {
+            return true;
+        }
+    }
+
+    Utils::File::create_directory(QFileInfo(journal_path).absolutePath());
+
+    QFile existing(journal_path);
+    if (existing.exists() && existing.open(QIODevice::ReadOnly)) {
+        qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+        while (!existing.atEnd()) {
+            QJsonDocument doc = QJsonDocument::fromJson(existing.readLine().trimmed());
+            if (!doc.isObject()) {
+                continue; // torn last line after a crash
+            }
+
+            QJsonObject record = doc.object();
+            QByteArray token_hash = record.value("token").toString().toLatin1();
+            if (token_hash.isEmpty()) {
+                continue;
+            }
+
+            Shard& shard = get_shard(token_hash);
+            QMutexLocker locker(&shard.mutex);
+            if (record.value("closed").toBool()) {
+                shard.sessions.remove(token_hash);
+                continue;
+            }
+
+            Session session;
+            session.user_id = record.value("user_id").toInt();
+            session.username = record.value("username").toString();
+            session.ip_address = record.value("ip").toString();
+            session.created_at_ms = record.value("created_at").toInteger();
+            session.expires_at_ms = record.value("expires_at").toInteger();
+            if (session.expires_at_ms > now_ms) {
+                shard.sessions.insert(token_hash, session);
+            }
+        }
+        existing.close();
+
+        int restored = size();
+        if (restored > 0) {
+            Utils::Logger::info(QString("Session journal: restored %1 sessions").arg(restored));
+        }
+    }
+
+    return compact();
+}
+
+// Sessions
+QString Session_Store::create(int user_id, const QString& username, const QString& ip_address)
+{
+    QString token = Utils::Crypto::generate_session_token();
+    QByteArray token_hash = hash_token(token);
+
+    Session session;
+    session.user_id = user_id;
+    session.username = username;
+    session.ip_address = ip_address;
+    session.created_at_ms = QDateTime::currentMSecsSinceEpoch();
+    session.expires_at_ms = session.created_at_ms + ttl_ms;
+
+    {
+        Shard& shard = get_shard(token_hash);
+        QMutexLocker locker(&shard.mutex);
+        shard.sessions.insert(token_hash, session);
+    }
+    append_record(token_hash, &session);
+
+    if (++opened_since_purge >= PURGE_EVERY_OPENED) {
+        opened_since_purge = 0;
+        purge_expired();
+    }
+    return token;
+}
+
+bool Session_Store::resume(const QString& token, Session& session)
+{
+    if (token.isEmpty()) {
+        return false;
+    }
+
+    QByteArray token_hash = hash_token(token);
+    Shard& shard = get_shard(token_hash);
+    QMutexLocker locker(&shard.mutex);
+
+    auto found = shard.sessions.constFind(token_hash);
+    if (found == shard.sessions.constEnd()) {
+        return false;
+    }
+    if (found->expires_at_ms <= QDateTime::currentMSecsSinceEpoch()) {
+        shard.sessions.erase(found);
+        return false; // the journal drops it at the next compaction
+    }
+
+    session = found.value();
+    return true;
+}
+
+bool Session_Store::revoke(const QString& token, int user_id)
+{
+    if (token.isEmpty()) {
+        return false;
+    }
+
+    QByteArray token_hash = hash_token(token);
+    {
+        Shard& shard = get_shard(token_hash);
+        QMutexLocker locker(&shard.mutex);
+        auto found = shard.sessions.find(token_hash);
+        if (found == shard.sessions.end() || found->user_id != user_id) {
+            return false;
+        }
+        shard.sessions.erase(found);
+    }
+
+    append_record(token_hash, nullptr);
+    return true;
+}
+
+int Session_Store::revoke_user(int user_id)
+{
+    // A full scan, but only on a password change or a deletion
+    QList<QByteArray> revoked;
+    for (int i = 0; i < shard_count; ++i) {
+        QMutexLocker locker(&shards[i].mutex);
+        for (auto it = shards[i].sessions.begin(); it != shards[i].sessions.end();) {
+            if (it->user_id == user_id) {
+                revoked.append(it.key());
+                it = shards[i].sessions.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (const QByteArray& token_hash : revoked) {
+        append_record(token_hash, nullptr);
+    }
+    return revoked.size();
+}
+
+int Session_Store::purge_expired()
+{
+    qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    int purged = 0;
+    for (int i = 0; i < shard_count; ++i) {
+        QMutexLocker locker(&shards[i].mutex);
+        for (auto it = shards[i].sessions.begin(); it != shards[i].sessions.end();) {
+            if (it->expires_at_ms <= now_ms) {
+                it = shards[i].sessions.erase(it);
+                ++purged;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    return purged;
+}
+
+int Session_Store::size() const
+{
+    int total = 0;
+    for (int i = 0; i < shard_count; ++i) {
+        QMutexLocker locker(&shards[i].mutex);
+        total += shards[i].sessions.size();
+    }
+    return total;
+}
+
+QByteArray Session_Store::hash_token(const QString& token)
+{
+    return QCryptographicHash::hash(token.toUtf8(), QCryptographicHash::Sha256).toHex();
+}
+
+// Private helpers
+Session_Store::Shard& Session_Store::get_shard(const QByteArray& token_hash) const
+{
+    return shards[qHash(token_hash) % static_cast<size_t>(shard_count)];
+}
+
+void Session_Store::append_record(const QByteArray& token_hash, const Session* session)
+{
+    QMutexLocker locker(&journal_mutex);
+    if (!journal.isOpen()) {
+        return;
+    }
+
+    // Flushed to the OS only, not synced: a session lost in a power cut means one more login
+    QByteArray line = to_line(token_hash, session);
+    if (journal.write(line) != line.size() || !journal.flush()) {
+        Utils::Logger::warning("Session journal: write failed: " + journal.errorString());
+        return;
+    }
+
+    if (++journal_records > 2 * qMax(size(), PURGE_EVERY_OPENED)) {
+        locker.unlock();
+        purge_expired();
+        compact();
+    }
+}
+
+QByteArray Session_Store::to_line(const QByteArray& token_hash, const Session* session)
+{
+    QJsonObject record;
+    record["token"] = QString::fromLatin1(token_hash);
+    if (session) {
+        record["user_id"] = session->user_id;
+        record["username"] = session->username;
+        record["ip"] = session->ip_address;
+        record["created_at"] = session->created_at_ms;
+        record["expires_at"] = session->expires_at_ms;
+    }
+    else {
+        record["closed"] = true;
+    }
+    return QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool Session_Store::compact()
+{
+    // Shards are copied one at a time; a session opened meanwhile is written to the
+    // new file by its own append_record, which waits for journal_mutex
+    QMutexLocker locker(&journal_mutex);
+    if (journal.isOpen()) {
+        journal.close();
+    }
+
+    QSaveFile rewritten(journal_path);
+    if (!rewritten.open(QIODevice::WriteOnly)) {
+        Utils::Logger::error("Session journal: cannot rewrite " + journal_path + ": " + rewritten.errorString());
+        return false;
+    }
+
+    journal_records = 0;
+    qint64 now_ms = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < shard_count; ++i) {
+        QHash<QByteArray, Session> sessions;
+        {
+            QMutexLocker shard_locker(&shards[i].mutex);
+            sessions = shards[i].sessions;
+        }
+        for (auto it = sessions.constBegin(); it != sessions.constEnd(); ++it) {
+            if (it->expires_at_ms > now_ms) {
+                rewritten.write(to_line(it.key(), &it.value()));
+                ++journal_records;
+            }
+        }
+    }
+
+    if (!rewritten.commit()) {
+        Utils::Logger::error("Session journal: cannot rewrite " + journal_path + ": " + rewritten.errorString());
+        return false;
+    }
+
+    journal.setFileName(journal_path);
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        Utils::Logger::error("Session journal: cannot open " + journal_path + ": " + journal.errorString());
+        return false;
+    }
+    return true;
+}
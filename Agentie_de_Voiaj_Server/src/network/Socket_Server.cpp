@@ -12,7 +12,7 @@
 using namespace SocketNetwork;
 
 Socket_Server::Socket_Server(QObject* parent)
-    : QObject(parent), tcp_server(nullptr), is_running(false), is_initialized(false),
+    : QObject(parent), tcp_server(nullptr), local_server(nullptr), is_running(false), is_initialized(false),
       accept_thread(nullptr), cleanup_timer(nullptr), client_count(0),
       total_connections(0), total_messages_received(0), total_messages_sent(0)
 {
@@ -27,7 +27,7 @@ Socket_Server::Socket_Server(QObject* parent)
 }
 
 Socket_Server::Socket_Server(const Server_Config& config, QObject* parent)
-    : QObject(parent), tcp_server(nullptr), config(config), is_running(false), is_initialized(false),
+    : QObject(parent), tcp_server(nullptr), local_server(nullptr), config(config), is_running(false), is_initialized(false),
       accept_thread(nullptr), cleanup_timer(nullptr), client_count(0),
       total_connections(0), total_messages_received(0), total_messages_sent(0)
 {
@@ -58,6 +58,13 @@ bool Socket_Server::initialize()
         // Connect server signals
         connect(tcp_server, &QTcpServer::newConnection, this, &Socket_Server::handle_new_connection);
         
+        // Same-host tools connect here, to the same protocol stack
+        if (!config.local_server_name.isEmpty()) {
+            local_server = new QLocalServer(this);
+            local_server->setSocketOptions(QLocalServer::UserAccessOption);
+            connect(local_server, &QLocalServer::newConnection, this, &Socket_Server::handle_new_local_connection);
+        }
+        
         // Create protocol handler
         if (db_manager) {
             protocol_handler = std::make_unique<Protocol_Handler>(db_manager);
@@ -113,6 +120,17 @@ bool Socket_Server::start()
             return false;
         }
 
+        // The TCP server runs without it: tools on the host then use the port like everyone else
+        if (local_server) {
+            // A server that was killed leaves its socket file behind, listen() would fail on it
+            QLocalServer::removeServer(config.local_server_name);
+            if (local_server->listen(config.local_server_name)) {
+                Utils::Logger::info("Local server listening on " + local_server->fullServerName());
+            } else {
+                Utils::Logger::warning("Local server not started: " + local_server->errorString());
+            }
+        }
+
         is_running = true;
         
         // Start cleanup timer
@@ -151,6 +169,9 @@ void Socket_Server::stop()
     if (tcp_server) {
         tcp_server->close();
     }
+    if (local_server) {
+        local_server->close();
+    }
 
     // Stop all client handlers
     for (auto it = active_clients.begin(); it != active_clients.end(); ++it) {
@@ -160,6 +181,7 @@ void Socket_Server::stop()
     }
     active_clients.clear();
     client_count = 0;
+    local_client_count = 0;
 
     Utils::Logger::info("Socket_Server stopped successfully");
 }
@@ -198,6 +220,8 @@ void Socket_Server::handle_new_connection()
             continue;
         }
 
+        configure_socket(client_socket);
+
         // Create client info
         Client_Info client_info(client_socket, 
                                client_socket->peerAddress().toString(),
@@ -206,31 +230,92 @@ void Socket_Server::handle_new_connection()
         Utils::Logger::info("New client connected: " + client_info.ip_address + ":" + 
                            QString::number(client_info.port));
 
-        // Create client handler
-        QMutexLocker locker(&protocol_handler_mutex);
-        auto client_handler = std::make_shared<Client_Handler>(
-            client_socket, client_info, db_manager, protocol_handler.get(), this);
+        add_client(client_socket, client_info);
+    }
+}
+
+void Socket_Server::handle_new_local_connection()
+{
+    if (!is_running) {
+        return;
+    }
+
+    while (local_server && local_server->hasPendingConnections()) {
+        QLocalSocket* client_socket = local_server->nextPendingConnection();
+        
+        if (!client_socket) {
+            continue;
+        }
+
+        // A budget of their own: local tools never take a slot meant for a remote agency
+        if (local_client_count >= config.max_local_clients) {
+            Utils::Logger::warning("Local connection limit reached. Rejecting local client");
+            client_socket->disconnectFromServer();
+            client_socket->deleteLater();
+            continue;
+        }
+
+        Client_Info client_info(client_socket, "local:" + local_server->serverName(), 0);
+        client_info.is_local = true;
+
+        Utils::Logger::info("New local client connected: " + client_info.ip_address);
+
+        add_client(client_socket, client_info);
+    }
+}
+
+void Socket_Server::add_client(QIODevice* socket, const Client_Info& client_info)
+{
+    // Create client handler
+    QMutexLocker locker(&protocol_handler_mutex);
+    auto client_handler = std::make_shared<Client_Handler>(
+        socket, client_info, db_manager, protocol_handler.get(), this);
 
-        // Add to active clients
-        {
-            QMutexLocker clients_locker(&clients_mutex);
-            active_clients[client_socket] = client_handler;
+    // Add to active clients
+    {
+        QMutexLocker clients_locker(&clients_mutex);
+        active_clients[socket] = client_handler;
+        if (client_info.is_local) {
+            local_client_count++;
+        } else {
             client_count++;
-            total_connections++;
         }
+        total_connections++;
+    }
 
-        // Connect client handler signals
-        connect(client_handler.get(), &Client_Handler::clientDisconnected, 
-                this, &Socket_Server::handle_client_disconnected);
-        connect(client_handler.get(), &Client_Handler::messageReceived,
-                this, [this](const QString& message) {
-                    total_messages_received++;
-                });
+    // Connect client handler signals
+    connect(client_handler.get(), &Client_Handler::clientDisconnected, 
+            this, &Socket_Server::handle_client_disconnected);
+    connect(client_handler.get(), &Client_Handler::messageReceived,
+            this, [this](const QByteArray&) {
+                total_messages_received++;
+            });
 
-        // Start handling client
-        client_handler->start_handling();
+    // Start handling client
+    client_handler->start_handling();
+
+    Utils::Logger::info("Client handler created and started for: " + client_info.ip_address);
+}
 
-        Utils::Logger::info("Client handler created and started for: " + client_info.ip_address);
+void Socket_Server::count_removed_client(const Client_Handler& client_handler)
+{
+    if (client_handler.get_client_info().is_local) {
+        local_client_count--;
+    } else {
+        client_count--;
+    }
+}
+
+void Socket_Server::configure_socket(QTcpSocket* socket) const
+{
+    // Set explicitly rather than left to platform defaults, which differ between Windows and Linux
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, Config::Server::ENABLE_TCP_NODELAY ? 1 : 0);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, Config::Server::ENABLE_KEEP_ALIVE ? 1 : 0);
+    if (Config::Server::SOCKET_SEND_BUFFER_BYTES > 0) {
+        socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, Config::Server::SOCKET_SEND_BUFFER_BYTES);
+    }
+    if (Config::Server::SOCKET_RECEIVE_BUFFER_BYTES > 0) {
+        socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, Config::Server::SOCKET_RECEIVE_BUFFER_BYTES);
     }
 }
 
@@ -246,14 +331,14 @@ void Socket_Server::handle_client_disconnected()
     for (auto it = active_clients.begin(); it != active_clients.end(); ++it) {
         if (it.value().get() == client_handler) {
             Utils::Logger::info("Client disconnected: " + it.value()->get_client_info().ip_address);
+            count_removed_client(*it.value());
             active_clients.erase(it);
-            client_count--;
             break;
         }
     }
 }
 
-void Socket_Server::remove_client(QTcpSocket* client_socket)
+void Socket_Server::remove_client(QIODevice* client_socket)
 {
     if (!client_socket) {
         return;
@@ -268,8 +353,8 @@ void Socket_Server::remove_client(QTcpSocket* client_socket)
         it.value()->stop_handling();
         
         // Remove from active clients
+        count_removed_client(*it.value());
         active_clients.erase(it);
-        client_count--;
     }
 }
 
@@ -284,15 +369,19 @@ void Socket_Server::cleanup_inactive_clients()
     for (auto it = active_clients.begin(); it != active_clients.end();) {
         if (!it.value() || !it.value()->is_client_running()) {
             Utils::Logger::info("Cleaning up inactive client");
+            if (it.value()) {
+                count_removed_client(*it.value());
+            } else {
+                client_count--;
+            }
             it = active_clients.erase(it);
-            client_count--;
         } else {
             // Check for idle timeout
             if (it.value()->get_idle_time() > Config::Server::SOCKET_TIMEOUT_MS) {
                 Utils::Logger::info("Client idle timeout: " + it.value()->get_client_info().ip_address);
                 it.value()->stop_handling();
+                count_removed_client(*it.value());
                 it = active_clients.erase(it);
-                client_count--;
             } else {
                 ++it;
             }
@@ -300,7 +389,7 @@ void Socket_Server::cleanup_inactive_clients()
     }
 }
 
-void Socket_Server::send_message_to_client(QTcpSocket* client_socket, const QString& message)
+void Socket_Server::send_message_to_client(QIODevice* client_socket, const QString& message)
 {
     if (!client_socket) {
         return;
@@ -318,7 +407,7 @@ void Socket_Server::send_message_to_client(QTcpSocket* client_socket, const QStr
 Server_Stats Socket_Server::get_server_stats() const
 {
     Server_Stats stats;
-    stats.active_clients = client_count;
+    stats.active_clients = client_count + local_client_count;
     stats.total_connections = total_connections;
     stats.total_messages_received = total_messages_received;
     stats.total_messages_sent = total_messages_sent;
@@ -341,15 +430,38 @@ Server_Stats Socket_Server::get_server_stats() const
     
     // Get memory usage
     stats.memory_usage_mb = static_cast<int>(Utils::Memory::get_memory_usage_MB());
+    if (total_requests > 0) {
+        stats.allocations_per_request = static_cast<qreal>(total_request_allocations) / total_requests;
+    }
     
     return stats;
 }
 
+void Socket_Server::record_request_allocations(quint64 allocations)
+{
+    // Covers read, parse, dispatch, serialize and write of one request on the server thread.
+    // A deferred request comes here when its reply is written, not when dispatch returns
+    if (Utils::Memory::is_allocation_counting_enabled()) {
+        total_requests++;
+        total_request_allocations += static_cast<qint64>(allocations);
+    }
+}
+
+Database::Group_Commit_Stats Socket_Server::get_group_commit_stats() const
+{
+    if (protocol_handler && protocol_handler->get_group_commit()) {
+        return protocol_handler->get_group_commit()->get_stats();
+    }
+    return Database::Group_Commit_Stats();
+}
+
 void Socket_Server::reset_server_stats()
 {
     total_connections = 0;
     total_messages_received = 0;
     total_messages_sent = 0;
+    total_requests = 0;
+    total_request_allocations = 0;
     server_start_time = Utils::DateTime::get_current_date_time();
     
     Utils::Logger::info("Server statistics reset");
@@ -362,7 +474,7 @@ bool Socket_Server::is_server_running() const
 
 int Socket_Server::get_active_client_count() const
 {
-    return client_count;
+    return client_count + local_client_count;
 }
 
 QString Socket_Server::get_server_address() const
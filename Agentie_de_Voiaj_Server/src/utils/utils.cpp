@@ -12,11 +12,14 @@
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QStorageInfo>
 #include <QtCore/QJsonParseError>
+#include <QtCore/QStringEncoder>
 #include <QtCore/QSysInfo>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QDebug>
 #include <QtCore/QDate>
 #include <QtCore/QTime>
+#include <QtCore/QLocale>
+#include <QtCore/QtNumeric>
 #include <QtNetwork/QHostInfo>
 #include <QtNetwork/QNetworkInterface>
 #include <QtNetwork/QHostAddress>
@@ -31,6 +34,60 @@ Q_LOGGING_CATEGORY(serverNetwork, "server.network")
 Q_LOGGING_CATEGORY(serverPerformance, "server.performance")
 Q_LOGGING_CATEGORY(serverMemory, "server.memory")
 
+#ifdef AGENTIE_COUNT_ALLOCATIONS
+// Benchmark builds only: every heap allocation bumps a per-thread counter. Qt containers
+// allocate with malloc rather than operator new, so the hook sits at the C runtime level.
+namespace
+{
+	thread_local quint64 thread_allocations = 0;
+}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+
+namespace
+{
+	int count_crt_allocation(int type, void*, size_t, int, long, const unsigned char*, int)
+	{
+		if (type == _HOOK_ALLOC || type == _HOOK_REALLOC)
+		{
+			++thread_allocations;
+		}
+		return 1; // let the allocation through
+	}
+
+	const bool crt_hook_installed = (_CrtSetAllocHook(count_crt_allocation), true);
+}
+#elif defined(__GLIBC__)
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* pointer, size_t size);
+
+	void* malloc(size_t size)
+	{
+		++thread_allocations;
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size)
+	{
+		++thread_allocations;
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* pointer, size_t size)
+	{
+		++thread_allocations;
+		return __libc_realloc(pointer, size);
+	}
+}
+#else
+#error "AGENTIE_COUNT_ALLOCATIONS needs a Debug MSVC build or glibc"
+#endif
+#endif
+
 namespace Utils
 {
 	namespace String
@@ -252,7 +309,11 @@ namespace Utils
 
 		QString generate_session_token()
 		{
-			return Utils::Random::generate_random_string(32, true, true);
+			// A bearer token: 256 bits from the OS generator, not the seeded global() one
+			quint32 words[8];
+			QRandomGenerator::system()->fillRange(words);
+			return QString::fromLatin1(QByteArray(reinterpret_cast<const char*>(words), sizeof(words))
+				.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
 		}
 
 		QString md5_hash(const QString& input)
@@ -579,48 +640,151 @@ namespace Utils
 
 		QString create_error_response(const QString& error_message, int error_code)
     	{
-			QJsonObject response;
-			response["success"] = false;
-			response["message"] = error_message;
-			if (error_code != -1)
-				response["error_code"] = error_code;
-			
-			QJsonDocument doc(response);
-			return doc.toJson(QJsonDocument::Compact);
+			QByteArray response;
+			append_error_response(response, error_message, error_code);
+			return QString::fromUtf8(response);
     	}
 
 		QString create_success_response(const QString& data, const QString& message)
    		{
-			QJsonObject response;
-			response["success"] = true;
-			response["message"] = message.isEmpty() ? "Success" : message;
-			
-			if (!data.isEmpty())
+			QByteArray response;
+			append_success_response(response, data.toUtf8(), message);
+			return QString::fromUtf8(response);
+    	}
+
+		void append_string(QByteArray& out, QStringView text)
+		{
+			out.append('"');
+			qsizetype start = out.size();
+
+			// Encoded in place, into capacity the buffer usually has from earlier replies
+			QStringEncoder encoder(QStringEncoder::Utf8);
+			out.resize(start + encoder.requiredSpace(text.size()));
+			char* end = encoder.appendToBuffer(out.data() + start, text);
+			out.resize(end - out.constData());
+
+			// UTF-8 multi-byte sequences never contain ASCII bytes, so escaping byte by byte is safe
+			bool needs_escape = std::any_of(out.constBegin() + start, out.constEnd(), [](char c) {
+				return static_cast<uchar>(c) < 0x20 || c == '"' || c == '\\';
+			});
+			if (needs_escape)
 			{
-				QJsonParseError error;
-				QJsonDocument dataDoc = QJsonDocument::fromJson(data.toUtf8(), &error);
-				if (error.error == QJsonParseError::NoError)
+				QByteArray raw = out.mid(start);
+				out.resize(start);
+				for (char c : std::as_const(raw))
 				{
-					if (dataDoc.isObject())
-						response["data"] = dataDoc.object();
-					else if (dataDoc.isArray())
-						response["data"] = dataDoc.array();
-					else
-						response["data"] = data;
+					switch (c)
+					{
+						case '"': out.append("\\\""); break;
+						case '\\': out.append("\\\\"); break;
+						case '\b': out.append("\\b"); break;
+						case '\f': out.append("\\f"); break;
+						case '\n': out.append("\\n"); break;
+						case '\r': out.append("\\r"); break;
+						case '\t': out.append("\\t"); break;
+						default:
+							if (static_cast<uchar>(c) < 0x20)
+							{
+								out.append("\\u00");
+								out.append("0123456789abcdef"[(c >> 4) & 0xf]);
+								out.append("0123456789abcdef"[c & 0xf]);
+							}
+							else
+							{
+								out.append(c);
+							}
+							break;
+					}
 				}
-				else
+			}
+			out.append('"');
+		}
+
+		void append_value(QByteArray& out, const QVariant& value)
+		{
+			if (value.isNull())
+			{
+				out.append("null");
+				return;
+			}
+
+			switch (value.metaType().id())
+			{
+				case QMetaType::Bool:
+					out.append(value.toBool() ? "true" : "false");
+					break;
+				case QMetaType::Int:
+				case QMetaType::Short:
+				case QMetaType::Long:
+				case QMetaType::LongLong:
+				case QMetaType::UInt:
+				case QMetaType::UShort:
+				case QMetaType::ULong:
+				case QMetaType::ULongLong:
+					out.append(QByteArray::number(value.toLongLong()));
+					break;
+				case QMetaType::Double:
+				case QMetaType::Float:
 				{
-					response["data"] = data;
+					double number = value.toDouble();
+					if (qIsFinite(number))
+					{
+						out.append(QByteArray::number(number, 'g', QLocale::FloatingPointShortest));
+					}
+					else
+					{
+						out.append("null"); // JSON has no inf or nan
+					}
+					break;
 				}
+				case QMetaType::QDate:
+					append_string(out, value.toDate().toString(Qt::ISODate));
+					break;
+				case QMetaType::QTime:
+				case QMetaType::QDateTime:
+					append_string(out, value.toString()); // QVariant gives ISODateWithMs, as fromVariant does
+					break;
+				default:
+					append_string(out, value.toString());
+					break;
+			}
+		}
+
+		void append_success_response(QByteArray& out, const QByteArray& data, const QString& message)
+		{
+			// Keys in QJsonObject order, so replies are byte for byte what toJson() used to give
+			out.append("{\"data\":");
+			QByteArrayView trimmed_data = QByteArrayView(data).trimmed();
+			if (trimmed_data.isEmpty())
+			{
+				out.append("{}");
+			}
+			else if (trimmed_data.front() == '{' || trimmed_data.front() == '[')
+			{
+				out.append(trimmed_data); // already JSON, serialized once by the handler
 			}
 			else
 			{
-				response["data"] = QJsonObject();
+				append_string(out, QString::fromUtf8(data));
 			}
-			
-			QJsonDocument doc(response);
-			return doc.toJson(QJsonDocument::Compact);
-    	}
+			out.append(",\"message\":");
+			append_string(out, message.isEmpty() ? QStringView(u"Success") : QStringView(message));
+			out.append(",\"success\":true}");
+		}
+
+		void append_error_response(QByteArray& out, const QString& error_message, int error_code)
+		{
+			out.append('{');
+			if (error_code != -1)
+			{
+				out.append("\"error_code\":");
+				out.append(QByteArray::number(error_code));
+				out.append(',');
+			}
+			out.append("\"message\":");
+			append_string(out, error_message);
+			out.append(",\"success\":false}");
+		}
 
 		QString format_json(const QString& json_str)
 		{
@@ -717,6 +881,24 @@ namespace Utils
 			qint64 availableGB = storageInfo.bytesAvailable() / (1024 * 1024 * 1024);
 			qCInfo(serverGeneral) << "Root Storage:" << totalGB << "GB total," << availableGB << "GB available";
 		}
+
+		bool is_allocation_counting_enabled()
+		{
+#ifdef AGENTIE_COUNT_ALLOCATIONS
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		quint64 get_thread_allocation_count()
+		{
+#ifdef AGENTIE_COUNT_ALLOCATIONS
+			return thread_allocations;
+#else
+			return 0;
+#endif
+		}
 	}
 
 	namespace Performance